@@ -0,0 +1,22 @@
+# Tell the user project where to find our headers and libraries
+SET(LIBAWS_INCLUDE_DIRS "/root/repo/libaws/include"
+                       "/tmp/gb/include"
+                       "/root/repo/libaws/src"
+                       "/tmp/gb/src"
+)
+SET(LIBAWS_LIBRARY_DIRS "/tmp/gb/src"
+)
+
+SET(LIBAWS_DIR "/tmp/gb")
+
+SET(LIBAWS_API "/tmp/gb/include"
+              "/root/repo/libaws/include"
+)
+
+# Tell the user project where to find our build settings and library dependencies
+SET(LIBAWS_BUILD_SETTINGS_FILE "/tmp/gb/LIBAWSBuildSettings.cmake")
+INCLUDE("/tmp/gb/LIBAWSDepends.cmake")
+
+# Tell the user project where to find the "USE" file.
+# This file uses the above settings to configure the user project
+SET(LIBAWS_USE_FILE "/root/repo/libaws/LIBAWSUse.cmake")
@@ -16,7 +16,13 @@
 #include "awscache.h"
 #include <cassert>
 #include <memory>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
 #include <syslog.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <libaws/awslog.h>
 
 #define S3FS_LOG_SYSLOG 1
 //#define CACHE_TEXT_FILES_ONLY 1
@@ -34,13 +40,13 @@ static int S3CACHE_LOGGING_LEVEL=S3CACHE_INFO;
 	    std::ostringstream logMessage; \
             if (level==S3CACHE_DEBUG){ \
                     logMessage << "AWSCache(bucket:" << theBucketname << ") " << location << " [DEBUG] ## " << message << " ## "; \
-		    syslog( LOG_DEBUG, logMessage.str().c_str() ); \
+		    aws::AWSLog::log( LOG_DEBUG, logMessage.str() ); \
 	    }else if (level==S3CACHE_INFO){ \
                     logMessage << "AWSCache(bucket:" << theBucketname << ") " << location << " [INFO] ## " << message << " ## "; \
-		    syslog( LOG_NOTICE, logMessage.str().c_str() ); \
+		    aws::AWSLog::log( LOG_NOTICE, logMessage.str() ); \
 	    }else if (level==S3CACHE_ERROR){ \
                     logMessage << "AWSCache(bucket:" << theBucketname << ") " << location << " [ERROR] ## " << message << " ## "; \
-		    syslog( LOG_ERR, logMessage.str().c_str() ); \
+		    aws::AWSLog::log( LOG_ERR, logMessage.str() ); \
 	    } \
       }
 #  else
@@ -80,182 +86,106 @@ namespace aws {
   std::string AWSCache::PREFIX_SYMLINK("symlink");
 
   unsigned int AWSCache::FILE_CACHING_UPPER_LIMIT=300000; // 1000 (means approx. 1kb)
+  unsigned int AWSCache::FILE_CHUNK_SIZE=512*1024;
   std::string AWSCache::DELIMITER_FOLDER_ENTRIES=",";
 
-  AWSCache::AWSCache(std::string bucketname):
+  AWSCache::AWSCache(std::string bucketname, CacheBackend* backend):
+     theBackend(backend),
      theBucketname(bucketname)
   {
-    if (!(theServers= getenv("MEMCACHED_SERVERS")))
-    {
-      std::cerr << "Unable to use memcached client functionality. Please specify the MEMCACHED_SERVERS environment variable" << std::endl;
-      exit(4);
-    }
+    memset(theHits, 0, sizeof(theHits));
+    memset(theMisses, 0, sizeof(theMisses));
   }
 
   AWSCache::~AWSCache(){
   }
 
-  memcached_st *
-  AWSCache::get_Memcached_struct()
-  {
-    S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::get_Memcached_struct()","create struct");
-
-    memcached_server_st *servers;
-    memcached_st * memc=memcached_create(NULL);
-    servers= memcached_servers_parse(theServers);
-
-    // tell memc where the memcached servers are
-    memcached_server_push(memc, servers);
-    memcached_server_list_free(servers);
-
-    return memc;
-  }
-
-
-  void AWSCache::free_Memcached_struct(memcached_st * memc)
-  {
-    S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::free_Memcached_struct(...)","destroy struct");
-
-    memcached_free(memc);
-  }
-
 /*
  * delete a key
  */
   void AWSCache::delete_key(const std::string& key)
   {
-    memcached_st* memc=NULL;
     try{
-      memc=get_Memcached_struct();
-      delete_key(memc,key);
-      free_Memcached_struct(memc);
+      theBackend->remove(key);
+      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::delete_key(...)","   invalidated key: '" << key << "'");
     }catch(...){
       S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::delete_key(...)","error invalidating key: '" << key << "'");
-      if(memc)free_Memcached_struct(memc);
-    }
-  }
-
-
-  void AWSCache::delete_key(memcached_st* memc, const std::string& key)
-  {
-    //memcached_return rc;
-    // TOOD: do something with the return value
-    memcached_delete (memc, key.c_str(), strlen(key.c_str()),(time_t)0);
-
-#ifndef NDEBUG
-    if (rc == MEMCACHED_SUCCESS){
-      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::delete_key(...)","   successfully invalidated key: '" << key << "'");
-    }else{
-      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::delete_key(...)","[WARNING] could not delete key: '" << key << "' from cache (rc=" << (int) rc << ": "<< memcached_strerror(memc,rc) <<")");
     }
-#endif
   }
 
 /*
  * save a key
  */
-  void AWSCache::save_key(memcached_st* memc, const std::string& key, const std::string& value)
-  {
-    //memcached_return rc;
-    // TODO: do something with the return value
-    memcached_set(memc, key.c_str(), strlen(key.c_str()),value.c_str(), strlen(value.c_str()),(time_t)0, (uint32_t)0);
-
-#ifndef NDEBUG
-    if (rc == MEMCACHED_SUCCESS){
-      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::save_cache_key(...)","successfully stored key: '" << key << "' value: '" << value << "'");
-    }else{
-      S3CACHE_LOG(S3CACHE_INFO,"AWSCache::save_cache_key(...)","[ERROR] could not store key: '" << key << "' in cache (rc=" << (int) rc << ": "<< memcached_strerror(memc,rc) <<")");
-    }
-#endif
-  }
-
-
   void AWSCache::save_key(const std::string& key, const std::string& value)
   {
-    memcached_st* memc=NULL;
     try{
-      memc=get_Memcached_struct();
-      save_key(memc,key,value);
-      free_Memcached_struct(memc);
+      if (theBackend->set(key, value.c_str(), value.length())){
+        S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::save_key(...)","successfully stored key: '" << key << "' value: '" << value << "'");
+      }else{
+        S3CACHE_LOG(S3CACHE_INFO,"AWSCache::save_key(...)","[ERROR] could not store key: '" << key << "' in cache");
+      }
     }catch(...){
       S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::save_key(...)","error saving key: '" << key << "' with value: '" << value << "'");
-      if(memc)free_Memcached_struct(memc);
     }
   }
 
-
 /*
  * saving a file to cache
+ * the chunks are sent directly from the mapped file, the key of the file
+ * holds "version:size:chunks" and is written after all chunks were stored
  */
-  void AWSCache::save_file(memcached_st* memc, const std::string& key, std::fstream* fstream, size_t size)
+  void AWSCache::save_file(const std::string& key, const std::string& version, int fd, size_t size)
   {
-    //memcached_return rc;
-    std::auto_ptr<char> memblock(new char [size]);
-
-    ASSERT(fstream);
-    fstream->seekg(0,std::ios_base::beg);
-
-    fstream->read(memblock.get(),size);
-    ASSERT((unsigned int)fstream->gcount()==size);
-
-    // TODO: do something with the return value
-    if(size==0){
-      memcached_set(memc, key.c_str(), strlen(key.c_str()), "", 0,(time_t)0, (uint32_t)0);
-    }else{
-      memcached_set(memc, key.c_str(), strlen(key.c_str()), memblock.get(), size,(time_t)0, (uint32_t)0);
+    // only cache file content if not too big
+    if(size >= AWSCache::FILE_CACHING_UPPER_LIMIT){
+      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::save_file(...)","not caching file, because it is too large '" << key << "' (size: " << size << ").");
+      return;
     }
 
-#ifndef NDEBUG
-    if (rc == MEMCACHED_SUCCESS){
-      std::string lvalue(memblock.get());
-      S3CACHE_LOG(S3CACHE_INFO,"AWSCache::save_cache_key_file(...)","   successfully stored file: '" << key << "'; size: " << size);// value: '"<<lvalue<<"'");
-    }else{
-      S3CACHE_LOG(S3CACHE_INFO,"AWSCache::save_cache_key_file(...)","    [ERROR] could not store file: '" << key << "' in cache (rc=" << (int) rc << ": "<< memcached_strerror(memc,rc) <<")");
+#ifdef CACHE_TEXT_FILES_ONLY
+    // check if file type is known
+    const char* extensions[]={".xq", ".xml", ".txt", ".fcgi", ".cgi", ".html", ".htm", ".htaccess"};
+    bool known=false;
+    for(size_t i=0; !known && i<sizeof(extensions)/sizeof(extensions[0]); i++){
+      size_t length=strlen(extensions[i]);
+      known=key.length()>length && key.compare(key.length()-length, length, extensions[i])==0;
+    }
+    if(!known){
+      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::save_file(...)","due to an unsupported file type: not caching file: '" << key << "'");
+      return;
     }
 #endif
-  }
 
-void AWSCache::save_file(const std::string& key, std::fstream* fstream, size_t size)
-  {
-    memcached_st* memc=NULL;
     try{
-      memc=get_Memcached_struct();
+      bool stored=true;
+      size_t chunks=(size+FILE_CHUNK_SIZE-1)/FILE_CHUNK_SIZE;
+      if(size>0){
+        void* data=mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        if(data==MAP_FAILED){
+          S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::save_file(...)","couldn't map file: '" << key << "'");
+          return;
+        }
+        for(size_t i=0; i<chunks && stored; i++){
+          size_t offset=i*FILE_CHUNK_SIZE;
+          size_t length=(size-offset<FILE_CHUNK_SIZE) ? size-offset : FILE_CHUNK_SIZE;
+          stored=theBackend->set(getchunkkey(key, version, i), (const char*)data+offset, length);
+        }
+        munmap(data, size);
+      }
 
-      // only cache file content if not too big
-      if(size < AWSCache::FILE_CACHING_UPPER_LIMIT){
-          
-#ifdef CACHE_TEXT_FILES_ONLY
-      // check if file type is known
-         if(key.length()>3 && key.substr(key.length()-3,key.length()).compare(".xq")==0){
-            save_file(memc, key, fstream, size);
-         }else if(key.length()>4 && key.substr(key.length()-4,key.length()).compare(".xml")==0){
-           save_file(memc, key, fstream, size);
-         }else if(key.length()>4 && key.substr(key.length()-4,key.length()).compare(".txt")==0){
-           save_file(memc, key, fstream, size);
-         }else if(key.length()>5 && key.substr(key.length()-5,key.length()).compare(".fcgi")==0){
-           save_file(memc, key, fstream, size);
-         }else if(key.length()>4 && key.substr(key.length()-4,key.length()).compare(".cgi")==0){
-           save_file(memc, key, fstream, size);
-         }else if(key.length()>5 && key.substr(key.length()-5,key.length()).compare(".html")==0){
-           save_file(memc, key, fstream, size);
-         }else if(key.length()>4 && key.substr(key.length()-4,key.length()).compare(".htm")==0){
-           save_file(memc, key, fstream, size);
-         }else if(key.length()==9 && key.compare(".htaccess")==0){
-           save_file(memc, key, fstream, size);
-         }else{
-           S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::save_file(...)","due to an unsupported file type: not caching file: '" << key << "'");
-         }
-#else
-         save_file(memc, key, fstream, size);
-#endif
-      }else{
-        S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::save_file(...)","not caching file, because it is too large '" << key << "' (size: " << size << ").");
+      if(stored){
+        std::ostringstream manifest;
+        manifest << version << ":" << size << ":" << chunks;
+        stored=theBackend->set(key, manifest.str().c_str(), manifest.str().length());
       }
 
-      free_Memcached_struct(memc);
+      if (stored){
+        S3CACHE_LOG(S3CACHE_INFO,"AWSCache::save_file(...)","   successfully stored file: '" << key << "'; size: " << size << "; chunks: " << chunks);
+      }else{
+        S3CACHE_LOG(S3CACHE_INFO,"AWSCache::save_file(...)","    [ERROR] could not store file: '" << key << "' in cache");
+      }
     }catch(...){
       S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::save_file(...)","error saving file: '" << key << "'");
-      if(memc)free_Memcached_struct(memc);
     }
   }
 
@@ -265,125 +195,110 @@ void AWSCache::save_file(const std::string& key, std::fstream* fstream, size_t s
  */
   void AWSCache::save_stat(struct stat* stbuf, const std::string& path)
   {
-    // get memc
-    memcached_st* memc=NULL;
-
-    try{
-       memc=get_Memcached_struct();
-
-       std::string key=getkey(PREFIX_STAT_ATTR,path,"mode");
-       save_key(memc, key, to_string(stbuf->st_mode));
-
-       key=getkey(PREFIX_STAT_ATTR,path,"gid").c_str();
-       save_key(memc, key,to_string(stbuf->st_gid));
-
-       key=getkey(PREFIX_STAT_ATTR,path,"oid").c_str();
-       save_key(memc, key,to_string(stbuf->st_uid));
-
-       key=getkey(PREFIX_STAT_ATTR,path,"mtime").c_str();
-       save_key(memc, key,time_to_string(stbuf->st_mtime));
-
-       key=getkey(PREFIX_STAT_ATTR,path,"size").c_str();
-       save_key(memc, key,to_string(stbuf->st_size));
-
-       key=getkey(PREFIX_STAT_ATTR,path,"nlink").c_str();
-       save_key(memc, key,to_string(stbuf->st_nlink));
-
-       free_Memcached_struct(memc);
-    }catch(...){
-      S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::save_stat(...)","error saving file stat for file: '" << path << "'");
-      if(memc)free_Memcached_struct(memc);
-    }
+    save_key(getkey(PREFIX_STAT_ATTR,path,"mode"), to_string(stbuf->st_mode));
+    save_key(getkey(PREFIX_STAT_ATTR,path,"gid"), to_string(stbuf->st_gid));
+    save_key(getkey(PREFIX_STAT_ATTR,path,"oid"), to_string(stbuf->st_uid));
+    save_key(getkey(PREFIX_STAT_ATTR,path,"mtime"), time_to_string(stbuf->st_mtime));
+    save_key(getkey(PREFIX_STAT_ATTR,path,"size"), to_string(stbuf->st_size));
+    save_key(getkey(PREFIX_STAT_ATTR,path,"nlink"), to_string(stbuf->st_nlink));
   }
 
-
 /*
  * read a key
  */
-  std::string AWSCache::read_key(memcached_st* memc, const std::string& key, memcached_return* rc)
-  {
-    uint32_t flags;
-    size_t value_length;
-    char* value;
-    std::string lvalue="";
-
-    value=memcached_get(memc, key.c_str(), strlen(key.c_str()),&value_length, &flags, rc);
-    if (value!=NULL){
-       lvalue=std::string(value);
-       free(value);
-    }
-
-#ifndef NDEBUG
-    std::string lkey(key);
-    if (*rc == MEMCACHED_SUCCESS){
-      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::read_key(...)","successfully read cached key: '" << lkey << "' value: '" << lvalue << "'");
-    }else{
-      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::read_key(...)","[WARNING] could not read key: '" << lkey << "' from cache (rc=" << (int) *rc << ": "<< memcached_strerror(memc,*rc) <<")");
-    }
-#endif
-
-    return lvalue;
-  }
-
-  std::string AWSCache::read_key(const std::string& key, memcached_return* rc)
+  std::string AWSCache::read_key(const std::string& key, bool* found)
   {
-    memcached_st* memc=NULL;
     std::string result;
+    *found=false;
     try{
-      memc=get_Memcached_struct();
-      result=read_key(memc, key, rc);
-      free_Memcached_struct(memc);
+      *found=theBackend->get(key, result);
     }catch(...){
       S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::read_key(...)","error reading key: '" << key << "'");
-      if(memc)free_Memcached_struct(memc);
+    }
+    count_lookup(key, *found);
+
+    if (*found){
+      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::read_key(...)","successfully read cached key: '" << key << "' value: '" << result << "'");
+    }else{
+      S3CACHE_LOG(S3CACHE_DEBUG,"AWSCache::read_key(...)","[WARNING] could not read key: '" << key << "' from cache");
     }
     return result;
   }
 
-
-
 /*
  * read a cached file
+ * all chunks are requested at once and written into the file as they arrive
  */
-  void AWSCache::read_file(memcached_st* memc, const std::string& key, std::fstream* fstream, memcached_return* rc)
-  {
-    uint32_t flags;
-    size_t value_length;
-    char* value;
+  namespace {
 
-    ASSERT(fstream);
+    class ChunkWriter : public CacheBackend::Receiver
+    {
+    public:
+      ChunkWriter(int fd, size_t size, size_t chunks)
+        : theFd(fd), theSize(size), theReceived(chunks, false), theCount(0), theFailed(false) {}
+
+      virtual void receive(size_t index, const char* value, size_t length)
+      {
+        size_t offset=index*AWSCache::FILE_CHUNK_SIZE;
+        size_t expected=(theSize-offset<AWSCache::FILE_CHUNK_SIZE) ? theSize-offset : AWSCache::FILE_CHUNK_SIZE;
+        if(theReceived[index] || length!=expected
+           || pwrite(theFd, value, length, offset)!=(ssize_t)length){
+          theFailed=true;
+          return;
+        }
+        theReceived[index]=true;
+        theCount++;
+      }
 
-    value=memcached_get(memc, key.c_str(), strlen(key.c_str()),&value_length, &flags, rc);
+      bool complete() const { return !theFailed && theCount==theReceived.size(); }
 
-    std::string lkey(key);
-    if (*rc == MEMCACHED_SUCCESS){
-      if(value!=NULL){
-        S3CACHE_LOG(S3CACHE_INFO,"AWSCache::read_file(...)","successfully read cached file: '" << lkey << "'; size: " << value_length);
-        fstream->seekg(0,std::ios_base::beg);
-	fstream->write(value, value_length);
-        fstream->flush();
-      }else{
-      	S3CACHE_LOG(S3CACHE_INFO,"AWSCache::read_file(...)","[WARNING] value is NULL.");
-      }
-    }
-#ifndef NDEBUG
-    else{
-      S3CACHE_LOG(S3CACHE_INFO,"AWSCache::read_file(...)","[WARNING] could not read file: '" << lkey << "' from cache (rc=" << (int) *rc << ": "<< memcached_strerror(memc,*rc) <<")");
-    }
-#endif
-  }
+      size_t count() const { return theCount; }
 
+    private:
+      int               theFd;
+      size_t            theSize;
+      std::vector<bool> theReceived;
+      size_t            theCount;
+      bool              theFailed;
+    };
+
+  }
 
-  void AWSCache::read_file(const std::string& key, std::fstream* fstream, memcached_return* rc)
+  void AWSCache::read_file(const std::string& key, int fd, size_t size, std::string* version, bool* found)
   {
-    memcached_st* memc=NULL;
+    std::string manifest=read_key(key, found);
+    if (!*found)
+      return;
+
+    // version:size:chunks, the version may contain colons
+    *found=false;
+    std::string::size_type sizepos=manifest.rfind(':');
+    sizepos=(sizepos==std::string::npos || sizepos==0) ? std::string::npos : manifest.rfind(':', sizepos-1);
+    if(sizepos==std::string::npos
+       || (size_t)atol(manifest.substr(sizepos+1).c_str())!=size){
+      S3CACHE_LOG(S3CACHE_INFO,"AWSCache::read_file(...)","[WARNING] cached file: '" << key << "' has another size");
+      return;
+    }
+    *version=manifest.substr(0, sizepos);
+
+    size_t chunks=(size+FILE_CHUNK_SIZE-1)/FILE_CHUNK_SIZE;
+    std::vector<std::string> chunkkeys(chunks);
+    for(size_t i=0; i<chunks; i++)
+      chunkkeys[i]=getchunkkey(key, *version, i);
+
+    ChunkWriter writer(fd, size, chunks);
     try{
-      memc=get_Memcached_struct();
-      read_file(memc, key, fstream, rc);
-      free_Memcached_struct(memc);
+      if(chunks>0)
+        theBackend->get_multi(chunkkeys, writer);
     }catch(...){
       S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::read_file(...)","error reading file: '" << key << "'");
-      if(memc)free_Memcached_struct(memc);
+    }
+
+    *found=writer.complete();
+    if(*found){
+      S3CACHE_LOG(S3CACHE_INFO,"AWSCache::read_file(...)","successfully read cached file: '" << key << "'; size: " << size);
+    }else{
+      S3CACHE_LOG(S3CACHE_INFO,"AWSCache::read_file(...)","[WARNING] got " << writer.count() << " of " << chunks << " chunks of file: '" << key << "'");
     }
   }
 
@@ -392,40 +307,46 @@ void AWSCache::save_file(const std::string& key, std::fstream* fstream, size_t s
  */
   void AWSCache::read_stat(struct stat* stbuf,const std::string& path)
   {
-    // get memc
-    memcached_st* memc=NULL;
-
-    try{
-       memc=get_Memcached_struct();
-       memcached_return rc;
-
-       std::string key=getkey(PREFIX_STAT_ATTR,path,"mode");
-       stbuf->st_mode=atoi(read_key(memc, key, &rc).c_str());
-
-       key=getkey(PREFIX_STAT_ATTR,path,"gid");
-       stbuf->st_gid=atoi(read_key(memc, key, &rc).c_str());
-
-       key=getkey(PREFIX_STAT_ATTR,path,"oid");
-       stbuf->st_uid=atoi(read_key(memc, key, &rc).c_str());
-
-       key=getkey(PREFIX_STAT_ATTR,path,"mtime");
-       stbuf->st_mtime=AWSCache::string_to_time(read_key(memc, key, &rc).c_str());
-
-       key=getkey(PREFIX_STAT_ATTR,path,"size");
-       stbuf->st_size=atol(read_key(memc, key, &rc).c_str());
+    bool found;
+    stbuf->st_mode=atoi(read_key(getkey(PREFIX_STAT_ATTR,path,"mode"), &found).c_str());
+    stbuf->st_gid=atoi(read_key(getkey(PREFIX_STAT_ATTR,path,"gid"), &found).c_str());
+    stbuf->st_uid=atoi(read_key(getkey(PREFIX_STAT_ATTR,path,"oid"), &found).c_str());
+    stbuf->st_mtime=AWSCache::string_to_time(read_key(getkey(PREFIX_STAT_ATTR,path,"mtime"), &found).c_str());
+    stbuf->st_size=atol(read_key(getkey(PREFIX_STAT_ATTR,path,"size"), &found).c_str());
+    stbuf->st_nlink=atol(read_key(getkey(PREFIX_STAT_ATTR,path,"nlink"), &found).c_str());
+  }
 
-       key=getkey(PREFIX_STAT_ATTR,path,"nlink");
-       stbuf->st_nlink=atol(read_key(memc, key, &rc).c_str());
+/*
+ * statistics
+ */
+  void AWSCache::count_lookup(const std::string& key, bool hit)
+  {
+    // keys are bucket:prefix:attr:path
+    std::string::size_type start=key.find(':');
+    if(start==std::string::npos) return;
+    std::string::size_type end=key.find(':', start+1);
+    std::string prefix=key.substr(start+1, end==std::string::npos ? std::string::npos : end-start-1);
+
+    const std::string* prefixes[NUMBER_OF_PREFIXES]={&PREFIX_EXISTS, &PREFIX_STAT_ATTR, &PREFIX_DIR_LS, &PREFIX_FILE, &PREFIX_SYMLINK};
+    for(int i=0; i<NUMBER_OF_PREFIXES; i++){
+      if(prefix==*prefixes[i]){
+        __sync_add_and_fetch(hit ? &theHits[i] : &theMisses[i], 1);
+        return;
+      }
+    }
+  }
 
-       free_Memcached_struct(memc);
-    }catch(...){
-      S3CACHE_LOG(S3CACHE_ERROR,"AWSCache::read_stat(...)","error reading file stat for: '" << path << "'");
-      if(memc)free_Memcached_struct(memc);
+  void AWSCache::print_stats(std::ostream& os) const
+  {
+    const std::string* prefixes[NUMBER_OF_PREFIXES]={&PREFIX_EXISTS, &PREFIX_STAT_ATTR, &PREFIX_DIR_LS, &PREFIX_FILE, &PREFIX_SYMLINK};
+    for(int i=0; i<NUMBER_OF_PREFIXES; i++){
+      os << "cache." << *prefixes[i] << ".hits " << theHits[i] << "\n";
+      os << "cache." << *prefixes[i] << ".misses " << theMisses[i] << "\n";
     }
   }
 
 /*******************
- * MEMCACHED HELPERS
+ * CACHE HELPERS
  *******************
  */
   std::string AWSCache::getkey(std::string& prefix, std::string key, std::string attr)
@@ -446,6 +367,13 @@ void AWSCache::save_file(const std::string& key, std::fstream* fstream, size_t s
     return result;
   }
 
+  std::string AWSCache::getchunkkey(const std::string& key, const std::string& version, size_t chunk)
+  {
+    std::ostringstream result;
+    result << key << "#" << version << "#" << chunk;
+    return result.str();
+  }
+
   std::string AWSCache::getParentFolder(const std::string& path)
   {
     size_t pos;
@@ -26,8 +26,11 @@
 #include <fuse.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 
-#include <libmemcached/memcached.h>
+#include <memory>
+
+#include "cachebackend.h"
 
 namespace aws { 
 
@@ -36,28 +39,26 @@ class AWSCache
 
 private:
 
-  char* theServers;
+  std::auto_ptr<CacheBackend> theBackend;
   std::string theBucketname;
 
-  void free_Memcached_struct(memcached_st * memc);
-
-  memcached_st* get_Memcached_struct();
-
-  void delete_key(memcached_st* memc, const std::string& key);
-
-  void save_key(memcached_st* memc, const std::string& key, const std::string& value);
+  // lookups per key prefix (ex, attr, ls, file, symlink)
+  enum { NUMBER_OF_PREFIXES = 5 };
+  uint64_t theHits[NUMBER_OF_PREFIXES];
+  uint64_t theMisses[NUMBER_OF_PREFIXES];
 
-  void save_file(memcached_st* memc, const std::string& key, std::fstream* fstream, size_t size);
+  void count_lookup(const std::string& key, bool hit);
 
-  std::string read_key(memcached_st* memc, const std::string& key, memcached_return* rc);
-
-  void read_file(memcached_st* memc, const std::string& key, std::fstream* fstream, memcached_return* rc);
+  std::string getchunkkey(const std::string& key, const std::string& version, size_t chunk);
 
 public:
 
   // file size limit that is cached -> bigger files are never cached
   static unsigned int FILE_CACHING_UPPER_LIMIT;
 
+  // files are stored in chunks of this size (below the memcached item size)
+  static unsigned int FILE_CHUNK_SIZE;
+
   static std::string PREFIX_EXISTS;
   static std::string PREFIX_STAT_ATTR;
   static std::string PREFIX_DIR_LS;
@@ -65,7 +66,8 @@ public:
   static std::string PREFIX_SYMLINK;
   static std::string DELIMITER_FOLDER_ENTRIES;
 
-  AWSCache(std::string bucketname);
+  // the cache owns the backend
+  AWSCache(std::string bucketname, CacheBackend* backend);
 
   ~AWSCache();
 
@@ -73,18 +75,23 @@ public:
 
   void save_key(const std::string& key, const std::string& value);
 
-  void save_file(const std::string& key, std::fstream* fstream, size_t size);
+  // stores the contents of the file as chunks whose keys contain the version (e.g. the ETag)
+  void save_file(const std::string& key, const std::string& version, int fd, size_t size);
 
   void save_stat(struct stat* stbuf, const std::string& path);
 
-  std::string read_key(const std::string& key, memcached_return* rc);
+  std::string read_key(const std::string& key, bool* found);
 
-  void read_file(const std::string& key, std::fstream* fstream, memcached_return* rc);
+  // writes the chunks of the file into fd if all of them are cached with the given size
+  void read_file(const std::string& key, int fd, size_t size, std::string* version, bool* found);
 
   void read_stat(struct stat* stbuf, const std::string& path);
 
+  // prints the hits and misses per key prefix as "name value" lines
+  void print_stats(std::ostream& os) const;
+
 /*******************
- * MEMCACHED HELPERS
+ * CACHE HELPERS
  *******************
  */
 
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cachebackend.h"
+
+namespace aws { 
+
+void
+CacheBackend::get_multi(const std::vector<std::string>& keys, Receiver& receiver)
+{
+  std::string value;
+  for(size_t i=0; i<keys.size(); i++){
+    if(get(keys[i], value))
+      receiver.receive(i, value.c_str(), value.length());
+  }
+}
+
+TieredBackend::TieredBackend()
+{
+}
+
+TieredBackend::~TieredBackend()
+{
+  for(size_t i=0; i<theTiers.size(); i++)
+    delete theTiers[i];
+}
+
+void
+TieredBackend::add(CacheBackend* backend)
+{
+  theTiers.push_back(backend);
+  theHits.push_back(0);
+}
+
+bool
+TieredBackend::get(const std::string& key, std::string& value)
+{
+  for(size_t i=0; i<theTiers.size(); i++){
+    if(theTiers[i]->get(key, value)){
+      __sync_add_and_fetch(&theHits[i], 1);
+      for(size_t j=0; j<i; j++)
+        theTiers[j]->set(key, value.c_str(), value.length());
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+TieredBackend::set(const std::string& key, const char* value, size_t length)
+{
+  // the lowest tier is the one that is shared by most processes,
+  // a value counts as stored if any tier took it (e.g. chunks that
+  // don't fit into a shared memory slot)
+  bool result=false;
+  for(size_t i=theTiers.size(); i>0; i--)
+    result=theTiers[i-1]->set(key, value, length) || result;
+  return result;
+}
+
+void
+TieredBackend::remove(const std::string& key)
+{
+  for(size_t i=theTiers.size(); i>0; i--)
+    theTiers[i-1]->remove(key);
+}
+
+namespace {
+
+  // remembers the values that were found in a tier and copies them into the tiers above
+  class TierReceiver : public CacheBackend::Receiver
+  {
+  public:
+    TierReceiver(CacheBackend::Receiver& receiver, std::vector<CacheBackend*>& upper,
+                 const std::vector<std::string>& keys, const std::vector<size_t>& indexes,
+                 std::vector<bool>& found)
+      : theReceiver(receiver), theUpper(upper), theKeys(keys), theIndexes(indexes),
+        theFound(found), theCount(0) {}
+
+    virtual void receive(size_t index, const char* value, size_t length)
+    {
+      size_t original=theIndexes[index];
+      if(theFound[original])
+        return;
+      theFound[original]=true;
+      theCount++;
+      for(size_t i=0; i<theUpper.size(); i++)
+        theUpper[i]->set(theKeys[index], value, length);
+      theReceiver.receive(original, value, length);
+    }
+
+    uint64_t count() const { return theCount; }
+
+  private:
+    CacheBackend::Receiver&         theReceiver;
+    std::vector<CacheBackend*>&     theUpper;
+    const std::vector<std::string>& theKeys;
+    const std::vector<size_t>&      theIndexes;
+    std::vector<bool>&              theFound;
+    uint64_t                        theCount;
+  };
+
+}
+
+void
+TieredBackend::get_multi(const std::vector<std::string>& keys, Receiver& receiver)
+{
+  std::vector<bool> found(keys.size(), false);
+  std::vector<CacheBackend*> upper;
+  for(size_t i=0; i<theTiers.size(); i++){
+    // only the keys that weren't found in the tiers above
+    std::vector<std::string> missing;
+    std::vector<size_t> indexes;
+    for(size_t j=0; j<keys.size(); j++){
+      if(!found[j]){
+        missing.push_back(keys[j]);
+        indexes.push_back(j);
+      }
+    }
+    if(missing.empty())
+      return;
+
+    TierReceiver tier(receiver, upper, missing, indexes, found);
+    theTiers[i]->get_multi(missing, tier);
+    __sync_add_and_fetch(&theHits[i], tier.count());
+    upper.push_back(theTiers[i]);
+  }
+}
+
+std::string
+TieredBackend::name() const
+{
+  std::string result;
+  for(size_t i=0; i<theTiers.size(); i++){
+    if(i>0) result.append("+");
+    result.append(theTiers[i]->name());
+  }
+  return result;
+}
+
+void
+TieredBackend::print_stats(std::ostream& os) const
+{
+  for(size_t i=0; i<theTiers.size(); i++)
+    os << "cache.tier." << theTiers[i]->name() << ".hits " << theHits[i] << "\n";
+}
+
+} /* namespace aws */
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3FS_CACHEBACKEND
+#define AWS_S3FS_CACHEBACKEND
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace aws { 
+
+/**
+ * Storage of the AWSCache (memcached, process memory, shared memory).
+ * Implementations must be thread-safe.
+ */
+class CacheBackend
+{
+public:
+
+  // receives the values of get_multi in any order
+  class Receiver
+  {
+  public:
+    virtual ~Receiver() {}
+
+    virtual void receive(size_t index, const char* value, size_t length) = 0;
+  };
+
+  virtual ~CacheBackend() {}
+
+  virtual bool get(const std::string& key, std::string& value) = 0;
+
+  virtual bool set(const std::string& key, const char* value, size_t length) = 0;
+
+  virtual void remove(const std::string& key) = 0;
+
+  // calls get for each key, backends that support batches override it
+  virtual void get_multi(const std::vector<std::string>& keys, Receiver& receiver);
+
+  virtual std::string name() const = 0;
+};
+
+/**
+ * Stack of backends, e.g. process memory, shared memory, and memcached.
+ * get returns the value of the first tier that has it and copies it into
+ * the tiers above, set and remove go to all tiers. set succeeds if
+ * at least one tier stored the value.
+ */
+class TieredBackend : public CacheBackend
+{
+public:
+
+  TieredBackend();
+
+  virtual ~TieredBackend();
+
+  // adds a tier below the existing ones, the backend is deleted with this object
+  void add(CacheBackend* backend);
+
+  size_t size() const { return theTiers.size(); }
+
+  virtual bool get(const std::string& key, std::string& value);
+
+  virtual bool set(const std::string& key, const char* value, size_t length);
+
+  virtual void remove(const std::string& key);
+
+  virtual void get_multi(const std::vector<std::string>& keys, Receiver& receiver);
+
+  virtual std::string name() const;
+
+  // prints the hits per tier as "name value" lines
+  void print_stats(std::ostream& os) const;
+
+private:
+
+  std::vector<CacheBackend*> theTiers;
+  std::vector<uint64_t>      theHits;
+};
+
+} /* namespace aws */
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "keyfilter.h"
+
+#include <cmath>
+
+namespace aws { 
+
+KeyFilter::KeyFilter(size_t aCapacity, double aFalsePositiveRate, time_t aMaxAge)
+  : theCapacity(aCapacity > 0 ? aCapacity : 1),
+    theNumberOfKeys(0),
+    theMaxAge(aMaxAge)
+{
+  if (aFalsePositiveRate <= 0 || aFalsePositiveRate >= 1)
+    aFalsePositiveRate = 0.01;
+
+  // optimal size for the given rate: m = -n ln(p) / ln(2)^2, k = m/n ln(2)
+  double lLn2 = std::log(2.0);
+  double lBits = -(double)theCapacity * std::log(aFalsePositiveRate) / (lLn2 * lLn2);
+  theNumberOfBits = (size_t)std::ceil(lBits);
+  theNumberOfHashes = (size_t)std::floor(lBits / theCapacity * lLn2 + 0.5);
+  if (theNumberOfHashes == 0)
+    theNumberOfHashes = 1;
+  theBits.resize((theNumberOfBits + 63) / 64, 0);
+}
+
+void
+KeyFilter::addDirectory(const std::string& aDirectory, const std::vector<std::string>& aKeys)
+{
+  theMutex.lock();
+  if (theNumberOfKeys + aKeys.size() > theCapacity)
+    clear();
+  for (std::vector<std::string>::const_iterator lIter = aKeys.begin();
+       lIter != aKeys.end(); ++lIter) {
+    add(*lIter);
+  }
+  // a directory that doesn't fit alone isn't remembered, lookups would be wrong
+  if (theNumberOfKeys <= theCapacity)
+    theDirectories[aDirectory] = time(0);
+  theMutex.unlock();
+}
+
+void
+KeyFilter::addKey(const std::string& aKey)
+{
+  theMutex.lock();
+  if (theNumberOfKeys >= theCapacity)
+    clear();
+  add(aKey);
+  theMutex.unlock();
+}
+
+bool
+KeyFilter::isMissing(const std::string& aKey)
+{
+  bool lIsMissing = false;
+  theMutex.lock();
+  std::map<std::string, time_t>::iterator lDir = theDirectories.find(getDirectory(aKey));
+  if (lDir != theDirectories.end()) {
+    if (lDir->second + theMaxAge <= time(0))
+      theDirectories.erase(lDir);
+    else
+      lIsMissing = !mayContain(aKey);
+  }
+  theMutex.unlock();
+  return lIsMissing;
+}
+
+size_t
+KeyFilter::getNumberOfKeys()
+{
+  theMutex.lock();
+  size_t lKeys = theNumberOfKeys;
+  theMutex.unlock();
+  return lKeys;
+}
+
+size_t
+KeyFilter::getNumberOfDirectories()
+{
+  theMutex.lock();
+  size_t lDirectories = theDirectories.size();
+  theMutex.unlock();
+  return lDirectories;
+}
+
+void
+KeyFilter::clear()
+{
+  theBits.assign(theBits.size(), 0);
+  theNumberOfKeys = 0;
+  theDirectories.clear();
+}
+
+void
+KeyFilter::add(const std::string& aKey)
+{
+  uint64_t lHash1, lHash2;
+  hash(aKey, lHash1, lHash2);
+  for (size_t i = 0; i < theNumberOfHashes; ++i) {
+    size_t lBit = (size_t)((lHash1 + i * lHash2) % theNumberOfBits);
+    theBits[lBit / 64] |= ((uint64_t)1) << (lBit % 64);
+  }
+  ++theNumberOfKeys;
+}
+
+bool
+KeyFilter::mayContain(const std::string& aKey) const
+{
+  uint64_t lHash1, lHash2;
+  hash(aKey, lHash1, lHash2);
+  for (size_t i = 0; i < theNumberOfHashes; ++i) {
+    size_t lBit = (size_t)((lHash1 + i * lHash2) % theNumberOfBits);
+    if ((theBits[lBit / 64] & (((uint64_t)1) << (lBit % 64))) == 0)
+      return false;
+  }
+  return true;
+}
+
+void
+KeyFilter::hash(const std::string& aKey, uint64_t& aHash1, uint64_t& aHash2)
+{
+  // FNV-1a, the second hash is derived by a 64 bit finalizer (double hashing)
+  uint64_t lHash = 14695981039346656037ULL;
+  for (std::string::const_iterator lIter = aKey.begin(); lIter != aKey.end(); ++lIter) {
+    lHash ^= (unsigned char)*lIter;
+    lHash *= 1099511628211ULL;
+  }
+  aHash1 = lHash;
+  lHash ^= lHash >> 33;
+  lHash *= 0xff51afd7ed558ccdULL;
+  lHash ^= lHash >> 33;
+  lHash *= 0xc4ceb9fe1a85ec53ULL;
+  lHash ^= lHash >> 33;
+  aHash2 = lHash | 1;
+}
+
+std::string
+KeyFilter::getDirectory(const std::string& aKey)
+{
+  std::string::size_type lSlash = aKey.rfind('/');
+  if (lSlash == std::string::npos)
+    return "";
+  return aKey.substr(0, lSlash + 1);
+}
+
+} /* namespace aws */
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3FS_KEYFILTER
+#define AWS_S3FS_KEYFILTER
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <libaws/mutex.h>
+
+namespace aws { 
+
+/**
+ * Bloom filter of the keys of the directories that were listed recently.
+ * It proves that a key doesn't exist if its directory was listed within
+ * the last aMaxAge seconds and the key was neither in the listing nor
+ * created by s3fs afterwards.
+ *
+ * Keys can't be removed from the filter (deleted keys only cause false
+ * positives). If more keys than aCapacity were added, the filter is
+ * cleared and refilled by the following directory listings.
+ */
+class KeyFilter
+{
+public:
+
+  KeyFilter(size_t aCapacity, double aFalsePositiveRate, time_t aMaxAge);
+
+  // remember the complete listing of a directory ("" for the root, "a/b/" otherwise)
+  void addDirectory(const std::string& aDirectory, const std::vector<std::string>& aKeys);
+
+  // remember a key that was created by s3fs
+  void addKey(const std::string& aKey);
+
+  // true if the key definitely doesn't exist
+  bool isMissing(const std::string& aKey);
+
+  size_t getNumberOfKeys();
+
+  size_t getNumberOfDirectories();
+
+private:
+
+  void clear();
+
+  void add(const std::string& aKey);
+
+  bool mayContain(const std::string& aKey) const;
+
+  static void hash(const std::string& aKey, uint64_t& aHash1, uint64_t& aHash2);
+
+  static std::string getDirectory(const std::string& aKey);
+
+  AWSMutex                       theMutex;
+  std::vector<uint64_t>          theBits;
+  size_t                         theNumberOfBits;
+  size_t                         theNumberOfHashes;
+  size_t                         theCapacity;
+  size_t                         theNumberOfKeys;
+  time_t                         theMaxAge;
+  std::map<std::string, time_t>  theDirectories;
+};
+
+} /* namespace aws */
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lrubackend.h"
+
+namespace aws { 
+
+LRUBackend::LRUBackend(size_t capacity, size_t maxitem, time_t ttl)
+  : theCapacity(capacity),
+    theMaxItem(maxitem),
+    theTTL(ttl),
+    theSize(0)
+{
+}
+
+bool
+LRUBackend::get(const std::string& key, std::string& value)
+{
+  bool result=false;
+  theMutex.lock();
+  EntryMap::iterator entry=theIndex.find(key);
+  if(entry!=theIndex.end()){
+    if(theTTL>0 && entry->second->expires<=time(0)){
+      erase(entry);
+    }else{
+      theEntries.splice(theEntries.begin(), theEntries, entry->second);
+      value=entry->second->value;
+      result=true;
+    }
+  }
+  theMutex.unlock();
+  return result;
+}
+
+bool
+LRUBackend::set(const std::string& key, const char* value, size_t length)
+{
+  theMutex.lock();
+  EntryMap::iterator entry=theIndex.find(key);
+  if(entry!=theIndex.end())
+    erase(entry);
+  if(length>theMaxItem || key.length()+length>theCapacity){
+    theMutex.unlock();
+    return false;
+  }
+
+  while(theSize+key.length()+length>theCapacity)
+    erase(theIndex.find(theEntries.back().key));
+
+  Entry newentry;
+  newentry.key=key;
+  newentry.value.assign(value, length);
+  newentry.expires=time(0)+theTTL;
+  theEntries.push_front(newentry);
+  theIndex[key]=theEntries.begin();
+  theSize+=key.length()+length;
+  theMutex.unlock();
+  return true;
+}
+
+void
+LRUBackend::remove(const std::string& key)
+{
+  theMutex.lock();
+  EntryMap::iterator entry=theIndex.find(key);
+  if(entry!=theIndex.end())
+    erase(entry);
+  theMutex.unlock();
+}
+
+void
+LRUBackend::erase(EntryMap::iterator entry)
+{
+  theSize-=entry->second->key.length()+entry->second->value.length();
+  theEntries.erase(entry->second);
+  theIndex.erase(entry);
+}
+
+} /* namespace aws */
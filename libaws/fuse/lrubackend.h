@@ -0,0 +1,71 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3FS_LRUBACKEND
+#define AWS_S3FS_LRUBACKEND
+
+#include <ctime>
+#include <list>
+#include <map>
+
+#include <libaws/mutex.h>
+#include "cachebackend.h"
+
+namespace aws { 
+
+/**
+ * Cache in the memory of the process, bounded by the number of bytes of
+ * the keys and values. Entries expire after ttl seconds (0 = never),
+ * because changes made by other hosts don't remove them.
+ */
+class LRUBackend : public CacheBackend
+{
+public:
+
+  LRUBackend(size_t capacity, size_t maxitem, time_t ttl);
+
+  virtual bool get(const std::string& key, std::string& value);
+
+  virtual bool set(const std::string& key, const char* value, size_t length);
+
+  virtual void remove(const std::string& key);
+
+  virtual std::string name() const { return "lru"; }
+
+private:
+
+  struct Entry
+  {
+    std::string key;
+    std::string value;
+    time_t      expires;
+  };
+
+  typedef std::list<Entry>                               EntryList;
+  typedef std::map<std::string, EntryList::iterator>     EntryMap;
+
+  void erase(EntryMap::iterator entry);
+
+  AWSMutex  theMutex;
+  size_t    theCapacity;
+  size_t    theMaxItem;
+  time_t    theTTL;
+  size_t    theSize;
+  EntryList theEntries;  // most recently used first
+  EntryMap  theIndex;
+};
+
+} /* namespace aws */
+#endif
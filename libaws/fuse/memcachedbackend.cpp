@@ -0,0 +1,106 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "memcachedbackend.h"
+
+#include <map>
+#include <stdlib.h>
+
+namespace aws { 
+
+MemcachedBackend::MemcachedBackend(const std::string& servers)
+  : theServers(servers)
+{
+}
+
+// a memcached_st must not be shared by threads, every call uses its own
+memcached_st*
+MemcachedBackend::create()
+{
+  memcached_st* memc=memcached_create(NULL);
+  memcached_server_st* servers=memcached_servers_parse(theServers.c_str());
+  memcached_server_push(memc, servers);
+  memcached_server_list_free(servers);
+  return memc;
+}
+
+bool
+MemcachedBackend::get(const std::string& key, std::string& value)
+{
+  memcached_st* memc=create();
+  uint32_t flags;
+  size_t value_length;
+  memcached_return rc;
+  char* result=memcached_get(memc, key.c_str(), key.length(), &value_length, &flags, &rc);
+  if(result!=NULL){
+    value.assign(result, value_length);
+    free(result);
+  }
+  memcached_free(memc);
+  return rc==MEMCACHED_SUCCESS;
+}
+
+bool
+MemcachedBackend::set(const std::string& key, const char* value, size_t length)
+{
+  memcached_st* memc=create();
+  memcached_return rc=memcached_set(memc, key.c_str(), key.length(), value, length, (time_t)0, (uint32_t)0);
+  memcached_free(memc);
+  return rc==MEMCACHED_SUCCESS;
+}
+
+void
+MemcachedBackend::remove(const std::string& key)
+{
+  memcached_st* memc=create();
+  memcached_delete(memc, key.c_str(), key.length(), (time_t)0);
+  memcached_free(memc);
+}
+
+void
+MemcachedBackend::get_multi(const std::vector<std::string>& keys, Receiver& receiver)
+{
+  if(keys.empty())
+    return;
+
+  std::vector<char*> keyptrs(keys.size());
+  std::vector<size_t> keylengths(keys.size());
+  std::map<std::string, size_t> indexes;
+  for(size_t i=0; i<keys.size(); i++){
+    keyptrs[i]=const_cast<char*>(keys[i].c_str());
+    keylengths[i]=keys[i].length();
+    indexes[keys[i]]=i;
+  }
+
+  memcached_st* memc=create();
+  if(memcached_mget(memc, &keyptrs[0], &keylengths[0], keys.size())==MEMCACHED_SUCCESS){
+    // the values arrive in any order
+    char key[MEMCACHED_MAX_KEY];
+    size_t key_length;
+    size_t value_length;
+    uint32_t flags;
+    memcached_return rc;
+    char* value;
+    while((value=memcached_fetch(memc, key, &key_length, &value_length, &flags, &rc))!=NULL){
+      std::map<std::string, size_t>::iterator index=indexes.find(std::string(key, key_length));
+      if(index!=indexes.end())
+        receiver.receive(index->second, value, value_length);
+      free(value);
+    }
+  }
+  memcached_free(memc);
+}
+
+} /* namespace aws */
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3FS_MEMCACHEDBACKEND
+#define AWS_S3FS_MEMCACHEDBACKEND
+
+#include <libmemcached/memcached.h>
+
+#include "cachebackend.h"
+
+namespace aws { 
+
+/**
+ * Cache on memcached servers (e.g. "host1:11211,host2:11211").
+ */
+class MemcachedBackend : public CacheBackend
+{
+public:
+
+  MemcachedBackend(const std::string& servers);
+
+  virtual bool get(const std::string& key, std::string& value);
+
+  virtual bool set(const std::string& key, const char* value, size_t length);
+
+  virtual void remove(const std::string& key);
+
+  // requests all keys at once
+  virtual void get_multi(const std::vector<std::string>& keys, Receiver& receiver);
+
+  virtual std::string name() const { return "memcached"; }
+
+private:
+
+  memcached_st* create();
+
+  std::string theServers;
+};
+
+} /* namespace aws */
+#endif
@@ -11,7 +11,16 @@ const char* Properties::AWS_ACCESS_KEY="aws-access-key";
 const char* Properties::AWS_SECRET_ACCESS_KEY="aws-secret-access-key";
 const char* Properties::TEMP_DIR="temp-dir";
 const char* Properties::MEMCACHED_SERVERS="memcached-servers";
+const char* Properties::MEMCACHED_FILE_LIMIT="memcached-file-limit";
 const char* Properties::CREATE_MOUNT_DIR="create-mountdir";
+const char* Properties::INDEX_FILE="index-file";
+const char* Properties::INDEX_MAX_AGE="index-max-age";
+const char* Properties::FILTER_MAX_AGE="filter-max-age";
+const char* Properties::FILTER_FP_RATE="filter-fp-rate";
+const char* Properties::CACHE_SIZE="cache-size";
+const char* Properties::CACHE_TTL="cache-ttl";
+const char* Properties::SHM_CACHE="shm-cache";
+const char* Properties::SHM_CACHE_SIZE="shm-cache-size";
 
 void PropertyUtil::read(const char *filename, PropertyMapT &map)
 {
@@ -15,7 +15,16 @@ public:
   static const char* AWS_SECRET_ACCESS_KEY;
   static const char* TEMP_DIR;
   static const char* MEMCACHED_SERVERS;
+  static const char* MEMCACHED_FILE_LIMIT;
   static const char* CREATE_MOUNT_DIR;
+  static const char* INDEX_FILE;
+  static const char* INDEX_MAX_AGE;
+  static const char* FILTER_MAX_AGE;
+  static const char* FILTER_FP_RATE;
+  static const char* CACHE_SIZE;
+  static const char* CACHE_TTL;
+  static const char* SHM_CACHE;
+  static const char* SHM_CACHE_SIZE;
 };
 
 class PropertyUtil
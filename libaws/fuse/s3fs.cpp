@@ -47,6 +47,7 @@
 #include <vector>
 #include <sys/stat.h>
 #include <map>
+#include <algorithm>
 #include <sstream>
 #include <syslog.h>
 #include <fstream>
@@ -57,25 +58,57 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stddef.h>
+#include <pthread.h>
 
 #include <libaws/aws.h>
 #include "properties.h"
+#include "keyfilter.h"
+#include "s3fsstats.h"
+#include "awscache.h"
+#include "lrubackend.h"
+#include "shmbackend.h"
 
 #ifdef S3FS_USE_MEMCACHED
-#  include <libmemcached/memcached.h>
-#  include "awscache.h"
+#  include "memcachedbackend.h"
 #endif //USE_MEMCACHED
 
 using namespace aws;
 
-#ifdef S3FS_USE_MEMCACHED
 std::auto_ptr<AWSCache> theCache;
-#endif //USE_MEMCACHED
+// the tiers of theCache, owned by it
+static TieredBackend* theCacheTiers=0;
+// the process memory cache is off by default if memcached is used, because
+// its entries don't see changes made on other hosts for up to theCacheTTL
+static size_t theCacheSize=64*1024*1024;
+static bool   theCacheSizeIsSet=false;
+static time_t theCacheTTL=30;
+static size_t theShmCacheSize=64*1024*1024;
+static const size_t SHM_CACHE_SLOT_SIZE=4096;
 
 AWSConnectionFactory* theFactory;
 std::auto_ptr<ConnectionPool<S3ConnectionPtr> > theS3ConnectionPool;
 static unsigned int CONNECTION_POOL_SIZE=5;
+
+// merges concurrent head and get requests for the same key
+static S3Coalescer theCoalescer;
+
+// printed through /s3fs.stat
+static S3FSStats theStats;
+
+// answers lookups and listings locally if an index file is given
+static std::auto_ptr<S3BucketIndex> theIndex;
+static time_t theIndexMaxAge=60;
+// seconds between two refreshes of the index by the refresh thread
+static unsigned int INDEX_REFRESH_INTERVAL=1;
+
+// proves that keys don't exist without a request if their directory was listed
+std::auto_ptr<KeyFilter> theKeyFilter;
+static time_t theKeyFilterMaxAge=30;
+static double theKeyFilterFalsePositiveRate=0.01;
+static size_t KEY_FILTER_CAPACITY=1000000;
 static unsigned int AWS_TRIES_ON_ERROR=3;
+// S3 copies at most 5 GB in a single request
+static const off_t S3_MAX_COPY_SIZE=5LL*1024*1024*1024;
 
 std::string theAccessKeyId;
 std::string theSecretAccessKey;
@@ -84,6 +117,8 @@ std::string theS3FSTempFilePattern;
 std::string theBucketname;
 std::string thePropertyFile;
 std::string theMemcachedServers;
+std::string theShmCacheFile;
+std::string theIndexFile;
 
 static std::string DELIMITER_FOLDER_ENTRIES=",";
 
@@ -95,8 +130,17 @@ struct s3fs_config {
   char* property_file;
   char* bucket;
   char* memcached_servers;
+  int   memcached_file_limit;
+  char* index_file;
   int   log_level;
   int   create_mount_dir;
+  int   index_max_age;
+  int   filter_max_age;
+  double filter_fp_rate;
+  int   cache_size;
+  int   cache_ttl;
+  char* shm_cache;
+  int   shm_cache_size;
 };
 
 enum {
@@ -113,7 +157,16 @@ static struct fuse_opt s3fs_opts[] = {
    S3FS_OPT("bucket=%s",            bucket, 0),
    S3FS_OPT("log-level=%i",         log_level, 0),
    S3FS_OPT("memcached-servers=%s", memcached_servers, 0),
+   S3FS_OPT("memcached-file-limit=%i", memcached_file_limit, 0),
    S3FS_OPT("create-mountdir=%i", create_mount_dir, 0),
+   S3FS_OPT("index-file=%s",        index_file, 0),
+   S3FS_OPT("index-max-age=%i",     index_max_age, 0),
+   S3FS_OPT("filter-max-age=%i",    filter_max_age, 0),
+   S3FS_OPT("filter-fp-rate=%lf",   filter_fp_rate, 0),
+   S3FS_OPT("cache-size=%i",        cache_size, 0),
+   S3FS_OPT("cache-ttl=%i",         cache_ttl, 0),
+   S3FS_OPT("shm-cache=%s",         shm_cache, 0),
+   S3FS_OPT("shm-cache-size=%i",    shm_cache_size, 0),
 
    FUSE_OPT_KEY("-h",             KEY_HELP),
    FUSE_OPT_KEY("-H",             KEY_HELP),
@@ -143,9 +196,21 @@ static int s3fs_opt_proc(void *data, const char *arg, int key, struct fuse_args
             "    -o secret-key=STRING        AWS Secret Access Key\n"
             "    -o temp-dir=STRING          temporary directory used by s3fs\n"
             "    -o bucket=STRING            bucket to mount\n"
-            "    -o memcached_servers=STRING memcached servers used for caching\n"
+            "    -o memcached-servers=STRING memcached servers shared by all hosts (optional)\n"
+            "    -o memcached-file-limit=INT bytes up to which file contents are cached (default 300000)\n"
             "    -o log-level=INT            logging level (0=ERROR, 1=INFO, 2=DEBUG)\n"
             "    -o create-mountdir=INT      create mount dir if not existent? (0=no, 1=yes)\n"
+            "    -o index-file=STRING        local file that indexes the keys of the bucket\n"
+            "    -o index-max-age=INT        seconds until indexed keys are listed again (default 60)\n"
+            "    -o filter-max-age=INT       seconds a listing proves that keys don't exist (default 30, -1=off)\n"
+            "    -o filter-fp-rate=DOUBLE    false positive rate of the key filter (default 0.01)\n"
+            "    -o cache-size=INT           bytes cached in the process memory (default 64MB,\n"
+            "                                off if memcached-servers is given, -1=off)\n"
+            "    -o cache-ttl=INT            seconds until locally cached entries expire (default 30);\n"
+            "                                changes made on other hosts aren't seen by the process\n"
+            "                                memory and shared memory caches until then\n"
+            "    -o shm-cache=STRING         shared memory file cache for all processes (e.g. /dev/shm/s3fs)\n"
+            "    -o shm-cache-size=INT       bytes of the shared memory cache (default 64MB)\n"
             , outargs->argv[0]);
     fuse_opt_add_arg(outargs, "-ho");
     fuse_main(outargs->argc, outargs->argv, &s3_filesystem_operations, NULL);
@@ -177,6 +242,8 @@ struct FileHandle {
    bool is_write; 
    mode_t mode;
    time_t mtime;
+   std::string etag;
+   bool is_cached;
 };
 
 FileHandle::FileHandle()
@@ -189,6 +256,8 @@ FileHandle::FileHandle()
   is_write=false;
   mode=0;
   mtime=0;
+  etag="";
+  is_cached=false;
 }
 
 FileHandle::~FileHandle()
@@ -237,6 +306,22 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
   theS3ConnectionPool->release(aConnection);
 }
 
+/**
+ * bucket index functions
+ * the ranges of the index that are older than theIndexMaxAge or were changed
+ * by s3fs are listed again by a background thread (see refreshIndexThread);
+ * requests are answered from the current index meanwhile
+ */
+static void invalidateIndex(const std::string& aKey) {
+  if (theIndex.get())
+    theIndex->invalidate(aKey);
+}
+
+static void addKnownKey(const std::string& aKey) {
+  if (theKeyFilter.get())
+    theKeyFilter->addKey(aKey);
+}
+
 /**
  * macro that should be used to exit a function
  * it releases the connection object used in the function and returns with the given return code
@@ -250,10 +335,15 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
  */
 #ifdef S3FS_LOG_SYSLOG
 #  define S3_LOG_OUTPUT(level, log_message) \
-     syslog( level, "%s", log_message );
+     aws::AWSLog::log( level, log_message );
 #else
+static void
+stderrSink(int, const char* aMessage, void*)
+{
+  std::cerr << aMessage << std::endl;
+}
 #  define S3_LOG_OUTPUT(level, log_message) \
-     std::cerr << log_message << std::endl;
+     aws::AWSLog::log( level, log_message, &stderrSink );
 #endif
     
 
@@ -263,7 +353,7 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
        std::ostringstream logMessage; \
        logMessage << "(func: " << __FUNCTION__ << "; line: " << __LINE__ << ") " \
                   << "[DEBUG] ## " << message << " ## "; \
-       S3_LOG_OUTPUT(LOG_DEBUG, logMessage.str().c_str()); \
+       S3_LOG_OUTPUT(LOG_DEBUG, logMessage.str()); \
      } \
    } while (0);
 
@@ -273,7 +363,7 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
        std::ostringstream logMessage; \
        logMessage << "(func: " << __FUNCTION__ << "; line: " << __LINE__ << ") " \
                   << "[INFO] ## " << message << " ## "; \
-       S3_LOG_OUTPUT(LOG_INFO, logMessage.str().c_str()); \
+       S3_LOG_OUTPUT(LOG_INFO, logMessage.str()); \
      } \
    } while (0);
 
@@ -283,7 +373,7 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
        std::ostringstream logMessage; \
        logMessage << "(func: " << __FUNCTION__ << "; line: " << __LINE__ << ") " \
                   << "[ERROR] ## " << message << " ## "; \
-       S3_LOG_OUTPUT(LOG_ERR, logMessage.str().c_str()); \
+       S3_LOG_OUTPUT(LOG_ERR, logMessage.str()); \
      } \
    } while (0);
 
@@ -298,6 +388,7 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
       S3_LOG_ERROR("S3Exception(ERRORCODE="<<((int)s3Exception.getErrorCode())<<"):"<<s3Exception.what()); \
       if (s3Exception.getErrorCode() != aws::S3Exception::NoSuchKey) { \
          haserror=true; \
+         theStats.addError(); \
          result=-EIO;\
       } else{ \
          haserror=false; \
@@ -306,10 +397,12 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
     } catch (AWSConnectionException & conException) { \
      S3_LOG_ERROR("AWSConnectionException: "<<conException.what()); \
       haserror=true; \
+      theStats.addError(); \
       result=-ECONNREFUSED; \
     }catch (AWSException & awsException) { \
       S3_LOG_ERROR("AWSException: "<<awsException.what()); \
       haserror=true; \
+      theStats.addError(); \
       result=-EIO;\
     }
 #else
@@ -317,6 +410,7 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
     } catch (kind ## Exception & s3Exception) { \
       if (s3Exception.getErrorCode() != aws::S3Exception::NoSuchKey) { \
          haserror=true; \
+         theStats.addError(); \
          result=-EIO;\
       } else{ \
          haserror=false; \
@@ -324,14 +418,68 @@ static void releaseConnection(const S3ConnectionPtr& aConnection) {
       } \
     } catch (AWSConnectionException & conException) { \
       haserror=true; \
+      theStats.addError(); \
       result=-ECONNREFUSED; \
     }catch (AWSException & awsException) { \
       haserror=true; \
+      theStats.addError(); \
       result=-EIO;\
     }
 #endif
 
 
+static void*
+refreshIndexThread(void*)
+{
+  // the index requires a connection of its own for each thread
+  S3ConnectionPtr lCon = theFactory->createS3Connection(theAccessKeyId, theSecretAccessKey);
+  while (true) {
+    try {
+      size_t lRanges = theIndex->refresh(lCon.get(), theIndexMaxAge);
+      if (lRanges > 0) {
+        S3_LOG_DEBUG("refreshed " << lRanges << " ranges of the bucket index");
+      }
+    } catch (AWSException& e) {
+      S3_LOG_ERROR("couldn't refresh the bucket index: " << e.what());
+    }
+    sleep(INDEX_REFRESH_INTERVAL);
+  }
+  return NULL;
+}
+
+/**
+ * contents of the /s3fs.stat file
+ */
+static void
+printStatistics(std::ostream& aStream)
+{
+  theStats.print(aStream);
+  aStream << "coalescer.requests " << theCoalescer.getNumberOfRequests() << "\n";
+  aStream << "coalescer.coalesced " << theCoalescer.getNumberOfCoalescedRequests() << "\n";
+  theCache->print_stats(aStream);
+  theCacheTiers->print_stats(aStream);
+  if (theKeyFilter.get()) {
+    aStream << "filter.keys " << theKeyFilter->getNumberOfKeys() << "\n";
+    aStream << "filter.directories " << theKeyFilter->getNumberOfDirectories() << "\n";
+  }
+  if (theIndex.get()) {
+    aStream << "index.objects " << theIndex->getNumberOfObjects() << "\n";
+    aStream << "index.ranges " << theIndex->getNumberOfRanges() << "\n";
+    aStream << "index.list_requests " << theIndex->getNumberOfListRequests() << "\n";
+  }
+
+  // the temp files of the open handles
+  uint64_t lTempBytes = 0;
+  for (std::map<int,struct FileHandle*>::iterator lIter = tempfilemap.begin();
+       lIter != tempfilemap.end(); ++lIter) {
+    struct stat lStat;
+    if (fstat(lIter->first, &lStat) == 0)
+      lTempBytes += (uint64_t)lStat.st_blocks * 512;
+  }
+  aStream << "handles.open " << tempfilemap.size() << "\n";
+  aStream << "handles.temp_bytes " << lTempBytes << "\n";
+}
+
 // shorcuts
 typedef std::map<std::string, std::string> map_t;
 typedef std::pair<std::string, std::string> pair_t;
@@ -434,6 +582,7 @@ s3_release(const char *path, struct fuse_file_info *fileinfo);
 static int
 s3_getattr(const char *path, struct stat *stbuf)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::GETATTR);
   // initialize result
   int result=0;
   memset(stbuf, 0, sizeof(struct stat));
@@ -464,16 +613,18 @@ s3_getattr(const char *path, struct stat *stbuf)
 
       S3_LOG_DEBUG("requested getattr for s3fs.stat => exit");
       return result;
+    } else if (theKeyFilter.get() && theKeyFilter->isMissing(lpath.substr(1))) {
+      S3_LOG_DEBUG("file or folder: " << lpath.substr(1) << " is not in the listing of its folder.");
+      return -ENOENT;
     } else {
 
-#ifdef S3FS_USE_MEMCACHED
       std::string value;
 
-      memcached_return rc;
+      bool found;
 
       // check if the cache knows if the file/folder exists
       std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
-      value=theCache->read_key(key, &rc);
+      value=theCache->read_key(key, &found);
       if (value.length() > 0 && value.compare("0")==0) // file does not exist
       {
         S3_LOG_DEBUG("[Memcached] file or folder: " << lpath.substr(1) << " is marked as non existent in cache.");
@@ -487,11 +638,18 @@ s3_getattr(const char *path, struct stat *stbuf)
        }
        else 
        {
-#endif
          bool haserror=false;
          unsigned int trycounter=0;
          S3ConnectionPtr lCon = getConnection();
 
+         // keys that don't exist are answered by the index without a request
+         S3BucketIndex::Object lIndexed;
+         if (theIndex.get()
+             && theIndex->lookup(lpath.substr(1), lIndexed) == S3BucketIndex::MISSING) {
+           S3_LOG_DEBUG("file or folder: " << lpath.substr(1) << " is not in the index.");
+           S3FS_EXIT(-ENOENT);
+         }
+
          do{
            trycounter++;
 					 if(haserror){	
@@ -505,7 +663,22 @@ s3_getattr(const char *path, struct stat *stbuf)
              // check if we have that path without first /
              HeadResponsePtr lRes;
              S3_LOG_DEBUG(" making head request to " << lpath.substr(1));
-             lRes = lCon->head(theBucketname, lpath.substr(1));
+             // missing paths are the common case (shell lookups), so they
+             // are reported by the response instead of an exception
+             theStats.addRequest(S3FSStats::HEAD, trycounter > 1);
+             lRes = theCoalescer.tryHead(lCon.get(), theBucketname, lpath.substr(1));
+             if (!lRes->isSuccessful()) {
+               if (lRes->getErrorCode() == aws::S3Exception::NoSuchKey) {
+                 haserror=false;
+                 result=-ENOENT;
+               } else {
+                 S3_LOG_ERROR("head failed (ERRORCODE=" << ((int)lRes->getErrorCode()) << ")");
+                 theStats.addError();
+                 haserror=true;
+                 result=-EIO;
+               }
+               continue;
+             }
              map_t lMap = lRes->getMetaData();
              if (theLogLevel <= S3_DEBUG) {
                S3_LOG_DEBUG("  requested metadata for " << lpath.substr(1));
@@ -523,7 +696,6 @@ s3_getattr(const char *path, struct stat *stbuf)
          releaseConnection(lCon);
          lCon=NULL;
 
-#ifdef S3FS_USE_MEMCACHED
          if(result==-ENOENT && !haserror){ 
 
            // remember in cache that file does not exist
@@ -542,23 +714,18 @@ s3_getattr(const char *path, struct stat *stbuf)
            key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"").c_str();
            theCache->delete_key(key);
          }
-#endif //USE_MEMCACHED
 
-#ifdef S3FS_USE_MEMCACHED
        }
-#endif
 
     }
 
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to get file attributes.");
 
-#ifdef S3FS_USE_MEMCACHED
 
     // cleanup cache to prevent future errors
     std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     return -EIO; // I/O Error
   }
@@ -573,6 +740,7 @@ s3_getattr(const char *path, struct stat *stbuf)
 static int
 s3_chmod(const char * path, mode_t mode)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::CHMOD);
   S3_LOG_DEBUG("path: " << path << " mode: " << mode);
 
    // init result
@@ -590,6 +758,7 @@ s3_chmod(const char * path, mode_t mode)
 static int
 s3_utimens(const char *path, const struct timespec tv[2])
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::UTIMENS);
   if(tv){
     S3_LOG_DEBUG("path: " << path << " time:" << time_to_string(tv->tv_sec));
   }else{
@@ -611,6 +780,7 @@ s3_utimens(const char *path, const struct timespec tv[2])
 static int
 s3_chown(const char * path, uid_t uid, gid_t gid)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::CHOWN);
   S3_LOG_DEBUG("path: " << path << " uid:" << uid << " gid:" << gid);
 
   //init result
@@ -630,14 +800,13 @@ s3_chown(const char * path, uid_t uid, gid_t gid)
 static int 
 s3_truncate(const char * path, off_t offset)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::TRUNCATE);
   S3_LOG_DEBUG("path: " << path << " offset:" << offset);
 
 // initialize result
   int result=0;
   std::string lpath(path);
-#ifdef S3FS_USE_MEMCACHED
   std::string key;
-#endif // S3FS_USE_MEMCACHED
   fuse_file_info fileinfo;
   memset(&fileinfo, 0, sizeof(struct fuse_file_info));
 
@@ -673,7 +842,6 @@ s3_truncate(const char * path, off_t offset)
       int lTmpPointer = fileHandle->id;
       tempfilemap.insert( std::pair<int,struct FileHandle*>(lTmpPointer,fileHandle.release()) );
 
-#ifdef S3FS_USE_MEMCACHED
 
       // remember changes in cache
       stbuf.st_size=0;
@@ -683,7 +851,6 @@ s3_truncate(const char * path, off_t offset)
       // cleanup cache
       key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"");
       theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
       // write the empty file to s3
       s3_release(path, &fileinfo);
@@ -696,13 +863,11 @@ s3_truncate(const char * path, off_t offset)
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to open a file.");
 
-#ifdef S3FS_USE_MEMCACHED
     // cleanup cache to prevent future errors
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
     key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     return -EIO; // I/O Error
   }
@@ -714,6 +879,7 @@ s3_truncate(const char * path, off_t offset)
 static int
 s3_mkdir(const char *path, mode_t mode)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::MKDIR);
   S3_LOG_DEBUG("path: " << path << " mode: " << mode);
 
   int result=0;
@@ -737,10 +903,12 @@ s3_mkdir(const char *path, mode_t mode)
         //TODO hack
         lDirMap.insert(pair_t("mode", "511"));
         lDirMap.insert(pair_t("mtime", time_to_string(getCurrentTime())));
+        theStats.addRequest(S3FSStats::PUT, trycounter > 1);
         PutResponsePtr lRes = lCon->put(theBucketname, lpath.substr(1), 0, "text/plain", 0, &lDirMap);
+        invalidateIndex(lpath.substr(1));
+        addKnownKey(lpath.substr(1));
 
         // success
-#ifdef S3FS_USE_MEMCACHED
         // delete data from cache
         std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
         theCache->delete_key(key);
@@ -749,7 +917,6 @@ s3_mkdir(const char *path, mode_t mode)
         std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
         key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
         theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
         S3FS_EXIT(result);
       S3FS_CATCH(Put)
@@ -757,7 +924,6 @@ s3_mkdir(const char *path, mode_t mode)
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying make dir.");
 
-#ifdef S3FS_USE_MEMCACHED
 
     // cleanup cache to prevent future errors
     std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
@@ -767,7 +933,6 @@ s3_mkdir(const char *path, mode_t mode)
     std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
     key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     S3FS_EXIT(-EIO); // I/O Error
   }
@@ -780,6 +945,7 @@ s3_mkdir(const char *path, mode_t mode)
 static int
 s3_rmdir(const char *path)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::RMDIR);
   S3_LOG_DEBUG("path: " << path);
 
   int result=0;
@@ -790,24 +956,22 @@ s3_rmdir(const char *path)
 
   try{
     // now we have to check if the folder is empty
-#ifdef S3FS_USE_MEMCACHED
      std::string value;
-     memcached_return rc;
+     bool found;
 
      std::string key=theCache->getkey(AWSCache::PREFIX_DIR_LS,lpath.substr(1),"");
 
-     value=theCache->read_key(key, &rc);
-     if (rc==MEMCACHED_SUCCESS && value.length()>0) // there are entries in the folder
+     value=theCache->read_key(key, &found);
+     if (found && value.length()>0) // there are entries in the folder
      {
        S3_LOG_DEBUG("[Memcached] found entries for folder '" << lpath.substr(1) << "': " << value);
        return -ENOTEMPTY;
-     }else if(rc==MEMCACHED_SUCCESS && value.length()==0){
+     }else if(found && value.length()==0){
        // folder empty -> can be removed
        S3_LOG_DEBUG("[Memcached] folder '" << lpath.substr(1) << "' is empty.");
      }
      else 
      {
-#endif // S3FS_USE_MEMCACHED
 
        lCon = getConnection();
 
@@ -827,6 +991,7 @@ s3_rmdir(const char *path)
            do {
              // get object without first /
              S3_LOG_DEBUG("list bucket: "<<theBucketname<<" prefix: "<<lpath.substr(1));
+             theStats.addRequest(S3FSStats::LIST, trycounter > 1 && lMarker.empty());
              lRes = lCon->listBucket(theBucketname, lpath.substr(1), lMarker, "/", -1);
              lRes->open();
              ListBucketResponse::Object o;
@@ -836,12 +1001,10 @@ s3_rmdir(const char *path)
                S3_LOG_DEBUG("result: " << o.KeyValue);
                std::string lTmp = o.KeyValue.replace(0, lpath.length()-1, "");
 
-#ifdef S3FS_USE_MEMCACHED
                // remember entries
                if(lentries.length()>0) {
                  lentries.append(AWSCache::DELIMITER_FOLDER_ENTRIES);
                }
-#endif
                lentries.append(lTmp);
 
                lMarker = o.KeyValue;
@@ -857,19 +1020,15 @@ s3_rmdir(const char *path)
          // folder not empty
          result=-ENOTEMPTY;
 
-#ifdef S3FS_USE_MEMCACHED
 
          //remember successfully retrieved entries in cache
          key=theCache->getkey(AWSCache::PREFIX_DIR_LS,lpath.substr(1),"");
          theCache->save_key(key, lentries);
-#endif // S3FS_USE_MEMCACHED
 
          S3FS_EXIT(result);
        }
 
-#ifdef S3FS_USE_MEMCACHED
     }
-#endif // S3FS_USE_MEMCACHED
 
     // folder is empty -> can be deleted
     if(lpath.length()>0 && lpath.at(lpath.length()-1)=='/') {
@@ -884,11 +1043,12 @@ s3_rmdir(const char *path)
       trycounter++;
       haserror=false;
       S3FS_TRY
+        theStats.addRequest(S3FSStats::DELETE, trycounter > 1);
         DeleteResponsePtr lRes = lCon->del(theBucketname, lpath.substr(1));
+        invalidateIndex(lpath.substr(1));
       S3FS_CATCH(Put)
     }while(haserror && trycounter<AWS_TRIES_ON_ERROR);
 
-#ifdef S3FS_USE_MEMCACHED
     if(result==0){ // successfully deleted
 
       // remember in cache that folder does not exist any more
@@ -909,13 +1069,11 @@ s3_rmdir(const char *path)
     std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
     key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     S3FS_EXIT(result);
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to remove dir.");
 
-#ifdef S3FS_USE_MEMCACHED
 
     // cleanup cache to prevent future errors
     std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
@@ -929,7 +1087,6 @@ s3_rmdir(const char *path)
     std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
     key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     if(lCon) releaseConnection(lCon);
     lCon=NULL;
@@ -962,6 +1119,7 @@ s3_readdir(const char *path,
            off_t offset,
            struct fuse_file_info *fi)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::READDIR);
   S3_LOG_DEBUG("readdir: " << path);
 
   int result=0;
@@ -977,14 +1135,13 @@ s3_readdir(const char *path,
     lpath += "/";
 
   try{
-#ifdef S3FS_USE_MEMCACHED
     std::string value;
-    memcached_return rc;
+    bool found;
 
     std::string key=theCache->getkey(AWSCache::PREFIX_DIR_LS,lpath.substr(1),"");
 
-    value=theCache->read_key(key, &rc);
-    if (rc==MEMCACHED_SUCCESS) // there are entries in the cache for this folder
+    value=theCache->read_key(key, &found);
+    if (found) // there are entries in the cache for this folder
     {
       S3_LOG_DEBUG("[Memcached] found entries for folder '" << lpath.substr(1) << "': " << value);
       std::vector<std::string> items;
@@ -1004,47 +1161,69 @@ s3_readdir(const char *path,
     else 
     {
       std::string lentries="";
-#endif
 
       lCon = getConnection();
       bool haserror=false;
       unsigned int trycounter=0;
 
-      do{
-        trycounter++;
-        haserror=false;
-        ListBucketResponsePtr lRes;
-        S3FS_TRY
-          std::string lMarker;
-          do {
-            // get object without first /
-            S3_LOG_DEBUG("list bucket: "<<theBucketname<<" prefix: "<<lpath.substr(1));
-            lRes = lCon->listBucket(theBucketname, lpath.substr(1), lMarker, "/", -1);
-            lRes->open();
-            ListBucketResponse::Object o;
-            while (lRes->next(o)) {
-              struct stat lStat;
-              memset(&lStat, 0, sizeof(struct stat));
-
-              S3_LOG_DEBUG("  result: " << o.KeyValue);
-              std::string lTmp = o.KeyValue.replace(0, lpath.length()-1, "");
+      // directories that are completely indexed are listed without a request
+      std::vector<S3BucketIndex::Object> lIndexed;
+      std::vector<std::string> lKeys;
+      if (theIndex.get() && theIndex->list(lpath.substr(1), "/", lIndexed)) {
+        S3_LOG_DEBUG("list index: " << lpath.substr(1));
+        for (std::vector<S3BucketIndex::Object>::iterator lIter = lIndexed.begin();
+             lIter != lIndexed.end(); ++lIter) {
+          struct stat lStat;
+          memset(&lStat, 0, sizeof(struct stat));
 
-#ifdef S3FS_USE_MEMCACHED
-              // remember entries to store in cache
-              if(lentries.length()>0) lentries.append(AWSCache::DELIMITER_FOLDER_ENTRIES);
-              lentries.append(lTmp);
-#endif //S3FS_USE_MEMCACHED
+          lKeys.push_back(lIter->KeyValue);
+          std::string lTmp = lIter->KeyValue.replace(0, lpath.length()-1, "");
 
-              filler(buf, lTmp.c_str(), &lStat, 0);
-              lMarker = o.KeyValue;
-            }
-            lRes->close();
-          } while (lRes->isTruncated());
+          if(lentries.length()>0) lentries.append(AWSCache::DELIMITER_FOLDER_ENTRIES);
+          lentries.append(lTmp);
 
-         S3FS_CATCH(ListBucket);
-       }while(haserror && trycounter<AWS_TRIES_ON_ERROR);
+          filler(buf, lTmp.c_str(), &lStat, 0);
+        }
+      } else {
+        do{
+          trycounter++;
+          haserror=false;
+          lKeys.clear();
+          ListBucketResponsePtr lRes;
+          S3FS_TRY
+            std::string lMarker;
+            do {
+              // get object without first /
+              S3_LOG_DEBUG("list bucket: "<<theBucketname<<" prefix: "<<lpath.substr(1));
+              theStats.addRequest(S3FSStats::LIST, trycounter > 1 && lMarker.empty());
+              lRes = lCon->listBucket(theBucketname, lpath.substr(1), lMarker, "/", -1);
+              lRes->open();
+              ListBucketResponse::Object o;
+              while (lRes->next(o)) {
+                struct stat lStat;
+                memset(&lStat, 0, sizeof(struct stat));
+
+                S3_LOG_DEBUG("  result: " << o.KeyValue);
+                lKeys.push_back(o.KeyValue);
+                std::string lTmp = o.KeyValue.replace(0, lpath.length()-1, "");
+
+                // remember entries to store in cache
+                if(lentries.length()>0) lentries.append(AWSCache::DELIMITER_FOLDER_ENTRIES);
+                lentries.append(lTmp);
+
+                filler(buf, lTmp.c_str(), &lStat, 0);
+                lMarker = o.KeyValue;
+              }
+              lRes->close();
+            } while (lRes->isTruncated());
+
+           S3FS_CATCH(ListBucket);
+         }while(haserror && trycounter<AWS_TRIES_ON_ERROR);
+      }
+
+      if (theKeyFilter.get() && !haserror && result==0)
+        theKeyFilter->addDirectory(lpath.substr(1), lKeys);
 
-#ifdef S3FS_USE_MEMCACHED
        if(result==-ENOENT && !haserror){ 
 
          // remember in cache that no entries exist in folder
@@ -1054,17 +1233,13 @@ s3_readdir(const char *path,
          //remember successfully retrieved entries in cache
          theCache->save_key(key, lentries);
        }
-#endif
 
        S3FS_EXIT(result);
 
-#ifdef S3FS_USE_MEMCACHED
     }
-#endif
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to read dir contents.");
 
-#ifdef S3FS_USE_MEMCACHED
 
     // cleanup cache to prevent future errors
     std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
@@ -1078,7 +1253,6 @@ s3_readdir(const char *path,
     std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
     key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     if(lCon) releaseConnection(lCon);
     lCon=NULL;
@@ -1102,6 +1276,7 @@ s3_readdir(const char *path,
 static int
 s3_create(const char *path, mode_t mode, struct fuse_file_info *fileinfo)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::CREATE);
   S3_LOG_DEBUG("path: " << path << " mode: " << mode);
 
   std::string lpath(path);
@@ -1145,8 +1320,9 @@ s3_create(const char *path, mode_t mode, struct fuse_file_info *fileinfo)
     fileinfo->fh = (uint64_t)fileHandle->id;
     int lTmpPointer = fileHandle->id;
     tempfilemap.insert( std::pair<int,struct FileHandle*>(lTmpPointer,fileHandle.release()) );
+    invalidateIndex(lpath.substr(1));
+    addKnownKey(lpath.substr(1));
 
-#ifdef S3FS_USE_MEMCACHED
 
     // init stat
     struct stat stbuf;
@@ -1166,11 +1342,9 @@ s3_create(const char *path, mode_t mode, struct fuse_file_info *fileinfo)
     std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
     key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"").c_str();
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to create a new file.");
 
-#ifdef S3FS_USE_MEMCACHED
 
     // cleanup cache to prevent future errors
     std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
@@ -1180,7 +1354,6 @@ s3_create(const char *path, mode_t mode, struct fuse_file_info *fileinfo)
     std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
     key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     return -EIO; // I/O Error
   }
@@ -1195,6 +1368,7 @@ s3_create(const char *path, mode_t mode, struct fuse_file_info *fileinfo)
 static int
 s3_unlink(const char * path)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::UNLINK);
 #ifndef NDEBUG
   std::string location="s3_unlink";
 #endif
@@ -1204,9 +1378,7 @@ s3_unlink(const char * path)
   S3ConnectionPtr lCon = NULL;
   int result=0;
   std::string lpath(path);
-#ifdef S3FS_USE_MEMCACHED
   std::string key;
-#endif // S3FS_USE_MEMCACHED
 
   try{
     lCon = getConnection();
@@ -1218,11 +1390,12 @@ s3_unlink(const char * path)
       trycounter++;
       haserror=false;
       S3FS_TRY
+        theStats.addRequest(S3FSStats::DELETE, trycounter > 1);
         DeleteResponsePtr lRes = lCon->del(theBucketname, lpath.substr(1));
+        invalidateIndex(lpath.substr(1));
       S3FS_CATCH(Put)
     }while(haserror && trycounter<AWS_TRIES_ON_ERROR);
 
-#ifdef S3FS_USE_MEMCACHED
     if(result!=-ENOENT){
       // delete data from cache
       key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
@@ -1237,13 +1410,11 @@ s3_unlink(const char * path)
       key=theCache->getkey(AWSCache::PREFIX_SYMLINK,lpath.substr(1),"").c_str();
       theCache->delete_key(key);
     }
-#endif // S3FS_USE_MEMCACHED
 
     S3FS_EXIT(result);
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to delete a file.");
 
-#ifdef S3FS_USE_MEMCACHED
     // cleanup cache to prevent future errors
     std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
@@ -1252,7 +1423,6 @@ s3_unlink(const char * path)
     std::string parentfolder=AWSCache::getParentFolder(lpath.substr(1));
     key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
      if(lCon) releaseConnection(lCon);
      lCon=NULL;
@@ -1260,6 +1430,85 @@ s3_unlink(const char * path)
   }
 }
 
+/*
+ * Rename a file
+ *
+ * The object is copied on the server side (i.e. the data is not
+ * transfered through s3fs) and the original is deleted afterwards.
+ * Objects larger than 5 GB are copied in parts in parallel.
+ * Directories are not renamed. Returning EXDEV lets the caller
+ * (e.g. mv) fall back to copying the files one by one.
+ */
+static int
+s3_rename(const char * from, const char * to)
+{
+  S3FSStats::Timer lTimer(theStats, S3FSStats::RENAME);
+  S3_LOG_DEBUG("from: " << from << " to: " << to);
+
+  S3ConnectionPtr lCon = NULL;
+  int result=0;
+  std::string lfrom(from);
+  std::string lto(to);
+
+  struct stat lStat;
+  result=s3_getattr(from, &lStat);
+  if (result != 0)
+    return result;
+  if (S_ISDIR(lStat.st_mode))
+    return -EXDEV;
+
+  try{
+    lCon = getConnection();
+
+    bool haserror=false;
+    unsigned int trycounter=0;
+
+    // the metadata (mode, mtime, ...) is copied together with the object
+    do{
+      trycounter++;
+      haserror=false;
+      S3FS_TRY
+        theStats.addRequest(S3FSStats::COPY, trycounter > 1);
+        // larger objects are copied in parts on connections of the pool
+        CopyResponsePtr lRes = lStat.st_size > S3_MAX_COPY_SIZE
+                               ? lCon->multipartCopy(theBucketname, lfrom.substr(1),
+                                                     theBucketname, lto.substr(1),
+                                                     theS3ConnectionPool.get())
+                               : lCon->copy(theBucketname, lfrom.substr(1),
+                                            theBucketname, lto.substr(1));
+        invalidateIndex(lto.substr(1));
+        addKnownKey(lto.substr(1));
+      S3FS_CATCH(Copy)
+    }while(haserror && trycounter<AWS_TRIES_ON_ERROR);
+
+    if(result==0){
+      // the target might have been cached as non-existent or with other content
+      std::string key=theCache->getkey(AWSCache::PREFIX_EXISTS,lto.substr(1),"");
+      theCache->delete_key(key);
+      key=theCache->getkey(AWSCache::PREFIX_FILE,lto.substr(1),"");
+      theCache->delete_key(key);
+      key=theCache->getkey(AWSCache::PREFIX_SYMLINK,lto.substr(1),"");
+      theCache->delete_key(key);
+
+      std::string parentfolder=AWSCache::getParentFolder(lto.substr(1));
+      key=theCache->getkey(AWSCache::PREFIX_DIR_LS,parentfolder,"");
+      theCache->delete_key(key);
+    }
+
+    releaseConnection(lCon);
+    lCon=NULL;
+  }catch(...){
+    S3_LOG_ERROR("An Error occured while trying to rename " << from << " to " << to);
+    if(lCon) releaseConnection(lCon);
+    return -EIO; // I/O Error
+  }
+
+  if (result != 0)
+    return result;
+
+  return s3_unlink(from);
+}
+
 // open, write, release
 // always use a temporary file
 
@@ -1276,6 +1525,7 @@ static int
 s3_open(const char *path, 
 	struct fuse_file_info *fileinfo)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::OPEN);
 #ifndef NDEBUG
   std::string location="s3_open";
 #endif
@@ -1286,9 +1536,7 @@ s3_open(const char *path,
   int result=0;
   std::string lpath(path);
   S3ConnectionPtr lCon = NULL;
-#ifdef S3FS_USE_MEMCACHED
   std::string key;
-#endif // S3FS_USE_MEMCACHED
 
   try{
     //get file stat
@@ -1299,6 +1547,37 @@ s3_open(const char *path,
 
     memset(fileinfo, 0, sizeof(struct fuse_file_info));
 
+    // the statistics are written into the temp file when the file is opened
+    if (strcmp(path, "/s3fs.stat") == 0) {
+      checkTempFolder();
+      int ltempsize=theS3FSTempFilePattern.length();
+      char ltempfile[ltempsize];
+      strcpy(ltempfile,theS3FSTempFilePattern.c_str());
+      fileHandle->id=mkstemp(ltempfile);
+      fileHandle->filename = std::string(ltempfile);
+      std::auto_ptr<std::fstream> tempfile(new std::fstream());
+      tempfile->open(ltempfile, std::fstream::in | std::fstream::out | std::fstream::binary);
+
+      std::ostringstream lStatistics;
+      printStatistics(lStatistics);
+      tempfile->write(lStatistics.str().c_str(), lStatistics.str().length());
+      tempfile->flush();
+
+      fileHandle->size = lStatistics.str().length();
+      fileHandle->filestream = tempfile.release();
+      fileHandle->is_write = false;
+      fileHandle->mtime = getCurrentTime();
+      fileHandle->mode = S_IFREG | 0444;
+      fileHandle->s3key = lpath.substr(1);
+
+      // getattr reports size 0, the kernel must read until the end
+      fileinfo->direct_io = 1;
+      fileinfo->fh = (uint64_t)fileHandle->id;
+      int lTmpPointer = fileHandle->id;
+      tempfilemap.insert( std::pair<int,struct FileHandle*>(lTmpPointer,fileHandle.release()) );
+      return result;
+    }
+
     // generate temp file and open it
     checkTempFolder();
     int ltempsize=theS3FSTempFilePattern.length();
@@ -1310,20 +1589,20 @@ s3_open(const char *path,
     std::auto_ptr<std::fstream> tempfile(new std::fstream());
     tempfile->open(ltempfile, std::fstream::in | std::fstream::out | std::fstream::binary);
 
-#ifdef S3FS_USE_MEMCACHED
     //init
     bool got_file_cont_from_cache=false;
-    memcached_return rc;
+    bool found;
     unsigned int filesize=(unsigned int)stbuf.st_size;
     
     // file can only be in cach if content is not too big
     if(filesize<AWSCache::FILE_CACHING_UPPER_LIMIT){
       S3_LOG_DEBUG("trying to get File of size " << filesize << " from cache");
       key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"").c_str();
-      theCache->read_file(key,dynamic_cast<std::fstream*>(tempfile.get()),&rc);
+      theCache->read_file(key,fileHandle->id,filesize,&fileHandle->etag,&found);
 
-      if (rc==MEMCACHED_SUCCESS){
+      if (found){
         got_file_cont_from_cache=true;
+        fileHandle->is_cached=true;
         fileHandle->size=stbuf.st_size;
         fileHandle->filestream = tempfile.release();
         fileHandle->is_write = false;
@@ -1338,7 +1617,6 @@ s3_open(const char *path,
     }
 
     if(!got_file_cont_from_cache){
-#endif // S3FS_USE_MEMCACHED
 
       // now lets get the data and save it into the temp file
       lCon = getConnection();
@@ -1350,22 +1628,19 @@ s3_open(const char *path,
         haserror=false;
         S3_LOG_DEBUG("going to make get call to s3 for " << lpath.substr(1) << "; trycounter " << trycounter);
         S3FS_TRY
-          GetResponsePtr lGet = lCon->get(theBucketname, lpath.substr(1));
+          // the data is written directly into the temp file while it is received
+          theStats.addRequest(S3FSStats::GET, trycounter > 1);
+          GetResponsePtr lGet = theCoalescer.get(lCon.get(), theBucketname, lpath.substr(1), fileHandle->id, 0);
+          theStats.addBytesIn(lGet->getContentLength());
           S3_LOG_DEBUG("successfully made get request");
-          std::istream& lInStream = lGet->getInputStream();
           S3_LOG_DEBUG("received content with length: " << lGet->getContentLength());
           fileHandle->size=lGet->getContentLength();
+          fileHandle->etag=lGet->getETag();
 
-          S3_LOG_DEBUG("going to write data to tempfile");
-          // write data to temp file
-          char data[1024];
-          while (lInStream.good())     // loop while extraction from file is possible
-          {
-            lInStream.read(data, 1024);       // get character from file
-            tempfile->write(data, lInStream.gcount());
-            S3_LOG_DEBUG("wrote " << lInStream.gcount() << "bytes to tempfile");
+          // cut off leftovers of a previous try
+          if (ftruncate(fileHandle->id, lGet->getContentLength()) != 0) {
+            S3_LOG_ERROR("couldn't truncate tempfile " << fileHandle->filename);
           }
-          tempfile->flush();
           S3_LOG_DEBUG("finished writing to tempfile");
 
           fileHandle->filestream = tempfile.release();
@@ -1383,9 +1658,7 @@ s3_open(const char *path,
         S3FS_CATCH(Get)
       }while(haserror && trycounter<AWS_TRIES_ON_ERROR);
 
-#ifdef S3FS_USE_MEMCACHED
     }
-#endif // S3FS_USE_MEMCACHED
     if (result!=0){
       S3_LOG_DEBUG("setting the fileinfo filehandle to NULL");
       fileinfo->fh = 0;
@@ -1395,13 +1668,11 @@ s3_open(const char *path,
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to open a file.");
 
-#ifdef S3FS_USE_MEMCACHED
     // cleanup cache to prevent future errors
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
     key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
      if(lCon) releaseConnection(lCon);
      lCon=NULL;
@@ -1422,6 +1693,7 @@ s3_open(const char *path,
 static int
 s3_write(const char * path, const char * data, size_t size, off_t offset, struct fuse_file_info * fileinfo)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::WRITE);
   S3_LOG_DEBUG("path: " << path << " data: " << data << " size: " << size << " offset: " << offset);
 
   S3_LOG_DEBUG("data size: " << strlen(data));
@@ -1429,9 +1701,7 @@ s3_write(const char * path, const char * data, size_t size, off_t offset, struct
   // init result
   int result=0;
   std::string lpath(path);
-#ifdef S3FS_USE_MEMCACHED
   std::string key;
-#endif // S3FS_USE_MEMCACHED
 
   try{
     if( 
@@ -1458,13 +1728,11 @@ s3_write(const char * path, const char * data, size_t size, off_t offset, struct
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying write data to a file.");
 
-#ifdef S3FS_USE_MEMCACHED
     // cleanup cache to prevent future errors
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
     key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     return -EIO; // I/O Error
   }
@@ -1488,6 +1756,7 @@ s3_write(const char * path, const char * data, size_t size, off_t offset, struct
 static int
 s3_release(const char *path, struct fuse_file_info *fileinfo)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::RELEASE);
 #ifndef NDEBUG
   std::string location="s3_release";
 #endif
@@ -1498,9 +1767,8 @@ s3_release(const char *path, struct fuse_file_info *fileinfo)
   int result=0;
   std::string lpath(path);
   S3ConnectionPtr lCon = NULL;
-#ifdef S3FS_USE_MEMCACHED
   std::string key;
-#endif // S3FS_USE_MEMCACHED
+  int lFileDescriptor=-1; // closed by the catch block, too
 
   try{
     if(fileinfo!=NULL
@@ -1514,8 +1782,14 @@ s3_release(const char *path, struct fuse_file_info *fileinfo)
         // check if we have to send changes to s3
         if(fileHandle->is_write){
 
-          // reset filestream
-          fileHandle->filestream->seekg(0,std::ios_base::beg);
+          // write pending changes to the temp file and send it from a
+          // separate descriptor (i.e. without copying it through the filestream)
+          fileHandle->filestream->flush();
+          lFileDescriptor=::open(fileHandle->filename.c_str(), O_RDONLY);
+          if(lFileDescriptor==-1){
+            S3_LOG_ERROR("couldn't open temp file " << fileHandle->filename);
+            return -EIO;
+          }
 
           // transfer temp file to s3
           lCon = getConnection();
@@ -1532,30 +1806,35 @@ s3_release(const char *path, struct fuse_file_info *fileinfo)
               lDirMap.insert(pair_t("uid", to_string(getuid())));
               lDirMap.insert(pair_t("mode", to_string(fileHandle->mode)));
               lDirMap.insert(pair_t("mtime", time_to_string(fileHandle->mtime)));
-              PutResponsePtr lRes = lCon->put(theBucketname, fileHandle->s3key, *(fileHandle->filestream), "text/plain", &lDirMap);
+              theStats.addRequest(S3FSStats::PUT, trycounter > 1);
+              PutResponsePtr lRes = lCon->put(theBucketname, fileHandle->s3key, lFileDescriptor, 0, "text/plain", -1, &lDirMap);
+              invalidateIndex(fileHandle->s3key);
+              struct stat lFileStat;
+              if (fstat(lFileDescriptor, &lFileStat) == 0)
+                theStats.addBytesOut(lFileStat.st_size);
 
-#ifdef S3FS_USE_MEMCACHED
               // invalidate cached data of file
               key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"").c_str();
               theCache->delete_key(key); 
               key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"").c_str();
               theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
             S3FS_CATCH(Put)
           }while(haserror && trycounter<AWS_TRIES_ON_ERROR);
+          ::close(lFileDescriptor);
+          lFileDescriptor=-1;
 
           if(result!=0){ 
             S3_LOG_ERROR("saving file on s3 failed");
           }
 
-        }else{ 
+        }else if(lpath.compare("/s3fs.stat")!=0){ 
           // we have to send no changes to s3 -> readonly
 
-#ifdef S3FS_USE_MEMCACHED
-          key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"").c_str();
-          theCache->save_file(key,dynamic_cast<std::fstream*>(fileHandle->filestream),fileHandle->size); 
-#endif // S3FS_USE_MEMCACHED
+          if(!fileHandle->is_cached){
+            key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"").c_str();
+            theCache->save_file(key,fileHandle->etag,fileHandle->id,fileHandle->size);
+          }
         }
 
       }else{
@@ -1568,13 +1847,13 @@ s3_release(const char *path, struct fuse_file_info *fileinfo)
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to release a file.");
 
-#ifdef S3FS_USE_MEMCACHED
+    if(lFileDescriptor!=-1) ::close(lFileDescriptor);
+
     // cleanup cache to prevent future errors
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
     key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     if(lCon) releaseConnection(lCon);
     lCon=NULL;
@@ -1601,13 +1880,12 @@ s3_read(const char *path,
         off_t offset,
         struct fuse_file_info *fileinfo)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::READ);
   S3_LOG_DEBUG("path: " << path << " offset: " << offset << " size: " << size);
   S3_LOG_DEBUG("size of the tempfilemap " << tempfilemap.size());
 
   std::string lpath(path);
-#ifdef S3FS_USE_MEMCACHED
   std::string key;
-#endif // S3FS_USE_MEMCACHED
 
   try{
     FileHandle* fileHandle=tempfilemap.find((int)fileinfo->fh)->second;
@@ -1633,19 +1911,96 @@ s3_read(const char *path,
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to read a file.");
 
-#ifdef S3FS_USE_MEMCACHED
     // cleanup cache to prevent future errors
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
     key=theCache->getkey(AWSCache::PREFIX_FILE,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     return -EIO; // I/O Error
   }
 
 }
 
+#if FUSE_VERSION >= 29
+/*
+ * Read data from an open file without copying it
+ * the buffer refers to the temp file, so fuse can splice it to the kernel
+ */
+static int
+s3_read_buf(const char *path,
+            struct fuse_bufvec **bufp,
+            size_t size,
+            off_t offset,
+            struct fuse_file_info *fileinfo)
+{
+  S3FSStats::Timer lTimer(theStats, S3FSStats::READ);
+  S3_LOG_DEBUG("path: " << path << " offset: " << offset << " size: " << size);
+
+  std::map<int,struct FileHandle*>::iterator lIter=tempfilemap.find((int)fileinfo->fh);
+  if(lIter==tempfilemap.end()){
+    S3_LOG_ERROR("No temporary file handle exists.");
+    return -EIO;
+  }
+  FileHandle* fileHandle=lIter->second;
+
+  // written data may still be in the buffer of the stream
+  if(fileHandle->is_write && !fileHandle->filestream->flush()){
+    S3_LOG_ERROR("An Error occured while trying to read a file.");
+    return -EIO;
+  }
+
+  // fuse reads from the descriptor, so its size is what can be read
+  struct stat lStat;
+  if(fstat(fileHandle->id, &lStat) != 0){
+    S3_LOG_ERROR("An Error occured while trying to read a file.");
+    return -EIO;
+  }
+  size_t readsize=0;
+  if(offset < lStat.st_size)
+    readsize=std::min(size, (size_t)(lStat.st_size-offset));
+
+  // freed by fuse
+  struct fuse_bufvec* lBuf=(struct fuse_bufvec*)malloc(sizeof(struct fuse_bufvec));
+  if(lBuf==NULL)
+    return -ENOMEM;
+  memset(lBuf, 0, sizeof(struct fuse_bufvec));
+  lBuf->count=1;
+  lBuf->buf[0].size=readsize;
+  lBuf->buf[0].flags=(enum fuse_buf_flags)(FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK);
+  lBuf->buf[0].fd=fileHandle->id;
+  lBuf->buf[0].pos=offset;
+
+  *bufp=lBuf;
+  return 0;
+}
+#endif
+
+/*
+ * Initialize the filesystem
+ * threads are started here because fuse_main forks into the background
+ */
+static void*
+s3_init(struct fuse_conn_info *conn)
+{
+#if FUSE_VERSION >= 29
+  // let fuse splice the buffers of s3_read_buf instead of copying them
+  if(conn->capable & FUSE_CAP_SPLICE_WRITE)
+    conn->want |= FUSE_CAP_SPLICE_WRITE;
+  if(conn->capable & FUSE_CAP_SPLICE_MOVE)
+    conn->want |= FUSE_CAP_SPLICE_MOVE;
+#endif
+
+  if(theIndex.get()){
+    pthread_t lThread;
+    if(pthread_create(&lThread, NULL, refreshIndexThread, NULL) == 0)
+      pthread_detach(lThread);
+    else
+      S3_LOG_ERROR("couldn't start the thread that refreshes the bucket index");
+  }
+  return NULL;
+}
+
 
 /*
  * Open directory
@@ -1671,6 +2026,7 @@ s3_opendir(const char *path, struct fuse_file_info *fi)
 static int
 s3_symlink(const char * oldpath, const char * newpath) 
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::SYMLINK);
   S3_LOG_DEBUG("oldpath: " << oldpath << " newpath: " << newpath);
   std::string lpath(newpath);
   int result=0;
@@ -1696,26 +2052,22 @@ s3_symlink(const char * oldpath, const char * newpath)
       result=s3_release(newpath, &fileinfo);
     }
 
-#ifdef S3FS_USE_MEMCACHED
     if(result==0){ 
 
       // we only have to remember the link, anything else is managed by s3_create...
       key=theCache->getkey(AWSCache::PREFIX_SYMLINK,lpath.substr(1),"").c_str();
       theCache->save_key(key, oldpath);
     }
-#endif //USE_MEMCACHED
 
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to create symlink " << newpath << " to file/folder " << oldpath );
 
-#ifdef S3FS_USE_MEMCACHED
 
     // cleanup cache to prevent future errors
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
     key=theCache->getkey(AWSCache::PREFIX_SYMLINK,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     return -EIO; // I/O Error
   }
@@ -1735,6 +2087,7 @@ s3_symlink(const char * oldpath, const char * newpath)
 static int
 s3_readlink(const char * path, char * link, size_t size)
 {
+  S3FSStats::Timer lTimer(theStats, S3FSStats::READLINK);
   S3_LOG_DEBUG("path: " << path << " buffer size: " << sizeof(link));
   std::string lpath(path);
   int result=0;
@@ -1742,14 +2095,13 @@ s3_readlink(const char * path, char * link, size_t size)
   int readsize=0;
 
   try{
-#ifdef S3FS_USE_MEMCACHED
     std::string value;
-    memcached_return rc;
+    bool found;
     bool readlink=false;
 
     // check if the cache knows if the link exists
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
-    value=theCache->read_key(key, &rc);
+    value=theCache->read_key(key, &found);
     if (value.length() > 0 && value.compare("0")==0) // link does not exist
     {
       S3_LOG_DEBUG("[Memcached] link: " << lpath.substr(1) << " is marked as non existent in cache.");
@@ -1760,7 +2112,7 @@ s3_readlink(const char * path, char * link, size_t size)
 
       // get the target link
       key=theCache->getkey(AWSCache::PREFIX_SYMLINK,lpath.substr(1),"");
-      value=theCache->read_key(key, &rc);
+      value=theCache->read_key(key, &found);
       if (value.compare("")==0){
       	
       	// although the link was marked as existent in cache the target value was not in the cache, so it needs to be read from s3
@@ -1777,7 +2129,6 @@ s3_readlink(const char * path, char * link, size_t size)
     } 
     
     if(readlink){
-#endif
       // open the file that contains the target path info
       fuse_file_info fileinfo;
       memset(&fileinfo, 0, sizeof(struct fuse_file_info));
@@ -1800,7 +2151,6 @@ s3_readlink(const char * path, char * link, size_t size)
         result=s3_release(path, &fileinfo);
       }
 
-#ifdef S3FS_USE_MEMCACHED
       if(result==0){ 
 
         // we only have to remember the link, anything else is managed by s3_create...
@@ -1808,19 +2158,16 @@ s3_readlink(const char * path, char * link, size_t size)
         theCache->save_key(key, link);
       }
     }
-#endif //USE_MEMCACHED
 
   }catch(...){
     S3_LOG_ERROR("An Error occured while trying to read symlink " << path);
 
-#ifdef S3FS_USE_MEMCACHED
 
     // cleanup cache to prevent future errors
     key=theCache->getkey(AWSCache::PREFIX_EXISTS,lpath.substr(1),"");
     theCache->delete_key(key);
     key=theCache->getkey(AWSCache::PREFIX_SYMLINK,lpath.substr(1),"");
     theCache->delete_key(key);
-#endif // S3FS_USE_MEMCACHED
 
     return -EIO; // I/O Error
   }
@@ -1844,6 +2191,7 @@ main(int argc, char **argv)
   s3_filesystem_operations.readdir    = s3_readdir;
   s3_filesystem_operations.create     = s3_create;
   s3_filesystem_operations.unlink     = s3_unlink;
+  s3_filesystem_operations.rename     = s3_rename;
   s3_filesystem_operations.opendir    = s3_opendir;
   s3_filesystem_operations.read       = s3_read;
   s3_filesystem_operations.write      = s3_write;
@@ -1851,6 +2199,10 @@ main(int argc, char **argv)
   s3_filesystem_operations.release    = s3_release;
   s3_filesystem_operations.symlink    = s3_symlink;
   s3_filesystem_operations.readlink   = s3_readlink;
+#if FUSE_VERSION >= 29
+  s3_filesystem_operations.read_buf   = s3_read_buf;
+#endif
+  s3_filesystem_operations.init       = s3_init;
 
   // handle s3fs and fuse args
   struct fuse_args args = FUSE_ARGS_INIT(argc, argv);
@@ -1881,10 +2233,29 @@ main(int argc, char **argv)
     }else{
       create_mount_dir=true;
     }
-#ifdef S3FS_USE_MEMCACHED
     if (!conf.memcached_servers)
       theMemcachedServers = lProperties[s3fs::utils::Properties::MEMCACHED_SERVERS];
-#endif
+    if (!conf.memcached_file_limit && lProperties[s3fs::utils::Properties::MEMCACHED_FILE_LIMIT].length() > 0)
+      AWSCache::FILE_CACHING_UPPER_LIMIT = atoi(lProperties[s3fs::utils::Properties::MEMCACHED_FILE_LIMIT].c_str());
+    if (!conf.index_file)
+      theIndexFile = lProperties[s3fs::utils::Properties::INDEX_FILE];
+    if (!conf.index_max_age && lProperties[s3fs::utils::Properties::INDEX_MAX_AGE].length() > 0)
+      theIndexMaxAge = atoi(lProperties[s3fs::utils::Properties::INDEX_MAX_AGE].c_str());
+    if (!conf.filter_max_age && lProperties[s3fs::utils::Properties::FILTER_MAX_AGE].length() > 0)
+      theKeyFilterMaxAge = atoi(lProperties[s3fs::utils::Properties::FILTER_MAX_AGE].c_str());
+    if (!conf.filter_fp_rate && lProperties[s3fs::utils::Properties::FILTER_FP_RATE].length() > 0)
+      theKeyFilterFalsePositiveRate = atof(lProperties[s3fs::utils::Properties::FILTER_FP_RATE].c_str());
+    if (!conf.cache_size && lProperties[s3fs::utils::Properties::CACHE_SIZE].length() > 0) {
+      long lCacheSize = atol(lProperties[s3fs::utils::Properties::CACHE_SIZE].c_str());
+      theCacheSize = lCacheSize < 0 ? 0 : lCacheSize;
+      theCacheSizeIsSet = true;
+    }
+    if (!conf.cache_ttl && lProperties[s3fs::utils::Properties::CACHE_TTL].length() > 0)
+      theCacheTTL = atoi(lProperties[s3fs::utils::Properties::CACHE_TTL].c_str());
+    if (!conf.shm_cache)
+      theShmCacheFile = lProperties[s3fs::utils::Properties::SHM_CACHE];
+    if (!conf.shm_cache_size && lProperties[s3fs::utils::Properties::SHM_CACHE_SIZE].length() > 0)
+      theShmCacheSize = atol(lProperties[s3fs::utils::Properties::SHM_CACHE_SIZE].c_str());
   } 
 
   // command line parameters override config file
@@ -1901,10 +2272,28 @@ main(int argc, char **argv)
     theS3FSTempFolder = conf.temp_dir;
   if (conf.bucket)
     theBucketname = conf.bucket;
-#ifdef S3FS_USE_MEMCACHED
   if (conf.memcached_servers)
     theMemcachedServers = conf.memcached_servers;
-#endif
+  if (conf.memcached_file_limit > 0)
+    AWSCache::FILE_CACHING_UPPER_LIMIT = conf.memcached_file_limit;
+  if (conf.index_file)
+    theIndexFile = conf.index_file;
+  if (conf.index_max_age)
+    theIndexMaxAge = conf.index_max_age;
+  if (conf.filter_max_age)
+    theKeyFilterMaxAge = conf.filter_max_age;
+  if (conf.filter_fp_rate)
+    theKeyFilterFalsePositiveRate = conf.filter_fp_rate;
+  if (conf.cache_size) {
+    theCacheSize = conf.cache_size < 0 ? 0 : conf.cache_size;
+    theCacheSizeIsSet = true;
+  }
+  if (conf.cache_ttl)
+    theCacheTTL = conf.cache_ttl;
+  if (conf.shm_cache)
+    theShmCacheFile = conf.shm_cache;
+  if (conf.shm_cache_size > 0)
+    theShmCacheSize = conf.shm_cache_size;
   if (0 <= conf.log_level && conf.log_level <= 2)
     theLogLevel = (LogLevel) conf.log_level; 
 
@@ -1937,23 +2326,42 @@ main(int argc, char **argv)
     std::cerr << "Please specify a temporary directory (-o temp-dir=string)." << std::endl;
     return 3;
   }
-#ifdef S3FS_USE_MEMCACHED
-  if (theMemcachedServers.length() == 0) {
-    S3_LOG_ERROR("Please specify the memcached servers (-o memcached-servers=string).");
-    std::cerr << "Please specify the memcached servers (-o memcached-servers=string)." << std::endl;
-    return 5;
-  }
-  setenv("MEMCACHED_SERVERS", theMemcachedServers.c_str(), 1); // replace the MEMCACHED_SERVERS var in the environment
-#endif
 
   theS3FSTempFilePattern = theS3FSTempFolder;
   if (theS3FSTempFolder.at(theS3FSTempFolder.length()-1) != '/')
     theS3FSTempFilePattern.append("/");
   theS3FSTempFilePattern.append("s3fs_file_XXXXXX");
 
+  // the cache tiers from the fastest to the most shared one
+#ifdef S3FS_USE_MEMCACHED
+  if (theMemcachedServers.length() > 0 && !theCacheSizeIsSet)
+    theCacheSize = 0;
+#endif
+  theCacheTiers = new TieredBackend();
+  if (theCacheSize > 0)
+    theCacheTiers->add(new LRUBackend(theCacheSize, AWSCache::FILE_CHUNK_SIZE, theCacheTTL));
+  if (theShmCacheFile.length() > 0) {
+    std::auto_ptr<ShmBackend> lShm(new ShmBackend(theShmCacheFile, theShmCacheSize / SHM_CACHE_SLOT_SIZE,
+                                                  SHM_CACHE_SLOT_SIZE, theCacheTTL));
+    if (lShm->is_open()) {
+      theCacheTiers->add(lShm.release());
+    } else {
+      S3_LOG_ERROR("couldn't open the shared memory cache " << theShmCacheFile);
+    }
+  }
+  if (theMemcachedServers.length() > 0) {
 #ifdef S3FS_USE_MEMCACHED
-  theCache.reset(new AWSCache(theBucketname));
-#endif //S3FS_USE_MEMCACHED
+    theCacheTiers->add(new MemcachedBackend(theMemcachedServers));
+#else
+    S3_LOG_ERROR("s3fs was built without memcached, ignoring the memcached servers");
+#endif
+  }
+  S3_LOG_INFO("using cache tiers: " << theCacheTiers->name());
+  theCache.reset(new AWSCache(theBucketname, theCacheTiers));
+
+  if (theKeyFilterMaxAge > 0)
+    theKeyFilter.reset(new KeyFilter(KEY_FILTER_CAPACITY, theKeyFilterFalsePositiveRate,
+                                     theKeyFilterMaxAge));
 
   // initialization
   theFactory = AWSConnectionFactory::getInstance();
@@ -1969,6 +2377,13 @@ main(int argc, char **argv)
       ListBucketResponse::Object o;
       while (lRes->next(o)) { }
       lRes->close();
+
+      // load the index of the last mount and list what is missing or too old
+      if (theIndexFile.length() > 0) {
+        S3_LOG_INFO("using bucket index " << theIndexFile);
+        theIndex.reset(new S3BucketIndex(theIndexFile, theBucketname));
+      }
+      releaseConnection(lCon);
      } catch (aws::AuthenticationException& auth_exception) {
        S3_LOG_ERROR("couldn't authenticate with s3 " << auth_exception.what());
        std::cerr << auth_exception.what() << std::endl;
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "s3fsstats.h"
+
+#include <string.h>
+
+namespace aws { 
+
+static const char* OPERATION_NAMES[] = {
+  "getattr", "readdir", "open", "read", "write", "release", "create", "mkdir", "rmdir",
+  "unlink", "rename", "truncate", "chmod", "chown", "utimens", "symlink", "readlink"
+};
+
+static const char* REQUEST_NAMES[] = {
+  "head", "get", "put", "delete", "copy", "list"
+};
+
+static const char* BUCKET_NAMES[] = {
+  "le_100us", "le_1ms", "le_10ms", "le_100ms", "le_1s", "le_10s", "gt_10s"
+};
+
+S3FSStats::Timer::Timer(S3FSStats& aStats, Operation aOperation)
+  : theStats(aStats),
+    theOperation(aOperation)
+{
+  gettimeofday(&theStart, 0);
+}
+
+S3FSStats::Timer::~Timer()
+{
+  struct timeval lEnd;
+  gettimeofday(&lEnd, 0);
+  int64_t lMicroseconds = (int64_t)(lEnd.tv_sec - theStart.tv_sec) * 1000000
+                          + (lEnd.tv_usec - theStart.tv_usec);
+  theStats.addOperation(theOperation, lMicroseconds > 0 ? lMicroseconds : 0);
+}
+
+S3FSStats::S3FSStats()
+  : theStartTime(time(0)),
+    theRetries(0),
+    theErrors(0),
+    theBytesIn(0),
+    theBytesOut(0)
+{
+  memset(theOperations, 0, sizeof(theOperations));
+  memset(theMicroseconds, 0, sizeof(theMicroseconds));
+  memset(theLatencies, 0, sizeof(theLatencies));
+  memset(theRequests, 0, sizeof(theRequests));
+}
+
+void
+S3FSStats::addOperation(Operation aOperation, uint64_t aMicroseconds)
+{
+  size_t lBucket = 0;
+  for (uint64_t lLimit = 100; lBucket < NUMBER_OF_BUCKETS - 1 && aMicroseconds > lLimit; lLimit *= 10)
+    ++lBucket;
+  __sync_add_and_fetch(&theOperations[aOperation], 1);
+  __sync_add_and_fetch(&theMicroseconds[aOperation], aMicroseconds);
+  __sync_add_and_fetch(&theLatencies[aOperation][lBucket], 1);
+}
+
+void
+S3FSStats::addRequest(Request aRequest, bool aIsRetry)
+{
+  __sync_add_and_fetch(&theRequests[aRequest], 1);
+  if (aIsRetry)
+    __sync_add_and_fetch(&theRetries, 1);
+}
+
+void
+S3FSStats::addError()
+{
+  __sync_add_and_fetch(&theErrors, 1);
+}
+
+void
+S3FSStats::addBytesIn(uint64_t aBytes)
+{
+  __sync_add_and_fetch(&theBytesIn, aBytes);
+}
+
+void
+S3FSStats::addBytesOut(uint64_t aBytes)
+{
+  __sync_add_and_fetch(&theBytesOut, aBytes);
+}
+
+void
+S3FSStats::print(std::ostream& aStream) const
+{
+  // the counters are read without synchronization, they may be slightly off
+  aStream << "uptime " << (time(0) - theStartTime) << "\n";
+  for (size_t i = 0; i < NUMBER_OF_OPERATIONS; ++i) {
+    if (theOperations[i] == 0)
+      continue;
+    aStream << "op." << OPERATION_NAMES[i] << ".count " << theOperations[i] << "\n";
+    aStream << "op." << OPERATION_NAMES[i] << ".us " << theMicroseconds[i] << "\n";
+    for (size_t j = 0; j < NUMBER_OF_BUCKETS; ++j)
+      aStream << "op." << OPERATION_NAMES[i] << "." << BUCKET_NAMES[j] << " " << theLatencies[i][j] << "\n";
+  }
+  for (size_t i = 0; i < NUMBER_OF_REQUESTS; ++i)
+    aStream << "request." << REQUEST_NAMES[i] << " " << theRequests[i] << "\n";
+  aStream << "request.retries " << theRetries << "\n";
+  aStream << "request.errors " << theErrors << "\n";
+  aStream << "bytes.in " << theBytesIn << "\n";
+  aStream << "bytes.out " << theBytesOut << "\n";
+}
+
+} /* namespace aws */
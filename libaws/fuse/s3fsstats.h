@@ -0,0 +1,90 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3FS_STATS
+#define AWS_S3FS_STATS
+
+#include <ctime>
+#include <ostream>
+#include <stdint.h>
+#include <sys/time.h>
+
+namespace aws { 
+
+/**
+ * Counters of the operations and requests of a mount that are printed
+ * through the /s3fs.stat file. All functions are thread-safe.
+ */
+class S3FSStats
+{
+public:
+
+  enum Operation {
+    GETATTR, READDIR, OPEN, READ, WRITE, RELEASE, CREATE, MKDIR, RMDIR,
+    UNLINK, RENAME, TRUNCATE, CHMOD, CHOWN, UTIMENS, SYMLINK, READLINK,
+    NUMBER_OF_OPERATIONS
+  };
+
+  enum Request {
+    HEAD, GET, PUT, DELETE, COPY, LIST,
+    NUMBER_OF_REQUESTS
+  };
+
+  // latencies up to 100us, 1ms, 10ms, 100ms, 1s, 10s, and above
+  enum { NUMBER_OF_BUCKETS = 7 };
+
+  // measures an operation from construction to destruction
+  class Timer
+  {
+  public:
+    Timer(S3FSStats& aStats, Operation aOperation);
+    ~Timer();
+
+  private:
+    S3FSStats&     theStats;
+    Operation      theOperation;
+    struct timeval theStart;
+  };
+
+  S3FSStats();
+
+  void addOperation(Operation aOperation, uint64_t aMicroseconds);
+
+  void addRequest(Request aRequest, bool aIsRetry);
+
+  void addError();
+
+  void addBytesIn(uint64_t aBytes);
+
+  void addBytesOut(uint64_t aBytes);
+
+  // "name value" lines
+  void print(std::ostream& aStream) const;
+
+private:
+
+  time_t   theStartTime;
+  uint64_t theOperations[NUMBER_OF_OPERATIONS];
+  uint64_t theMicroseconds[NUMBER_OF_OPERATIONS];
+  uint64_t theLatencies[NUMBER_OF_OPERATIONS][NUMBER_OF_BUCKETS];
+  uint64_t theRequests[NUMBER_OF_REQUESTS];
+  uint64_t theRetries;
+  uint64_t theErrors;
+  uint64_t theBytesIn;
+  uint64_t theBytesOut;
+};
+
+} /* namespace aws */
+#endif
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "shmbackend.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace aws { 
+
+// a key may be stored in one of this many consecutive slots
+static const size_t SHM_PROBES=8;
+
+static const char SHM_MAGIC[8]={'S','3','F','S','S','H','M','1'};
+
+struct ShmBackend::Header
+{
+  char            magic[8];   // written last by the creator
+  uint32_t        slots;
+  uint32_t        slotsize;
+  uint64_t        clock;
+  pthread_mutex_t mutex;
+};
+
+struct ShmBackend::Slot
+{
+  uint32_t hash;
+  uint32_t used;
+  uint32_t keylength;
+  uint32_t valuelength;
+  int64_t  expires;
+  uint64_t lastuse;
+  char     data[1];           // key followed by the value
+};
+
+// the slots start at a cache line
+size_t
+ShmBackend::header_size()
+{
+  return (sizeof(Header)+63)/64*64;
+}
+
+ShmBackend::ShmBackend(const std::string& path, size_t slots, size_t slotsize, time_t ttl)
+  : theHeader(NULL),
+    theSize(0),
+    theTTL(ttl)
+{
+  if(slotsize<=offsetof(Slot, data)+1)
+    slotsize=offsetof(Slot, data)+1;
+  slotsize=(slotsize+7)/8*8;
+  if(!open(path, slots>0 ? slots : 1, slotsize) && theHeader){
+    munmap(theHeader, theSize);
+    theHeader=NULL;
+  }
+}
+
+ShmBackend::~ShmBackend()
+{
+  if(theHeader)
+    munmap(theHeader, theSize);
+}
+
+bool
+ShmBackend::open(const std::string& path, size_t slots, size_t slotsize)
+{
+  bool creator=true;
+  int fd=::open(path.c_str(), O_RDWR|O_CREAT|O_EXCL, 0600);
+  if(fd==-1 && errno==EEXIST){
+    creator=false;
+    fd=::open(path.c_str(), O_RDWR);
+  }
+  if(fd==-1)
+    return false;
+
+  if(creator){
+    theSize=header_size()+slots*slotsize;
+    if(ftruncate(fd, theSize)!=0){
+      ::close(fd);
+      unlink(path.c_str());
+      return false;
+    }
+  }else{
+    // wait until the creator has set the size of the file
+    struct stat st;
+    for(int i=0; i<100; i++){
+      if(fstat(fd, &st)==0 && (size_t)st.st_size>=header_size())
+        break;
+      usleep(10000);
+    }
+    theSize=(size_t)st.st_size;
+    if(theSize<header_size()){
+      ::close(fd);
+      return false;
+    }
+  }
+
+  void* data=mmap(NULL, theSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if(data==MAP_FAILED)
+    return false;
+  theHeader=(Header*)data;
+
+  if(creator){
+    theHeader->slots=slots;
+    theHeader->slotsize=slotsize;
+    theHeader->clock=0;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&theHeader->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    __sync_synchronize();
+    memcpy(theHeader->magic, SHM_MAGIC, sizeof(SHM_MAGIC));
+    return true;
+  }
+
+  for(int i=0; i<100 && memcmp(theHeader->magic, SHM_MAGIC, sizeof(SHM_MAGIC))!=0; i++)
+    usleep(10000);
+  __sync_synchronize();
+  return memcmp(theHeader->magic, SHM_MAGIC, sizeof(SHM_MAGIC))==0
+         && theHeader->slots>0
+         && header_size()+(size_t)theHeader->slots*theHeader->slotsize<=theSize;
+}
+
+void
+ShmBackend::lock()
+{
+  // a process died while holding the lock, its slot was never marked as used
+  if(pthread_mutex_lock(&theHeader->mutex)==EOWNERDEAD)
+    pthread_mutex_consistent(&theHeader->mutex);
+}
+
+ShmBackend::Slot*
+ShmBackend::slot(size_t index) const
+{
+  return (Slot*)((char*)theHeader+header_size()+index*theHeader->slotsize);
+}
+
+ShmBackend::Slot*
+ShmBackend::find(const std::string& key, uint32_t keyhash) const
+{
+  for(size_t i=0; i<SHM_PROBES; i++){
+    Slot* current=slot((keyhash+i)%theHeader->slots);
+    if(current->used && current->hash==keyhash && current->keylength==key.length()
+       && memcmp(current->data, key.data(), key.length())==0)
+      return current;
+  }
+  return NULL;
+}
+
+bool
+ShmBackend::get(const std::string& key, std::string& value)
+{
+  if(!theHeader)
+    return false;
+
+  bool result=false;
+  uint32_t keyhash=hash(key);
+  lock();
+  Slot* current=find(key, keyhash);
+  if(current){
+    if(theTTL>0 && current->expires<=time(0)){
+      current->used=0;
+    }else{
+      value.assign(current->data+current->keylength, current->valuelength);
+      current->lastuse=++theHeader->clock;
+      result=true;
+    }
+  }
+  pthread_mutex_unlock(&theHeader->mutex);
+  return result;
+}
+
+bool
+ShmBackend::set(const std::string& key, const char* value, size_t length)
+{
+  if(!theHeader)
+    return false;
+
+  uint32_t keyhash=hash(key);
+  bool fits=offsetof(Slot, data)+key.length()+length<=theHeader->slotsize;
+  lock();
+  Slot* target=find(key, keyhash);
+  if(!fits){
+    // don't keep an old value
+    if(target)
+      target->used=0;
+    pthread_mutex_unlock(&theHeader->mutex);
+    return false;
+  }
+
+  // an empty or expired slot, otherwise the least recently used one
+  time_t now=time(0);
+  for(size_t i=0; !target && i<SHM_PROBES; i++){
+    Slot* current=slot((keyhash+i)%theHeader->slots);
+    if(!current->used || (theTTL>0 && current->expires<=now))
+      target=current;
+  }
+  if(!target){
+    target=slot(keyhash%theHeader->slots);
+    for(size_t i=1; i<SHM_PROBES; i++){
+      Slot* current=slot((keyhash+i)%theHeader->slots);
+      if(current->lastuse<target->lastuse)
+        target=current;
+    }
+  }
+
+  target->used=0;
+  target->hash=keyhash;
+  target->keylength=key.length();
+  target->valuelength=length;
+  target->expires=now+theTTL;
+  memcpy(target->data, key.data(), key.length());
+  memcpy(target->data+key.length(), value, length);
+  target->lastuse=++theHeader->clock;
+  __sync_synchronize();
+  target->used=1;
+  pthread_mutex_unlock(&theHeader->mutex);
+  return true;
+}
+
+void
+ShmBackend::remove(const std::string& key)
+{
+  if(!theHeader)
+    return;
+
+  lock();
+  Slot* current=find(key, hash(key));
+  if(current)
+    current->used=0;
+  pthread_mutex_unlock(&theHeader->mutex);
+}
+
+uint32_t
+ShmBackend::hash(const std::string& key)
+{
+  // FNV-1a
+  uint32_t result=2166136261U;
+  for(std::string::const_iterator i=key.begin(); i!=key.end(); ++i){
+    result^=(unsigned char)*i;
+    result*=16777619U;
+  }
+  return result;
+}
+
+} /* namespace aws */
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3FS_SHMBACKEND
+#define AWS_S3FS_SHMBACKEND
+
+#include <ctime>
+#include <pthread.h>
+
+#include "cachebackend.h"
+
+namespace aws { 
+
+/**
+ * Hash table in a memory-mapped file (e.g. in /dev/shm) that is shared by
+ * all s3fs processes on a host that use the same file. Every entry lives in
+ * a slot of a fixed size, values that don't fit aren't stored. A key is
+ * placed in one of a few slots after its hash, the least recently used of
+ * them is replaced. The table is locked by a process-shared mutex.
+ */
+class ShmBackend : public CacheBackend
+{
+public:
+
+  // the number of slots and their size are only used by the process that creates the file
+  ShmBackend(const std::string& path, size_t slots, size_t slotsize, time_t ttl);
+
+  virtual ~ShmBackend();
+
+  bool is_open() const { return theHeader!=NULL; }
+
+  virtual bool get(const std::string& key, std::string& value);
+
+  virtual bool set(const std::string& key, const char* value, size_t length);
+
+  virtual void remove(const std::string& key);
+
+  virtual std::string name() const { return "shm"; }
+
+private:
+
+  struct Header;
+  struct Slot;
+
+  bool open(const std::string& path, size_t slots, size_t slotsize);
+
+  void lock();
+
+  Slot* slot(size_t index) const;
+
+  static size_t header_size();
+
+  Slot* find(const std::string& key, uint32_t hash) const;
+
+  static uint32_t hash(const std::string& key);
+
+  Header* theHeader;
+  size_t  theSize;
+  time_t  theTTL;
+};
+
+} /* namespace aws */
+#endif
@@ -17,15 +17,25 @@
 #define LIBAWS_AWS_API_H
 
 #include <libaws/awsconnectionfactory.h>
+#include <libaws/awsreactor.h>
+#include <libaws/awsendpointset.h>
+#include <libaws/awslog.h>
 
 #include <libaws/s3connection.h>
+#include <libaws/s3awaitable.h>
+#include <libaws/s3presigner.h>
+#include <libaws/s3coalescer.h>
+#include <libaws/s3objectcache.h>
+#include <libaws/s3bucketindex.h>
 #include <libaws/connectionpool.h>
 #include <libaws/s3response.h>
 #include <libaws/s3exception.h>
 #include <libaws/sqsconnection.h>
+#include <libaws/sqsawaitable.h>
 #include <libaws/sqsresponse.h>
 #include <libaws/sqsexception.h>
 #include <libaws/sdbconnection.h>
+#include <libaws/sdbawaitable.h>
 #include <libaws/sdbresponse.h>
 #include <libaws/sdbexception.h>
 
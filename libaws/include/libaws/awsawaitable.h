@@ -0,0 +1,109 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBAWS_AWSAWAITABLE_API_H
+#define LIBAWS_AWSAWAITABLE_API_H
+
+#include <libaws/exception.h>
+
+// the awaitable requests need C++20 coroutines; the rest of the library
+// is usable with any C++ version
+#if __cplusplus >= 202002L
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+
+namespace aws {
+
+  /** \brief AWSAwaitable is the base of the asynchronous requests that can
+   *         be awaited by a C++20 coroutine (see S3Awaitable, SQSAwaitable,
+   *         and SDBAwaitable).
+   *
+   * Handler is the handler of the asynchronous requests of the connection
+   * (e.g. S3AsyncHandler). A derived class passes the responses of the
+   * xxxDone functions to done. The result is only stored by xxxDone and
+   * failed; the coroutine is resumed by completed, i.e. outside of the
+   * handling of the exception of a failed request.
+   */
+  template <typename Handler, typename ConnectionPtr, typename ResponsePtr>
+  class AWSAwaitable : protected Handler
+  {
+    public:
+      typedef std::function<void (Handler*)> StartFunction;
+
+      AWSAwaitable(const ConnectionPtr& aConnection, StartFunction aStart)
+        : theConnection(aConnection),
+          theStart(aStart) {}
+
+      bool
+      await_ready() const noexcept { return false; }
+
+      // doesn't suspend the coroutine if the request couldn't be started
+      bool
+      await_suspend(std::coroutine_handle<> aCoroutine)
+      {
+        theCoroutine = aCoroutine;
+        try {
+          theStart(this);
+        } catch (...) {
+          theException = std::current_exception();
+          return false;
+        }
+        return true;
+      }
+
+      ResponsePtr
+      await_resume()
+      {
+        if (theException)
+          std::rethrow_exception(theException);
+        return theResponse;
+      }
+
+    protected:
+      virtual void
+      failed(const AWSException& aException)
+      {
+        // failed is called while the exception is handled
+        theException = std::current_exception();
+        if (!theException)
+          theException = std::make_exception_ptr(std::runtime_error(aException.what()));
+      }
+
+      // the coroutine may destroy this object, i.e. nothing must be
+      // accessed afterwards
+      virtual void
+      completed() { theCoroutine.resume(); }
+
+      void
+      done(const ResponsePtr& aResponse) { theResponse = aResponse; }
+
+      // a response of another type can't arrive
+      template <typename OtherResponsePtr> void
+      done(const OtherResponsePtr&) {}
+
+      ConnectionPtr           theConnection; // kept alive during the request
+      StartFunction           theStart;
+      std::coroutine_handle<> theCoroutine;
+      ResponsePtr             theResponse;
+      std::exception_ptr      theException;
+  };
+
+} /* namespace aws */
+
+#endif /* C++20 coroutines */
+#endif
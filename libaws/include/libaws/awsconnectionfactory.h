@@ -82,6 +82,40 @@ namespace aws {
     createS3Connection(const std::string& aAccessKeyId,  const std::string& aSecretAccessKey,
                        const std::string& aCustomHost = "") const = 0;
 
+    /*! \brief Retrieve a smart pointer to a aws::S3Presigner instance.
+     *
+     * The createS3Presigner function creates an instance of the aws::S3Presigner class.
+     * Such an instance generates presigned urls for S3 objects without holding a
+     * connection. In contrast to connections, a presigner can be shared among threads.
+     * Like S3 connections, it creates https urls unless aIsSecure is false.
+     *
+     * \throws aws::AWSAccessKeyIdMissingException if the AWS Access Key Id provided as parameter
+     *         is empty.
+     * \throws aws::AWSSecretAccessKeyMissingException if the AWS Secret Access Key provided
+     *         as parameter is empty.
+     *
+     * @return A smart pointer to a aws::S3Presigner instance.
+     */
+    virtual S3PresignerPtr
+    createS3Presigner(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
+                      const std::string& aCustomHost = "", bool aIsSecure = true) const = 0;
+
+    /*! \brief Retrieve a smart pointer to a aws::AWSReactor instance.
+     *
+     * The reactor performs asynchronous requests driven by the event loop
+     * of the application (see aws::AWSReactor).
+     *
+     * @param aSocketFunction Called whenever the events of interest of a socket change.
+     * @param aTimerFunction Called whenever the timeout of the reactor changes.
+     * @param aUserData Passed to both functions.
+     *
+     * @return A smart pointer to a aws::AWSReactor instance.
+     */
+    virtual AWSReactorPtr
+    createReactor(void (*aSocketFunction)(int aSocket, int aEvents, void* aUserData),
+                  void (*aTimerFunction)(long aTimeout, void* aUserData),
+                  void* aUserData) const = 0;
+
     /*! \brief Retrieve a smart pointer to a aws::sqs::SQSConnection instance.
      *
      * The createSQSConnection function creates an instance of the aws::sqs::SQSConnection class.
@@ -137,6 +171,45 @@ namespace aws {
     createSDBConnection(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
                         const std::string& aCustomHost = "") const = 0;
 
+    /*! \brief Retrieve a smart pointer to an empty aws::AWSEndpointSet instance.
+     *
+     * Connections created with an endpoint set route their requests to the
+     * fastest healthy endpoint of the set and fail over to the next one
+     * if an endpoint can't be reached (see aws::AWSEndpointSet).
+     *
+     * @return A smart pointer to a aws::AWSEndpointSet instance.
+     */
+    virtual AWSEndpointSetPtr
+    createEndpointSet() const = 0;
+
+    /*! \brief Retrieve a smart pointer to a aws::s3::S3Connection instance that
+     *         routes its requests over the endpoints of the given set.
+     *
+     * See createS3Connection(const std::string&, const std::string&, const std::string&).
+     */
+    virtual S3ConnectionPtr
+    createS3Connection(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
+                       const AWSEndpointSetPtr& aEndpoints) const = 0;
+
+    /*! \brief Retrieve a smart pointer to a aws::sqs::SQSConnection instance that
+     *         routes its requests over the endpoints of the given set.
+     *
+     * The requests on queue urls are routed, too (i.e. the host of the url is replaced).
+     * See createSQSConnection(const std::string&, const std::string&, const std::string&).
+     */
+    virtual SQSConnectionPtr
+    createSQSConnection(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
+                        const AWSEndpointSetPtr& aEndpoints) const = 0;
+
+    /*! \brief Retrieve a smart pointer to a aws::sdb::SDBConnection instance that
+     *         routes its requests over the endpoints of the given set.
+     *
+     * See createSDBConnection(const std::string&, const std::string&, const std::string&).
+     */
+    virtual SDBConnectionPtr
+    createSDBConnection(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
+                        const AWSEndpointSetPtr& aEndpoints) const = 0;
+
     /*! \brief Release all resources that have been allocated by libaws or any library it uses.
      *
      * This function releases all resources that have been allocated by libaws
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBAWS_AWSENDPOINTSET_API_H
+#define LIBAWS_AWSENDPOINTSET_API_H
+
+#include <string>
+#include <libaws/common.h>
+
+namespace aws {
+
+  /*! \brief A set of endpoints (e.g. replicas or regions) of a service that
+   *         connections route their requests over.
+   *
+   * Connections created with an endpoint set (see
+   * aws::AWSConnectionFactory::createS3Connection) send every request to the
+   * endpoint that is expected to answer first. The latency of every endpoint
+   * is tracked as a moving average of the time to the first byte of its responses.
+   * Endpoints that haven't been measured yet are tried first. Otherwise, the
+   * healthy endpoint with the lowest latency divided by its weight is used.
+   *
+   * An endpoint becomes unhealthy if a request to it fails on the network level.
+   * It is tried again after a second, doubled for every further failure up to a minute.
+   * If a request failed before it was sent (i.e. the endpoint couldn't be resolved or
+   * connected), it is repeated on the next endpoint (failover).
+   *
+   * An endpoint set can be shared by connections of different threads.
+   * The hosts have the format that is passed to the factory otherwise
+   * (e.g. "s3.amazonaws.com" or "http://localhost:8080" for S3).
+   */
+  class AWSEndpointSet : public SmartObject
+  {
+    public:
+      virtual ~AWSEndpointSet() {}
+
+      /*! \brief Adds an endpoint (at most 64).
+       *
+       * Endpoints must be added before the set is passed to the factory.
+       *
+       * @param aHost The host of the endpoint.
+       * @param aWeight Endpoints with a higher weight are preferred if the
+       *                latencies are similar (e.g. 2 for an endpoint that
+       *                may be twice as slow as one of weight 1).
+       */
+      virtual void
+      addEndpoint(const std::string& aHost, unsigned int aWeight = 1) = 0;
+
+      virtual size_t
+      getNumberOfEndpoints() const = 0;
+
+      virtual std::string
+      getHost(size_t aEndpoint) const = 0;
+
+      /*! \brief The average time to the first byte of a response in seconds
+       *         (0 if no request has been answered by the endpoint yet).
+       */
+      virtual double
+      getLatency(size_t aEndpoint) const = 0;
+
+      /*! \brief false if the last request to the endpoint failed on the network level.
+       */
+      virtual bool
+      isHealthy(size_t aEndpoint) const = 0;
+
+      /*! \brief The number of requests that were repeated on another endpoint.
+       */
+      virtual uint64_t
+      getNumberOfFailovers() const = 0;
+
+  }; /* class AWSEndpointSet */
+
+} /* namespace aws */
+#endif
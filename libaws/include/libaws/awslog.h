@@ -0,0 +1,87 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_AWSLOG_API_H
+#define AWS_AWSLOG_API_H
+
+#include <string>
+#include <libaws/common.h>
+
+namespace aws {
+
+  /** \brief AWSLog writes log messages on a background thread.
+   *
+   * A thread that logs a message copies it into a ring buffer of its own
+   * and returns immediately, i.e. it never waits for a lock or for I/O.
+   * A single writer thread empties the ring buffers of all threads and
+   * hands the messages to their sinks (syslog by default). If the ring
+   * buffer of a thread is full, the message is dropped and the number of
+   * dropped messages is written to syslog later on.
+   *
+   * A message that is logged again to the same sink within the suppression
+   * interval is only counted and reported as "last message repeated n times"
+   * (like syslogd does).
+   *
+   * Messages of one thread are written in order. Messages of different
+   * threads may be interleaved differently from the order in which they
+   * were logged.
+   *
+   * Checking the log level before formatting a message is up to the caller,
+   * such that disabled messages cost nothing but a comparison.
+   */
+  class AWSLog
+  {
+    public:
+      /*! \brief Writes a message (called by the writer thread).
+       *
+       * aPriority is the priority the message was logged with (e.g. a
+       * syslog priority) and aUserData the pointer passed to log().
+       */
+      typedef void (*Sink)(int aPriority, const char* aMessage, void* aUserData);
+
+      /*! \brief Queues a message for aSink or syslog if aSink is 0.
+       */
+      static void
+      log(int aPriority, const std::string& aMessage, Sink aSink = 0, void* aUserData = 0);
+
+      /*! \brief Waits until all messages that were logged before are written.
+       */
+      static void
+      flush();
+
+      /*! \brief Sets the interval in which duplicate messages are suppressed.
+       *
+       * The default is 10 seconds. 0 turns suppression off.
+       */
+      static void
+      setSuppressionInterval(unsigned int aSeconds);
+
+      /*! \brief The number of messages that were dropped because the ring
+       *         buffer of the logging thread was full.
+       */
+      static uint64_t
+      getNumberOfDroppedMessages();
+
+      /*! \brief The sink used if none is given (writes to syslog).
+       */
+      static void
+      syslogSink(int aPriority, const char* aMessage, void* aUserData);
+
+    private:
+      AWSLog();
+  }; /* class AWSLog */
+
+} /* namespace aws */
+#endif
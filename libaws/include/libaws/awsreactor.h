@@ -0,0 +1,91 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBAWS_AWSREACTOR_API_H
+#define LIBAWS_AWSREACTOR_API_H
+
+#include <libaws/common.h>
+
+namespace aws {
+
+  /** \brief AWSReactor performs asynchronous requests on behalf of an event
+   *         loop (e.g. epoll) that is owned by the application.
+   *
+   * The reactor tells the application which sockets it is interested in and
+   * when it wants to be woken up through the functions passed to
+   * AWSConnectionFactory::createReactor. The application reports readiness
+   * of these sockets (socketReady) and expired timers (timeout) back. The
+   * completion handlers of the requests are called from within these two
+   * functions, i.e. on the thread of the event loop. The reactor doesn't
+   * create any threads.
+   *
+   * Requests are started with the asynchronous functions of a connection
+   * (e.g. S3Connection::headAsync, SQSConnection::receiveMessageAsync, or
+   * SDBConnection::queryAsync). A connection can only have one request
+   * in flight at a time. A reactor must only be used by one thread.
+   */
+  class AWSReactor : public SmartObject
+  {
+    public:
+      /*! \brief Socket events (can be combined)
+       */
+      enum Events {
+        EVENT_IN     = 1,
+        EVENT_OUT    = 2,
+        EVENT_REMOVE = 4, // the socket is no longer of interest
+        EVENT_ERROR  = 8
+      };
+
+      /*! \brief Called to set the events of interest for a socket.
+       */
+      typedef void (*SocketFunction)(int aSocket, int aEvents, void* aUserData);
+
+      /*! \brief Called to (re)set the single timer of the reactor.
+       *
+       * After aTimeout milliseconds the application must call timeout().
+       * A negative value deletes the timer.
+       */
+      typedef void (*TimerFunction)(long aTimeout, void* aUserData);
+
+      virtual ~AWSReactor() {}
+
+      /*! \brief Reports the events (EVENT_IN, EVENT_OUT, EVENT_ERROR)
+       *         that occured on a socket.
+       */
+      virtual void
+      socketReady(int aSocket, int aEvents) = 0;
+
+      /*! \brief Reports that the timer expired.
+       */
+      virtual void
+      timeout() = 0;
+
+      /*! \brief The number of requests in flight.
+       */
+      virtual unsigned int
+      getNumberOfRequests() const = 0;
+
+      /*! \brief Sets the maximum time a request started afterwards may take.
+       *
+       * A request that takes longer fails with an
+       * aws::AWSConnectionException. 0 (the default) means no limit.
+       */
+      virtual void
+      setTimeout(long aMilliseconds) = 0;
+
+  }; /* class AWSReactor */
+
+} /* namespace aws */
+#endif
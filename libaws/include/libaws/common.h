@@ -33,12 +33,24 @@
 
 namespace aws {
 
+  class AWSReactor;
+  typedef SmartPtr<AWSReactor> AWSReactorPtr;
+
+  class AWSEndpointSet;
+  typedef SmartPtr<AWSEndpointSet> AWSEndpointSetPtr;
+
   /**
    * S3 stuff
    */
   class S3Connection;
   typedef SmartPtr<S3Connection> S3ConnectionPtr;
 
+  class S3Presigner;
+  typedef SmartPtr<S3Presigner> S3PresignerPtr;
+
+  class S3CachedObject;
+  typedef SmartPtr<S3CachedObject> S3CachedObjectPtr;
+
   template <class T> class S3Response;
   typedef SmartPtr<S3Response<class T> > S3ResponsePtr;
 
@@ -63,6 +75,9 @@ namespace aws {
   class DeleteResponse;
   typedef SmartPtr<DeleteResponse> DeleteResponsePtr;
 
+  class CopyResponse;
+  typedef SmartPtr<CopyResponse> CopyResponsePtr;
+
   class DeleteAllResponse;
   typedef SmartPtr<DeleteAllResponse> DeleteAllResponsePtr;
 
@@ -36,6 +36,7 @@ private:
     AWSMutex theConnectionPoolMutex;
     std::string theAccessKeyId;
     std::string theSecretAccessKey;
+    std::string theCustomHost;
     unsigned int theSize;
 
     T createConnection (const std::string& aAccessKeyId,
@@ -43,7 +44,10 @@ private:
 
 public:
 
-    ConnectionPool(unsigned int size, const std::string& accesskeyid, const std::string& secretaccesskey);
+    // the connections are created for aCustomHost (see AWSConnectionFactory)
+    // if it is given
+    ConnectionPool(unsigned int size, const std::string& accesskeyid, const std::string& secretaccesskey,
+                   const std::string& aCustomHost = "");
 
     ~ConnectionPool();
 
@@ -66,6 +66,20 @@ namespace aws {
       std::string theErrorString;
   };
 
+  class AWSFileException : public AWSException
+  {
+    public:
+      AWSFileException(const std::string& aFileName, int aErrno);
+
+      virtual ~AWSFileException() throw();
+
+      virtual const char*
+      what() const throw();
+
+    protected:
+      std::string theErrorString;
+  };
+
   class AWSInitializationException : public AWSException
   {
     public:
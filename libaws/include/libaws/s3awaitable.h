@@ -0,0 +1,128 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBAWS_S3AWAITABLE_API_H
+#define LIBAWS_S3AWAITABLE_API_H
+
+#include <libaws/awsawaitable.h>
+#include <libaws/s3connection.h>
+
+#if __cplusplus >= 202002L
+
+#include <string>
+
+namespace aws {
+
+  /** \brief S3Awaitable is an asynchronous request of a S3Connection that
+   *         can be awaited by a C++20 coroutine.
+   *
+   * Awaiting it starts the request on the reactor (see
+   * S3Connection::headAsync) and suspends the coroutine. The coroutine is
+   * resumed on the thread of the event loop that drives the reactor once
+   * the request is done. co_await then returns the response or throws the
+   * exception the synchronous function would have thrown.
+   *
+   * A request is canceled with S3Connection::cancelAsync and its duration
+   * is limited with AWSReactor::setTimeout; in both cases co_await throws
+   * an aws::AWSConnectionException. The objects are created with
+   * awaitHead, awaitGet, awaitPut and awaitDel:
+   *
+   * \code
+   *   HeadResponsePtr lHead = co_await awaitHead(lReactor, lConnection, "bucket", "key");
+   * \endcode
+   */
+  template <typename ResponsePtr>
+  class S3Awaitable : public AWSAwaitable<S3AsyncHandler, S3ConnectionPtr, ResponsePtr>
+  {
+    public:
+      typedef std::function<void (S3AsyncHandler*)> StartFunction;
+
+      S3Awaitable(const S3ConnectionPtr& aConnection, StartFunction aStart)
+        : AWSAwaitable<S3AsyncHandler, S3ConnectionPtr, ResponsePtr>(aConnection, aStart) {}
+
+    private:
+      virtual void
+      headDone(const HeadResponsePtr& aResponse) { this->done(aResponse); }
+
+      virtual void
+      getDone(const GetResponsePtr& aResponse) { this->done(aResponse); }
+
+      virtual void
+      putDone(const PutResponsePtr& aResponse) { this->done(aResponse); }
+
+      virtual void
+      deleteDone(const DeleteResponsePtr& aResponse) { this->done(aResponse); }
+  };
+
+  /*! \brief Awaitable version of S3Connection::headAsync.
+   */
+  inline S3Awaitable<HeadResponsePtr>
+  awaitHead(AWSReactor* aReactor, const S3ConnectionPtr& aConnection,
+          const std::string& aBucketName, const std::string& aKey)
+  {
+    S3Connection* lConnection = aConnection.get();
+    return S3Awaitable<HeadResponsePtr>(aConnection,
+        [=](S3AsyncHandler* aHandler) {
+          lConnection->headAsync(aReactor, aBucketName, aKey, aHandler);
+        });
+  }
+
+  /*! \brief Awaitable version of S3Connection::getAsync.
+   */
+  inline S3Awaitable<GetResponsePtr>
+  awaitGet(AWSReactor* aReactor, const S3ConnectionPtr& aConnection,
+         const std::string& aBucketName, const std::string& aKey)
+  {
+    S3Connection* lConnection = aConnection.get();
+    return S3Awaitable<GetResponsePtr>(aConnection,
+        [=](S3AsyncHandler* aHandler) {
+          lConnection->getAsync(aReactor, aBucketName, aKey, aHandler);
+        });
+  }
+
+  /*! \brief Awaitable version of S3Connection::putAsync.
+   *
+   * aData isn't copied and must be valid until co_await returns.
+   */
+  inline S3Awaitable<PutResponsePtr>
+  awaitPut(AWSReactor* aReactor, const S3ConnectionPtr& aConnection,
+         const std::string& aBucketName, const std::string& aKey,
+         const char* aData, const std::string& aContentType, long aSize)
+  {
+    S3Connection* lConnection = aConnection.get();
+    return S3Awaitable<PutResponsePtr>(aConnection,
+        [=](S3AsyncHandler* aHandler) {
+          lConnection->putAsync(aReactor, aBucketName, aKey, aData, aContentType,
+                                aSize, aHandler);
+        });
+  }
+
+  /*! \brief Awaitable version of S3Connection::delAsync.
+   */
+  inline S3Awaitable<DeleteResponsePtr>
+  awaitDel(AWSReactor* aReactor, const S3ConnectionPtr& aConnection,
+         const std::string& aBucketName, const std::string& aKey)
+  {
+    S3Connection* lConnection = aConnection.get();
+    return S3Awaitable<DeleteResponsePtr>(aConnection,
+        [=](S3AsyncHandler* aHandler) {
+          lConnection->delAsync(aReactor, aBucketName, aKey, aHandler);
+        });
+  }
+
+} /* namespace aws */
+
+#endif /* C++20 coroutines */
+#endif
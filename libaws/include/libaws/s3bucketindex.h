@@ -0,0 +1,207 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3BUCKETINDEX_API_H
+#define AWS_S3BUCKETINDEX_API_H
+
+#include <pthread.h>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <libaws/common.h>
+#include <libaws/s3response.h>
+
+namespace aws {
+
+  class S3Connection;
+
+  /** \brief S3BucketIndex keeps the listing of a bucket (or of a prefix of it)
+   *         in a local file in order to answer lookups and prefix scans
+   *         without listing the bucket again.
+   *
+   * The index is a sorted file that is memory-mapped. It holds the key, size,
+   * ETag, and last modification time of every object, i.e. the information
+   * returned by aws::S3Connection::listBucket. The file is kept across restarts.
+   *
+   * The keys are partitioned into ranges of about the same number of keys.
+   * A range is listed again by refresh if it was invalidated (e.g. because
+   * an object in it was written or deleted) or if its listing is too old.
+   * Lookups and scans report if they hit a range that is not up to date,
+   * such that callers can fall back to S3.
+   *
+   * All functions of a S3BucketIndex are thread-safe. Each thread must use
+   * its own S3Connection.
+   */
+  class S3BucketIndex
+  {
+    public:
+      typedef ListBucketResponse::Object Object;
+
+      enum LookupResult
+      {
+        UNKNOWN,  //!< the range of the key is not up to date or not indexed
+        MISSING,  //!< the key doesn't exist
+        FOUND     //!< the key exists
+      };
+
+      /*! \brief Opens the index stored in the given file.
+       *
+       * The file is created by the first refresh. If it holds the index of
+       * another bucket or prefix, it is replaced.
+       *
+       * @param aRangeSize The number of keys of a range that is listed at once.
+       */
+      S3BucketIndex(const std::string& aFileName, const std::string& aBucketName,
+                    const std::string& aPrefix = "", size_t aRangeSize = 1000);
+
+      virtual ~S3BucketIndex();
+
+      /*! \brief Lists the ranges that were invalidated or listed more than
+       *         aMaxAge seconds ago (0 lists all ranges).
+       *
+       * Returns immediately if another thread refreshes the index.
+       *
+       * @returns The number of ranges that were listed.
+       *
+       * \throws aws::s3::ListBucketException if the bucket couldn't be listed.
+       * \throws aws::AWSConnectionException if a connection error occured.
+       * \throws aws::AWSFileException if the index file couldn't be written.
+       *         In all cases, the index is left as it was.
+       */
+      size_t
+      refresh(S3Connection* aConnection, time_t aMaxAge = 0);
+
+      /*! \brief Looks up a key (aObject is set if the key was found).
+       */
+      LookupResult
+      lookup(const std::string& aKey, Object& aObject) const;
+
+      /*! \brief Appends the objects whose keys begin with aPrefix to aObjects.
+       *
+       * Like listBucket, keys that contain aDelimiter after the prefix are rolled
+       * up into aCommonPrefixes (if aDelimiter is not empty).
+       *
+       * @returns false if a range of the result is not up to date or the
+       *          prefix is not indexed (the result may be incomplete).
+       */
+      bool
+      list(const std::string& aPrefix, const std::string& aDelimiter,
+           std::vector<Object>& aObjects,
+           std::vector<std::string>* aCommonPrefixes = 0) const;
+
+      /*! \brief Marks the range of the given key as not up to date
+       *         (e.g. after the object was written or deleted).
+       */
+      void
+      invalidate(const std::string& aKey);
+
+      /*! \brief Marks all ranges that hold keys beginning with aPrefix as not up to date.
+       */
+      void
+      invalidatePrefix(const std::string& aPrefix);
+
+      const std::string&
+      getBucketName() const { return theBucketName; }
+
+      const std::string&
+      getPrefix() const { return thePrefix; }
+
+      /*! \brief The number of indexed objects.
+       */
+      size_t
+      getNumberOfObjects() const;
+
+      size_t
+      getNumberOfRanges() const;
+
+      /*! \brief The number of list requests sent by refresh.
+       */
+      uint64_t
+      getNumberOfListRequests() const;
+
+    private:
+      struct StringRef;
+      struct FileHeader;
+      struct RangeRecord;
+      struct ObjectRecord;
+      struct RangeListing;
+
+      void
+      mapFile();
+
+      void
+      unmapFile();
+
+      void
+      write(const std::vector<RangeListing>& aListings);
+
+      std::string
+      getString(const StringRef& aString) const;
+
+      void
+      getObject(size_t aObject, Object& aResult) const;
+
+      static bool
+      isValid(const StringRef& aString, uint64_t aStringsSize);
+
+      static void
+      appendString(std::string& aStrings, const char* aString, size_t aLength,
+                   StringRef& aRef);
+
+      // compares a string of the file with aString like std::string::compare
+      static int
+      compareString(const char* aStrings, const StringRef& aRef, const std::string& aString);
+
+      // the range that holds the given key (which must begin with the prefix)
+      size_t
+      findRange(const std::string& aKey) const;
+
+      // the first object of the range whose key is not less than aKey
+      size_t
+      findObject(size_t aRange, const std::string& aKey) const;
+
+      // invalidate and invalidatePrefix with the mutex held
+      void
+      markStale(const std::string& aKey, bool aIsPrefix);
+
+      // list a range that ends with aUpperBound (inclusive) if aHasUpperBound
+      size_t
+      listRange(S3Connection* aConnection, RangeListing& aListing,
+                bool aHasUpperBound, const std::string& aUpperBound);
+
+      S3BucketIndex(const S3BucketIndex&);
+      S3BucketIndex& operator=(const S3BucketIndex&);
+
+      mutable pthread_mutex_t  theMutex;
+      pthread_mutex_t          theRefreshMutex;
+      std::string              theFileName;
+      std::string              theBucketName;
+      std::string              thePrefix;
+      size_t                   theRangeSize;
+      const char*              theData;     // the mapped file, 0 if there is none
+      size_t                   theDataSize;
+      const FileHeader*        theHeader;
+      const RangeRecord*       theRanges;
+      const ObjectRecord*      theObjects;
+      std::vector<bool>        theStaleRanges;
+      bool                     theIsRefreshing;
+      // keys (false) and prefixes (true) invalidated while refreshing
+      // which are applied to the new ranges
+      std::vector<std::pair<std::string, bool> > theRefreshInvalidations;
+      uint64_t                 theNumberOfListRequests;
+  }; /* class S3BucketIndex */
+
+} /* namespace aws */
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3COALESCER_API_H
+#define AWS_S3COALESCER_API_H
+
+#include <pthread.h>
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <libaws/common.h>
+
+namespace aws {
+
+  class S3Connection;
+
+  /** \brief S3Coalescer merges identical head and get requests that are
+   *         issued concurrently by several threads.
+   *
+   * The first thread that requests an object (the leader) sends the request
+   * on its own connection. All threads that request the same object while
+   * the request is in flight wait for its result instead of sending a request
+   * of their own. They receive the same response object (or the same exception)
+   * as the leader. For gets into a file, the leader's file is copied into
+   * the file of each waiter.
+   *
+   * Requests are identical if the type of request, the bucket, and the key
+   * are equal. Only requests that are in flight at the same time are merged,
+   * i.e. no results are cached.
+   *
+   * All functions of a S3Coalescer are thread-safe. Each thread must use
+   * its own S3Connection.
+   */
+  class S3Coalescer
+  {
+    public:
+      S3Coalescer();
+
+      virtual ~S3Coalescer();
+
+      /*! \brief Same as S3Connection::head but merged with identical
+       *         concurrent requests.
+       */
+      HeadResponsePtr
+      head(S3Connection* aConnection,
+           const std::string& aBucketName,
+           const std::string& aKey);
+
+      /*! \brief Same as S3Connection::tryHead but merged with identical
+       *         concurrent requests.
+       */
+      HeadResponsePtr
+      tryHead(S3Connection* aConnection,
+              const std::string& aBucketName,
+              const std::string& aKey);
+
+      /*! \brief Same as S3Connection::get into a file descriptor but merged
+       *         with identical concurrent requests.
+       *
+       * If the object received by the leader can't be copied into the file
+       * of a waiter, the waiter sends its own request.
+       */
+      GetResponsePtr
+      get(S3Connection* aConnection,
+          const std::string& aBucketName,
+          const std::string& aKey,
+          int aFileDescriptor,
+          off_t aOffset);
+
+      /*! \brief The number of requests that were sent to S3.
+       */
+      uint64_t
+      getNumberOfRequests() const;
+
+      /*! \brief The number of requests that were saved because they were merged
+       *         with an identical request in flight.
+       */
+      uint64_t
+      getNumberOfCoalescedRequests() const;
+
+    private:
+      struct Flight;
+
+      Flight*
+      join(const std::string& aFlightKey, bool& aIsLeader);
+
+      void
+      land(Flight* aFlight);
+
+      void
+      leave(Flight* aFlight);
+
+      S3Coalescer(const S3Coalescer&);
+      S3Coalescer& operator=(const S3Coalescer&);
+
+      mutable pthread_mutex_t          theMutex;
+      pthread_cond_t                   theCondition;
+      std::map<std::string, Flight*>   theFlights;
+      uint64_t                         theNumberOfRequests;
+      uint64_t                         theNumberOfCoalescedRequests;
+  }; /* class S3Coalescer */
+
+} /* namespace aws */
+#endif
@@ -18,15 +18,163 @@
 
 #include <istream>
 #include <map>
+#include <sys/types.h>
+#include <sys/uio.h>
 #include <libaws/common.h>
 
 namespace aws {
 
+  class AWSException;
+  class AWSReactor;
+  class S3BucketIndex;
+  template <class T> class ConnectionPool;
+
+  /** \brief S3AsyncHandler is notified about the completion of an
+   *         asynchronous request of a S3Connection.
+   *
+   * The functions are called on the thread of the event loop that drives
+   * the AWSReactor which performed the request. Exactly one of them is
+   * called per request.
+   */
+  class S3AsyncHandler
+  {
+    public:
+      virtual ~S3AsyncHandler() {}
+
+      virtual void
+      headDone(const HeadResponsePtr& aResponse) {}
+
+      virtual void
+      getDone(const GetResponsePtr& aResponse) {}
+
+      virtual void
+      putDone(const PutResponsePtr& aResponse) {}
+
+      virtual void
+      deleteDone(const DeleteResponsePtr& aResponse) {}
+
+      /*! \brief Called instead of the xxxDone function with the exception
+       *         the synchronous function would have thrown.
+       *
+       * The function is called while aException is handled, i.e. throw;
+       * rethrows it. Anything that shouldn't run inside the handling of the
+       * exception (e.g. resuming a coroutine) belongs to completed.
+       */
+      virtual void
+      failed(const AWSException& aException) = 0;
+
+      /*! \brief Called after the xxxDone or failed function returned.
+       *
+       * It's the last function called for a request, i.e. the handler
+       * may be destroyed by it (see S3Awaitable).
+       */
+      virtual void
+      completed() {}
+  };
+
   class S3Connection : public SmartObject
   {
     public:
+      /*! \brief The way buckets are addressed in request urls
+       *
+       * PATH_STYLE addresses buckets as part of the path (host/bucket/key).
+       * VIRTUAL_HOST_STYLE addresses buckets as part of the host name
+       * (bucket.host/key). Buckets whose names can't be used in a host name
+       * are always addressed path-style.
+       */
+      enum CallingFormatType {
+        PATH_STYLE = 0,
+        VIRTUAL_HOST_STYLE
+      };
+
+      /*! \brief The codec used to compress objects sent by put
+       */
+      enum CompressionType {
+        NO_COMPRESSION = 0,
+        GZIP_COMPRESSION
+      };
+
+      /*! \brief The version of HTTP used for requests
+       *
+       * HTTP_2 is negotiated during the TLS handshake and falls back to
+       * HTTP/1.1 if the server or libcurl don't support it. Connections
+       * using HTTP_2 whose requests are performed by the same AWSReactor
+       * share one TLS connection per host (one stream per request).
+       */
+      enum HttpVersionType {
+        HTTP_1_0 = 0,
+        HTTP_1_1,
+        HTTP_2
+      };
+
       virtual ~S3Connection() {}
 
+      /*! \brief Sets the way buckets are addressed by this connection
+       *
+       * @param aType The calling format used for all buckets which don't
+       *              have their own calling format set.
+       */
+      virtual void
+      setCallingFormat(CallingFormatType aType) = 0;
+
+      /*! \brief Sets the way a particular bucket is addressed by this connection
+       *
+       * @param aBucketName The name of the bucket.
+       * @param aType The calling format used for requests to the given bucket.
+       */
+      virtual void
+      setCallingFormat(const std::string& aBucketName, CallingFormatType aType) = 0;
+
+      /*! \brief Sets the compression of objects sent by this connection
+       *
+       * If compression is enabled, text objects (text/\*, xml, json, and
+       * javascript content types) of at least 1 KB are compressed before
+       * they are sent. The codec and the original size are recorded in
+       * the metadata of the object. Get and head requests of any connection
+       * decompress such objects transparently, i.e. the input stream,
+       * the content length, and the metadata refer to the original object.
+       * Note that the ETag of a compressed object is the ETag of the
+       * compressed data.
+       *
+       * @param aType The codec used for compression (none by default).
+       */
+      virtual void
+      setCompression(CompressionType aType) = 0;
+
+      /*! \brief Sets the version of HTTP used by this connection
+       *
+       * @param aVersion The version of HTTP (HTTP_1_0 by default).
+       */
+      virtual void
+      setHttpVersion(HttpVersionType aVersion) = 0;
+
+      /*! \brief Enables hedging of head and get requests
+       *
+       * If no response of a head or get request arrived within the given
+       * percentile of the latencies measured by this connection (time to the
+       * first byte), the request is sent again on a second connection.
+       * The first request to respond wins and the other one is canceled.
+       * Hedging starts once 16 requests have been measured. Gets into caller
+       * provided buffers or files and asynchronous requests are never hedged.
+       *
+       * @param aPercentile The percentile of the latencies after which a
+       *        request is hedged (e.g. 95). 0 disables hedging (the default).
+       * @param aBudget The maximum number of hedges in percent of the head
+       *        and get requests.
+       */
+      virtual void
+      setHedging(unsigned int aPercentile, unsigned int aBudget = 5) = 0;
+
+      /*! \brief The number of requests that were sent again by hedging.
+       */
+      virtual uint64_t
+      getNumberOfHedgedRequests() const = 0;
+
+      /*! \brief The number of hedges that responded before the original request.
+       */
+      virtual uint64_t
+      getNumberOfHedgeWins() const = 0;
+
       /*! \brief Creates a bucket on S3
        *
        * This function creates a bucket on S3. The name of the bucket to create
@@ -146,6 +294,37 @@ namespace aws {
            const std::map<std::string, std::string>* aMetaDataMap = 0,
            bool aReducedRedunancy = false) = 0;
 
+      /*! \brief Put an object on S3.
+       *
+       * Stores the content of a file on S3. The object is stored in the given bucket using the given key.
+       * The file is mapped into memory (or read with pread if it can't be mapped) such that the
+       * data is sent without being copied into intermediate buffers. The file must not be
+       * truncated while the object is sent.
+       *
+       * @param aBucketName The name of the bucket the object should be stored in.
+       * @param aKey The name of the key the object should be stored with.
+       * @param aFileDescriptor A file descriptor opened for reading.
+       * @param aOffset The offset in the file at which the object starts.
+       * @param aContentType The content type of the object to store.
+       * @param aSize An optional parameter specificying the size of the object.
+       *              If -1 is passed, the object reaches from aOffset to the end of the file.
+       * @param aReducedRedunancy An optional parameter that specifies whether the AWS
+       *        reduced redunancy feature should be used for the object.
+       *
+       * \throws aws::s3::PutException if the object couldn't be stored or if the region
+       *         reaches beyond the end of the file (S3Exception::InvalidArgument).
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      virtual PutResponsePtr
+      put(const std::string& aBucketName,
+          const std::string& aKey,
+          int aFileDescriptor,
+          off_t aOffset,
+          const std::string& aContentType,
+          long aSize = -1,
+          const std::map<std::string, std::string>* aMetaDataMap = 0,
+          bool aReducedRedunancy = false) = 0;
+
       /*! \brief Create a get query string for encoding in a web page.
        *
        * This function creates a query string (URL) that will allow a file
@@ -172,8 +351,9 @@ namespace aws {
        *
        * @param aBucketName The name of the bucket in which the object is stored.
        * @param aKey The key for which the object should be retrieved.
-       * @param aMetaDataMap A map containing additional headers that are sent 
-       *                     with the get requests (e.g. Range:)
+       * @param aMetaDataMap A map containing additional headers that are sent
+       *                     with the get request. The names are prefixed with
+       *                     x-amz-meta-, i.e. HTTP headers like Range can't be passed.
        *
        *
        * \throws aws::s3::GetException if the object coldn't be received.
@@ -204,6 +384,123 @@ namespace aws {
           const std::string& aKey,
           const std::string& aOldEtag) = 0;
 
+      /*! \brief Receive an object from S3 into a buffer.
+       *
+       * This function receives an object from S3 and writes it directly into the given
+       * buffer while it is received. The input stream of the returned response must not be used.
+       * The number of bytes written is the content length of the response.
+       *
+       * @param aBucketName The name of the bucket in which the object is stored.
+       * @param aKey The key for which the object should be retrieved.
+       * @param aBuffer The buffer to write the object to.
+       * @param aBufferSize The size of aBuffer.
+       * @param aMetaDataMap A map containing additional headers that are sent
+       *                     with the get request. The names are prefixed with
+       *                     x-amz-meta-, i.e. HTTP headers like Range can't be passed.
+       *
+       * \throws aws::s3::GetException if the object coldn't be received or
+       *         doesn't fit into the buffer (error code EntityTooLarge).
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      virtual GetResponsePtr
+      get(const std::string& aBucketName,
+          const std::string& aKey,
+          char* aBuffer,
+          size_t aBufferSize,
+          const std::map<std::string, std::string>* aMetaDataMap = 0) = 0;
+
+      /*! \brief Receive an object from S3 into a list of buffers.
+       *
+       * Like the previous function but the object is scattered into the given
+       * buffers in order.
+       *
+       * @param aIovec The buffers to write the object to.
+       * @param aIovecCount The number of buffers in aIovec.
+       */
+      virtual GetResponsePtr
+      get(const std::string& aBucketName,
+          const std::string& aKey,
+          const struct iovec* aIovec,
+          int aIovecCount,
+          const std::map<std::string, std::string>* aMetaDataMap = 0) = 0;
+
+      /*! \brief Receive an object from S3 into a file.
+       *
+       * This function receives an object from S3 and writes it directly into the given
+       * file (using pwrite) while it is received. The input stream of the returned
+       * response must not be used.
+       *
+       * @param aFileDescriptor A file descriptor opened for writing.
+       * @param aOffset The offset in the file at which the object is written.
+       *
+       * \throws aws::s3::GetException if the object coldn't be received or written.
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      virtual GetResponsePtr
+      get(const std::string& aBucketName,
+          const std::string& aKey,
+          int aFileDescriptor,
+          off_t aOffset,
+          const std::map<std::string, std::string>* aMetaDataMap = 0) = 0;
+
+      /*! \brief Copy an object within S3.
+       *
+       * The copy is performed by S3 itself (server-side), i.e. the data of the
+       * object is not transferred through the client.
+       * S3 copies objects of up to 5 GB in one request, larger objects fail
+       * with a CopyException (see multipartCopy).
+       *
+       * @param aSrcBucketName The name of the bucket in which the source object is stored.
+       * @param aSrcKey The key of the source object.
+       * @param aDstBucketName The name of the bucket in which the copy is stored.
+       * @param aDstKey The key of the copy.
+       * @param aMetaDataMap If given, the metadata of the copy is replaced by
+       *        the entries of this map. Otherwise, the metadata of the source
+       *        object is copied.
+       * @param aContentType The content type of the copy. Only used if
+       *        aMetaDataMap is given.
+       *
+       * \throws aws::s3::CopyException if the object coldn't be copied.
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      virtual CopyResponsePtr
+      copy(const std::string& aSrcBucketName,
+           const std::string& aSrcKey,
+           const std::string& aDstBucketName,
+           const std::string& aDstKey,
+           const std::map<std::string, std::string>* aMetaDataMap = 0,
+           const std::string& aContentType = "") = 0;
+
+      /*! \brief Copy an object of any size (e.g. larger than 5 GB) within S3.
+       *
+       * The copy is uploaded in parts, each of which is copied by S3 from a
+       * range of the source object. The parts are copied in parallel on
+       * connections taken from aPool (one per thread, at most 8 threads)
+       * or one after the other on this connection if no pool is given.
+       * The metadata and content type of the source object are copied.
+       * If a part can't be copied, the upload is aborted, i.e. no partial
+       * copy is left behind.
+       *
+       * @param aSrcBucketName The name of the bucket in which the source object is stored.
+       * @param aSrcKey The key of the source object.
+       * @param aDstBucketName The name of the bucket in which the copy is stored.
+       * @param aDstKey The key of the copy.
+       * @param aPool The pool providing the connections of the parallel copies.
+       * @param aPartSize The size of the parts (at least 5 MB). By default,
+       *        the parts are 512 MB, or larger if the object would
+       *        otherwise need more than 10000 parts.
+       *
+       * \throws aws::s3::CopyException if the object coldn't be copied.
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      virtual CopyResponsePtr
+      multipartCopy(const std::string& aSrcBucketName,
+                    const std::string& aSrcKey,
+                    const std::string& aDstBucketName,
+                    const std::string& aDstKey,
+                    ConnectionPool<S3ConnectionPtr>* aPool = 0,
+                    long long aPartSize = 0) = 0;
+
       /*! \brief Delete an object from S3. 
        *
        * This function delete an object in the given bucket with the given key from S3.
@@ -232,10 +529,56 @@ namespace aws {
       deleteAll(const std::string& aBucketName,
               const std::string& aPrefix = "") = 0;
 
+      /*! \brief Delete all objects with the given prefix whose keys are known
+       *         by a local index (see aws::S3BucketIndex) without listing the bucket.
+       *
+       * If the index can't provide an up to date listing of the prefix,
+       * the bucket is listed like above. Afterwards, the deleted keys are
+       * invalidated in the index.
+       *
+       * \throws aws::s3::DeleteException if the object coldn't be deleted.
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      virtual DeleteAllResponsePtr
+      deleteAll(const std::string& aBucketName,
+                const std::string& aPrefix,
+                S3BucketIndex* aIndex) = 0;
+
       virtual HeadResponsePtr
       head(const std::string& aBucketName,
           const std::string& aKey) = 0;
 
+      /*! \brief Variants of head, get, del, and listBucket that don't throw
+       *         if S3 reports an error.
+       *
+       * They are meant for paths where errors are expected, e.g. looking
+       * up keys that usually don't exist. Whether the request succeeded is
+       * reported by isSuccessful() of the response and the error by
+       * getErrorCode() (e.g. aws::S3Exception::NoSuchKey for a missing
+       * key or aws::S3Exception::SlowDown if the request was throttled).
+       *
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      virtual HeadResponsePtr
+      tryHead(const std::string& aBucketName,
+              const std::string& aKey) = 0;
+
+      virtual GetResponsePtr
+      tryGet(const std::string& aBucketName,
+             const std::string& aKey,
+             const std::map<std::string, std::string>* aMetaDataMap = 0) = 0;
+
+      virtual DeleteResponsePtr
+      tryDel(const std::string& aBucketName,
+             const std::string& aKey) = 0;
+
+      virtual ListBucketResponsePtr
+      tryListBucket(const std::string& aBucketName,
+                    const std::string& aPrefix,
+                    const std::string& aMarker,
+                    const std::string& aDelimiter,
+                    int aMaxKeys = -1) = 0;
+
       /*! \brief Retrieve the logging status of the bucket.
        *
        * This function retrieves the logging status of the bucket. It returns
@@ -259,6 +602,73 @@ namespace aws {
       virtual DisableBucketLoggingResponsePtr
       disableBucketLogging(const std::string& aBucketName) = 0;
 
+      /*! \brief Starts a head request that is performed by aReactor.
+       *
+       * The function returns immediately. The result is passed to aHandler
+       * once the request is done. A connection can only perform one request
+       * at a time, i.e. no other function of this connection must be called
+       * before the handler has been notified.
+       *
+       * @param aReactor The reactor which performs the request.
+       * @param aHandler The handler which is notified about the result. It
+       *                 must be valid until its completed function has been
+       *                 called.
+       *
+       * \throws aws::AWSConnectionException if the request couldn't be started.
+       */
+      virtual void
+      headAsync(AWSReactor* aReactor,
+                const std::string& aBucketName,
+                const std::string& aKey,
+                S3AsyncHandler* aHandler) = 0;
+
+      /*! \brief Starts a get request that is performed by aReactor.
+       *
+       * The whole object is received into memory before aHandler is notified,
+       * i.e. reading from the input stream of the response never blocks.
+       *
+       * \see headAsync
+       */
+      virtual void
+      getAsync(AWSReactor* aReactor,
+               const std::string& aBucketName,
+               const std::string& aKey,
+               S3AsyncHandler* aHandler) = 0;
+
+      /*! \brief Starts a put request that is performed by aReactor.
+       *
+       * aData isn't copied and must be valid until aHandler is notified.
+       *
+       * \see headAsync
+       */
+      virtual void
+      putAsync(AWSReactor* aReactor,
+               const std::string& aBucketName,
+               const std::string& aKey,
+               const char* aData,
+               const std::string& aContentType,
+               long aSize,
+               S3AsyncHandler* aHandler) = 0;
+
+      /*! \brief Starts a delete request that is performed by aReactor.
+       *
+       * \see headAsync
+       */
+      virtual void
+      delAsync(AWSReactor* aReactor,
+               const std::string& aBucketName,
+               const std::string& aKey,
+               S3AsyncHandler* aHandler) = 0;
+
+      /*! \brief Cancels the asynchronous request of this connection.
+       *
+       * The handler of the request is notified immediately (i.e. before this
+       * function returns) with an aws::AWSConnectionException. Nothing
+       * happens if no request is in flight.
+       */
+      virtual void
+      cancelAsync() = 0;
+
 
   }; /* class S3Connection */
 
@@ -24,6 +24,7 @@ namespace aws {
     namespace s3 {
       class S3Connection;
       class S3ResponseError;
+      class GzipStreamBuffer;
     }
 
     class S3Exception : public AWSException
@@ -77,7 +78,10 @@ namespace aws {
         TooManyBuckets,
         UnexpectedContent,
         UnresolvableGrantByEmailAddress,
-        NoError
+        NoError,
+        // added later, i.e. after NoError such that the values above are kept
+        SlowDown,
+        ServiceUnavailable
       };
 
       ErrorCode getErrorCode()             { return theErrorCode;    }
@@ -145,6 +149,7 @@ namespace aws {
       virtual ~GetException() throw();
     private:
       friend class s3::S3Connection;
+      friend class s3::GzipStreamBuffer;
       GetException(const s3::S3ResponseError&);
     };
 
@@ -166,6 +171,15 @@ namespace aws {
       HeadException(const s3::S3ResponseError&);
     };
 
+    class CopyException : public S3Exception 
+    {
+    public:
+      virtual ~CopyException() throw();
+    private:
+      friend class s3::S3Connection;
+      CopyException(const s3::S3ResponseError&);
+    };
+
     class DeleteException : public S3Exception 
     {
     public:
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3OBJECTCACHE_API_H
+#define AWS_S3OBJECTCACHE_API_H
+
+#include <pthread.h>
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include <libaws/common.h>
+
+namespace aws {
+
+  class S3Connection;
+
+  /** \brief An object held by a S3ObjectCache.
+   *
+   * Cached objects are read-only and can be shared between threads.
+   */
+  class S3CachedObject : public SmartObject
+  {
+    public:
+      virtual ~S3CachedObject() {}
+
+      /*! \brief The contents of the object.
+       */
+      const std::string&
+      getData() const { return theData; }
+
+      const std::string&
+      getETag() const { return theETag; }
+
+      const std::string&
+      getContentType() const { return theContentType; }
+
+      const std::map<std::string, std::string>&
+      getMetaData() const { return theMetaData; }
+
+    private:
+      friend class S3ObjectCache;
+      S3CachedObject() {}
+
+      std::string                         theData;
+      std::string                         theETag;
+      std::string                         theContentType;
+      std::map<std::string, std::string>  theMetaData;
+  }; /* class S3CachedObject */
+
+  /** \brief S3ObjectCache keeps small objects in memory in order to serve
+   *         repeated gets of the same objects without transferring them again.
+   *
+   * An object is served from the cache without any request until its time
+   * to live expires. Afterwards, it is revalidated with a conditional get
+   * (If-None-Match), i.e. only the headers are transferred if the object
+   * didn't change.
+   *
+   * The cache is bounded by a number of bytes. Entries are evicted in least
+   * recently used order. A new object only displaces other objects if it
+   * was requested more often than the objects it displaces (TinyLFU admission),
+   * such that objects that are read once don't flush the cache.
+   *
+   * All functions of a S3ObjectCache are thread-safe. Each thread must use
+   * its own S3Connection.
+   */
+  class S3ObjectCache
+  {
+    public:
+      /*! \brief Creates a cache.
+       *
+       * @param aCapacity The maximum number of bytes of all cached objects.
+       * @param aTimeToLive The number of seconds an object is served without
+       *        revalidation (0 revalidates on every get).
+       * @param aMaxObjectSize Larger objects are never cached.
+       */
+      S3ObjectCache(size_t aCapacity, time_t aTimeToLive = 0,
+                    size_t aMaxObjectSize = 1024 * 1024);
+
+      virtual ~S3ObjectCache();
+
+      /*! \brief Sets the time to live and the maximum object size
+       *         for the objects of the given bucket.
+       */
+      void
+      setBucketPolicy(const std::string& aBucketName, time_t aTimeToLive,
+                      size_t aMaxObjectSize);
+
+      /*! \brief Returns an object from the cache or from S3.
+       *
+       * \throws aws::s3::GetException if the object couldn't be received.
+       * \throws aws::AWSConnectionException if a connection error occured.
+       */
+      S3CachedObjectPtr
+      get(S3Connection* aConnection, const std::string& aBucketName,
+          const std::string& aKey);
+
+      /*! \brief Removes an object from the cache (e.g. after it was modified).
+       */
+      void
+      invalidate(const std::string& aBucketName, const std::string& aKey);
+
+      /*! \brief The number of gets that were served without any request.
+       */
+      uint64_t
+      getNumberOfHits() const;
+
+      /*! \brief The number of gets that were served after a successful
+       *         revalidation (i.e. without transferring the object).
+       */
+      uint64_t
+      getNumberOfRevalidations() const;
+
+      /*! \brief The number of gets that transferred the object.
+       */
+      uint64_t
+      getNumberOfMisses() const;
+
+      /*! \brief The number of bytes of all cached objects.
+       */
+      size_t
+      getSize() const;
+
+    private:
+      struct Entry;
+
+      struct Policy
+      {
+        time_t theTimeToLive;
+        size_t theMaxObjectSize;
+      };
+
+      const Policy&
+      getPolicy(const std::string& aBucketName) const;
+
+      // frequency sketch used for the admission of new objects
+      void
+      recordAccess(const std::string& aCacheKey);
+
+      unsigned int
+      estimateFrequency(const std::string& aCacheKey) const;
+
+      void
+      insert(const std::string& aCacheKey, const S3CachedObjectPtr& aObject,
+             const Policy& aPolicy);
+
+      void
+      remove(Entry* aEntry);
+
+      S3ObjectCache(const S3ObjectCache&);
+      S3ObjectCache& operator=(const S3ObjectCache&);
+
+      static const unsigned int SKETCH_DEPTH = 4;
+      static const unsigned int SKETCH_WIDTH = 4096;
+
+      mutable pthread_mutex_t          theMutex;
+      size_t                           theCapacity;
+      size_t                           theSize;
+      Policy                           theDefaultPolicy;
+      std::map<std::string, Policy>    theBucketPolicies;
+      std::map<std::string, Entry*>    theEntries;
+      std::list<Entry*>                theLRUList; // most recently used first
+      unsigned char                    theSketch[SKETCH_DEPTH][SKETCH_WIDTH];
+      unsigned int                     theSketchAdditions;
+      uint64_t                         theNumberOfHits;
+      uint64_t                         theNumberOfRevalidations;
+      uint64_t                         theNumberOfMisses;
+  }; /* class S3ObjectCache */
+
+} /* namespace aws */
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3_S3PRESIGNER_API_H
+#define AWS_S3_S3PRESIGNER_API_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <libaws/common.h>
+#include <libaws/s3connection.h>
+
+namespace aws {
+
+  /*! \brief Generates presigned (query string authenticated) GET urls.
+   *
+   * In contrast to aws::S3Connection::getQueryString, a presigner doesn't
+   * hold a connection and computes the signing key state only once.
+   * All const member functions can be called concurrently from several threads
+   * (note that copying the smart pointer to the presigner is not thread safe).
+   */
+  class S3Presigner : public SmartObject
+  {
+    public:
+      virtual ~S3Presigner() {}
+
+      /*! \brief Sets the way buckets are addressed in the generated urls.
+       *
+       * This function must not be called while other threads use the presigner.
+       */
+      virtual void
+      setCallingFormat(S3Connection::CallingFormatType aType) = 0;
+
+      /*! \brief Creates a url that allows to get the given object until aExpiration.
+       *
+       * @param aBucketName The name of the bucket in which the object is stored.
+       * @param aKey The key of the object.
+       * @param aExpiration The time at which the URL expires (seconds since the Epoch)
+       */
+      virtual std::string
+      getQueryString(const std::string& aBucketName,
+                     const std::string& aKey,
+                     time_t aExpiration) const = 0;
+
+      /*! \brief Writes a url that allows to get the given object into a buffer.
+       *
+       * The url is null terminated if it fits into the buffer.
+       *
+       * @param aBuffer The buffer to write the url into.
+       * @param aBufferSize The size of aBuffer.
+       * @returns The length of the url (without the terminating null character).
+       *          If this is not less than aBufferSize, the buffer was too small
+       *          and its content is undefined.
+       */
+      virtual size_t
+      getQueryString(const std::string& aBucketName,
+                     const std::string& aKey,
+                     time_t aExpiration,
+                     char* aBuffer,
+                     size_t aBufferSize) const = 0;
+
+      /*! \brief Creates urls for a batch of objects in the same bucket.
+       *
+       * aUrls is resized to the number of keys. Strings that are already
+       * contained in aUrls are reused to avoid reallocations.
+       */
+      virtual void
+      getQueryStrings(const std::string& aBucketName,
+                      const std::vector<std::string>& aKeys,
+                      time_t aExpiration,
+                      std::vector<std::string>& aUrls) const = 0;
+
+  }; /* class S3Presigner */
+
+} /* namespace aws */
+#endif
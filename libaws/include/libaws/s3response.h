@@ -21,6 +21,7 @@
 #include <string>
 #include <libaws/common.h>
 #include <libaws/awstime.h>
+#include <libaws/s3exception.h>
 
 namespace aws {
 
@@ -35,6 +36,7 @@ namespace aws {
       class HeadResponse;
       class DeleteResponse;
       class DeleteAllResponse;
+      class CopyResponse;
       class BucketLoggingStatusResponse;
       class SetBucketLoggingResponse;
       class DisableBucketLoggingResponse;
@@ -61,6 +63,18 @@ namespace aws {
       virtual const std::string&
       getAmazonId() const;
 
+      /** \brief False if S3 reported an error (only returned by the tryXXX
+       *         functions of S3Connection; the other functions throw).
+       */
+      virtual bool
+      isSuccessful() const;
+
+      virtual S3Exception::ErrorCode
+      getErrorCode() const;
+
+      virtual const std::string&
+      getErrorMessage() const;
+
       virtual T*
       get() const { return theS3Response; }
 
@@ -205,6 +219,9 @@ namespace aws {
       virtual const std::string&
       getBucketName() const;
 
+      // if the object was compressed by put and its data turns out to be
+      // corrupt or truncated, the stream is put into the bad state (reading
+      // through its streambuf directly throws a GetException instead)
       virtual std::istream&
       getInputStream() const;
 
@@ -266,6 +283,32 @@ namespace aws {
       DeleteResponse(s3::DeleteResponse*);
   }; /* class DeleteResponse */
 
+  class CopyResponse  : public S3Response<s3::CopyResponse>
+  {
+    public:
+      virtual ~CopyResponse() {}
+
+      /** \brief The key of the newly created object.
+       */
+      virtual const std::string&
+      getKey() const;
+
+      /** \brief The bucket of the newly created object.
+       */
+      virtual const std::string&
+      getBucketName() const;
+
+      /** \brief The last modification date of the newly created object
+       *         as returned by S3.
+       */
+      virtual const std::string&
+      getLastModified() const;
+
+    private:
+      friend class S3ConnectionImpl;
+      CopyResponse(s3::CopyResponse*);
+  }; /* class CopyResponse */
+
   class DeleteAllResponse  : public S3Response<s3::DeleteAllResponse>
   {
     public:
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBAWS_SDBAWAITABLE_API_H
+#define LIBAWS_SDBAWAITABLE_API_H
+
+#include <libaws/awsawaitable.h>
+#include <libaws/sdbconnection.h>
+
+#if __cplusplus >= 202002L
+
+#include <string>
+#include <vector>
+
+namespace aws {
+
+  /** \brief SDBAwaitable is an asynchronous request of a SDBConnection that
+   *         can be awaited by a C++20 coroutine.
+   *
+   * It works like S3Awaitable on top of SDBConnection::queryAsync etc. A
+   * canceled request throws the exception of the failed request (e.g.
+   * aws::QueryException). The objects are created with
+   * awaitPutAttributes, awaitGetAttributes and awaitQuery:
+   *
+   * \code
+   *   SDBQueryResponsePtr lItems =
+   *     co_await awaitQuery(lReactor, lConnection, "domain", "['a' = 'b']");
+   * \endcode
+   */
+  template <typename ResponsePtr>
+  class SDBAwaitable : public AWSAwaitable<SDBAsyncHandler, SDBConnectionPtr, ResponsePtr>
+  {
+    public:
+      typedef std::function<void (SDBAsyncHandler*)> StartFunction;
+
+      SDBAwaitable(const SDBConnectionPtr& aConnection, StartFunction aStart)
+        : AWSAwaitable<SDBAsyncHandler, SDBConnectionPtr, ResponsePtr>(aConnection, aStart) {}
+
+    private:
+      virtual void
+      putAttributesDone(const PutAttributesResponsePtr& aResponse) { this->done(aResponse); }
+
+      virtual void
+      getAttributesDone(const GetAttributesResponsePtr& aResponse) { this->done(aResponse); }
+
+      virtual void
+      queryDone(const SDBQueryResponsePtr& aResponse) { this->done(aResponse); }
+  };
+
+  /*! \brief Awaitable version of SDBConnection::putAttributesAsync.
+   */
+  inline SDBAwaitable<PutAttributesResponsePtr>
+  awaitPutAttributes(AWSReactor* aReactor, const SDBConnectionPtr& aConnection,
+                     const std::string& aDomainName, const std::string& aItemName,
+                     const std::vector<Attribute>& aAttributes)
+  {
+    SDBConnection* lConnection = aConnection.get();
+    return SDBAwaitable<PutAttributesResponsePtr>(aConnection,
+        [=](SDBAsyncHandler* aHandler) {
+          lConnection->putAttributesAsync(aReactor, aDomainName, aItemName, aAttributes,
+                                          aHandler);
+        });
+  }
+
+  /*! \brief Awaitable version of SDBConnection::getAttributesAsync.
+   */
+  inline SDBAwaitable<GetAttributesResponsePtr>
+  awaitGetAttributes(AWSReactor* aReactor, const SDBConnectionPtr& aConnection,
+                     const std::string& aDomainName, const std::string& aItemName,
+                     const std::string& aAttributeName = "")
+  {
+    SDBConnection* lConnection = aConnection.get();
+    return SDBAwaitable<GetAttributesResponsePtr>(aConnection,
+        [=](SDBAsyncHandler* aHandler) {
+          lConnection->getAttributesAsync(aReactor, aDomainName, aItemName, aHandler,
+                                          aAttributeName);
+        });
+  }
+
+  /*! \brief Awaitable version of SDBConnection::queryAsync.
+   */
+  inline SDBAwaitable<SDBQueryResponsePtr>
+  awaitQuery(AWSReactor* aReactor, const SDBConnectionPtr& aConnection,
+             const std::string& aDomainName, const std::string& aQueryExpression,
+             int aMaxNumberOfItems = 0, const std::string& aNextToken = "")
+  {
+    SDBConnection* lConnection = aConnection.get();
+    return SDBAwaitable<SDBQueryResponsePtr>(aConnection,
+        [=](SDBAsyncHandler* aHandler) {
+          lConnection->queryAsync(aReactor, aDomainName, aQueryExpression, aHandler,
+                                  aMaxNumberOfItems, aNextToken);
+        });
+  }
+
+} /* namespace aws */
+
+#endif /* C++20 coroutines */
+#endif
@@ -23,6 +23,9 @@
 
 namespace aws {
 
+  class AWSException;
+  class AWSReactor;
+
   namespace sdb {
     class SDBConnection;
   }
@@ -70,6 +73,46 @@ namespace aws {
       size() const { return theBatch.size(); }
   };
 
+  /** \brief SDBAsyncHandler is notified about the completion of an
+   *         asynchronous request of a SDBConnection.
+   *
+   * The functions are called on the thread of the event loop that drives
+   * the AWSReactor which performed the request. Exactly one of them is
+   * called per request.
+   */
+  class SDBAsyncHandler
+  {
+    public:
+      virtual ~SDBAsyncHandler() {}
+
+      virtual void
+      putAttributesDone(const PutAttributesResponsePtr& aResponse) {}
+
+      virtual void
+      getAttributesDone(const GetAttributesResponsePtr& aResponse) {}
+
+      virtual void
+      queryDone(const SDBQueryResponsePtr& aResponse) {}
+
+      /*! \brief Called instead of the xxxDone function with the exception
+       *         the synchronous function would have thrown.
+       *
+       * The function is called while aException is handled, i.e. throw;
+       * rethrows it. Anything that shouldn't run inside the handling of the
+       * exception (e.g. resuming a coroutine) belongs to completed.
+       */
+      virtual void
+      failed(const AWSException& aException) = 0;
+
+      /*! \brief Called after the xxxDone or failed function returned.
+       *
+       * It's the last function called for a request, i.e. the handler
+       * may be destroyed by it (see SDBAwaitable).
+       */
+      virtual void
+      completed() {}
+  };
+
 	class SDBConnection: public SmartObject {
 	public:
 		virtual ~SDBConnection() {
@@ -111,6 +154,80 @@ namespace aws {
                         const std::vector<std::string>& aAttributeNames, int aMaxNumberOfItems = 0,
                         const std::string& aNextToken = "") = 0;
 
+    /*! \brief Variants of putAttributes, batchPutAttributes, deleteAttributes,
+     *         getAttributes, and query that don't throw if SimpleDB reports
+     *         an error.
+     *
+     * Whether the request succeeded is reported by isSuccessful() of the
+     * response and the error by getErrorCode() (e.g.
+     * aws::SDBException::ServiceUnavailable if the request was throttled).
+     */
+    virtual PutAttributesResponsePtr
+    tryPutAttributes(const std::string& aDomainName, const std::string& aItemName,
+                     const std::vector<aws::Attribute>& attributes) = 0;
+
+    virtual BatchPutAttributesResponsePtr
+    tryBatchPutAttributes(const std::string& aDomainName, const SDBBatch& aBatch) = 0;
+
+    virtual DeleteAttributesResponsePtr
+    tryDeleteAttributes(const std::string& aDomainName, const std::string& aItemName,
+                        const std::vector<aws::Attribute>& attributes) = 0;
+
+    virtual GetAttributesResponsePtr
+    tryGetAttributes(const std::string& aDomainName, const std::string& aItemName,
+                     const std::string& attributeName = "") = 0;
+
+    virtual SDBQueryResponsePtr
+    tryQuery(const std::string& aDomainName, const std::string& aQueryExpression,
+             int aMaxNumberOfItems = 0, const std::string& aNextToken = "") = 0;
+
+    /*! \brief Starts a put attributes request that is performed by aReactor.
+     *
+     * The function returns immediately. The result is passed to aHandler
+     * once the request is done. A connection can only perform one request
+     * at a time, i.e. no other function of this connection must be called
+     * before the handler has been notified.
+     *
+     * @param aReactor The reactor which performs the request.
+     * @param aHandler The handler which is notified about the result. It
+     *                 must be valid until its completed function has been
+     *                 called.
+     */
+    virtual void
+    putAttributesAsync(AWSReactor* aReactor,
+                       const std::string& aDomainName, const std::string& aItemName,
+                       const std::vector<aws::Attribute>& attributes,
+                       SDBAsyncHandler* aHandler) = 0;
+
+    /*! \brief Starts a get attributes request that is performed by aReactor.
+     *
+     * \see putAttributesAsync
+     */
+    virtual void
+    getAttributesAsync(AWSReactor* aReactor,
+                       const std::string& aDomainName, const std::string& aItemName,
+                       SDBAsyncHandler* aHandler,
+                       const std::string& attributeName = "") = 0;
+
+    /*! \brief Starts a query request that is performed by aReactor.
+     *
+     * \see putAttributesAsync
+     */
+    virtual void
+    queryAsync(AWSReactor* aReactor,
+               const std::string& aDomainName, const std::string& aQueryExpression,
+               SDBAsyncHandler* aHandler,
+               int aMaxNumberOfItems = 0, const std::string& aNextToken = "") = 0;
+
+    /*! \brief Cancels the asynchronous request of this connection.
+     *
+     * The handler of the request is notified immediately (i.e. before this
+     * function returns) with the exception of the failed request. Nothing
+     * happens if no request is in flight.
+     */
+    virtual void
+    cancelAsync() = 0;
+
 	};
 
 }
@@ -90,7 +90,10 @@ namespace aws {
       ReadCountOutOfRange,
 
       //Unknown
-      Unknown
+      Unknown,
+
+      // reported by the responses of the non-throwing functions on success
+      NoError
 
     };
 
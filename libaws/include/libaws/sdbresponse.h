@@ -20,6 +20,7 @@
 #include <map>
 #include <string>
 #include <libaws/common.h>
+#include <libaws/sdbexception.h>
 
 namespace aws {
 
@@ -49,6 +50,13 @@ namespace aws {
     virtual double getKBOutTransfer() const = 0;
     virtual double getKBInTransfer() const = 0;
 
+    /** \brief False if SimpleDB reported an error (only returned by the
+     *         tryXXX functions of SDBConnection; the other functions throw).
+     */
+    virtual bool isSuccessful() const = 0;
+    virtual SDBException::ErrorCode getErrorCode() const = 0;
+    virtual const std::string& getErrorMessage() const = 0;
+
 	};
 
 	template<class T>
@@ -63,6 +71,10 @@ namespace aws {
     
     virtual double getKBOutTransfer() const;
     virtual double getKBInTransfer() const;
+
+    virtual bool isSuccessful() const;
+    virtual SDBException::ErrorCode getErrorCode() const;
+    virtual const std::string& getErrorMessage() const;
     
     virtual T*
     get() const { return theSDBResponse; }
@@ -36,12 +36,23 @@ public:
 
   long getRefCount() const { return theRefCount; }
 
+  // the reference count is changed atomically such that responses
+  // can be shared between threads (e.g. by a S3Coalescer)
+#ifdef __GNUC__
+  void addReference() const { __sync_add_and_fetch(&theRefCount, 1); }
+
+  void removeReference () {
+    if (__sync_sub_and_fetch(&theRefCount, 1) == 0)
+      free();
+  }
+#else
   void addReference() const { ++theRefCount; }
 
   void removeReference () {
     if (--theRefCount == 0) 
       free();
   }
+#endif
 
 	SmartObject& operator=(const SmartObject&) { return *this; }
 }; /* class SmartObject */
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBAWS_SQSAWAITABLE_API_H
+#define LIBAWS_SQSAWAITABLE_API_H
+
+#include <libaws/awsawaitable.h>
+#include <libaws/sqsconnection.h>
+
+#if __cplusplus >= 202002L
+
+#include <string>
+
+namespace aws {
+
+  /** \brief SQSAwaitable is an asynchronous request of a SQSConnection that
+   *         can be awaited by a C++20 coroutine.
+   *
+   * It works like S3Awaitable on top of SQSConnection::receiveMessageAsync
+   * etc. A canceled request throws the exception of the failed request
+   * (e.g. aws::ReceiveMessageException). The objects are created with
+   * awaitSendMessage, awaitReceiveMessage and awaitDeleteMessage:
+   *
+   * \code
+   *   ReceiveMessageResponsePtr lMessages =
+   *     co_await awaitReceiveMessage(lReactor, lConnection, lQueueUrl, 10);
+   * \endcode
+   */
+  template <typename ResponsePtr>
+  class SQSAwaitable : public AWSAwaitable<SQSAsyncHandler, SQSConnectionPtr, ResponsePtr>
+  {
+    public:
+      typedef std::function<void (SQSAsyncHandler*)> StartFunction;
+
+      SQSAwaitable(const SQSConnectionPtr& aConnection, StartFunction aStart)
+        : AWSAwaitable<SQSAsyncHandler, SQSConnectionPtr, ResponsePtr>(aConnection, aStart) {}
+
+    private:
+      virtual void
+      sendMessageDone(const SendMessageResponsePtr& aResponse) { this->done(aResponse); }
+
+      virtual void
+      receiveMessageDone(const ReceiveMessageResponsePtr& aResponse) { this->done(aResponse); }
+
+      virtual void
+      deleteMessageDone(const DeleteMessageResponsePtr& aResponse) { this->done(aResponse); }
+  };
+
+  /*! \brief Awaitable version of SQSConnection::sendMessageAsync.
+   */
+  inline SQSAwaitable<SendMessageResponsePtr>
+  awaitSendMessage(AWSReactor* aReactor, const SQSConnectionPtr& aConnection,
+                   const std::string& aQueueUrl, const std::string& aMessageBody,
+                   bool aEncodeToBase64 = true)
+  {
+    SQSConnection* lConnection = aConnection.get();
+    return SQSAwaitable<SendMessageResponsePtr>(aConnection,
+        [=](SQSAsyncHandler* aHandler) {
+          lConnection->sendMessageAsync(aReactor, aQueueUrl, aMessageBody, aHandler,
+                                        aEncodeToBase64);
+        });
+  }
+
+  /*! \brief Awaitable version of SQSConnection::receiveMessageAsync.
+   */
+  inline SQSAwaitable<ReceiveMessageResponsePtr>
+  awaitReceiveMessage(AWSReactor* aReactor, const SQSConnectionPtr& aConnection,
+                      const std::string& aQueueUrl, int aNumberOfMessages = 0,
+                      int aVisibilityTimeout = -1, bool aDecodeFromBase64 = true)
+  {
+    SQSConnection* lConnection = aConnection.get();
+    return SQSAwaitable<ReceiveMessageResponsePtr>(aConnection,
+        [=](SQSAsyncHandler* aHandler) {
+          lConnection->receiveMessageAsync(aReactor, aQueueUrl, aHandler, aNumberOfMessages,
+                                           aVisibilityTimeout, aDecodeFromBase64);
+        });
+  }
+
+  /*! \brief Awaitable version of SQSConnection::deleteMessageAsync.
+   */
+  inline SQSAwaitable<DeleteMessageResponsePtr>
+  awaitDeleteMessage(AWSReactor* aReactor, const SQSConnectionPtr& aConnection,
+                     const std::string& aQueueUrl, const std::string& aReceiptHandle)
+  {
+    SQSConnection* lConnection = aConnection.get();
+    return SQSAwaitable<DeleteMessageResponsePtr>(aConnection,
+        [=](SQSAsyncHandler* aHandler) {
+          lConnection->deleteMessageAsync(aReactor, aQueueUrl, aReceiptHandle, aHandler);
+        });
+  }
+
+} /* namespace aws */
+
+#endif /* C++20 coroutines */
+#endif
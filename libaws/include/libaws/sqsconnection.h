@@ -22,6 +22,49 @@
 
 namespace aws {
 
+  class AWSException;
+  class AWSReactor;
+
+  /** \brief SQSAsyncHandler is notified about the completion of an
+   *         asynchronous request of a SQSConnection.
+   *
+   * The functions are called on the thread of the event loop that drives
+   * the AWSReactor which performed the request. Exactly one of them is
+   * called per request.
+   */
+  class SQSAsyncHandler
+  {
+    public:
+      virtual ~SQSAsyncHandler() {}
+
+      virtual void
+      sendMessageDone(const SendMessageResponsePtr& aResponse) {}
+
+      virtual void
+      receiveMessageDone(const ReceiveMessageResponsePtr& aResponse) {}
+
+      virtual void
+      deleteMessageDone(const DeleteMessageResponsePtr& aResponse) {}
+
+      /*! \brief Called instead of the xxxDone function with the exception
+       *         the synchronous function would have thrown.
+       *
+       * The function is called while aException is handled, i.e. throw;
+       * rethrows it. Anything that shouldn't run inside the handling of the
+       * exception (e.g. resuming a coroutine) belongs to completed.
+       */
+      virtual void
+      failed(const AWSException& aException) = 0;
+
+      /*! \brief Called after the xxxDone or failed function returned.
+       *
+       * It's the last function called for a request, i.e. the handler
+       * may be destroyed by it (see SQSAwaitable).
+       */
+      virtual void
+      completed() {}
+  };
+
   class SQSConnection : public SmartObject
   {
     public:
@@ -50,9 +93,86 @@ namespace aws {
       virtual DeleteMessageResponsePtr
       deleteMessage(const std::string &aQueueUrl, const std::string &aReceiptHandle) = 0;
 
+      /*! \brief Variants of sendMessage, receiveMessage, and deleteMessage
+       *         that don't throw if SQS reports an error.
+       *
+       * They are meant for producers and consumers that back off if the
+       * service is overloaded. Whether the request succeeded is reported by
+       * isSuccessful() of the response and the error by getErrorCode()
+       * (e.g. aws::SQSException::RequestThrottled or
+       * aws::SQSException::ServiceUnavailable if the request was throttled).
+       *
+       * \throws aws::SendMessageException if the message is larger than 32kB.
+       */
+      virtual SendMessageResponsePtr
+      trySendMessage(const std::string &aQueueUrl,
+                     const std::string &aMessageBody,
+                     bool aEncodeToBase64 = true) = 0;
+
+      virtual ReceiveMessageResponsePtr
+      tryReceiveMessage(const std::string &aQueueUrl,
+                        int aNumberOfMessages = 0,
+                        int aVisibilityTimeout = -1,
+                        bool aDecodeFromBase64 = true) = 0;
+
+      virtual DeleteMessageResponsePtr
+      tryDeleteMessage(const std::string &aQueueUrl, const std::string &aReceiptHandle) = 0;
+
       virtual GetQueueAttributesResponsePtr
       getQueueAttributes(const std::string &aQueueUrl, const std::string &aAttributeName) = 0;
 
+      /*! \brief Starts a send message request that is performed by aReactor.
+       *
+       * The function returns immediately. The result is passed to aHandler
+       * once the request is done. A connection can only perform one request
+       * at a time, i.e. no other function of this connection must be called
+       * before the handler has been notified.
+       *
+       * @param aReactor The reactor which performs the request.
+       * @param aHandler The handler which is notified about the result. It
+       *                 must be valid until its completed function has been
+       *                 called.
+       *
+       * \throws aws::SendMessageException if the message is larger than 32kB.
+       */
+      virtual void
+      sendMessageAsync(AWSReactor* aReactor,
+                       const std::string &aQueueUrl,
+                       const std::string &aMessageBody,
+                       SQSAsyncHandler* aHandler,
+                       bool aEncodeToBase64 = true) = 0;
+
+      /*! \brief Starts a receive message request that is performed by aReactor.
+       *
+       * \see sendMessageAsync
+       */
+      virtual void
+      receiveMessageAsync(AWSReactor* aReactor,
+                          const std::string &aQueueUrl,
+                          SQSAsyncHandler* aHandler,
+                          int aNumberOfMessages = 0,
+                          int aVisibilityTimeout = -1,
+                          bool aDecodeFromBase64 = true) = 0;
+
+      /*! \brief Starts a delete message request that is performed by aReactor.
+       *
+       * \see sendMessageAsync
+       */
+      virtual void
+      deleteMessageAsync(AWSReactor* aReactor,
+                         const std::string &aQueueUrl,
+                         const std::string &aReceiptHandle,
+                         SQSAsyncHandler* aHandler) = 0;
+
+      /*! \brief Cancels the asynchronous request of this connection.
+       *
+       * The handler of the request is notified immediately (i.e. before this
+       * function returns) with the exception of the failed request. Nothing
+       * happens if no request is in flight.
+       */
+      virtual void
+      cancelAsync() = 0;
+
   }; /* class SQSConnection */
 
 } /* namespace aws */
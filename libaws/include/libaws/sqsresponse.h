@@ -20,6 +20,7 @@
 #include <map>
 #include <string>
 #include <libaws/common.h>
+#include <libaws/sqsexception.h>
 
 namespace aws {
 
@@ -47,6 +48,18 @@ namespace aws {
       
       virtual double getKBInTransfer() const;
 
+      /** \brief False if SQS reported an error (only returned by the tryXXX
+       *         functions of SQSConnection; the other functions throw).
+       */
+      virtual bool
+      isSuccessful() const;
+
+      virtual SQSException::ErrorCode
+      getErrorCode() const;
+
+      virtual const std::string&
+      getErrorMessage() const;
+
       virtual T*
       get() const { return theSQSResponse; }
 
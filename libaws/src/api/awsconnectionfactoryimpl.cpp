@@ -22,17 +22,41 @@
 
 #include <libaws/exception.h>
 #include <libaws/awsversion.h>
+#include <libaws/mutex.h>
 
+#include "awsconnection.h"
 #include "api/awsconnectionfactoryimpl.h"
 #include "api/s3connectionimpl.h"
+#include "api/s3presignerimpl.h"
+#include "api/awsreactorimpl.h"
+#include "api/awsendpointsetimpl.h"
 #include "api/sqsconnectionimpl.h"
 #include "api/sdbconnectionimpl.h"
+#include "s3/s3connection.h"
+#include "sqs/sqsconnection.h"
+#include "sdb/sdbconnection.h"
 
 namespace aws {
 
+  // lock callbacks for the curl share handle
+  // aUserPtr is the array of mutexes owned by the factory
+  static void
+  lockShareData ( CURL* aCurl, curl_lock_data aData, curl_lock_access aAccess, void* aUserPtr )
+  {
+    static_cast<AWSMutex*> ( aUserPtr ) [aData].lock();
+  }
+
+  static void
+  unlockShareData ( CURL* aCurl, curl_lock_data aData, void* aUserPtr )
+  {
+    static_cast<AWSMutex*> ( aUserPtr ) [aData].unlock();
+  }
+
   AWSConnectionFactoryImpl::AWSConnectionFactoryImpl()
       : theIsInitialized ( false ),
-      theInitializationFailed ( false )
+      theInitializationFailed ( false ),
+      theShareHandle ( 0 ),
+      theShareMutexes ( 0 )
   { }
 
   void
@@ -60,6 +84,25 @@ namespace aws {
     return new S3ConnectionImpl ( aAccessKeyId, aSecretAccessKey, aCustomHost );
   }
 
+  S3PresignerPtr
+  AWSConnectionFactoryImpl::createS3Presigner ( const std::string& aAccessKeyId,
+      const std::string& aSecretAccessKey,
+      const std::string& aCustomHost,
+      bool aIsSecure ) const
+  {
+    checkParameters ( aAccessKeyId, aSecretAccessKey );
+
+    return new S3PresignerImpl ( aAccessKeyId, aSecretAccessKey, aCustomHost, aIsSecure );
+  }
+
+  AWSReactorPtr
+  AWSConnectionFactoryImpl::createReactor ( void (*aSocketFunction)(int, int, void*),
+      void (*aTimerFunction)(long, void*),
+      void* aUserData ) const
+  {
+    return new AWSReactorImpl ( aSocketFunction, aTimerFunction, aUserData );
+  }
+
   SQSConnectionPtr
   AWSConnectionFactoryImpl::createSQSConnection ( const std::string &aAccessKeyId,
       const std::string &aSecretAccessKey,
@@ -89,6 +132,64 @@ namespace aws {
     return new SDBConnectionImpl ( aAccessKeyId, aSecretAccessKey, aCustomHost );
   }
 
+  // connections are created for the first endpoint and routed from then on
+  static std::string
+  getFirstHost ( const AWSEndpointSetPtr& aEndpoints )
+  {
+    return aEndpoints->getNumberOfEndpoints() > 0 ? aEndpoints->getHost ( 0 ) : "";
+  }
+
+  static EndpointSet*
+  getEndpointSet ( const AWSEndpointSetPtr& aEndpoints )
+  {
+    return static_cast<AWSEndpointSetImpl*> ( aEndpoints.get() )->getEndpointSet();
+  }
+
+  AWSEndpointSetPtr
+  AWSConnectionFactoryImpl::createEndpointSet() const
+  {
+    return new AWSEndpointSetImpl();
+  }
+
+  S3ConnectionPtr
+  AWSConnectionFactoryImpl::createS3Connection ( const std::string& aAccessKeyId,
+      const std::string& aSecretAccessKey,
+      const AWSEndpointSetPtr& aEndpoints ) const
+  {
+    checkParameters ( aAccessKeyId, aSecretAccessKey );
+
+    S3ConnectionImpl* lConnection =
+      new S3ConnectionImpl ( aAccessKeyId, aSecretAccessKey, getFirstHost ( aEndpoints ) );
+    lConnection->theConnection->setEndpoints ( getEndpointSet ( aEndpoints ) );
+    return lConnection;
+  }
+
+  SQSConnectionPtr
+  AWSConnectionFactoryImpl::createSQSConnection ( const std::string &aAccessKeyId,
+      const std::string &aSecretAccessKey,
+      const AWSEndpointSetPtr& aEndpoints ) const
+  {
+    checkParameters ( aAccessKeyId, aSecretAccessKey );
+
+    SQSConnectionImpl* lConnection =
+      new SQSConnectionImpl ( aAccessKeyId, aSecretAccessKey, getFirstHost ( aEndpoints ) );
+    lConnection->theConnection->setEndpoints ( getEndpointSet ( aEndpoints ) );
+    return lConnection;
+  }
+
+  SDBConnectionPtr
+  AWSConnectionFactoryImpl::createSDBConnection ( const std::string &aAccessKeyId,
+      const std::string &aSecretAccessKey,
+      const AWSEndpointSetPtr& aEndpoints ) const
+  {
+    checkParameters ( aAccessKeyId, aSecretAccessKey );
+
+    SDBConnectionImpl* lConnection =
+      new SDBConnectionImpl ( aAccessKeyId, aSecretAccessKey, getFirstHost ( aEndpoints ) );
+    lConnection->theConnection->setEndpoints ( getEndpointSet ( aEndpoints ) );
+    return lConnection;
+  }
+
   AWSConnectionFactoryImpl::~AWSConnectionFactoryImpl()
   {
     if ( theIsInitialized )
@@ -98,6 +199,17 @@ namespace aws {
   void
   AWSConnectionFactoryImpl::shutdown()
   {
+    if ( theShareHandle ) {
+      AWSConnection::setShareHandle ( 0 );
+      // connections that are still alive keep using the share handle
+      // in this case, we leak it rather than pulling it from under them
+      if ( curl_share_cleanup ( theShareHandle ) == CURLSHE_OK ) {
+        delete[] theShareMutexes;
+      }
+      theShareHandle = 0;
+      theShareMutexes = 0;
+    }
+
     if ( !theInitializationFailed ) {
       xmlCleanupParser();
       curl_global_cleanup();
@@ -129,6 +241,22 @@ namespace aws {
     // initialize the libxml2 library and perform version check
     LIBXML_TEST_VERSION
 
+    // share the dns cache and ssl sessions between all connections
+    // such that a fresh connection from the pool neither has to resolve
+    // the host again nor do a full ssl handshake
+    // the connection cache is not shared because connections are
+    // used concurrently from several threads (which libcurl doesn't support)
+    theShareHandle = curl_share_init();
+    if ( theShareHandle ) {
+      theShareMutexes = new AWSMutex[CURL_LOCK_DATA_LAST];
+      curl_share_setopt ( theShareHandle, CURLSHOPT_LOCKFUNC, lockShareData );
+      curl_share_setopt ( theShareHandle, CURLSHOPT_UNLOCKFUNC, unlockShareData );
+      curl_share_setopt ( theShareHandle, CURLSHOPT_USERDATA, theShareMutexes );
+      curl_share_setopt ( theShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+      curl_share_setopt ( theShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+      AWSConnection::setShareHandle ( theShareHandle );
+    }
+
     theIsInitialized = true;
   }
 
@@ -19,8 +19,12 @@
 #include "common.h"
 #include <libaws/awsconnectionfactory.h>
 
+typedef void CURLSH;
+
 namespace aws {
 
+  class AWSMutex;
+
   class AWSConnectionFactoryImpl : public AWSConnectionFactory {
     
     friend class AWSConnectionFactory;
@@ -42,6 +46,17 @@ namespace aws {
                          const std::string& aSecretAccessKey,
                          const std::string& aCustomHost) const;
 
+      virtual S3PresignerPtr
+      createS3Presigner(const std::string& aAccessKeyId,
+                        const std::string& aSecretAccessKey,
+                        const std::string& aCustomHost,
+                        bool aIsSecure) const;
+
+      virtual AWSReactorPtr
+      createReactor(void (*aSocketFunction)(int aSocket, int aEvents, void* aUserData),
+                    void (*aTimerFunction)(long aTimeout, void* aUserData),
+                    void* aUserData) const;
+
       virtual SQSConnectionPtr
       createSQSConnection(const std::string& aAccessKeyId,
                           const std::string& aSecretAccessKey,
@@ -58,6 +73,24 @@ namespace aws {
                           const std::string& aSecretAccessKey,
                           const std::string& aCustomHost) const;
 
+      virtual AWSEndpointSetPtr
+      createEndpointSet() const;
+
+      virtual S3ConnectionPtr
+      createS3Connection(const std::string& aAccessKeyId,
+                         const std::string& aSecretAccessKey,
+                         const AWSEndpointSetPtr& aEndpoints) const;
+
+      virtual SQSConnectionPtr
+      createSQSConnection(const std::string& aAccessKeyId,
+                          const std::string& aSecretAccessKey,
+                          const AWSEndpointSetPtr& aEndpoints) const;
+
+      virtual SDBConnectionPtr
+      createSDBConnection(const std::string& aAccessKeyId,
+                          const std::string& aSecretAccessKey,
+                          const AWSEndpointSetPtr& aEndpoints) const;
+
       virtual void
       shutdown();
 
@@ -77,6 +110,13 @@ namespace aws {
       // error messages reported during initializing libcurl
       std::string theInitializationErrorMessage;
 
+      // curl share handle all connections attach to in order to
+      // share the dns cache and ssl sessions (created in init)
+      CURLSH* theShareHandle;
+
+      // one mutex for each kind of data that is shared through theShareHandle
+      AWSMutex* theShareMutexes;
+
   }; /* class AWSConnectionFactoryImpl */
 
 } /* namespace aws */
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common.h"
+
+#include "api/awsendpointsetimpl.h"
+
+namespace aws {
+
+  AWSEndpointSetImpl::AWSEndpointSetImpl()
+    : theEndpointSet(new EndpointSet())
+  {
+  }
+
+  AWSEndpointSetImpl::~AWSEndpointSetImpl()
+  {
+  }
+
+  void
+  AWSEndpointSetImpl::addEndpoint(const std::string& aHost, unsigned int aWeight)
+  {
+    theEndpointSet->addEndpoint(aHost, aWeight);
+  }
+
+  size_t
+  AWSEndpointSetImpl::getNumberOfEndpoints() const
+  {
+    return theEndpointSet->getNumberOfEndpoints();
+  }
+
+  std::string
+  AWSEndpointSetImpl::getHost(size_t aEndpoint) const
+  {
+    return theEndpointSet->getHost(aEndpoint);
+  }
+
+  double
+  AWSEndpointSetImpl::getLatency(size_t aEndpoint) const
+  {
+    return theEndpointSet->getLatency(aEndpoint);
+  }
+
+  bool
+  AWSEndpointSetImpl::isHealthy(size_t aEndpoint) const
+  {
+    return theEndpointSet->isHealthy(aEndpoint);
+  }
+
+  uint64_t
+  AWSEndpointSetImpl::getNumberOfFailovers() const
+  {
+    return theEndpointSet->getNumberOfFailovers();
+  }
+
+} /* namespace aws */
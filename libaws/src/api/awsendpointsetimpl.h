@@ -0,0 +1,62 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_AWSENDPOINTSETIMPL_H
+#define AWS_AWSENDPOINTSETIMPL_H
+
+#include "common.h"
+#include <libaws/awsendpointset.h>
+
+#include "endpointset.h"
+
+namespace aws {
+
+  class AWSEndpointSetImpl : public AWSEndpointSet
+  {
+    public:
+      virtual ~AWSEndpointSetImpl();
+
+      virtual void
+      addEndpoint(const std::string& aHost, unsigned int aWeight = 1);
+
+      virtual size_t
+      getNumberOfEndpoints() const;
+
+      virtual std::string
+      getHost(size_t aEndpoint) const;
+
+      virtual double
+      getLatency(size_t aEndpoint) const;
+
+      virtual bool
+      isHealthy(size_t aEndpoint) const;
+
+      virtual uint64_t
+      getNumberOfFailovers() const;
+
+      // the set connections route their requests over
+      EndpointSet*
+      getEndpointSet() const { return theEndpointSet.get(); }
+
+    protected:
+      // only the factory can create us
+      friend class AWSConnectionFactoryImpl;
+      AWSEndpointSetImpl();
+
+      SmartPtr<EndpointSet> theEndpointSet;
+  }; /* class AWSEndpointSetImpl */
+
+} /* namespace aws */
+#endif
@@ -0,0 +1,439 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common.h"
+
+#include <libaws/awslog.h>
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <vector>
+
+namespace aws {
+
+  namespace {
+
+    // a message in the ring buffer of a thread; messages that don't fit
+    // into the record are copied to the heap
+    struct LogRecord
+    {
+      static const size_t INLINE_SIZE = 480;
+
+      AWSLog::Sink  theSink;
+      void*         theUserData;
+      int           thePriority;
+      char*         theLongMessage;
+      char          theMessage[INLINE_SIZE];
+    };
+
+    // the ring buffer of a thread: the thread is the only producer,
+    // the writer thread the only consumer
+    struct LogRing
+    {
+      static const unsigned int SIZE = 128; // power of two
+
+      LogRing() : theHead(0), theTail(0), theIsOrphaned(false) {}
+
+      volatile unsigned int theHead;       // next record to write
+      volatile unsigned int theTail;       // next record to read
+      volatile bool         theIsOrphaned; // the thread has exited
+      LogRecord             theRecords[SIZE];
+    };
+
+    class LogWriter
+    {
+      public:
+        static LogWriter*
+        instance()
+        {
+          static LogWriter theInstance;
+          return &theInstance;
+        }
+
+        // the ring buffer of the calling thread
+        LogRing*
+        getRing();
+
+        void
+        wakeUp() { pthread_cond_signal(&theWakeUp); }
+
+        void
+        flush();
+
+        volatile unsigned int theSuppressionInterval;
+        volatile uint64_t     theDropped;
+
+      private:
+        LogWriter();
+
+        void
+        start();
+
+        void
+        run();
+
+        // writes all records of the rings; returns the orphaned rings that
+        // were emptied
+        void
+        drain(const std::vector<LogRing*>& aRings, std::vector<LogRing*>& aEmptied);
+
+        void
+        write(LogRecord& aRecord, time_t aNow);
+
+        void
+        reportRepeated();
+
+        static void*
+        runThread(void* aWriter);
+
+        static void
+        releaseRing(void* aRing);
+
+        static void
+        stopAtExit();
+
+        static void
+        childAfterFork();
+
+        pthread_key_t           theKey;
+        pthread_mutex_t         theMutex; // protects all members below
+        pthread_cond_t          theWakeUp;
+        pthread_cond_t          theFlushed;
+        pthread_t               theThread;
+        volatile bool           theIsRunning;
+        bool                    theStop;
+        bool                    theHooksInstalled;
+        std::vector<LogRing*>   theRings;
+        unsigned long           theFlushRequests;
+        unsigned long           theFlushesDone;
+
+        // duplicate suppression (only used by the writer thread)
+        std::string             theLastMessage;
+        AWSLog::Sink            theLastSink;
+        void*                   theLastUserData;
+        int                     theLastPriority;
+        time_t                  theLastTime;
+        unsigned int            theRepeated;
+        uint64_t                theReportedDrops;
+    };
+
+    LogWriter::LogWriter()
+      : theSuppressionInterval(10),
+        theDropped(0),
+        theIsRunning(false),
+        theStop(false),
+        theHooksInstalled(false),
+        theFlushRequests(0),
+        theFlushesDone(0),
+        theLastSink(0),
+        theLastUserData(0),
+        theLastPriority(0),
+        theLastTime(0),
+        theRepeated(0),
+        theReportedDrops(0)
+    {
+      pthread_key_create(&theKey, &LogWriter::releaseRing);
+      pthread_mutex_init(&theMutex, 0);
+      pthread_cond_init(&theWakeUp, 0);
+      pthread_cond_init(&theFlushed, 0);
+    }
+
+    LogRing*
+    LogWriter::getRing()
+    {
+      LogRing* lRing = static_cast<LogRing*>(pthread_getspecific(theKey));
+      if (!lRing) {
+        lRing = new LogRing();
+        pthread_setspecific(theKey, lRing);
+        pthread_mutex_lock(&theMutex);
+        theRings.push_back(lRing);
+        pthread_mutex_unlock(&theMutex);
+      }
+      // the writer thread doesn't survive a fork (e.g. of a daemon)
+      if (!theIsRunning)
+        start();
+      return lRing;
+    }
+
+    void
+    LogWriter::start()
+    {
+      pthread_mutex_lock(&theMutex);
+      if (!theIsRunning) {
+        theStop = false;
+        theIsRunning = pthread_create(&theThread, 0, &LogWriter::runThread, this) == 0;
+        if (!theHooksInstalled) {
+          theHooksInstalled = true;
+          atexit(&LogWriter::stopAtExit);
+          pthread_atfork(0, 0, &LogWriter::childAfterFork);
+        }
+      }
+      pthread_mutex_unlock(&theMutex);
+    }
+
+    void
+    LogWriter::flush()
+    {
+      pthread_mutex_lock(&theMutex);
+      unsigned long lRequest = ++theFlushRequests;
+      pthread_cond_signal(&theWakeUp);
+      while (theIsRunning && theFlushesDone < lRequest)
+        pthread_cond_wait(&theFlushed, &theMutex);
+      pthread_mutex_unlock(&theMutex);
+    }
+
+    void*
+    LogWriter::runThread(void* aWriter)
+    {
+      // signals are handled by the threads of the application
+      sigset_t lSignals;
+      sigfillset(&lSignals);
+      pthread_sigmask(SIG_BLOCK, &lSignals, 0);
+
+      static_cast<LogWriter*>(aWriter)->run();
+      return 0;
+    }
+
+    void
+    LogWriter::run()
+    {
+      std::vector<LogRing*> lRings;
+      std::vector<LogRing*> lEmptied;
+
+      pthread_mutex_lock(&theMutex);
+      while (true) {
+        unsigned long lFlushRequests = theFlushRequests;
+        bool lStop = theStop;
+        lRings = theRings;
+        pthread_mutex_unlock(&theMutex);
+
+        lEmptied.clear();
+        drain(lRings, lEmptied);
+
+        pthread_mutex_lock(&theMutex);
+        for (std::vector<LogRing*>::iterator lIter = lEmptied.begin();
+             lIter != lEmptied.end(); ++lIter) {
+          for (std::vector<LogRing*>::iterator lRing = theRings.begin();
+               lRing != theRings.end(); ++lRing) {
+            if (*lRing == *lIter) {
+              theRings.erase(lRing);
+              break;
+            }
+          }
+          delete *lIter;
+        }
+
+        theFlushesDone = lFlushRequests;
+        pthread_cond_broadcast(&theFlushed);
+
+        if (lStop)
+          break;
+        if (theFlushRequests == lFlushRequests && !theStop) {
+          // producers only wake the writer if a ring is half full
+          struct timespec lTimeout;
+          clock_gettime(CLOCK_REALTIME, &lTimeout);
+          lTimeout.tv_nsec += 100 * 1000 * 1000;
+          if (lTimeout.tv_nsec >= 1000 * 1000 * 1000) {
+            lTimeout.tv_nsec -= 1000 * 1000 * 1000;
+            ++lTimeout.tv_sec;
+          }
+          pthread_cond_timedwait(&theWakeUp, &theMutex, &lTimeout);
+        }
+      }
+      pthread_mutex_unlock(&theMutex);
+    }
+
+    void
+    LogWriter::drain(const std::vector<LogRing*>& aRings, std::vector<LogRing*>& aEmptied)
+    {
+      time_t lNow = time(0);
+
+      for (std::vector<LogRing*>::const_iterator lIter = aRings.begin();
+           lIter != aRings.end(); ++lIter) {
+        LogRing* lRing = *lIter;
+        bool lIsOrphaned = lRing->theIsOrphaned;
+        unsigned int lHead = lRing->theHead;
+        __sync_synchronize(); // read the records after the head
+
+        for (unsigned int lTail = lRing->theTail; lTail != lHead; ++lTail) {
+          write(lRing->theRecords[lTail % LogRing::SIZE], lNow);
+        }
+
+        __sync_synchronize(); // release the records before the tail
+        lRing->theTail = lHead;
+
+        if (lIsOrphaned)
+          aEmptied.push_back(lRing);
+      }
+
+      if (theRepeated > 0 && lNow - theLastTime >= (time_t) theSuppressionInterval) {
+        reportRepeated();
+        theLastSink = 0;
+      }
+
+      uint64_t lDropped = theDropped;
+      if (lDropped != theReportedDrops) {
+        char lBuffer[64];
+        snprintf(lBuffer, sizeof(lBuffer), "%llu log messages dropped",
+                 (unsigned long long) (lDropped - theReportedDrops));
+        AWSLog::syslogSink(LOG_WARNING, lBuffer, 0);
+        theReportedDrops = lDropped;
+      }
+    }
+
+    void
+    LogWriter::write(LogRecord& aRecord, time_t aNow)
+    {
+      const char* lMessage = aRecord.theLongMessage ? aRecord.theLongMessage
+                                                    : aRecord.theMessage;
+
+      if (aRecord.theSink == theLastSink && aRecord.theUserData == theLastUserData
+          && aNow - theLastTime < (time_t) theSuppressionInterval
+          && theLastMessage == lMessage) {
+        ++theRepeated;
+      } else {
+        reportRepeated();
+        aRecord.theSink(aRecord.thePriority, lMessage, aRecord.theUserData);
+        theLastMessage = lMessage;
+        theLastSink = aRecord.theSink;
+        theLastUserData = aRecord.theUserData;
+        theLastPriority = aRecord.thePriority;
+        theLastTime = aNow;
+      }
+
+      free(aRecord.theLongMessage);
+      aRecord.theLongMessage = 0;
+    }
+
+    void
+    LogWriter::reportRepeated()
+    {
+      if (theRepeated == 0)
+        return;
+      char lBuffer[64];
+      snprintf(lBuffer, sizeof(lBuffer), "last message repeated %u times", theRepeated);
+      theLastSink(theLastPriority, lBuffer, theLastUserData);
+      theRepeated = 0;
+    }
+
+    void
+    LogWriter::releaseRing(void* aRing)
+    {
+      // the writer deletes the ring after it has been emptied
+      __sync_synchronize();
+      static_cast<LogRing*>(aRing)->theIsOrphaned = true;
+    }
+
+    void
+    LogWriter::stopAtExit()
+    {
+      LogWriter* lWriter = instance();
+
+      pthread_mutex_lock(&lWriter->theMutex);
+      bool lIsRunning = lWriter->theIsRunning;
+      lWriter->theStop = true;
+      pthread_cond_signal(&lWriter->theWakeUp);
+      pthread_mutex_unlock(&lWriter->theMutex);
+
+      if (lIsRunning) {
+        pthread_join(lWriter->theThread, 0);
+        lWriter->theIsRunning = false;
+      } else {
+        // e.g. in the child of a fork that never logged anything
+        std::vector<LogRing*> lEmptied;
+        lWriter->drain(lWriter->theRings, lEmptied);
+      }
+      lWriter->reportRepeated();
+    }
+
+    void
+    LogWriter::childAfterFork()
+    {
+      // only the forking thread exists in the child
+      LogWriter* lWriter = instance();
+      pthread_mutex_init(&lWriter->theMutex, 0);
+      pthread_cond_init(&lWriter->theWakeUp, 0);
+      pthread_cond_init(&lWriter->theFlushed, 0);
+      lWriter->theIsRunning = false;
+    }
+
+  } /* anonymous namespace */
+
+  void
+  AWSLog::log(int aPriority, const std::string& aMessage, Sink aSink, void* aUserData)
+  {
+    LogWriter* lWriter = LogWriter::instance();
+    LogRing* lRing = lWriter->getRing();
+
+    unsigned int lHead = lRing->theHead;
+    unsigned int lUsed = lHead - lRing->theTail;
+    if (lUsed >= LogRing::SIZE) {
+      __sync_add_and_fetch(&lWriter->theDropped, 1);
+      lWriter->wakeUp();
+      return;
+    }
+
+    LogRecord& lRecord = lRing->theRecords[lHead % LogRing::SIZE];
+    lRecord.theSink = aSink ? aSink : &AWSLog::syslogSink;
+    lRecord.theUserData = aUserData;
+    lRecord.thePriority = aPriority;
+    if (aMessage.size() < LogRecord::INLINE_SIZE) {
+      memcpy(lRecord.theMessage, aMessage.c_str(), aMessage.size() + 1);
+      lRecord.theLongMessage = 0;
+    } else {
+      lRecord.theLongMessage = strdup(aMessage.c_str());
+      if (!lRecord.theLongMessage) {
+        __sync_add_and_fetch(&lWriter->theDropped, 1);
+        return;
+      }
+    }
+
+    __sync_synchronize(); // publish the record before the head
+    lRing->theHead = lHead + 1;
+
+    if (lUsed + 1 == LogRing::SIZE / 2)
+      lWriter->wakeUp();
+  }
+
+  void
+  AWSLog::flush()
+  {
+    LogWriter::instance()->flush();
+  }
+
+  void
+  AWSLog::setSuppressionInterval(unsigned int aSeconds)
+  {
+    LogWriter::instance()->theSuppressionInterval = aSeconds;
+  }
+
+  uint64_t
+  AWSLog::getNumberOfDroppedMessages()
+  {
+    return LogWriter::instance()->theDropped;
+  }
+
+  void
+  AWSLog::syslogSink(int aPriority, const char* aMessage, void*)
+  {
+    syslog(aPriority, "%s", aMessage);
+  }
+
+} /* namespace aws */
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "api/awsreactorimpl.h"
+
+#include <curl/curl.h>
+
+namespace aws {
+
+  AWSReactorImpl::AWSReactorImpl(SocketFunction aSocketFunction,
+                                 TimerFunction aTimerFunction,
+                                 void* aUserData)
+    : theSocketFunction(aSocketFunction),
+      theTimerFunction(aTimerFunction),
+      theUserData(aUserData),
+      theTimeout(0)
+  {
+    theMultiHandle = curl_multi_init();
+    curl_multi_setopt(theMultiHandle, CURLMOPT_SOCKETFUNCTION, AWSReactorImpl::socketCallback);
+    curl_multi_setopt(theMultiHandle, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(theMultiHandle, CURLMOPT_TIMERFUNCTION, AWSReactorImpl::timerCallback);
+    curl_multi_setopt(theMultiHandle, CURLMOPT_TIMERDATA, this);
+#ifdef CURLPIPE_MULTIPLEX
+    // requests of connections using HTTP/2 share connections as streams
+    curl_multi_setopt(theMultiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+  }
+
+  AWSReactorImpl::~AWSReactorImpl()
+  {
+    // requests in flight are dropped without calling their completion
+    for (std::set<AWSAsyncRequest*>::iterator lIter = theRequests.begin();
+         lIter != theRequests.end(); ++lIter) {
+      curl_multi_remove_handle(theMultiHandle, (*lIter)->getHandle());
+      delete *lIter;
+    }
+    curl_multi_cleanup(theMultiHandle);
+  }
+
+  void
+  AWSReactorImpl::addRequest(AWSAsyncRequest* aRequest)
+  {
+    curl_easy_setopt(aRequest->getHandle(), CURLOPT_PRIVATE, aRequest);
+    curl_easy_setopt(aRequest->getHandle(), CURLOPT_TIMEOUT_MS, theTimeout);
+    theRequests.insert(aRequest);
+    // curl sets the timer which lets the application kick off the request
+    curl_multi_add_handle(theMultiHandle, aRequest->getHandle());
+  }
+
+  void
+  AWSReactorImpl::socketReady(int aSocket, int aEvents)
+  {
+    int lMask = 0;
+    if (aEvents & EVENT_IN)
+      lMask |= CURL_CSELECT_IN;
+    if (aEvents & EVENT_OUT)
+      lMask |= CURL_CSELECT_OUT;
+    if (aEvents & EVENT_ERROR)
+      lMask |= CURL_CSELECT_ERR;
+
+    int lRunning;
+    curl_multi_socket_action(theMultiHandle, aSocket, lMask, &lRunning);
+    completeRequests();
+  }
+
+  void
+  AWSReactorImpl::timeout()
+  {
+    int lRunning;
+    curl_multi_socket_action(theMultiHandle, CURL_SOCKET_TIMEOUT, 0, &lRunning);
+    completeRequests();
+  }
+
+  void
+  AWSReactorImpl::completeRequests()
+  {
+    CURLMsg* lMsg;
+    int lMsgsInQueue;
+    while ((lMsg = curl_multi_info_read(theMultiHandle, &lMsgsInQueue))) {
+      if (lMsg->msg != CURLMSG_DONE)
+        continue;
+
+      char* lPrivate = 0;
+      curl_easy_getinfo(lMsg->easy_handle, CURLINFO_PRIVATE, &lPrivate);
+      completeRequest(reinterpret_cast<AWSAsyncRequest*>(lPrivate),
+                      lMsg->data.result);
+    }
+  }
+
+  void
+  AWSReactorImpl::cancelRequest(AWSAsyncRequest* aRequest)
+  {
+    if (theRequests.find(aRequest) != theRequests.end())
+      completeRequest(aRequest, CURLE_ABORTED_BY_CALLBACK);
+  }
+
+  void
+  AWSReactorImpl::completeRequest(AWSAsyncRequest* aRequest, int aCurlCode)
+  {
+    CURL* lEasy = aRequest->getHandle();
+
+    // the handle is removed first such that the completion handler
+    // can start a new request on the same connection
+    curl_multi_remove_handle(theMultiHandle, lEasy);
+    curl_easy_setopt(lEasy, CURLOPT_PRIVATE, 0);
+    curl_easy_setopt(lEasy, CURLOPT_TIMEOUT_MS, 0L);
+    theRequests.erase(aRequest);
+
+    aRequest->complete(aCurlCode);
+    delete aRequest;
+  }
+
+  int
+  AWSReactorImpl::socketCallback(CURL* aEasy, int aSocket, int aWhat,
+                                 void* aUserData, void* aSocketData)
+  {
+    AWSReactorImpl* lReactor = static_cast<AWSReactorImpl*>(aUserData);
+
+    int lEvents = 0;
+    if (aWhat == CURL_POLL_REMOVE) {
+      lEvents = EVENT_REMOVE;
+    } else {
+      if (aWhat & CURL_POLL_IN)
+        lEvents |= EVENT_IN;
+      if (aWhat & CURL_POLL_OUT)
+        lEvents |= EVENT_OUT;
+    }
+
+    lReactor->theSocketFunction(aSocket, lEvents, lReactor->theUserData);
+    return 0;
+  }
+
+  int
+  AWSReactorImpl::timerCallback(CURLM* aMulti, long aTimeout, void* aUserData)
+  {
+    AWSReactorImpl* lReactor = static_cast<AWSReactorImpl*>(aUserData);
+    lReactor->theTimerFunction(aTimeout, lReactor->theUserData);
+    return 0;
+  }
+
+} /* namespace aws */
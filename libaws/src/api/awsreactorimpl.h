@@ -0,0 +1,97 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_AWSREACTORIMPL_H
+#define AWS_AWSREACTORIMPL_H
+
+#include "common.h"
+#include <set>
+#include <libaws/awsreactor.h>
+
+typedef void CURL;
+typedef void CURLM;
+
+namespace aws {
+
+  // a request performed by a reactor; deleted by the reactor after complete
+  // has been called (or when the reactor is destroyed)
+  class AWSAsyncRequest
+  {
+    public:
+      virtual ~AWSAsyncRequest() {}
+
+      virtual CURL*
+      getHandle() const = 0;
+
+      // called on the thread of the event loop with the result of curl
+      virtual void
+      complete(int aCurlCode) = 0;
+  };
+
+  class AWSReactorImpl : public AWSReactor
+  {
+    public:
+      virtual ~AWSReactorImpl();
+
+      virtual void
+      socketReady(int aSocket, int aEvents);
+
+      virtual void
+      timeout();
+
+      virtual unsigned int
+      getNumberOfRequests() const { return theRequests.size(); }
+
+      virtual void
+      setTimeout(long aMilliseconds) { theTimeout = aMilliseconds; }
+
+      // takes over the ownership of aRequest
+      void
+      addRequest(AWSAsyncRequest* aRequest);
+
+      // completes aRequest with CURLE_ABORTED_BY_CALLBACK if it is still
+      // in flight and deletes it
+      void
+      cancelRequest(AWSAsyncRequest* aRequest);
+
+    protected:
+      friend class AWSConnectionFactoryImpl;
+      AWSReactorImpl(SocketFunction aSocketFunction, TimerFunction aTimerFunction,
+                     void* aUserData);
+
+      // calls the completion of all requests that are done
+      void
+      completeRequests();
+
+      // removes aRequest from the multi handle, completes and deletes it
+      void
+      completeRequest(AWSAsyncRequest* aRequest, int aCurlCode);
+
+      static int
+      socketCallback(CURL* aEasy, int aSocket, int aWhat, void* aUserData, void* aSocketData);
+
+      static int
+      timerCallback(CURLM* aMulti, long aTimeout, void* aUserData);
+
+      CURLM*                      theMultiHandle;
+      SocketFunction              theSocketFunction;
+      TimerFunction               theTimerFunction;
+      void*                       theUserData;
+      long                        theTimeout;
+      std::set<AWSAsyncRequest*>  theRequests;
+  };
+
+} /* namespace aws */
+#endif
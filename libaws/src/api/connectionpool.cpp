@@ -18,10 +18,12 @@
 namespace aws { 
 
     template<class T>
-    ConnectionPool<T>::ConnectionPool(unsigned int size, const std::string& accesskeyid, const std::string& secretaccesskey) :
+    ConnectionPool<T>::ConnectionPool(unsigned int size, const std::string& accesskeyid, const std::string& secretaccesskey,
+                                      const std::string& aCustomHost) :
       theFactory(AWSConnectionFactory::getInstance()),
       theAccessKeyId(accesskeyid),
       theSecretAccessKey(secretaccesskey),
+      theCustomHost(aCustomHost),
       theSize(size)
     {
       for(unsigned int i=1;i<=size;i++){
@@ -65,19 +67,19 @@ namespace aws {
    template<> S3ConnectionPtr 
    ConnectionPool<S3ConnectionPtr>::createConnection ( const std::string& aAccessKeyId,
                                          const std::string& aSecretAccessKey ) {
-     return theFactory->createS3Connection(theAccessKeyId, theSecretAccessKey);
+     return theFactory->createS3Connection(theAccessKeyId, theSecretAccessKey, theCustomHost);
    }
 
    template<> SQSConnectionPtr
    ConnectionPool<SQSConnectionPtr>::createConnection ( const std::string& aAccessKeyId,
                                          const std::string& aSecretAccessKey ) {
-    return theFactory->createSQSConnection(theAccessKeyId, theSecretAccessKey);
+    return theFactory->createSQSConnection(theAccessKeyId, theSecretAccessKey, theCustomHost);
    }
 
    template<> SDBConnectionPtr
    ConnectionPool<SDBConnectionPtr>::createConnection ( const std::string& aAccessKeyId,
                                          const std::string& aSecretAccessKey ) {
-    return theFactory->createSDBConnection(theAccessKeyId, theSecretAccessKey);
+    return theFactory->createSDBConnection(theAccessKeyId, theSecretAccessKey, theCustomHost);
    }
 
    template class ConnectionPool<S3ConnectionPtr>;
@@ -0,0 +1,640 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <libaws/s3bucketindex.h>
+#include <libaws/s3connection.h>
+#include <libaws/exception.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace aws {
+
+  // the file consists of the header, the ranges, the objects (sorted by key),
+  // and the strings; strings are referenced by their offset into the strings
+  struct S3BucketIndex::StringRef
+  {
+    uint64_t  theOffset;
+    uint64_t  theLength;
+  };
+
+  struct S3BucketIndex::FileHeader
+  {
+    char      theMagic[8];
+    uint64_t  theNumberOfRanges;
+    uint64_t  theNumberOfObjects;
+    uint64_t  theStrings;      // offset of the strings in the file
+    uint64_t  theStringsSize;
+    StringRef theBucketName;
+    StringRef thePrefix;
+  };
+
+  // a range holds the keys after its marker up to the marker of the next range
+  struct S3BucketIndex::RangeRecord
+  {
+    StringRef theMarker;
+    uint64_t  theFirstObject;
+    uint64_t  theNumberOfObjects;
+    int64_t   theListTime;
+  };
+
+  struct S3BucketIndex::ObjectRecord
+  {
+    StringRef theKey;
+    StringRef theETag;
+    StringRef theLastModified;
+    int64_t   theSize;
+  };
+
+  // a range of the index that is written by refresh
+  struct S3BucketIndex::RangeListing
+  {
+    std::string          theMarker;
+    bool                 theIsListed;  // by this refresh
+    size_t               theOldRange;  // in the mapped file if not listed
+    time_t               theListTime;
+    std::vector<Object>  theObjects;
+  };
+
+  static const char INDEX_MAGIC[8] = { 'S', '3', 'I', 'N', 'D', 'E', 'X', '1' };
+
+  static bool
+  startsWith(const std::string& aString, const std::string& aPrefix)
+  {
+    return aString.compare(0, aPrefix.size(), aPrefix) == 0;
+  }
+
+  bool
+  S3BucketIndex::isValid(const StringRef& aString, uint64_t aStringsSize)
+  {
+    return aString.theOffset <= aStringsSize && aString.theLength <= aStringsSize - aString.theOffset;
+  }
+
+  void
+  S3BucketIndex::appendString(std::string& aStrings, const char* aString, size_t aLength,
+                              StringRef& aRef)
+  {
+    aRef.theOffset = aStrings.size();
+    aRef.theLength = aLength;
+    aStrings.append(aString, aLength);
+  }
+
+  static void
+  writeAll(int aFile, const void* aData, size_t aSize, const std::string& aFileName)
+  {
+    const char* lData = static_cast<const char*>(aData);
+    while (aSize > 0) {
+      ssize_t lWritten = ::write(aFile, lData, aSize);
+      if (lWritten < 0) {
+        if (errno == EINTR)
+          continue;
+        int lErrno = errno;
+        ::close(aFile);
+        ::unlink(aFileName.c_str());
+        throw AWSFileException(aFileName, lErrno);
+      }
+      lData += lWritten;
+      aSize -= lWritten;
+    }
+  }
+
+  S3BucketIndex::S3BucketIndex(const std::string& aFileName, const std::string& aBucketName,
+                               const std::string& aPrefix, size_t aRangeSize)
+    : theFileName(aFileName),
+      theBucketName(aBucketName),
+      thePrefix(aPrefix),
+      theRangeSize(aRangeSize > 0 ? aRangeSize : 1),
+      theData(0),
+      theDataSize(0),
+      theHeader(0),
+      theRanges(0),
+      theObjects(0),
+      theIsRefreshing(false),
+      theNumberOfListRequests(0)
+  {
+    pthread_mutex_init(&theMutex, 0);
+    pthread_mutex_init(&theRefreshMutex, 0);
+    mapFile();
+  }
+
+  S3BucketIndex::~S3BucketIndex()
+  {
+    unmapFile();
+    pthread_mutex_destroy(&theRefreshMutex);
+    pthread_mutex_destroy(&theMutex);
+  }
+
+  void
+  S3BucketIndex::mapFile()
+  {
+    int lFile = ::open(theFileName.c_str(), O_RDONLY);
+    if (lFile < 0)
+      return;
+
+    struct stat lStat;
+    if (fstat(lFile, &lStat) != 0 || (size_t) lStat.st_size < sizeof(FileHeader)) {
+      ::close(lFile);
+      return;
+    }
+
+    void* lData = mmap(0, lStat.st_size, PROT_READ, MAP_SHARED, lFile, 0);
+    ::close(lFile);
+    if (lData == MAP_FAILED)
+      return;
+
+    theData = static_cast<const char*>(lData);
+    theDataSize = lStat.st_size;
+    theHeader = reinterpret_cast<const FileHeader*>(theData);
+    theRanges = reinterpret_cast<const RangeRecord*>(theData + sizeof(FileHeader));
+    theObjects = reinterpret_cast<const ObjectRecord*>(theRanges + theHeader->theNumberOfRanges);
+
+    // an index of another bucket or a damaged file is replaced by the next refresh
+    uint64_t lTables = sizeof(FileHeader) + theHeader->theNumberOfRanges * sizeof(RangeRecord)
+                       + theHeader->theNumberOfObjects * sizeof(ObjectRecord);
+    bool lIsValid = memcmp(theHeader->theMagic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0
+        && theHeader->theNumberOfRanges < theDataSize
+        && theHeader->theNumberOfObjects < theDataSize
+        && theHeader->theStrings == lTables
+        && lTables <= theDataSize
+        && theHeader->theStringsSize <= theDataSize - lTables
+        && isValid(theHeader->theBucketName, theHeader->theStringsSize)
+        && isValid(theHeader->thePrefix, theHeader->theStringsSize)
+        && getString(theHeader->theBucketName) == theBucketName
+        && getString(theHeader->thePrefix) == thePrefix;
+
+    uint64_t lNextObject = 0;
+    for (uint64_t i = 0; lIsValid && i < theHeader->theNumberOfRanges; ++i) {
+      const RangeRecord& lRange = theRanges[i];
+      lIsValid = isValid(lRange.theMarker, theHeader->theStringsSize)
+          && lRange.theFirstObject == lNextObject
+          && lRange.theNumberOfObjects <= theHeader->theNumberOfObjects - lNextObject;
+      lNextObject += lRange.theNumberOfObjects;
+    }
+    lIsValid = lIsValid && lNextObject == theHeader->theNumberOfObjects;
+    for (uint64_t i = 0; lIsValid && i < theHeader->theNumberOfObjects; ++i) {
+      const ObjectRecord& lObject = theObjects[i];
+      lIsValid = isValid(lObject.theKey, theHeader->theStringsSize)
+          && isValid(lObject.theETag, theHeader->theStringsSize)
+          && isValid(lObject.theLastModified, theHeader->theStringsSize);
+    }
+
+    if (!lIsValid) {
+      unmapFile();
+      return;
+    }
+    theStaleRanges.assign(theHeader->theNumberOfRanges, false);
+  }
+
+  void
+  S3BucketIndex::unmapFile()
+  {
+    if (theData)
+      munmap(const_cast<char*>(theData), theDataSize);
+    theData = 0;
+    theDataSize = 0;
+    theHeader = 0;
+    theRanges = 0;
+    theObjects = 0;
+    theStaleRanges.clear();
+  }
+
+  std::string
+  S3BucketIndex::getString(const StringRef& aString) const
+  {
+    return std::string(theData + theHeader->theStrings + aString.theOffset, aString.theLength);
+  }
+
+  void
+  S3BucketIndex::getObject(size_t aObject, Object& aResult) const
+  {
+    const ObjectRecord& lObject = theObjects[aObject];
+    aResult.KeyValue = getString(lObject.theKey);
+    aResult.ETag = getString(lObject.theETag);
+    aResult.LastModified = getString(lObject.theLastModified);
+    aResult.Size = lObject.theSize;
+  }
+
+  int
+  S3BucketIndex::compareString(const char* aStrings, const StringRef& aRef,
+                               const std::string& aString)
+  {
+    size_t lLength = std::min((size_t) aRef.theLength, aString.size());
+    int lResult = memcmp(aStrings + aRef.theOffset, aString.data(), lLength);
+    if (lResult != 0)
+      return lResult;
+    if (aRef.theLength == aString.size())
+      return 0;
+    return aRef.theLength < aString.size() ? -1 : 1;
+  }
+
+  size_t
+  S3BucketIndex::findRange(const std::string& aKey) const
+  {
+    // the last range whose marker is less than the key
+    const char* lStrings = theData + theHeader->theStrings;
+    size_t lLow = 0;
+    size_t lHigh = theHeader->theNumberOfRanges;
+    while (lLow < lHigh) {
+      size_t lMiddle = lLow + (lHigh - lLow) / 2;
+      if (compareString(lStrings, theRanges[lMiddle].theMarker, aKey) < 0)
+        lLow = lMiddle + 1;
+      else
+        lHigh = lMiddle;
+    }
+    return lLow > 0 ? lLow - 1 : 0;
+  }
+
+  size_t
+  S3BucketIndex::findObject(size_t aRange, const std::string& aKey) const
+  {
+    const char* lStrings = theData + theHeader->theStrings;
+    size_t lLow = theRanges[aRange].theFirstObject;
+    size_t lHigh = lLow + theRanges[aRange].theNumberOfObjects;
+    while (lLow < lHigh) {
+      size_t lMiddle = lLow + (lHigh - lLow) / 2;
+      if (compareString(lStrings, theObjects[lMiddle].theKey, aKey) < 0)
+        lLow = lMiddle + 1;
+      else
+        lHigh = lMiddle;
+    }
+    return lLow;
+  }
+
+  S3BucketIndex::LookupResult
+  S3BucketIndex::lookup(const std::string& aKey, Object& aObject) const
+  {
+    if (!startsWith(aKey, thePrefix))
+      return UNKNOWN;
+
+    LookupResult lResult = UNKNOWN;
+    pthread_mutex_lock(&theMutex);
+    if (theHeader && theHeader->theNumberOfRanges > 0) {
+      size_t lRange = findRange(aKey);
+      if (!theStaleRanges[lRange]) {
+        size_t lObject = findObject(lRange, aKey);
+        const RangeRecord& lRangeRecord = theRanges[lRange];
+        if (lObject < lRangeRecord.theFirstObject + lRangeRecord.theNumberOfObjects
+            && compareString(theData + theHeader->theStrings,
+                             theObjects[lObject].theKey, aKey) == 0) {
+          getObject(lObject, aObject);
+          lResult = FOUND;
+        } else {
+          lResult = MISSING;
+        }
+      }
+    }
+    pthread_mutex_unlock(&theMutex);
+    return lResult;
+  }
+
+  bool
+  S3BucketIndex::list(const std::string& aPrefix, const std::string& aDelimiter,
+                      std::vector<Object>& aObjects,
+                      std::vector<std::string>* aCommonPrefixes) const
+  {
+    if (!startsWith(aPrefix, thePrefix))
+      return false;
+
+    pthread_mutex_lock(&theMutex);
+    if (!theHeader || theHeader->theNumberOfRanges == 0) {
+      pthread_mutex_unlock(&theMutex);
+      return false;
+    }
+
+    const char* lStrings = theData + theHeader->theStrings;
+    bool lIsComplete = true;
+    bool lIsDone = false;
+    std::string lCommonPrefix;
+    for (size_t lRange = findRange(aPrefix);
+         lRange < theHeader->theNumberOfRanges && !lIsDone; ++lRange) {
+      // the keys of this and all following ranges are greater than the
+      // keys with the prefix if the marker is
+      const RangeRecord& lRangeRecord = theRanges[lRange];
+      std::string lMarker = getString(lRangeRecord.theMarker);
+      if (lMarker > aPrefix && !startsWith(lMarker, aPrefix))
+        break;
+
+      if (theStaleRanges[lRange])
+        lIsComplete = false;
+
+      size_t lEnd = lRangeRecord.theFirstObject + lRangeRecord.theNumberOfObjects;
+      for (size_t i = findObject(lRange, aPrefix); i < lEnd; ++i) {
+        const StringRef& lKey = theObjects[i].theKey;
+        if (lKey.theLength < aPrefix.size()
+            || memcmp(lStrings + lKey.theOffset, aPrefix.data(), aPrefix.size()) != 0) {
+          lIsDone = true;
+          break;
+        }
+
+        if (!aDelimiter.empty()) {
+          std::string lKeyValue = getString(lKey);
+          std::string::size_type lDelimiter = lKeyValue.find(aDelimiter, aPrefix.size());
+          if (lDelimiter != std::string::npos) {
+            lKeyValue.erase(lDelimiter + aDelimiter.size());
+            // keys are sorted, i.e. equal common prefixes are adjacent
+            if (lKeyValue != lCommonPrefix) {
+              lCommonPrefix = lKeyValue;
+              if (aCommonPrefixes)
+                aCommonPrefixes->push_back(lCommonPrefix);
+            }
+            continue;
+          }
+        }
+
+        aObjects.push_back(Object());
+        getObject(i, aObjects.back());
+      }
+    }
+    pthread_mutex_unlock(&theMutex);
+    return lIsComplete;
+  }
+
+  void
+  S3BucketIndex::invalidate(const std::string& aKey)
+  {
+    pthread_mutex_lock(&theMutex);
+    markStale(aKey, false);
+    pthread_mutex_unlock(&theMutex);
+  }
+
+  void
+  S3BucketIndex::invalidatePrefix(const std::string& aPrefix)
+  {
+    pthread_mutex_lock(&theMutex);
+    markStale(aPrefix, true);
+    pthread_mutex_unlock(&theMutex);
+  }
+
+  void
+  S3BucketIndex::markStale(const std::string& aKey, bool aIsPrefix)
+  {
+    if (theIsRefreshing)
+      theRefreshInvalidations.push_back(std::make_pair(aKey, aIsPrefix));
+
+    if (!theHeader || theHeader->theNumberOfRanges == 0)
+      return;
+
+    if (!aIsPrefix) {
+      if (startsWith(aKey, thePrefix))
+        theStaleRanges[findRange(aKey)] = true;
+      return;
+    }
+
+    if (startsWith(thePrefix, aKey)) {
+      // the whole index
+      theStaleRanges.assign(theStaleRanges.size(), true);
+      return;
+    }
+    if (!startsWith(aKey, thePrefix))
+      return;
+
+    for (size_t lRange = findRange(aKey); lRange < theHeader->theNumberOfRanges; ++lRange) {
+      std::string lMarker = getString(theRanges[lRange].theMarker);
+      if (lMarker > aKey && !startsWith(lMarker, aKey))
+        break;
+      theStaleRanges[lRange] = true;
+    }
+  }
+
+  size_t
+  S3BucketIndex::listRange(S3Connection* aConnection, RangeListing& aListing,
+                           bool aHasUpperBound, const std::string& aUpperBound)
+  {
+    size_t lRequests = 0;
+    std::string lMarker = aListing.theMarker;
+    bool lIsDone = false;
+    ListBucketResponsePtr lList;
+
+    aListing.theListTime = time(0);
+    aListing.theObjects.clear();
+    do {
+      lList = aConnection->listBucket(theBucketName, thePrefix, lMarker);
+      ++lRequests;
+      lList->open();
+      Object lObject;
+      while (lList->next(lObject)) {
+        if (aHasUpperBound && lObject.KeyValue > aUpperBound) {
+          lIsDone = true;
+          break;
+        }
+        lMarker = lObject.KeyValue;
+        aListing.theObjects.push_back(lObject);
+      }
+      lList->close();
+    } while (!lIsDone && lList->isTruncated());
+    return lRequests;
+  }
+
+  size_t
+  S3BucketIndex::refresh(S3Connection* aConnection, time_t aMaxAge)
+  {
+    if (pthread_mutex_trylock(&theRefreshMutex) != 0)
+      return 0;
+
+    // decide which ranges to list, the others are copied from the current file
+    std::vector<RangeListing> lListings;
+    time_t lNow = time(0);
+    pthread_mutex_lock(&theMutex);
+    size_t lNumberOfRanges = theHeader ? theHeader->theNumberOfRanges : 0;
+    lListings.resize(lNumberOfRanges > 0 ? lNumberOfRanges : 1);
+    lListings[0].theIsListed = true;
+    for (size_t i = 0; i < lNumberOfRanges; ++i) {
+      RangeListing& lListing = lListings[i];
+      const RangeRecord& lRange = theRanges[i];
+      lListing.theMarker = getString(lRange.theMarker);
+      lListing.theOldRange = i;
+      lListing.theListTime = lRange.theListTime;
+      lListing.theIsListed = theStaleRanges[i] || aMaxAge == 0
+                             || lRange.theListTime + aMaxAge <= lNow;
+    }
+    theIsRefreshing = true;
+    theRefreshInvalidations.clear();
+    pthread_mutex_unlock(&theMutex);
+
+    size_t lNumberOfListed = 0;
+    size_t lRequests = 0;
+    try {
+      for (size_t i = 0; i < lListings.size(); ++i) {
+        if (!lListings[i].theIsListed)
+          continue;
+        bool lHasUpperBound = i + 1 < lListings.size();
+        lRequests += listRange(aConnection, lListings[i], lHasUpperBound,
+                               lHasUpperBound ? lListings[i + 1].theMarker : "");
+        ++lNumberOfListed;
+      }
+    } catch (...) {
+      pthread_mutex_lock(&theMutex);
+      theIsRefreshing = false;
+      theNumberOfListRequests += lRequests;
+      pthread_mutex_unlock(&theMutex);
+      pthread_mutex_unlock(&theRefreshMutex);
+      throw;
+    }
+
+    pthread_mutex_lock(&theMutex);
+    theIsRefreshing = false;
+    theNumberOfListRequests += lRequests;
+    if (lNumberOfListed == 0) {
+      // everything is recent, the file stays as it is
+      theRefreshInvalidations.clear();
+      pthread_mutex_unlock(&theMutex);
+      pthread_mutex_unlock(&theRefreshMutex);
+      return 0;
+    }
+    try {
+      write(lListings);
+    } catch (...) {
+      pthread_mutex_unlock(&theMutex);
+      pthread_mutex_unlock(&theRefreshMutex);
+      throw;
+    }
+    // changes during the refresh may not be contained in the listings
+    for (size_t i = 0; i < theRefreshInvalidations.size(); ++i)
+      markStale(theRefreshInvalidations[i].first, theRefreshInvalidations[i].second);
+    theRefreshInvalidations.clear();
+    pthread_mutex_unlock(&theMutex);
+
+    pthread_mutex_unlock(&theRefreshMutex);
+    return lNumberOfListed;
+  }
+
+  void
+  S3BucketIndex::write(const std::vector<RangeListing>& aListings)
+  {
+    FileHeader lHeader;
+    std::vector<RangeRecord> lRanges;
+    std::vector<ObjectRecord> lObjects;
+    std::string lStrings;
+
+    memset(&lHeader, 0, sizeof(lHeader));
+    memcpy(lHeader.theMagic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    appendString(lStrings, theBucketName.data(), theBucketName.size(), lHeader.theBucketName);
+    appendString(lStrings, thePrefix.data(), thePrefix.size(), lHeader.thePrefix);
+
+    const char* lOldStrings = theHeader ? theData + theHeader->theStrings : 0;
+    for (size_t i = 0; i < aListings.size(); ++i) {
+      const RangeListing& lListing = aListings[i];
+      RangeRecord lRange;
+      lRange.theListTime = lListing.theListTime;
+
+      if (!lListing.theIsListed) {
+        const RangeRecord& lOldRange = theRanges[lListing.theOldRange];
+        appendString(lStrings, lListing.theMarker.data(), lListing.theMarker.size(),
+                     lRange.theMarker);
+        lRange.theFirstObject = lObjects.size();
+        lRange.theNumberOfObjects = lOldRange.theNumberOfObjects;
+        for (size_t j = 0; j < lOldRange.theNumberOfObjects; ++j) {
+          const ObjectRecord& lOldObject = theObjects[lOldRange.theFirstObject + j];
+          ObjectRecord lObject;
+          appendString(lStrings, lOldStrings + lOldObject.theKey.theOffset,
+                       lOldObject.theKey.theLength, lObject.theKey);
+          appendString(lStrings, lOldStrings + lOldObject.theETag.theOffset,
+                       lOldObject.theETag.theLength, lObject.theETag);
+          appendString(lStrings, lOldStrings + lOldObject.theLastModified.theOffset,
+                       lOldObject.theLastModified.theLength, lObject.theLastModified);
+          lObject.theSize = lOldObject.theSize;
+          lObjects.push_back(lObject);
+        }
+        lRanges.push_back(lRange);
+        continue;
+      }
+
+      // a listed range is split into ranges of theRangeSize keys; if it is
+      // empty, the previous range takes over its keys (the first one is kept)
+      const std::vector<Object>& lListed = lListing.theObjects;
+      if (lListed.empty() && !lRanges.empty())
+        continue;
+      for (size_t j = 0; j == 0 || j < lListed.size(); j += theRangeSize) {
+        const std::string& lMarker = j == 0 ? lListing.theMarker : lListed[j - 1].KeyValue;
+        appendString(lStrings, lMarker.data(), lMarker.size(), lRange.theMarker);
+        lRange.theFirstObject = lObjects.size();
+        lRange.theNumberOfObjects = std::min(theRangeSize, lListed.size() - j);
+        for (size_t k = j; k < j + lRange.theNumberOfObjects; ++k) {
+          const Object& lListedObject = lListed[k];
+          ObjectRecord lObject;
+          appendString(lStrings, lListedObject.KeyValue.data(), lListedObject.KeyValue.size(),
+                       lObject.theKey);
+          appendString(lStrings, lListedObject.ETag.data(), lListedObject.ETag.size(),
+                       lObject.theETag);
+          appendString(lStrings, lListedObject.LastModified.data(),
+                       lListedObject.LastModified.size(), lObject.theLastModified);
+          lObject.theSize = lListedObject.Size;
+          lObjects.push_back(lObject);
+        }
+        lRanges.push_back(lRange);
+      }
+    }
+
+    lHeader.theNumberOfRanges = lRanges.size();
+    lHeader.theNumberOfObjects = lObjects.size();
+    lHeader.theStrings = sizeof(FileHeader) + lRanges.size() * sizeof(RangeRecord)
+                         + lObjects.size() * sizeof(ObjectRecord);
+    lHeader.theStringsSize = lStrings.size();
+
+    // the new file replaces the mapped one atomically
+    std::string lTmpFileName = theFileName + ".tmp";
+    int lFile = ::open(lTmpFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (lFile < 0)
+      throw AWSFileException(lTmpFileName, errno);
+    writeAll(lFile, &lHeader, sizeof(lHeader), lTmpFileName);
+    if (!lRanges.empty())
+      writeAll(lFile, &lRanges[0], lRanges.size() * sizeof(RangeRecord), lTmpFileName);
+    if (!lObjects.empty())
+      writeAll(lFile, &lObjects[0], lObjects.size() * sizeof(ObjectRecord), lTmpFileName);
+    writeAll(lFile, lStrings.data(), lStrings.size(), lTmpFileName);
+    if (fsync(lFile) != 0 || ::close(lFile) != 0
+        || rename(lTmpFileName.c_str(), theFileName.c_str()) != 0) {
+      int lErrno = errno;
+      ::unlink(lTmpFileName.c_str());
+      throw AWSFileException(theFileName, lErrno);
+    }
+
+    unmapFile();
+    mapFile();
+  }
+
+  size_t
+  S3BucketIndex::getNumberOfObjects() const
+  {
+    pthread_mutex_lock(&theMutex);
+    size_t lObjects = theHeader ? theHeader->theNumberOfObjects : 0;
+    pthread_mutex_unlock(&theMutex);
+    return lObjects;
+  }
+
+  size_t
+  S3BucketIndex::getNumberOfRanges() const
+  {
+    pthread_mutex_lock(&theMutex);
+    size_t lRanges = theHeader ? theHeader->theNumberOfRanges : 0;
+    pthread_mutex_unlock(&theMutex);
+    return lRanges;
+  }
+
+  uint64_t
+  S3BucketIndex::getNumberOfListRequests() const
+  {
+    pthread_mutex_lock(&theMutex);
+    uint64_t lRequests = theNumberOfListRequests;
+    pthread_mutex_unlock(&theMutex);
+    return lRequests;
+  }
+
+} /* namespace aws */
@@ -0,0 +1,320 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <libaws/s3coalescer.h>
+#include <libaws/s3connection.h>
+#include <libaws/s3response.h>
+#include <libaws/s3exception.h>
+
+#include <cerrno>
+#include <unistd.h>
+
+namespace aws {
+
+  // a request in flight and its result
+  struct S3Coalescer::Flight
+  {
+    Flight()
+      : theIsLanded(false),
+        theIsFailed(false),
+        theWaiters(0),
+        theFileDescriptor(-1),
+        theOffset(0),
+        theHeadException(0),
+        theGetException(0),
+        theConnectionException(0) {}
+
+    ~Flight()
+    {
+      delete theHeadException;
+      delete theGetException;
+      delete theConnectionException;
+    }
+
+    std::string      theKey;
+    bool             theIsLanded;
+    bool             theIsFailed;  // the leader failed with an unexpected exception
+    unsigned int     theWaiters;   // threads that wait for the result
+
+    HeadResponsePtr  theHeadResponse;
+    GetResponsePtr   theGetResponse;
+    int              theFileDescriptor; // file of the leader (get only)
+    off_t            theOffset;
+
+    HeadException*           theHeadException;
+    GetException*            theGetException;
+    AWSConnectionException*  theConnectionException;
+  };
+
+  S3Coalescer::S3Coalescer()
+    : theNumberOfRequests(0),
+      theNumberOfCoalescedRequests(0)
+  {
+    pthread_mutex_init(&theMutex, 0);
+    pthread_cond_init(&theCondition, 0);
+  }
+
+  S3Coalescer::~S3Coalescer()
+  {
+    pthread_cond_destroy(&theCondition);
+    pthread_mutex_destroy(&theMutex);
+  }
+
+  S3Coalescer::Flight*
+  S3Coalescer::join(const std::string& aFlightKey, bool& aIsLeader)
+  {
+    pthread_mutex_lock(&theMutex);
+
+    std::map<std::string, Flight*>::iterator lIter = theFlights.find(aFlightKey);
+    if (lIter == theFlights.end()) {
+      Flight* lFlight = new Flight();
+      lFlight->theKey = aFlightKey;
+      theFlights.insert(std::pair<std::string, Flight*>(aFlightKey, lFlight));
+      ++theNumberOfRequests;
+      pthread_mutex_unlock(&theMutex);
+      aIsLeader = true;
+      return lFlight;
+    }
+
+    Flight* lFlight = (*lIter).second;
+    ++lFlight->theWaiters;
+    ++theNumberOfCoalescedRequests;
+    while (!lFlight->theIsLanded)
+      pthread_cond_wait(&theCondition, &theMutex);
+    pthread_mutex_unlock(&theMutex);
+    aIsLeader = false;
+    return lFlight;
+  }
+
+  void
+  S3Coalescer::land(Flight* aFlight)
+  {
+    pthread_mutex_lock(&theMutex);
+
+    // requests issued from now on start a new flight
+    theFlights.erase(aFlight->theKey);
+    aFlight->theIsLanded = true;
+    pthread_cond_broadcast(&theCondition);
+
+    // the waiters might still read the result and the file of the leader
+    while (aFlight->theWaiters > 0)
+      pthread_cond_wait(&theCondition, &theMutex);
+
+    pthread_mutex_unlock(&theMutex);
+    delete aFlight;
+  }
+
+  void
+  S3Coalescer::leave(Flight* aFlight)
+  {
+    pthread_mutex_lock(&theMutex);
+    if (--aFlight->theWaiters == 0)
+      pthread_cond_broadcast(&theCondition);
+    pthread_mutex_unlock(&theMutex);
+  }
+
+  HeadResponsePtr
+  S3Coalescer::head(S3Connection* aConnection,
+                    const std::string& aBucketName,
+                    const std::string& aKey)
+  {
+    bool lIsLeader;
+    Flight* lFlight = join("HEAD\n" + aBucketName + "\n" + aKey, lIsLeader);
+
+    if (lIsLeader) {
+      HeadResponsePtr lRes;
+      try {
+        lRes = aConnection->head(aBucketName, aKey);
+      } catch (HeadException& e) {
+        lFlight->theHeadException = new HeadException(e);
+        land(lFlight);
+        throw;
+      } catch (AWSConnectionException& e) {
+        lFlight->theConnectionException = new AWSConnectionException(e);
+        land(lFlight);
+        throw;
+      } catch (...) {
+        lFlight->theIsFailed = true;
+        land(lFlight);
+        throw;
+      }
+      lFlight->theHeadResponse = lRes;
+      land(lFlight);
+      return lRes;
+    }
+
+    // copy the result before leaving because the leader deletes the flight
+    if (lFlight->theHeadException) {
+      HeadException lException(*lFlight->theHeadException);
+      leave(lFlight);
+      throw lException;
+    } else if (lFlight->theConnectionException) {
+      AWSConnectionException lException(*lFlight->theConnectionException);
+      leave(lFlight);
+      throw lException;
+    } else if (lFlight->theIsFailed) {
+      leave(lFlight);
+      return aConnection->head(aBucketName, aKey);
+    }
+
+    HeadResponsePtr lRes = lFlight->theHeadResponse;
+    leave(lFlight);
+    return lRes;
+  }
+
+  HeadResponsePtr
+  S3Coalescer::tryHead(S3Connection* aConnection,
+                       const std::string& aBucketName,
+                       const std::string& aKey)
+  {
+    bool lIsLeader;
+    Flight* lFlight = join("TRYHEAD\n" + aBucketName + "\n" + aKey, lIsLeader);
+
+    if (lIsLeader) {
+      HeadResponsePtr lRes;
+      try {
+        lRes = aConnection->tryHead(aBucketName, aKey);
+      } catch (AWSConnectionException& e) {
+        lFlight->theConnectionException = new AWSConnectionException(e);
+        land(lFlight);
+        throw;
+      } catch (...) {
+        lFlight->theIsFailed = true;
+        land(lFlight);
+        throw;
+      }
+      lFlight->theHeadResponse = lRes;
+      land(lFlight);
+      return lRes;
+    }
+
+    if (lFlight->theConnectionException) {
+      AWSConnectionException lException(*lFlight->theConnectionException);
+      leave(lFlight);
+      throw lException;
+    } else if (lFlight->theIsFailed) {
+      leave(lFlight);
+      return aConnection->tryHead(aBucketName, aKey);
+    }
+
+    HeadResponsePtr lRes = lFlight->theHeadResponse;
+    leave(lFlight);
+    return lRes;
+  }
+
+  // copies aLength bytes from one file to another
+  static bool
+  copyFile(int aSrc, off_t aSrcOffset, int aDst, off_t aDstOffset, long long aLength)
+  {
+    char lBuffer[65536];
+    long long lCopied = 0;
+    while (lCopied < aLength) {
+      size_t lSize = aLength - lCopied < (long long) sizeof(lBuffer)
+                     ? (size_t) (aLength - lCopied) : sizeof(lBuffer);
+      ssize_t lRead = pread(aSrc, lBuffer, lSize, aSrcOffset + lCopied);
+      if (lRead < 0 && errno == EINTR)
+        continue;
+      if (lRead <= 0)
+        return false;
+      ssize_t lWritten = 0;
+      while (lWritten < lRead) {
+        ssize_t lRes = pwrite(aDst, lBuffer + lWritten, lRead - lWritten,
+                              aDstOffset + lCopied + lWritten);
+        if (lRes < 0 && errno == EINTR)
+          continue;
+        if (lRes < 0)
+          return false;
+        lWritten += lRes;
+      }
+      lCopied += lRead;
+    }
+    return true;
+  }
+
+  GetResponsePtr
+  S3Coalescer::get(S3Connection* aConnection,
+                   const std::string& aBucketName,
+                   const std::string& aKey,
+                   int aFileDescriptor,
+                   off_t aOffset)
+  {
+    bool lIsLeader;
+    Flight* lFlight = join("GET\n" + aBucketName + "\n" + aKey, lIsLeader);
+
+    if (lIsLeader) {
+      GetResponsePtr lRes;
+      lFlight->theFileDescriptor = aFileDescriptor;
+      lFlight->theOffset = aOffset;
+      try {
+        lRes = aConnection->get(aBucketName, aKey, aFileDescriptor, aOffset);
+      } catch (GetException& e) {
+        lFlight->theGetException = new GetException(e);
+        land(lFlight);
+        throw;
+      } catch (AWSConnectionException& e) {
+        lFlight->theConnectionException = new AWSConnectionException(e);
+        land(lFlight);
+        throw;
+      } catch (...) {
+        lFlight->theIsFailed = true;
+        land(lFlight);
+        throw;
+      }
+      lFlight->theGetResponse = lRes;
+      land(lFlight);
+      return lRes;
+    }
+
+    // copy the result before leaving because the leader deletes the flight
+    if (lFlight->theGetException) {
+      GetException lException(*lFlight->theGetException);
+      leave(lFlight);
+      throw lException;
+    } else if (lFlight->theConnectionException) {
+      AWSConnectionException lException(*lFlight->theConnectionException);
+      leave(lFlight);
+      throw lException;
+    }
+
+    GetResponsePtr lRes = lFlight->theGetResponse;
+    bool lCopied = !lFlight->theIsFailed
+                   && copyFile(lFlight->theFileDescriptor, lFlight->theOffset,
+                               aFileDescriptor, aOffset, lRes->getContentLength());
+    leave(lFlight);
+
+    if (!lCopied)
+      return aConnection->get(aBucketName, aKey, aFileDescriptor, aOffset);
+    return lRes;
+  }
+
+  uint64_t
+  S3Coalescer::getNumberOfRequests() const
+  {
+    pthread_mutex_lock(&theMutex);
+    uint64_t lRes = theNumberOfRequests;
+    pthread_mutex_unlock(&theMutex);
+    return lRes;
+  }
+
+  uint64_t
+  S3Coalescer::getNumberOfCoalescedRequests() const
+  {
+    pthread_mutex_lock(&theMutex);
+    uint64_t lRes = theNumberOfCoalescedRequests;
+    pthread_mutex_unlock(&theMutex);
+    return lRes;
+  }
+
+} /* namespace aws */
@@ -14,13 +14,215 @@
  * limitations under the License.
  */
 #include "common.h"
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
 #include <libaws/s3response.h>
+#include <libaws/s3bucketindex.h>
+#include <libaws/s3exception.h>
+#include <libaws/exception.h>
+#include <libaws/mutex.h>
+#include <libaws/connectionpool.h>
 
+#include "callingformat.h"
 #include "s3/s3connection.h"
+#include "s3/s3asyncrequest.h"
+#include "s3/s3response.h"
 #include "api/s3connectionimpl.h"
+#include "api/awsreactorimpl.h"
 
 namespace aws {
 
+  // an asynchronous request of a S3ConnectionImpl that is performed by a
+  // reactor; keeps the connection alive until the request is done
+  class S3AsyncRequestImpl : public AWSAsyncRequest
+  {
+    public:
+      S3AsyncRequestImpl(S3ConnectionImpl* aConnection,
+                         s3::S3AsyncRequest* aRequest,
+                         S3AsyncHandler* aHandler)
+        : theConnection(aConnection),
+          theRequest(aRequest),
+          theHandler(aHandler) {}
+
+      virtual ~S3AsyncRequestImpl()
+      {
+        if (theConnection->theAsyncRequest == this)
+          theConnection->theAsyncRequest = 0;
+        delete theRequest;
+      }
+
+      virtual CURL*
+      getHandle() const { return theConnection->theConnection->getHandle(); }
+
+      virtual void
+      complete(int aCurlCode)
+      {
+        // the handler may start the next request of the connection
+        theConnection->theAsyncRequest = 0;
+        theConnection->completeAsync(theRequest, theHandler, aCurlCode);
+      }
+
+    protected:
+      SmartPtr<S3ConnectionImpl> theConnection;
+      s3::S3AsyncRequest*        theRequest;
+      S3AsyncHandler*            theHandler;
+  };
+
+  // the parts of a multipartCopy; the parts are taken one after the other
+  // by the threads copying them (each on its own connection)
+  class MultipartCopy
+  {
+    public:
+      MultipartCopy(const std::string& aSrcBucketName, const std::string& aSrcKey,
+                    const std::string& aDstBucketName, const std::string& aDstKey,
+                    const std::string& aUploadId, long long aSize, long long aPartSize,
+                    ConnectionPool<S3ConnectionPtr>* aPool)
+        : theSrcBucketName(aSrcBucketName),
+          theSrcKey(aSrcKey),
+          theDstBucketName(aDstBucketName),
+          theDstKey(aDstKey),
+          theUploadId(aUploadId),
+          theSize(aSize),
+          thePartSize(aPartSize),
+          thePool(aPool),
+          theETags((aSize + aPartSize - 1) / aPartSize),
+          theNextPart(0) {}
+
+      // copies parts on aConnection until all parts are taken or a part
+      // couldn't be copied (by any of the threads)
+      void
+      copyParts(s3::S3Connection* aConnection)
+      {
+        while (true) {
+          theMutex.lock();
+          bool lFailed = theCopyError.get() || theConnectionError.get();
+          size_t lPart = theNextPart++;
+          theMutex.unlock();
+          if (lFailed || lPart >= theETags.size())
+            return;
+
+          long long lFirstByte = lPart * thePartSize;
+          long long lLastByte = std::min(lFirstByte + thePartSize, theSize) - 1;
+          try {
+            std::auto_ptr<s3::CopyResponse> lRes(
+                aConnection->copyPart(theSrcBucketName, theSrcKey, theDstBucketName, theDstKey,
+                                      theUploadId, lPart + 1, lFirstByte, lLastByte));
+            theETags[lPart] = lRes->getETag();
+          } catch (CopyException& e) {
+            theMutex.lock();
+            if (!theCopyError.get() && !theConnectionError.get())
+              theCopyError.reset(new CopyException(e));
+            theMutex.unlock();
+          } catch (AWSConnectionException& e) {
+            theMutex.lock();
+            if (!theCopyError.get() && !theConnectionError.get())
+              theConnectionError.reset(new AWSConnectionException(e));
+            theMutex.unlock();
+          }
+        }
+      }
+
+      // entry of the threads, copies on a connection of the pool
+      static void*
+      run(void* aCopy)
+      {
+        MultipartCopy* lCopy = static_cast<MultipartCopy*>(aCopy);
+        try {
+          S3ConnectionPtr lConnection = lCopy->thePool->getConnection();
+          lCopy->copyParts(static_cast<S3ConnectionImpl*>(lConnection.get())->theConnection);
+          lCopy->thePool->release(lConnection);
+        } catch (AWSException&) {
+          // no connection, the parts are copied by the other threads
+        }
+        return 0;
+      }
+
+      // throws the error of the first part that couldn't be copied (if any)
+      void
+      rethrow() const
+      {
+        if (theCopyError.get())
+          throw CopyException(*theCopyError);
+        if (theConnectionError.get())
+          throw AWSConnectionException(*theConnectionError);
+      }
+
+      bool
+      failed() const { return theCopyError.get() || theConnectionError.get(); }
+
+      std::string                           theSrcBucketName;
+      std::string                           theSrcKey;
+      std::string                           theDstBucketName;
+      std::string                           theDstKey;
+      std::string                           theUploadId;
+      long long                             theSize;
+      long long                             thePartSize;
+      ConnectionPool<S3ConnectionPtr>*      thePool;
+      std::vector<std::string>              theETags; // of the parts 1 to n
+
+      AWSMutex                              theMutex; // guards the members below
+      size_t                                theNextPart;
+      std::auto_ptr<CopyException>          theCopyError;
+      std::auto_ptr<AWSConnectionException> theConnectionError;
+  };
+
+  static CallingFormat*
+  toCallingFormat(S3Connection::CallingFormatType aType)
+  {
+    if (aType == S3Connection::VIRTUAL_HOST_STYLE)
+      return CallingFormat::getVirtualHostCallingFormat();
+    return CallingFormat::getRegularCallingFormat();
+  }
+
+  void
+  S3ConnectionImpl::setCallingFormat(CallingFormatType aType)
+  {
+    theConnection->setCallingFormat(toCallingFormat(aType));
+  }
+
+  void
+  S3ConnectionImpl::setCallingFormat(const std::string& aBucketName, CallingFormatType aType)
+  {
+    theConnection->setCallingFormat(aBucketName, toCallingFormat(aType));
+  }
+
+  void
+  S3ConnectionImpl::setCompression(CompressionType aType)
+  {
+    theConnection->setCompression(aType == GZIP_COMPRESSION);
+  }
+
+  void
+  S3ConnectionImpl::setHttpVersion(HttpVersionType aVersion)
+  {
+    if (aVersion == HTTP_2)
+      theConnection->setHttpVersion(s3::S3Connection::HTTP_2);
+    else if (aVersion == HTTP_1_1)
+      theConnection->setHttpVersion(s3::S3Connection::HTTP_1_1);
+    else
+      theConnection->setHttpVersion(s3::S3Connection::HTTP_1_0);
+  }
+
+  void
+  S3ConnectionImpl::setHedging(unsigned int aPercentile, unsigned int aBudget)
+  {
+    theConnection->setHedging(aPercentile, aBudget);
+  }
+
+  uint64_t
+  S3ConnectionImpl::getNumberOfHedgedRequests() const
+  {
+    return theConnection->getNumberOfHedgedRequests();
+  }
+
+  uint64_t
+  S3ConnectionImpl::getNumberOfHedgeWins() const
+  {
+    return theConnection->getNumberOfHedgeWins();
+  }
+
   CreateBucketResponsePtr
   S3ConnectionImpl::createBucket(const std::string& aBucketName)
   {
@@ -72,6 +274,19 @@ namespace aws {
     return new PutResponse(theConnection->put(aBucketName, aKey, aData, aContentType, aMetaDataMap, aSize, aReducedRedunancy));
   }
 
+  PutResponsePtr
+  S3ConnectionImpl::put(const std::string& aBucketName,
+                        const std::string& aKey,
+                        int aFileDescriptor,
+                        off_t aOffset,
+                        const std::string& aContentType,
+                        long aSize,
+                        const std::map<std::string, std::string>* aMetaDataMap,
+                        bool aReducedRedunancy)
+  {
+    return new PutResponse(theConnection->put(aBucketName, aKey, aFileDescriptor, aOffset, aContentType, aMetaDataMap, aSize, aReducedRedunancy));
+  }
+
   std::string
   S3ConnectionImpl::getQueryString(const std::string& aBucketName,
                                    const std::string& aKey,
@@ -96,6 +311,105 @@ namespace aws {
     return new GetResponse(theConnection->get(aBucketName, aKey, aOldEtag));
   }
 
+  GetResponsePtr
+  S3ConnectionImpl::get(const std::string& aBucketName, const std::string& aKey,
+                        char* aBuffer, size_t aBufferSize,
+                        const std::map<std::string, std::string>* aMetaDataMap)
+  {
+    return new GetResponse(theConnection->get(aBucketName, aKey, aBuffer, aBufferSize, aMetaDataMap));
+  }
+
+  GetResponsePtr
+  S3ConnectionImpl::get(const std::string& aBucketName, const std::string& aKey,
+                        const struct iovec* aIovec, int aIovecCount,
+                        const std::map<std::string, std::string>* aMetaDataMap)
+  {
+    return new GetResponse(theConnection->get(aBucketName, aKey, aIovec, aIovecCount, aMetaDataMap));
+  }
+
+  GetResponsePtr
+  S3ConnectionImpl::get(const std::string& aBucketName, const std::string& aKey,
+                        int aFileDescriptor, off_t aOffset,
+                        const std::map<std::string, std::string>* aMetaDataMap)
+  {
+    return new GetResponse(theConnection->get(aBucketName, aKey, aFileDescriptor, aOffset, aMetaDataMap));
+  }
+
+  CopyResponsePtr
+  S3ConnectionImpl::copy(const std::string& aSrcBucketName,
+                         const std::string& aSrcKey,
+                         const std::string& aDstBucketName,
+                         const std::string& aDstKey,
+                         const std::map<std::string, std::string>* aMetaDataMap,
+                         const std::string& aContentType)
+  {
+    return new CopyResponse(theConnection->copy(aSrcBucketName, aSrcKey,
+                                                aDstBucketName, aDstKey,
+                                                aMetaDataMap, aContentType));
+  }
+
+  // S3 takes at most 10000 parts of at least 5 MB per upload
+  static const long long MULTIPART_COPY_PART_SIZE = 512LL * 1024 * 1024;
+  static const long long MULTIPART_COPY_MAX_PARTS = 10000;
+  static const size_t MULTIPART_COPY_MAX_THREADS = 8;
+
+  CopyResponsePtr
+  S3ConnectionImpl::multipartCopy(const std::string& aSrcBucketName,
+                                  const std::string& aSrcKey,
+                                  const std::string& aDstBucketName,
+                                  const std::string& aDstKey,
+                                  ConnectionPool<S3ConnectionPtr>* aPool,
+                                  long long aPartSize)
+  {
+    long long lSize = 0;
+    std::auto_ptr<s3::CopyResponse> lInitiate(
+        theConnection->initiateMultipartCopy(aSrcBucketName, aSrcKey,
+                                             aDstBucketName, aDstKey, lSize));
+    const std::string& lUploadId = lInitiate->getUploadId();
+
+    if (lSize == 0) {
+      // an upload needs at least one part, but a range can't be empty
+      theConnection->abortMultipartCopy(aDstBucketName, aDstKey, lUploadId);
+      return copy(aSrcBucketName, aSrcKey, aDstBucketName, aDstKey);
+    }
+
+    if (aPartSize <= 0) {
+      aPartSize = std::max(MULTIPART_COPY_PART_SIZE,
+                           (lSize + MULTIPART_COPY_MAX_PARTS - 1) / MULTIPART_COPY_MAX_PARTS);
+    }
+    MultipartCopy lCopy(aSrcBucketName, aSrcKey, aDstBucketName, aDstKey,
+                        lUploadId, lSize, aPartSize, aPool);
+
+    // this thread copies parts as well, i.e. the copy doesn't depend on
+    // the other threads being started
+    std::vector<pthread_t> lThreads;
+    if (aPool) {
+      size_t lNumberOfThreads = std::min(lCopy.theETags.size(), MULTIPART_COPY_MAX_THREADS);
+      for (size_t i = 1; i < lNumberOfThreads; ++i) {
+        pthread_t lThread;
+        if (pthread_create(&lThread, 0, &MultipartCopy::run, &lCopy) != 0)
+          break;
+        lThreads.push_back(lThread);
+      }
+    }
+    lCopy.copyParts(theConnection);
+    for (size_t i = 0; i < lThreads.size(); ++i)
+      pthread_join(lThreads[i], 0);
+
+    if (lCopy.failed()) {
+      theConnection->abortMultipartCopy(aDstBucketName, aDstKey, lUploadId);
+      lCopy.rethrow();
+    }
+
+    try {
+      return new CopyResponse(theConnection->completeMultipartCopy(aDstBucketName, aDstKey,
+                                                                   lUploadId, lCopy.theETags));
+    } catch (AWSException&) {
+      theConnection->abortMultipartCopy(aDstBucketName, aDstKey, lUploadId);
+      throw;
+    }
+  }
+
   DeleteResponsePtr
   S3ConnectionImpl::del(const std::string& aBucketName, const std::string& aKey)
   {
@@ -108,12 +422,70 @@ namespace aws {
     return new DeleteAllResponse(theConnection->deleteAll(aBucketName, aPrefix));
   }
 
+  DeleteAllResponsePtr
+  S3ConnectionImpl::deleteAll(const std::string& aBucketName, const std::string& aPrefix,
+                              S3BucketIndex* aIndex)
+  {
+    if (aIndex->getBucketName() != aBucketName)
+      return deleteAll(aBucketName, aPrefix);
+
+    std::vector<S3BucketIndex::Object> lObjects;
+    bool lIsIndexed = aIndex->list(aPrefix, "", lObjects);
+    std::vector<std::string> lKeys;
+    for (std::vector<S3BucketIndex::Object>::const_iterator lIter = lObjects.begin();
+         lIter != lObjects.end(); ++lIter) {
+      lKeys.push_back((*lIter).KeyValue);
+    }
+
+    DeleteAllResponsePtr lRes;
+    try {
+      if (lIsIndexed)
+        lRes = new DeleteAllResponse(theConnection->deleteAll(aBucketName, aPrefix, lKeys));
+      else
+        lRes = new DeleteAllResponse(theConnection->deleteAll(aBucketName, aPrefix));
+    } catch (...) {
+      // some keys may have been deleted
+      aIndex->invalidatePrefix(aPrefix);
+      throw;
+    }
+    aIndex->invalidatePrefix(aPrefix);
+    return lRes;
+  }
+
   HeadResponsePtr
   S3ConnectionImpl::head(const std::string& aBucketName, const std::string& aKey)
   {
     return new HeadResponse(theConnection->head(aBucketName, aKey));
   }
 
+  HeadResponsePtr
+  S3ConnectionImpl::tryHead(const std::string& aBucketName, const std::string& aKey)
+  {
+    return new HeadResponse(theConnection->head(aBucketName, aKey, false));
+  }
+
+  GetResponsePtr
+  S3ConnectionImpl::tryGet(const std::string& aBucketName, const std::string& aKey,
+                           const std::map<std::string, std::string>* aMetaDataMap)
+  {
+    return new GetResponse(theConnection->get(aBucketName, aKey, aMetaDataMap, false));
+  }
+
+  DeleteResponsePtr
+  S3ConnectionImpl::tryDel(const std::string& aBucketName, const std::string& aKey)
+  {
+    return new DeleteResponse(theConnection->del(aBucketName, aKey, false));
+  }
+
+  ListBucketResponsePtr
+  S3ConnectionImpl::tryListBucket(const std::string& aBucketName, const std::string& aPrefix,
+                                  const std::string& aMarker, const std::string& aDelimiter,
+                                  int aMaxKeys)
+  {
+    return new ListBucketResponse(theConnection->listBucket(aBucketName, aPrefix, aMarker,
+                                                            aDelimiter, aMaxKeys, false));
+  }
+
   BucketLoggingStatusResponsePtr
   S3ConnectionImpl::bucketLoggingStatus(const std::string& aBucketName)
   {
@@ -139,6 +511,8 @@ namespace aws {
   S3ConnectionImpl::S3ConnectionImpl(const std::string& aAccessKeyId, 
                                      const std::string& aSecretAccessKey,
                                      const std::string& aCustomHost)
+    : theAsyncReactor(0),
+      theAsyncRequest(0)
   {
     theConnection = new s3::S3Connection(aAccessKeyId, aSecretAccessKey, aCustomHost);
   }
@@ -148,4 +522,88 @@ namespace aws {
     delete theConnection;
   }
 
+  void
+  S3ConnectionImpl::startAsync(AWSReactor* aReactor, s3::S3AsyncRequest* aRequest,
+                               S3AsyncHandler* aHandler)
+  {
+    theAsyncReactor = static_cast<AWSReactorImpl*>(aReactor);
+    theAsyncRequest = new S3AsyncRequestImpl(this, aRequest, aHandler);
+    theAsyncReactor->addRequest(theAsyncRequest);
+  }
+
+  void
+  S3ConnectionImpl::cancelAsync()
+  {
+    if (theAsyncRequest)
+      theAsyncReactor->cancelRequest(theAsyncRequest);
+  }
+
+  void
+  S3ConnectionImpl::completeAsync(s3::S3AsyncRequest* aRequest,
+                                  S3AsyncHandler* aHandler, int aCurlCode)
+  {
+    bool lFailed = false;
+    try {
+      theConnection->finishAsync(aRequest, aCurlCode);
+    } catch (AWSException& e) {
+      aHandler->failed(e);
+      lFailed = true;
+    }
+
+    if (!lFailed) {
+      s3::S3Response* lRes = aRequest->releaseResponse();
+      switch (aRequest->theActionType) {
+        case s3::S3Connection::HEAD:
+          aHandler->headDone(new HeadResponse(static_cast<s3::HeadResponse*>(lRes)));
+          break;
+        case s3::S3Connection::GET:
+          aHandler->getDone(new GetResponse(static_cast<s3::GetResponse*>(lRes)));
+          break;
+        case s3::S3Connection::PUT:
+          aHandler->putDone(new PutResponse(static_cast<s3::PutResponse*>(lRes)));
+          break;
+        case s3::S3Connection::DELETE:
+          aHandler->deleteDone(new DeleteResponse(static_cast<s3::DeleteResponse*>(lRes)));
+          break;
+        default:
+          delete lRes;
+      }
+    }
+
+    // outside of the handling of the exception
+    aHandler->completed();
+  }
+
+  void
+  S3ConnectionImpl::headAsync(AWSReactor* aReactor, const std::string& aBucketName,
+                              const std::string& aKey, S3AsyncHandler* aHandler)
+  {
+    startAsync(aReactor, theConnection->startHead(aBucketName, aKey), aHandler);
+  }
+
+  void
+  S3ConnectionImpl::getAsync(AWSReactor* aReactor, const std::string& aBucketName,
+                             const std::string& aKey, S3AsyncHandler* aHandler)
+  {
+    startAsync(aReactor, theConnection->startGet(aBucketName, aKey), aHandler);
+  }
+
+  void
+  S3ConnectionImpl::putAsync(AWSReactor* aReactor, const std::string& aBucketName,
+                             const std::string& aKey, const char* aData,
+                             const std::string& aContentType, long aSize,
+                             S3AsyncHandler* aHandler)
+  {
+    startAsync(aReactor,
+               theConnection->startPut(aBucketName, aKey, aData, aContentType, aSize),
+               aHandler);
+  }
+
+  void
+  S3ConnectionImpl::delAsync(AWSReactor* aReactor, const std::string& aBucketName,
+                             const std::string& aKey, S3AsyncHandler* aHandler)
+  {
+    startAsync(aReactor, theConnection->startDelete(aBucketName, aKey), aHandler);
+  }
+
 } /* namespace aws */
@@ -21,8 +21,12 @@
 
 namespace aws {
 
+  class AWSReactorImpl;
+  class AWSAsyncRequest;
+
   namespace s3 {
     class S3Connection;
+    class S3AsyncRequest;
   }
 
   class S3ConnectionImpl : public S3Connection
@@ -30,6 +34,27 @@ namespace aws {
     public:
       virtual ~S3ConnectionImpl();
 
+      void
+      setCallingFormat(CallingFormatType aType);
+
+      void
+      setCallingFormat(const std::string& aBucketName, CallingFormatType aType);
+
+      void
+      setCompression(CompressionType aType);
+
+      void
+      setHttpVersion(HttpVersionType aVersion);
+
+      void
+      setHedging(unsigned int aPercentile, unsigned int aBudget);
+
+      uint64_t
+      getNumberOfHedgedRequests() const;
+
+      uint64_t
+      getNumberOfHedgeWins() const;
+
       CreateBucketResponsePtr
       createBucket(const std::string& aBucketName);
 
@@ -61,6 +86,16 @@ namespace aws {
           const std::map<std::string, std::string>* aMetaDataMap = 0,
           bool aReducedRedunancy = false);
 
+      PutResponsePtr
+      put(const std::string& aBucketName,
+          const std::string& aKey,
+          int aFileDescriptor,
+          off_t aOffset,
+          const std::string& aContentType,
+          long aSize = -1,
+          const std::map<std::string, std::string>* aMetaDataMap = 0,
+          bool aReducedRedunancy = false);
+
       std::string
       getQueryString(const std::string& aBucket,
                      const std::string& aKey,
@@ -74,15 +109,65 @@ namespace aws {
       GetResponsePtr
       get(const std::string& aBucketName, const std::string& aKey, const std::string& aOldEtag);
 
+      GetResponsePtr
+      get(const std::string& aBucketName, const std::string& aKey,
+          char* aBuffer, size_t aBufferSize,
+          const std::map<std::string, std::string>* aMetaDataMap = 0);
+
+      GetResponsePtr
+      get(const std::string& aBucketName, const std::string& aKey,
+          const struct iovec* aIovec, int aIovecCount,
+          const std::map<std::string, std::string>* aMetaDataMap = 0);
+
+      GetResponsePtr
+      get(const std::string& aBucketName, const std::string& aKey,
+          int aFileDescriptor, off_t aOffset,
+          const std::map<std::string, std::string>* aMetaDataMap = 0);
+
+      CopyResponsePtr
+      copy(const std::string& aSrcBucketName,
+           const std::string& aSrcKey,
+           const std::string& aDstBucketName,
+           const std::string& aDstKey,
+           const std::map<std::string, std::string>* aMetaDataMap = 0,
+           const std::string& aContentType = "");
+
+      CopyResponsePtr
+      multipartCopy(const std::string& aSrcBucketName,
+                    const std::string& aSrcKey,
+                    const std::string& aDstBucketName,
+                    const std::string& aDstKey,
+                    ConnectionPool<S3ConnectionPtr>* aPool = 0,
+                    long long aPartSize = 0);
+
       DeleteResponsePtr
       del(const std::string& aBucketName, const std::string& aKey);
 
       DeleteAllResponsePtr
       deleteAll(const std::string& aBucketName, const std::string& aPrefix);
 
+      DeleteAllResponsePtr
+      deleteAll(const std::string& aBucketName, const std::string& aPrefix,
+                S3BucketIndex* aIndex);
+
       HeadResponsePtr
       head(const std::string& aBucketName, const std::string& aKey);
 
+      HeadResponsePtr
+      tryHead(const std::string& aBucketName, const std::string& aKey);
+
+      GetResponsePtr
+      tryGet(const std::string& aBucketName, const std::string& aKey,
+             const std::map<std::string, std::string>* aMetaDataMap = 0);
+
+      DeleteResponsePtr
+      tryDel(const std::string& aBucketName, const std::string& aKey);
+
+      ListBucketResponsePtr
+      tryListBucket(const std::string& aBucketName, const std::string& aPrefix,
+                    const std::string& aMarker, const std::string& aDelimiter,
+                    int aMaxKeys = -1);
+
       BucketLoggingStatusResponsePtr
       bucketLoggingStatus(const std::string& aBucketName);
 
@@ -94,13 +179,51 @@ namespace aws {
       DisableBucketLoggingResponsePtr
       disableBucketLogging(const std::string& aBucketName);
 
+      void
+      headAsync(AWSReactor* aReactor, const std::string& aBucketName,
+                const std::string& aKey, S3AsyncHandler* aHandler);
+
+      void
+      getAsync(AWSReactor* aReactor, const std::string& aBucketName,
+               const std::string& aKey, S3AsyncHandler* aHandler);
+
+      void
+      putAsync(AWSReactor* aReactor, const std::string& aBucketName,
+               const std::string& aKey, const char* aData,
+               const std::string& aContentType, long aSize,
+               S3AsyncHandler* aHandler);
+
+      void
+      delAsync(AWSReactor* aReactor, const std::string& aBucketName,
+               const std::string& aKey, S3AsyncHandler* aHandler);
+
+      void
+      cancelAsync();
+
     protected:
+      friend class S3AsyncRequestImpl;
+      friend class MultipartCopy;
+
+      // hands aRequest over to aReactor
+      void
+      startAsync(AWSReactor* aReactor, s3::S3AsyncRequest* aRequest,
+                 S3AsyncHandler* aHandler);
+
+      // called by the reactor once aRequest is done; notifies aHandler
+      void
+      completeAsync(s3::S3AsyncRequest* aRequest, S3AsyncHandler* aHandler,
+                    int aCurlCode);
+
       // only the factory can create us
       friend class AWSConnectionFactoryImpl;
       S3ConnectionImpl(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
                        const std::string& aCustomHost);
 
       s3::S3Connection* theConnection;
+
+      // the request in flight, if any, and the reactor performing it
+      AWSReactorImpl*   theAsyncReactor;
+      AWSAsyncRequest*  theAsyncRequest;
   }; /* class S3ConnectionImpl */
 } /* namespace aws */
 #endif
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <libaws/s3objectcache.h>
+#include <libaws/s3connection.h>
+#include <libaws/s3response.h>
+
+#include <cstring>
+#include <istream>
+
+namespace aws {
+
+  struct S3ObjectCache::Entry
+  {
+    std::string                  theCacheKey;
+    S3CachedObjectPtr            theObject;
+    time_t                       theValidUntil;
+    std::list<Entry*>::iterator  theLRUPosition;
+  };
+
+  // FNV-1a with a different offset basis for every row of the sketch
+  static unsigned int
+  hashKey(const std::string& aKey, unsigned int aRow)
+  {
+    unsigned int lHash = 2166136261u ^ (aRow * 0x9e3779b9u);
+    for (std::string::size_type i = 0; i < aKey.size(); ++i) {
+      lHash ^= (unsigned char) aKey[i];
+      lHash *= 16777619u;
+    }
+    return lHash;
+  }
+
+  S3ObjectCache::S3ObjectCache(size_t aCapacity, time_t aTimeToLive,
+                               size_t aMaxObjectSize)
+    : theCapacity(aCapacity),
+      theSize(0),
+      theSketchAdditions(0),
+      theNumberOfHits(0),
+      theNumberOfRevalidations(0),
+      theNumberOfMisses(0)
+  {
+    pthread_mutex_init(&theMutex, 0);
+    theDefaultPolicy.theTimeToLive = aTimeToLive;
+    theDefaultPolicy.theMaxObjectSize = aMaxObjectSize;
+    memset(theSketch, 0, sizeof(theSketch));
+  }
+
+  S3ObjectCache::~S3ObjectCache()
+  {
+    for (std::map<std::string, Entry*>::iterator lIter = theEntries.begin();
+         lIter != theEntries.end(); ++lIter) {
+      delete (*lIter).second;
+    }
+    pthread_mutex_destroy(&theMutex);
+  }
+
+  void
+  S3ObjectCache::setBucketPolicy(const std::string& aBucketName, time_t aTimeToLive,
+                                 size_t aMaxObjectSize)
+  {
+    Policy lPolicy;
+    lPolicy.theTimeToLive = aTimeToLive;
+    lPolicy.theMaxObjectSize = aMaxObjectSize;
+
+    pthread_mutex_lock(&theMutex);
+    theBucketPolicies[aBucketName] = lPolicy;
+    pthread_mutex_unlock(&theMutex);
+  }
+
+  const S3ObjectCache::Policy&
+  S3ObjectCache::getPolicy(const std::string& aBucketName) const
+  {
+    std::map<std::string, Policy>::const_iterator lIter = theBucketPolicies.find(aBucketName);
+    if (lIter == theBucketPolicies.end())
+      return theDefaultPolicy;
+    return (*lIter).second;
+  }
+
+  void
+  S3ObjectCache::recordAccess(const std::string& aCacheKey)
+  {
+    for (unsigned int i = 0; i < SKETCH_DEPTH; ++i) {
+      unsigned char& lCounter = theSketch[i][hashKey(aCacheKey, i) % SKETCH_WIDTH];
+      if (lCounter < 255)
+        ++lCounter;
+    }
+
+    // age the sketch such that old popularity fades out
+    if (++theSketchAdditions >= 10 * SKETCH_WIDTH) {
+      for (unsigned int i = 0; i < SKETCH_DEPTH; ++i)
+        for (unsigned int j = 0; j < SKETCH_WIDTH; ++j)
+          theSketch[i][j] >>= 1;
+      theSketchAdditions = 0;
+    }
+  }
+
+  unsigned int
+  S3ObjectCache::estimateFrequency(const std::string& aCacheKey) const
+  {
+    unsigned int lMin = 255;
+    for (unsigned int i = 0; i < SKETCH_DEPTH; ++i) {
+      unsigned int lCounter = theSketch[i][hashKey(aCacheKey, i) % SKETCH_WIDTH];
+      if (lCounter < lMin)
+        lMin = lCounter;
+    }
+    return lMin;
+  }
+
+  void
+  S3ObjectCache::remove(Entry* aEntry)
+  {
+    theSize -= aEntry->theObject->getData().size();
+    theLRUList.erase(aEntry->theLRUPosition);
+    theEntries.erase(aEntry->theCacheKey);
+    delete aEntry;
+  }
+
+  void
+  S3ObjectCache::insert(const std::string& aCacheKey, const S3CachedObjectPtr& aObject,
+                        const Policy& aPolicy)
+  {
+    size_t lObjectSize = aObject->getData().size();
+    if (lObjectSize > aPolicy.theMaxObjectSize || lObjectSize > theCapacity)
+      return;
+
+    std::map<std::string, Entry*>::iterator lIter = theEntries.find(aCacheKey);
+    if (lIter != theEntries.end())
+      remove((*lIter).second);
+
+    // the new object has to be more popular than each object it displaces
+    unsigned int lFrequency = estimateFrequency(aCacheKey);
+    size_t lFreed = 0;
+    std::list<Entry*>::reverse_iterator lVictim = theLRUList.rbegin();
+    while (theSize - lFreed + lObjectSize > theCapacity) {
+      if (lVictim == theLRUList.rend()
+          || estimateFrequency((*lVictim)->theCacheKey) >= lFrequency)
+        return; // not admitted
+      lFreed += (*lVictim)->theObject->getData().size();
+      ++lVictim;
+    }
+    while (lFreed > 0) {
+      Entry* lEntry = theLRUList.back();
+      lFreed -= lEntry->theObject->getData().size();
+      remove(lEntry);
+    }
+
+    Entry* lEntry = new Entry();
+    lEntry->theCacheKey = aCacheKey;
+    lEntry->theObject = aObject;
+    lEntry->theValidUntil = time(0) + aPolicy.theTimeToLive;
+    theLRUList.push_front(lEntry);
+    lEntry->theLRUPosition = theLRUList.begin();
+    theEntries.insert(std::pair<std::string, Entry*>(aCacheKey, lEntry));
+    theSize += lObjectSize;
+  }
+
+  S3CachedObjectPtr
+  S3ObjectCache::get(S3Connection* aConnection, const std::string& aBucketName,
+                     const std::string& aKey)
+  {
+    std::string lCacheKey = aBucketName + "/" + aKey;
+    S3CachedObjectPtr lCached;
+
+    pthread_mutex_lock(&theMutex);
+    Policy lPolicy = getPolicy(aBucketName);
+    recordAccess(lCacheKey);
+    std::map<std::string, Entry*>::iterator lIter = theEntries.find(lCacheKey);
+    if (lIter != theEntries.end()) {
+      Entry* lEntry = (*lIter).second;
+      theLRUList.splice(theLRUList.begin(), theLRUList, lEntry->theLRUPosition);
+      lCached = lEntry->theObject;
+      if (time(0) < lEntry->theValidUntil) {
+        ++theNumberOfHits;
+        pthread_mutex_unlock(&theMutex);
+        return lCached;
+      }
+    }
+    pthread_mutex_unlock(&theMutex);
+
+    GetResponsePtr lRes;
+    if (!lCached.isNull()) {
+      lRes = aConnection->get(aBucketName, aKey, "\"" + lCached->getETag() + "\"");
+      if (!lRes->isModified()) {
+        pthread_mutex_lock(&theMutex);
+        ++theNumberOfRevalidations;
+        lIter = theEntries.find(lCacheKey);
+        if (lIter != theEntries.end() && (*lIter).second->theObject == lCached)
+          (*lIter).second->theValidUntil = time(0) + lPolicy.theTimeToLive;
+        pthread_mutex_unlock(&theMutex);
+        return lCached;
+      }
+    } else {
+      lRes = aConnection->get(aBucketName, aKey);
+    }
+
+    S3CachedObjectPtr lObject = new S3CachedObject();
+    lObject->theETag = lRes->getETag();
+    lObject->theContentType = lRes->getContentType();
+    lObject->theMetaData = lRes->getMetaData();
+
+    std::istream& lInStream = lRes->getInputStream();
+    char lBuffer[4096];
+    lObject->theData.reserve(lRes->getContentLength());
+    while (lInStream.read(lBuffer, sizeof(lBuffer)) || lInStream.gcount() > 0)
+      lObject->theData.append(lBuffer, lInStream.gcount());
+
+    pthread_mutex_lock(&theMutex);
+    ++theNumberOfMisses;
+    insert(lCacheKey, lObject, lPolicy);
+    pthread_mutex_unlock(&theMutex);
+
+    return lObject;
+  }
+
+  void
+  S3ObjectCache::invalidate(const std::string& aBucketName, const std::string& aKey)
+  {
+    pthread_mutex_lock(&theMutex);
+    std::map<std::string, Entry*>::iterator lIter = theEntries.find(aBucketName + "/" + aKey);
+    if (lIter != theEntries.end())
+      remove((*lIter).second);
+    pthread_mutex_unlock(&theMutex);
+  }
+
+  uint64_t
+  S3ObjectCache::getNumberOfHits() const
+  {
+    pthread_mutex_lock(&theMutex);
+    uint64_t lRes = theNumberOfHits;
+    pthread_mutex_unlock(&theMutex);
+    return lRes;
+  }
+
+  uint64_t
+  S3ObjectCache::getNumberOfRevalidations() const
+  {
+    pthread_mutex_lock(&theMutex);
+    uint64_t lRes = theNumberOfRevalidations;
+    pthread_mutex_unlock(&theMutex);
+    return lRes;
+  }
+
+  uint64_t
+  S3ObjectCache::getNumberOfMisses() const
+  {
+    pthread_mutex_lock(&theMutex);
+    uint64_t lRes = theNumberOfMisses;
+    pthread_mutex_unlock(&theMutex);
+    return lRes;
+  }
+
+  size_t
+  S3ObjectCache::getSize() const
+  {
+    pthread_mutex_lock(&theMutex);
+    size_t lRes = theSize;
+    pthread_mutex_unlock(&theMutex);
+    return lRes;
+  }
+
+} /* namespace aws */
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common.h"
+
+#include <cstring>
+
+#include "callingformat.h"
+#include "s3/s3connection.h"
+#include "api/s3presignerimpl.h"
+
+namespace aws {
+
+  namespace {
+
+    const char BASE64_CHARS[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    const char HEX_CHARS[] = "0123456789ABCDEF";
+
+    // writes into a fixed size buffer and counts the characters
+    // that didn't fit such that the required size is known afterwards
+    struct UrlWriter
+    {
+      char*  theBuffer;
+      size_t theSize;
+      size_t thePos;
+
+      UrlWriter(char* aBuffer, size_t aSize)
+        : theBuffer(aBuffer), theSize(aSize), thePos(0) {}
+
+      void append(char c)
+      {
+        if (thePos < theSize)
+          theBuffer[thePos] = c;
+        ++thePos;
+      }
+
+      void append(const char* aChars, size_t aLength)
+      {
+        if (thePos + aLength <= theSize)
+          memcpy(theBuffer + thePos, aChars, aLength);
+        thePos += aLength;
+      }
+
+      void append(const std::string& aString)
+      {
+        append(aString.c_str(), aString.size());
+      }
+
+      // url encodes a key but keeps the slashes
+      void appendKey(const std::string& aKey)
+      {
+        for (std::string::const_iterator lIter = aKey.begin(); lIter != aKey.end(); ++lIter) {
+          unsigned char c = *lIter;
+          if (isalnum(c) || c == '/' || c == '-' || c == '_' || c == '.' || c == '~') {
+            append((char) c);
+          } else {
+            append('%');
+            append(HEX_CHARS[c >> 4]);
+            append(HEX_CHARS[c & 0x0F]);
+          }
+        }
+      }
+
+      bool fits() const { return thePos < theSize; }
+    };
+
+    // writes the decimal representation of aValue into aBuffer (not null terminated)
+    size_t
+    formatTime(time_t aValue, char* aBuffer)
+    {
+      char lTmp[24];
+      size_t lLength = 0;
+      unsigned long long lValue = aValue < 0 ? 0 : (unsigned long long) aValue;
+      do {
+        lTmp[lLength++] = '0' + (char) (lValue % 10);
+        lValue /= 10;
+      } while (lValue);
+      for (size_t i = 0; i < lLength; ++i)
+        aBuffer[i] = lTmp[lLength - i - 1];
+      return lLength;
+    }
+
+  } /* anonymous namespace */
+
+  S3PresignerImpl::S3PresignerImpl(const std::string& aAccessKeyId,
+                                   const std::string& aSecretAccessKey,
+                                   const std::string& aCustomHost,
+                                   bool aIsSecure)
+    : theAccessKeyId(aAccessKeyId),
+      theHost(aCustomHost.size() == 0 ? s3::S3Connection::DEFAULT_HOST : aCustomHost),
+      theIsSecure(aIsSecure),
+      theCallingFormat(S3Connection::PATH_STYLE)
+  {
+    // keys longer than the block size are hashed first (see rfc 2104)
+    unsigned char lKey[SHA_CBLOCK];
+    memset(lKey, 0, SHA_CBLOCK);
+    if (aSecretAccessKey.size() > SHA_CBLOCK) {
+      SHA1((const unsigned char*) aSecretAccessKey.c_str(), aSecretAccessKey.size(), lKey);
+    } else {
+      memcpy(lKey, aSecretAccessKey.c_str(), aSecretAccessKey.size());
+    }
+
+    unsigned char lPad[SHA_CBLOCK];
+    for (int i = 0; i < SHA_CBLOCK; ++i)
+      lPad[i] = lKey[i] ^ 0x36;
+    SHA1_Init(&theInnerCtx);
+    SHA1_Update(&theInnerCtx, lPad, SHA_CBLOCK);
+
+    for (int i = 0; i < SHA_CBLOCK; ++i)
+      lPad[i] = lKey[i] ^ 0x5c;
+    SHA1_Init(&theOuterCtx);
+    SHA1_Update(&theOuterCtx, lPad, SHA_CBLOCK);
+
+    memset(lKey, 0, SHA_CBLOCK);
+    memset(lPad, 0, SHA_CBLOCK);
+  }
+
+  S3PresignerImpl::~S3PresignerImpl()
+  {
+    memset(&theInnerCtx, 0, sizeof(SHA_CTX));
+    memset(&theOuterCtx, 0, sizeof(SHA_CTX));
+  }
+
+  void
+  S3PresignerImpl::setCallingFormat(S3Connection::CallingFormatType aType)
+  {
+    theCallingFormat = aType;
+  }
+
+  size_t
+  S3PresignerImpl::sign(const char* aStringToSign, size_t aLength, char* aSignature) const
+  {
+    unsigned char lDigest[SHA_DIGEST_LENGTH];
+
+    // the precomputed states are only read, hence, signing is thread safe
+    SHA_CTX lCtx = theInnerCtx;
+    SHA1_Update(&lCtx, aStringToSign, aLength);
+    SHA1_Final(lDigest, &lCtx);
+
+    lCtx = theOuterCtx;
+    SHA1_Update(&lCtx, lDigest, SHA_DIGEST_LENGTH);
+    SHA1_Final(lDigest, &lCtx);
+
+    // base64 encode and url encode in one pass
+    size_t lPos = 0;
+    for (size_t i = 0; i < SHA_DIGEST_LENGTH; i += 3) {
+      unsigned int lTriple = lDigest[i] << 16;
+      size_t lRemaining = SHA_DIGEST_LENGTH - i;
+      if (lRemaining > 1) lTriple |= lDigest[i + 1] << 8;
+      if (lRemaining > 2) lTriple |= lDigest[i + 2];
+
+      for (size_t j = 0; j < 4; ++j) {
+        char c = (j <= lRemaining) ? BASE64_CHARS[(lTriple >> (18 - 6 * j)) & 0x3F] : '=';
+        if (c == '+') {
+          aSignature[lPos++] = '%'; aSignature[lPos++] = '2'; aSignature[lPos++] = 'B';
+        } else if (c == '/') {
+          aSignature[lPos++] = '%'; aSignature[lPos++] = '2'; aSignature[lPos++] = 'F';
+        } else if (c == '=') {
+          aSignature[lPos++] = '%'; aSignature[lPos++] = '3'; aSignature[lPos++] = 'D';
+        } else {
+          aSignature[lPos++] = c;
+        }
+      }
+    }
+    memset(lDigest, 0, SHA_DIGEST_LENGTH);
+    return lPos;
+  }
+
+  size_t
+  S3PresignerImpl::getQueryString(const std::string& aBucketName,
+                                  const std::string& aKey,
+                                  time_t aExpiration,
+                                  char* aBuffer,
+                                  size_t aBufferSize) const
+  {
+    UrlWriter lWriter(aBuffer, aBufferSize);
+    bool lVirtualHost = theCallingFormat == S3Connection::VIRTUAL_HOST_STYLE
+        && VirtualHostCallingFormat::isDnsCompatible(theIsSecure, aBucketName);
+
+    lWriter.append(theIsSecure ? "https://" : "http://", theIsSecure ? 8 : 7);
+    if (lVirtualHost) {
+      lWriter.append(aBucketName);
+      lWriter.append('.');
+      lWriter.append(theHost);
+      lWriter.append('/');
+    } else {
+      lWriter.append(theHost);
+      lWriter.append('/');
+      lWriter.append(aBucketName);
+      lWriter.append('/');
+    }
+    size_t lKeyBegin = lWriter.thePos;
+    lWriter.appendKey(aKey);
+    size_t lKeyEnd = lWriter.thePos;
+
+    char lExpires[24];
+    size_t lExpiresLength = formatTime(aExpiration, lExpires);
+
+    // string to sign: GET\n<content-md5>\n<content-type>\n<expires>\n/<bucket>/<key>
+    // it is assembled on the stack for common key sizes
+    char lStackBuffer[512];
+    std::string lHeapBuffer;
+    char* lStringToSign = lStackBuffer;
+    size_t lStringToSignLength = 8 + lExpiresLength + 1 + 1 + aBucketName.size() + 1
+                                 + (lKeyEnd - lKeyBegin);
+    if (lStringToSignLength > sizeof(lStackBuffer)) {
+      lHeapBuffer.resize(lStringToSignLength);
+      lStringToSign = &lHeapBuffer[0];
+    }
+    char* lPos = lStringToSign;
+    memcpy(lPos, "GET\n\n\n", 6); lPos += 6;
+    memcpy(lPos, lExpires, lExpiresLength); lPos += lExpiresLength;
+    *lPos++ = '\n';
+    *lPos++ = '/';
+    memcpy(lPos, aBucketName.c_str(), aBucketName.size()); lPos += aBucketName.size();
+    *lPos++ = '/';
+    if (lKeyEnd <= aBufferSize) {
+      memcpy(lPos, aBuffer + lKeyBegin, lKeyEnd - lKeyBegin);
+    } else {
+      // the key didn't fit into the caller's buffer; encode it again
+      UrlWriter lKeyWriter(lPos, lKeyEnd - lKeyBegin);
+      lKeyWriter.appendKey(aKey);
+    }
+    lPos += lKeyEnd - lKeyBegin;
+    lStringToSignLength = lPos - lStringToSign;
+
+    char lSignature[3 * 28];
+    size_t lSignatureLength = sign(lStringToSign, lStringToSignLength, lSignature);
+
+    lWriter.append("?AWSAccessKeyId=", 16);
+    lWriter.append(theAccessKeyId);
+    lWriter.append("&Expires=", 9);
+    lWriter.append(lExpires, lExpiresLength);
+    lWriter.append("&Signature=", 11);
+    lWriter.append(lSignature, lSignatureLength);
+
+    size_t lLength = lWriter.thePos;
+    if (lWriter.fits())
+      aBuffer[lLength] = 0;
+    return lLength;
+  }
+
+  void
+  S3PresignerImpl::appendUrl(const std::string& aBucketName, const std::string& aKey,
+                             time_t aExpiration, std::string& aUrl) const
+  {
+    // a url is rarely longer than the host, bucket, key, and the
+    // query parameters (which are less than 256 characters)
+    size_t lOffset = aUrl.size();
+    size_t lEstimate = theHost.size() + aBucketName.size() + 3 * aKey.size()
+                       + theAccessKeyId.size() + 256;
+    aUrl.resize(lOffset + lEstimate);
+    size_t lLength = getQueryString(aBucketName, aKey, aExpiration,
+                                    &aUrl[lOffset], lEstimate);
+    if (lLength >= lEstimate) {
+      aUrl.resize(lOffset + lLength + 1);
+      getQueryString(aBucketName, aKey, aExpiration, &aUrl[lOffset], lLength + 1);
+    }
+    aUrl.resize(lOffset + lLength);
+  }
+
+  std::string
+  S3PresignerImpl::getQueryString(const std::string& aBucketName,
+                                  const std::string& aKey,
+                                  time_t aExpiration) const
+  {
+    std::string lUrl;
+    appendUrl(aBucketName, aKey, aExpiration, lUrl);
+    return lUrl;
+  }
+
+  void
+  S3PresignerImpl::getQueryStrings(const std::string& aBucketName,
+                                   const std::vector<std::string>& aKeys,
+                                   time_t aExpiration,
+                                   std::vector<std::string>& aUrls) const
+  {
+    aUrls.resize(aKeys.size());
+    for (size_t i = 0; i < aKeys.size(); ++i) {
+      aUrls[i].clear(); // keeps the capacity
+      appendUrl(aBucketName, aKeys[i], aExpiration, aUrls[i]);
+    }
+  }
+
+} /* namespace aws */
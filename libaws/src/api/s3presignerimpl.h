@@ -0,0 +1,79 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3_S3PRESIGNERIMPL_H
+#define AWS_S3_S3PRESIGNERIMPL_H
+
+#include <openssl/sha.h>
+
+#include "common.h"
+#include <libaws/s3presigner.h>
+
+namespace aws {
+
+  class S3PresignerImpl : public S3Presigner
+  {
+    public:
+      virtual ~S3PresignerImpl();
+
+      void
+      setCallingFormat(S3Connection::CallingFormatType aType);
+
+      std::string
+      getQueryString(const std::string& aBucketName,
+                     const std::string& aKey,
+                     time_t aExpiration) const;
+
+      size_t
+      getQueryString(const std::string& aBucketName,
+                     const std::string& aKey,
+                     time_t aExpiration,
+                     char* aBuffer,
+                     size_t aBufferSize) const;
+
+      void
+      getQueryStrings(const std::string& aBucketName,
+                      const std::vector<std::string>& aKeys,
+                      time_t aExpiration,
+                      std::vector<std::string>& aUrls) const;
+
+    protected:
+      // only the factory can create us
+      friend class AWSConnectionFactoryImpl;
+      S3PresignerImpl(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
+                      const std::string& aCustomHost, bool aIsSecure);
+
+      // computes the base64 encoded hmac-sha1 signature of aStringToSign
+      // and writes it url encoded into aSignature (at most 3 * 28 chars)
+      size_t
+      sign(const char* aStringToSign, size_t aLength, char* aSignature) const;
+
+      // appends the url for the given object to aUrl
+      void
+      appendUrl(const std::string& aBucketName, const std::string& aKey,
+                time_t aExpiration, std::string& aUrl) const;
+
+      std::string theAccessKeyId;
+      std::string theHost;
+      bool        theIsSecure;
+      S3Connection::CallingFormatType theCallingFormat;
+
+      // sha1 states after hashing the inner and outer padded key
+      // they are copied for every signature (see rfc 2104)
+      SHA_CTX     theInnerCtx;
+      SHA_CTX     theOuterCtx;
+  }; /* class S3PresignerImpl */
+} /* namespace aws */
+#endif
@@ -59,6 +59,27 @@ namespace aws {
     return theS3Response->getAmazonId();
   }
 
+  template <class T>
+  bool
+  S3Response<T>::isSuccessful() const
+  {
+    return theS3Response->isSuccessful();
+  }
+
+  template <class T>
+  S3Exception::ErrorCode
+  S3Response<T>::getErrorCode() const
+  {
+    return theS3Response->getS3ResponseError().getErrorCode();
+  }
+
+  template <class T>
+  const std::string&
+  S3Response<T>::getErrorMessage() const
+  {
+    return theS3Response->getS3ResponseError().getErrorMessage();
+  }
+
   /**
    * CreateBucketResponse
    */
@@ -325,6 +346,30 @@ namespace aws {
     return theS3Response->getBucketName();
   }
 
+  /**
+   * CopyResponse
+   */
+  CopyResponse::CopyResponse(s3::CopyResponse* r)
+    : S3Response<s3::CopyResponse>(r) {}
+
+  const std::string&
+  CopyResponse::getKey() const
+  {
+    return theS3Response->getKey();
+  }
+
+  const std::string&
+  CopyResponse::getBucketName() const
+  {
+    return theS3Response->getBucketName();
+  }
+
+  const std::string&
+  CopyResponse::getLastModified() const
+  {
+    return theS3Response->getLastModified();
+  }
+
   /**
    * DeleteAllResponse
    */
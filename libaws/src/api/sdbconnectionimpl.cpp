@@ -17,13 +17,56 @@
 #include <libaws/sdbresponse.h>
 
 #include "sdb/sdbconnection.h"
+#include "sdb/sdbhandler.h"
 #include "api/sdbconnectionimpl.h"
+#include "api/awsreactorimpl.h"
 
 namespace aws {
 
+  // an asynchronous request of a SDBConnectionImpl that is performed by a
+  // reactor; keeps the connection alive until the request is done
+  class SDBAsyncRequestImpl : public AWSAsyncRequest
+  {
+    public:
+      SDBAsyncRequestImpl(SDBConnectionImpl* aConnection,
+                          SDBConnectionImpl::AsyncActionType aActionType,
+                          QueryCallBack* aRequest,
+                          SDBAsyncHandler* aHandler)
+        : theConnection(aConnection),
+          theActionType(aActionType),
+          theRequest(aRequest),
+          theHandler(aHandler) {}
+
+      virtual ~SDBAsyncRequestImpl()
+      {
+        if (theConnection->theAsyncRequest == this)
+          theConnection->theAsyncRequest = 0;
+        delete theRequest;
+      }
+
+      virtual CURL*
+      getHandle() const { return theConnection->theConnection->getHandle(); }
+
+      virtual void
+      complete(int aCurlCode)
+      {
+        // the handler may start the next request of the connection
+        theConnection->theAsyncRequest = 0;
+        theConnection->completeAsync(theActionType, theRequest, theHandler, aCurlCode);
+      }
+
+    protected:
+      SmartPtr<SDBConnectionImpl>        theConnection;
+      SDBConnectionImpl::AsyncActionType theActionType;
+      QueryCallBack*                     theRequest;
+      SDBAsyncHandler*                   theHandler;
+  };
+
 	SDBConnectionImpl::SDBConnectionImpl(const std::string& aAccessKeyId,
 			const std::string& aSecretAccessKey,
       const std::string& aCustomHost)
+    : theAsyncReactor(0),
+      theAsyncRequest(0)
   {
 		theConnection = new sdb::SDBConnection(aAccessKeyId, aSecretAccessKey, aCustomHost);
 	}
@@ -106,4 +149,140 @@ namespace aws {
         aQueryExpression, aAttributeNames, aMaxNumberOfItems, aNextToken));
   }
 
+	PutAttributesResponsePtr
+  SDBConnectionImpl::tryPutAttributes(const std::string& aDomainName, const std::string& aItemName,
+                                      const std::vector<aws::Attribute>& attributes)
+  {
+		return new PutAttributesResponse(theConnection->putAttributes(aDomainName, aItemName,
+        attributes, false));
+	}
+
+  BatchPutAttributesResponsePtr
+  SDBConnectionImpl::tryBatchPutAttributes(const std::string& aDomainName, const SDBBatch& aBatch)
+  {
+    return new BatchPutAttributesResponse(theConnection->batchPutAttributes(aDomainName, aBatch, false));
+  }
+
+	DeleteAttributesResponsePtr
+  SDBConnectionImpl::tryDeleteAttributes(const std::string& aDomainName, const std::string& aItemName,
+                                         const std::vector<aws::Attribute>& attributes)
+  {
+		return new DeleteAttributesResponse(theConnection->deleteAttributes(
+				aDomainName, aItemName, attributes, false));
+	}
+
+	GetAttributesResponsePtr
+  SDBConnectionImpl::tryGetAttributes(const std::string& aDomainName, const std::string& aItemName,
+                                      const std::string& attributeName)
+  {
+		return new GetAttributesResponse(theConnection->getAttributes(aDomainName,
+				aItemName, attributeName, false));
+	}
+
+	SDBQueryResponsePtr
+  SDBConnectionImpl::tryQuery(const std::string& aDomainName, const std::string& aQueryExpression,
+                              int aMaxNumberOfItems, const std::string& aNextToken)
+  {
+		return new SDBQueryResponse(theConnection->query(aDomainName,
+				aQueryExpression, aMaxNumberOfItems, aNextToken, false));
+	}
+
+  void
+  SDBConnectionImpl::putAttributesAsync(AWSReactor* aReactor,
+                                        const std::string& aDomainName, const std::string& aItemName,
+                                        const std::vector<aws::Attribute>& attributes,
+                                        SDBAsyncHandler* aHandler)
+  {
+    startAsync(aReactor, PUT_ATTRIBUTES,
+               theConnection->startPutAttributes(aDomainName, aItemName, attributes),
+               aHandler);
+  }
+
+  void
+  SDBConnectionImpl::getAttributesAsync(AWSReactor* aReactor,
+                                        const std::string& aDomainName, const std::string& aItemName,
+                                        SDBAsyncHandler* aHandler,
+                                        const std::string& attributeName)
+  {
+    startAsync(aReactor, GET_ATTRIBUTES,
+               theConnection->startGetAttributes(aDomainName, aItemName, attributeName),
+               aHandler);
+  }
+
+  void
+  SDBConnectionImpl::queryAsync(AWSReactor* aReactor,
+                                const std::string& aDomainName, const std::string& aQueryExpression,
+                                SDBAsyncHandler* aHandler,
+                                int aMaxNumberOfItems, const std::string& aNextToken)
+  {
+    startAsync(aReactor, QUERY,
+               theConnection->startQuery(aDomainName, aQueryExpression,
+                                         aMaxNumberOfItems, aNextToken),
+               aHandler);
+  }
+
+  void
+  SDBConnectionImpl::startAsync(AWSReactor* aReactor, AsyncActionType aActionType,
+                                QueryCallBack* aRequest, SDBAsyncHandler* aHandler)
+  {
+    theAsyncReactor = static_cast<AWSReactorImpl*>(aReactor);
+    theAsyncRequest = new SDBAsyncRequestImpl(this, aActionType, aRequest, aHandler);
+    theAsyncReactor->addRequest(theAsyncRequest);
+  }
+
+  void
+  SDBConnectionImpl::cancelAsync()
+  {
+    if (theAsyncRequest)
+      theAsyncReactor->cancelRequest(theAsyncRequest);
+  }
+
+  void
+  SDBConnectionImpl::completeAsync(AsyncActionType aActionType, QueryCallBack* aRequest,
+                                   SDBAsyncHandler* aHandler, int aCurlCode)
+  {
+    // the handler is notified outside of the try block such that an
+    // exception thrown by xxxDone isn't reported to failed
+    bool lFailed = false;
+    PutAttributesResponsePtr lPutAttributes;
+    GetAttributesResponsePtr lGetAttributes;
+    SDBQueryResponsePtr      lQuery;
+    try {
+      switch (aActionType) {
+        case PUT_ATTRIBUTES:
+          lPutAttributes = new PutAttributesResponse(theConnection->finishPutAttributes(
+              static_cast<sdb::PutAttributesHandler*>(aRequest), aCurlCode));
+          break;
+        case GET_ATTRIBUTES:
+          lGetAttributes = new GetAttributesResponse(theConnection->finishGetAttributes(
+              static_cast<sdb::GetAttributesHandler*>(aRequest), aCurlCode));
+          break;
+        case QUERY:
+          lQuery = new SDBQueryResponse(theConnection->finishQuery(
+              static_cast<sdb::QueryHandler*>(aRequest), aCurlCode));
+          break;
+      }
+    } catch (AWSException& e) {
+      aHandler->failed(e);
+      lFailed = true;
+    }
+
+    if (!lFailed) {
+      switch (aActionType) {
+        case PUT_ATTRIBUTES:
+          aHandler->putAttributesDone(lPutAttributes);
+          break;
+        case GET_ATTRIBUTES:
+          aHandler->getAttributesDone(lGetAttributes);
+          break;
+        case QUERY:
+          aHandler->queryDone(lQuery);
+          break;
+      }
+    }
+
+    // outside of the handling of the exception
+    aHandler->completed();
+  }
+
 }//namespace aws
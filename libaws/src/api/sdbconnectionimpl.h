@@ -21,6 +21,10 @@
 
 namespace aws {
 
+  class AWSReactorImpl;
+  class AWSAsyncRequest;
+  class QueryCallBack;
+
 	namespace sdb {
 		class SDBConnection;
 	}
@@ -35,6 +39,28 @@ namespace aws {
 
 		sdb::SDBConnection* theConnection;
 
+    friend class SDBAsyncRequestImpl;
+
+    enum AsyncActionType {
+      PUT_ATTRIBUTES,
+      GET_ATTRIBUTES,
+      QUERY
+    };
+
+    // hands the request started on aRequest over to aReactor
+    void
+    startAsync(AWSReactor* aReactor, AsyncActionType aActionType,
+               QueryCallBack* aRequest, SDBAsyncHandler* aHandler);
+
+    // called by the reactor once aRequest is done; notifies aHandler
+    void
+    completeAsync(AsyncActionType aActionType, QueryCallBack* aRequest,
+                  SDBAsyncHandler* aHandler, int aCurlCode);
+
+    // the request in flight, if any, and the reactor performing it
+    AWSReactorImpl*     theAsyncReactor;
+    AWSAsyncRequest*    theAsyncRequest;
+
 	public:
 		virtual ~SDBConnectionImpl();
 
@@ -74,6 +100,46 @@ namespace aws {
     queryWithAttributes(const std::string& aDomainName, const std::string& aQueryExpression,
                         const std::vector<std::string>& aAttributeNames, int aMaxNumberOfItems = 0,
                         const std::string& aNextToken = "");
+
+    virtual PutAttributesResponsePtr
+    tryPutAttributes(const std::string& aDomainName, const std::string& aItemName,
+                     const std::vector<aws::Attribute>& attributes);
+
+    virtual BatchPutAttributesResponsePtr
+    tryBatchPutAttributes(const std::string& aDomainName, const SDBBatch& aBatch);
+
+    virtual DeleteAttributesResponsePtr
+    tryDeleteAttributes(const std::string& aDomainName, const std::string& aItemName,
+                        const std::vector<aws::Attribute>& attributes);
+
+    virtual GetAttributesResponsePtr
+    tryGetAttributes(const std::string& aDomainName, const std::string& aItemName,
+                     const std::string& attributeName = "");
+
+    virtual SDBQueryResponsePtr
+    tryQuery(const std::string& aDomainName, const std::string& aQueryExpression,
+             int aMaxNumberOfItems = 0, const std::string& aNextToken = "");
+
+    virtual void
+    putAttributesAsync(AWSReactor* aReactor,
+                       const std::string& aDomainName, const std::string& aItemName,
+                       const std::vector<aws::Attribute>& attributes,
+                       SDBAsyncHandler* aHandler);
+
+    virtual void
+    getAttributesAsync(AWSReactor* aReactor,
+                       const std::string& aDomainName, const std::string& aItemName,
+                       SDBAsyncHandler* aHandler,
+                       const std::string& attributeName = "");
+
+    virtual void
+    queryAsync(AWSReactor* aReactor,
+               const std::string& aDomainName, const std::string& aQueryExpression,
+               SDBAsyncHandler* aHandler,
+               int aMaxNumberOfItems = 0, const std::string& aNextToken = "");
+
+    virtual void
+    cancelAsync();
 	};
 } /* namespace aws */
 #endif
@@ -52,6 +52,23 @@ namespace aws {
     return  ((double)theSDBResponse->getInTransfer()) / 1024;
     }
 
+  template <class T>
+  bool SDBTemplateResponse<T>::isSuccessful() const {
+    return theSDBResponse->isSuccessful();
+  }
+
+  template <class T>
+  SDBException::ErrorCode SDBTemplateResponse<T>::getErrorCode() const {
+    if (theSDBResponse->isSuccessful())
+      return SDBException::NoError;
+    return SDBException::parseError(theSDBResponse->getQueryErrorResponse().getErrorCode());
+  }
+
+  template <class T>
+  const std::string& SDBTemplateResponse<T>::getErrorMessage() const {
+    return theSDBResponse->getQueryErrorResponse().getErrorMessage();
+  }
+
 	CreateDomainResponse::CreateDomainResponse(sdb::CreateDomainResponse* r) :
 		SDBTemplateResponse<sdb::CreateDomainResponse> (r) {
 	}
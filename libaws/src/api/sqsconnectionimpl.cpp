@@ -17,10 +17,51 @@
 #include <libaws/sqsresponse.h>
 
 #include "sqs/sqsconnection.h"
+#include "sqs/sqshandler.h"
 #include "api/sqsconnectionimpl.h"
+#include "api/awsreactorimpl.h"
 
 namespace aws {
 
+  // an asynchronous request of a SQSConnectionImpl that is performed by a
+  // reactor; keeps the connection alive until the request is done
+  class SQSAsyncRequestImpl : public AWSAsyncRequest
+  {
+    public:
+      SQSAsyncRequestImpl(SQSConnectionImpl* aConnection,
+                          SQSConnectionImpl::AsyncActionType aActionType,
+                          sqs::QueueErrorHandler* aRequest,
+                          SQSAsyncHandler* aHandler)
+        : theConnection(aConnection),
+          theActionType(aActionType),
+          theRequest(aRequest),
+          theHandler(aHandler) {}
+
+      virtual ~SQSAsyncRequestImpl()
+      {
+        if (theConnection->theAsyncRequest == this)
+          theConnection->theAsyncRequest = 0;
+        delete theRequest;
+      }
+
+      virtual CURL*
+      getHandle() const { return theConnection->theConnection->getHandle(); }
+
+      virtual void
+      complete(int aCurlCode)
+      {
+        // the handler may start the next request of the connection
+        theConnection->theAsyncRequest = 0;
+        theConnection->completeAsync(theActionType, theRequest, theHandler, aCurlCode);
+      }
+
+    protected:
+      SmartPtr<SQSConnectionImpl>        theConnection;
+      SQSConnectionImpl::AsyncActionType theActionType;
+      sqs::QueueErrorHandler*            theRequest;
+      SQSAsyncHandler*                   theHandler;
+  };
+
   CreateQueueResponsePtr
   SQSConnectionImpl::createQueue(const std::string &aQueueName, int aDefaultVisibilityTimeout)
   {
@@ -65,6 +106,32 @@ namespace aws {
     return new DeleteMessageResponse(theConnection->deleteMessage(aQueueUrl, aReceiptHandle));
   }
 
+  SendMessageResponsePtr
+  SQSConnectionImpl::trySendMessage(const std::string &aQueueUrl, const std::string &aMessageBody, bool aEncode)
+  {
+    return new SendMessageResponse(theConnection->sendMessage(aQueueUrl, aMessageBody, aEncode, false));
+  }
+
+  ReceiveMessageResponsePtr
+  SQSConnectionImpl::tryReceiveMessage(const std::string &aQueueUrl,
+                int aNumberOfMessages,
+                int aVisibilityTimeout,
+                bool aDecode)
+  {
+    return new ReceiveMessageResponse(theConnection->receiveMessage(aQueueUrl,
+                                                                    aNumberOfMessages,
+                                                                    aVisibilityTimeout,
+                                                                    aDecode,
+                                                                    false));
+  }
+
+  DeleteMessageResponsePtr
+  SQSConnectionImpl::tryDeleteMessage(const std::string &aQueueUrl,
+								const std::string &aReceiptHandle)
+  {
+    return new DeleteMessageResponse(theConnection->deleteMessage(aQueueUrl, aReceiptHandle, false));
+  }
+
   GetQueueAttributesResponsePtr
   SQSConnectionImpl::getQueueAttributes(const std::string &aQueueUrl,
                                 const std::string &aAttributeName)
@@ -73,9 +140,108 @@ namespace aws {
   }
 
 
+  void
+  SQSConnectionImpl::sendMessageAsync(AWSReactor* aReactor, const std::string &aQueueUrl,
+                                      const std::string &aMessageBody,
+                                      SQSAsyncHandler* aHandler, bool aEncode)
+  {
+    startAsync(aReactor, SEND_MESSAGE,
+               theConnection->startSendMessage(aQueueUrl, aMessageBody, aEncode),
+               aHandler);
+  }
+
+  void
+  SQSConnectionImpl::receiveMessageAsync(AWSReactor* aReactor, const std::string &aQueueUrl,
+                                         SQSAsyncHandler* aHandler,
+                                         int aNumberOfMessages,
+                                         int aVisibilityTimeout,
+                                         bool aDecode)
+  {
+    startAsync(aReactor, RECEIVE_MESSAGE,
+               theConnection->startReceiveMessage(aQueueUrl, aNumberOfMessages,
+                                                  aVisibilityTimeout, aDecode),
+               aHandler);
+  }
+
+  void
+  SQSConnectionImpl::deleteMessageAsync(AWSReactor* aReactor, const std::string &aQueueUrl,
+                                        const std::string &aReceiptHandle,
+                                        SQSAsyncHandler* aHandler)
+  {
+    startAsync(aReactor, DELETE_MESSAGE,
+               theConnection->startDeleteMessage(aQueueUrl, aReceiptHandle),
+               aHandler);
+  }
+
+  void
+  SQSConnectionImpl::startAsync(AWSReactor* aReactor, AsyncActionType aActionType,
+                                sqs::QueueErrorHandler* aRequest, SQSAsyncHandler* aHandler)
+  {
+    theAsyncReactor = static_cast<AWSReactorImpl*>(aReactor);
+    theAsyncRequest = new SQSAsyncRequestImpl(this, aActionType, aRequest, aHandler);
+    theAsyncReactor->addRequest(theAsyncRequest);
+  }
+
+  void
+  SQSConnectionImpl::cancelAsync()
+  {
+    if (theAsyncRequest)
+      theAsyncReactor->cancelRequest(theAsyncRequest);
+  }
+
+  void
+  SQSConnectionImpl::completeAsync(AsyncActionType aActionType, sqs::QueueErrorHandler* aRequest,
+                                   SQSAsyncHandler* aHandler, int aCurlCode)
+  {
+    // the handler is notified outside of the try block such that an
+    // exception thrown by xxxDone isn't reported to failed
+    bool lFailed = false;
+    SendMessageResponsePtr    lSendMessage;
+    ReceiveMessageResponsePtr lReceiveMessage;
+    DeleteMessageResponsePtr  lDeleteMessage;
+    try {
+      switch (aActionType) {
+        case SEND_MESSAGE:
+          lSendMessage = new SendMessageResponse(theConnection->finishSendMessage(
+              static_cast<sqs::SendMessageHandler*>(aRequest), aCurlCode));
+          break;
+        case RECEIVE_MESSAGE:
+          lReceiveMessage = new ReceiveMessageResponse(theConnection->finishReceiveMessage(
+              static_cast<sqs::ReceiveMessageHandler*>(aRequest), aCurlCode));
+          break;
+        case DELETE_MESSAGE:
+          lDeleteMessage = new DeleteMessageResponse(theConnection->finishDeleteMessage(
+              static_cast<sqs::DeleteMessageHandler*>(aRequest), aCurlCode));
+          break;
+      }
+    } catch (AWSException& e) {
+      aHandler->failed(e);
+      lFailed = true;
+    }
+
+    if (!lFailed) {
+      switch (aActionType) {
+        case SEND_MESSAGE:
+          aHandler->sendMessageDone(lSendMessage);
+          break;
+        case RECEIVE_MESSAGE:
+          aHandler->receiveMessageDone(lReceiveMessage);
+          break;
+        case DELETE_MESSAGE:
+          aHandler->deleteMessageDone(lDeleteMessage);
+          break;
+      }
+    }
+
+    // outside of the handling of the exception
+    aHandler->completed();
+  }
+
   SQSConnectionImpl::SQSConnectionImpl(const std::string& aAccessKeyId,
                                        const std::string& aSecretAccessKey,
                                        const std::string& aCustomHost)
+    : theAsyncReactor(0),
+      theAsyncRequest(0)
   {
     theConnection = new sqs::SQSConnection(aAccessKeyId, aSecretAccessKey, aCustomHost);
   }
@@ -85,6 +251,8 @@ namespace aws {
                                        const std::string& aCustomHost,
                                        int aPort,
                                        bool aIsSecure)
+    : theAsyncReactor(0),
+      theAsyncRequest(0)
   {
     theConnection = new sqs::SQSConnection(aAccessKeyId, aSecretAccessKey, aCustomHost, aPort, aIsSecure);
   }
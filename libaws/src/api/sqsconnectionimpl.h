@@ -21,8 +21,12 @@
 
 namespace aws {
 
+  class AWSReactorImpl;
+  class AWSAsyncRequest;
+
   namespace sqs {
     class SQSConnection;
+    class QueueErrorHandler;
   }
 
   class SQSConnectionImpl : public SQSConnection
@@ -53,10 +57,66 @@ namespace aws {
       virtual DeleteMessageResponsePtr
       deleteMessage(const std::string &aQueueUrl, const std::string &aReceiptHandle);
 
+      virtual SendMessageResponsePtr
+      trySendMessage(const std::string &aQueueUrl,
+                     const std::string &aMessageBody,
+                     bool aEncodeToBase64 = true);
+
+      virtual ReceiveMessageResponsePtr
+      tryReceiveMessage(const std::string &aQueueUrl,
+                        int aNumberOfMessages = 0,
+                        int aVisibilityTimeout = -1,
+                        bool aDecodeFromBase64 = true);
+
+      virtual DeleteMessageResponsePtr
+      tryDeleteMessage(const std::string &aQueueUrl, const std::string &aReceiptHandle);
+
       virtual GetQueueAttributesResponsePtr
       getQueueAttributes(const std::string &aQueueUrl, const std::string &aAttributeName);
 
+      virtual void
+      sendMessageAsync(AWSReactor* aReactor,
+                       const std::string &aQueueUrl,
+                       const std::string &aMessageBody,
+                       SQSAsyncHandler* aHandler,
+                       bool aEncodeToBase64 = true);
+
+      virtual void
+      receiveMessageAsync(AWSReactor* aReactor,
+                          const std::string &aQueueUrl,
+                          SQSAsyncHandler* aHandler,
+                          int aNumberOfMessages = 0,
+                          int aVisibilityTimeout = -1,
+                          bool aDecodeFromBase64 = true);
+
+      virtual void
+      deleteMessageAsync(AWSReactor* aReactor,
+                         const std::string &aQueueUrl,
+                         const std::string &aReceiptHandle,
+                         SQSAsyncHandler* aHandler);
+
+      virtual void
+      cancelAsync();
+
     protected:
+      friend class SQSAsyncRequestImpl;
+
+      enum AsyncActionType {
+        SEND_MESSAGE,
+        RECEIVE_MESSAGE,
+        DELETE_MESSAGE
+      };
+
+      // hands the request started on aRequest over to aReactor
+      void
+      startAsync(AWSReactor* aReactor, AsyncActionType aActionType,
+                 sqs::QueueErrorHandler* aRequest, SQSAsyncHandler* aHandler);
+
+      // called by the reactor once aRequest is done; notifies aHandler
+      void
+      completeAsync(AsyncActionType aActionType, sqs::QueueErrorHandler* aRequest,
+                    SQSAsyncHandler* aHandler, int aCurlCode);
+
       // only the factory can create us
       friend class AWSConnectionFactoryImpl;
       SQSConnectionImpl(const std::string& aAccessKeyId, const std::string& aSecretAccessKey,
@@ -66,6 +126,10 @@ namespace aws {
 
       sqs::SQSConnection* theConnection;
 
+      // the request in flight, if any, and the reactor performing it
+      AWSReactorImpl*     theAsyncReactor;
+      AWSAsyncRequest*    theAsyncRequest;
+
   }; /* class S3ConnectionImpl */
 
 } /* namespace aws */
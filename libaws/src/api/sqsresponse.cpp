@@ -49,6 +49,29 @@ namespace aws {
     return  theSQSResponse->getInTransfer() / 1024;
   }
 
+  template <class T>
+  bool
+  SQSResponse<T>::isSuccessful() const
+  {
+    return theSQSResponse->isSuccessful();
+  }
+
+  template <class T>
+  SQSException::ErrorCode
+  SQSResponse<T>::getErrorCode() const
+  {
+    if (theSQSResponse->isSuccessful())
+      return SQSException::NoError;
+    return SQSException::parseError(theSQSResponse->getQueryErrorResponse().getErrorCode());
+  }
+
+  template <class T>
+  const std::string&
+  SQSResponse<T>::getErrorMessage() const
+  {
+    return theSQSResponse->getQueryErrorResponse().getErrorMessage();
+  }
+
   /**
    * CreateQueueResponse
    */
@@ -32,6 +32,8 @@ std::string AWSConnection::ALTERNATIVE_DATE_HEADER  = "x-amz-date";
 
 uint8_t AWSConnection::MAX_REQUESTS = 30;
 
+CURLSH* AWSConnection::theShareHandle = 0;
+
 AWSConnection::AWSConnection(const std::string& aAccessKeyId,
                              const std::string& aSecretAccessKey,
                              const std::string& aHost,
@@ -44,7 +46,9 @@ AWSConnection::AWSConnection(const std::string& aAccessKeyId,
       theIsSecure(false),
       theNumberOfRequests(0),
       thePort(aPort),
-      theCurl(0)
+      theCurl(0),
+      theEndpoint(EndpointSet::MAX_ENDPOINTS),
+      theFailedEndpoints(0)
 {
   // Initialize SHA1 encryption
   HMAC_CTX_init(&theHctx);
@@ -63,6 +67,90 @@ AWSConnection::AWSConnection(const std::string& aAccessKeyId,
 
   theCurl = curl_easy_init();
 
+  // dns cache and ssl sessions are shared among all connections
+  if (theShareHandle) {
+    curl_easy_setopt(theCurl, CURLOPT_SHARE, theShareHandle);
+  }
+}
+
+void
+AWSConnection::setShareHandle(CURLSH* aShareHandle)
+{
+  theShareHandle = aShareHandle;
+}
+
+void
+AWSConnection::setEndpoints(EndpointSet* aEndpoints)
+{
+  theEndpoints = aEndpoints;
+  theEndpoint = EndpointSet::MAX_ENDPOINTS;
+}
+
+void
+AWSConnection::routeRequest(size_t aAvoid)
+{
+  if (theEndpoints.isNull())
+    return;
+  theFailedEndpoints = 0;
+  if (aAvoid != EndpointSet::MAX_ENDPOINTS)
+    theEndpoint = theEndpoints->select((EndpointSet::Excluded) 1 << aAvoid, theHost);
+  if (aAvoid == EndpointSet::MAX_ENDPOINTS || theEndpoint == EndpointSet::MAX_ENDPOINTS)
+    theEndpoint = theEndpoints->select(theFailedEndpoints, theHost);
+}
+
+void
+AWSConnection::reportEndpoint(int aCurlCode)
+{
+  if (theEndpoints.isNull() || theEndpoint == EndpointSet::MAX_ENDPOINTS)
+    return;
+
+  switch (aCurlCode) {
+    case CURLE_OK: {
+      // time to the first byte, independent of the size of the response
+      double lLatency = 0;
+      curl_easy_getinfo(theCurl, CURLINFO_STARTTRANSFER_TIME, &lLatency);
+      if (lLatency > 0)
+        theEndpoints->reportSuccess(theEndpoint, lLatency);
+      break;
+    }
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SSL_CONNECT_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+      theEndpoints->reportFailure(theEndpoint);
+      break;
+    default:
+      // errors of the request itself (e.g. aborted by a callback)
+      break;
+  }
+}
+
+bool
+AWSConnection::failover(int aCurlCode)
+{
+  reportEndpoint(aCurlCode);
+  if (theEndpoints.isNull() || theEndpoint == EndpointSet::MAX_ENDPOINTS)
+    return false;
+
+  // only failures before the request was sent are safe to repeat
+  // for every kind of request (e.g. a put or a send message)
+  if (aCurlCode != CURLE_COULDNT_RESOLVE_HOST && aCurlCode != CURLE_COULDNT_CONNECT
+      && aCurlCode != CURLE_SSL_CONNECT_ERROR)
+    return false;
+
+  theFailedEndpoints |= (EndpointSet::Excluded) 1 << theEndpoint;
+  std::string lHost;
+  size_t lEndpoint = theEndpoints->select(theFailedEndpoints, lHost);
+  if (lEndpoint == EndpointSet::MAX_ENDPOINTS)
+    return false;
+
+  theEndpoints->countFailover();
+  theEndpoint = lEndpoint;
+  theHost = lHost;
+  return true;
 }
 
 AWSConnection::~AWSConnection()
@@ -18,11 +18,14 @@
 
 #include <openssl/hmac.h>
 #include "common.h"
+#include "parsercache.h"
+#include "endpointset.h"
 
 struct bio_st;
 typedef struct bio_st BIO;
 typedef void CURLM;
 typedef void CURL;
+typedef void CURLSH;
 
 class OpenSSLData;
 
@@ -46,11 +49,21 @@ public:
   const char* base64Decode(const char* a64Content, size_t a64ContentSize,
 													 size_t &aDecodedStringLength);
 
+  // set the curl share handle that connections created afterwards
+  // attach to (owned by the AWSConnectionFactory)
+  static
+  void setShareHandle(CURLSH* aShareHandle);
+
+  // route the requests of this connection over the given endpoints
+  // instead of the host it was created for
+  void setEndpoints(EndpointSet* aEndpoints);
+
 protected:
     friend class RequestHeaderMap;
     static std::string AMAZON_HEADER_PREFIX;
     static std::string ALTERNATIVE_DATE_HEADER;
     static uint8_t  MAX_REQUESTS;
+    static CURLSH*  theShareHandle;
 
     std::string theAccessKeyId;
     std::string theSecretAccessKey;
@@ -63,6 +76,14 @@ protected:
     CURL*       theCurl; // maybe a pool later
     HMAC_CTX    theHctx;
 
+    // parser reused by the requests of this connection
+    ParserCache theParserCache;
+
+    // endpoints the requests are routed over (see routeRequest), if any
+    SmartPtr<EndpointSet>  theEndpoints;
+    size_t                 theEndpoint;        // endpoint of the current request
+    EndpointSet::Excluded  theFailedEndpoints; // tried by the current request
+
     // moved these vars into static function
     // BIO*        theBio;
     // BIO*        theB64;
@@ -74,6 +95,18 @@ protected:
 
     static std::string urlencode(const std::string&);
 
+    // point theHost to the best endpoint before preparing a request;
+    // aAvoid is only used if there is no other endpoint (e.g. for a hedge)
+    void routeRequest(size_t aAvoid = EndpointSet::MAX_ENDPOINTS);
+
+    // report the outcome of the current request to the endpoints
+    void reportEndpoint(int aCurlCode);
+
+    // reports the outcome of the current request and, if it failed before
+    // anything was sent, points theHost to an endpoint that hasn't been
+    // tried yet; returns false if the request must not be repeated
+    bool failover(int aCurlCode);
+
 public:
     virtual ~AWSConnection();
 
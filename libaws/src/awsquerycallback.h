@@ -20,6 +20,7 @@
 
 #include <libxml/parser.h>
 #include "awsqueryresponse.h"
+#include "parsercache.h"
 
 
 namespace aws
@@ -31,36 +32,53 @@ namespace aws
       //std::vector<Error> theErrors;
       QueryErrorResponse theQueryErrorResponse;
       bool theIsSuccessful;
-      xmlParserCtxtPtr theParserCtxt;
+      ParserCache::Parser theParserCtxt;
       xmlSAXHandler theSAXHandler;
       bool theParserCreated;
+      ParserCache* theParserCache; // set by the connection
       double theOutTransfer;
       double theInTransfer;
 
     public:
 
-      QueryCallBack() : theIsSuccessful ( true ), theParserCreated ( false ),theOutTransfer(0), theInTransfer(0)  {
+      QueryCallBack() : theIsSuccessful ( true ), theParserCtxt ( 0 ), theParserCreated ( false ), theParserCache ( 0 ), theOutTransfer(0), theInTransfer(0)  {
         memset ( &theSAXHandler, 0, sizeof ( theSAXHandler ) );
         theSAXHandler.initialized    = XML_SAX2_MAGIC;
       }
-      virtual ~QueryCallBack(){}
+      virtual ~QueryCallBack() { destroyParser(); }
 
       QueryErrorResponse& getQueryErrorResponse() {return theQueryErrorResponse;}
 
       bool isSuccessful() { return theIsSuccessful; }
 
+      // the parser is created lazily by parseChunk (see S3CallBackWrapper)
       void createParser()
       {
-        theParserCtxt = xmlCreatePushParserCtxt ( &theSAXHandler, this, NULL, 0, 0 );
         theParserCreated = true;
       }
 
+      void parseChunk ( const char* aChunk, int aSize, bool aTerminate )
+      {
+        if ( !theParserCtxt ) {
+          if ( aSize == 0 )
+            return;
+          theParserCtxt = theParserCache
+              ? theParserCache->acquire ( &theSAXHandler, this )
+              : ParserCache::create ( &theSAXHandler, this );
+        }
+        ParserCache::parseChunk ( theParserCtxt, aChunk, aSize, aTerminate );
+      }
+
       void destroyParser()
       {
-        if ( theParserCreated ) {
-          xmlFreeParserCtxt ( theParserCtxt );
-          theParserCreated=false;
+        if ( theParserCtxt ) {
+          if ( theParserCache )
+            theParserCache->release ( theParserCtxt );
+          else
+            ParserCache::destroy ( theParserCtxt );
+          theParserCtxt = 0;
         }
+        theParserCreated=false;
       }
       
       virtual void startElementNs ( const xmlChar * localname,
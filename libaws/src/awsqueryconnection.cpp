@@ -100,6 +100,42 @@ namespace aws {
                                          const std::string &action,
                                          ParameterMap* aParameterMap,
                                          QueryCallBack* aCallBack )
+  {
+    startQueryRequest ( aURL, action, aParameterMap, aCallBack );
+
+    CURLcode lCurlCode;
+    while ( true ) {
+      // finally, execute the request
+      lCurlCode = curl_easy_perform ( theCurl );
+
+      // nothing has been sent if it fails over to the next endpoint
+      if ( !failover ( lCurlCode ) )
+        break;
+
+      setQueryUrl ( aCallBack );
+    }
+
+    completeQueryRequest ( aCallBack, lCurlCode );
+  }
+
+  void
+  AWSQueryConnection::startQueryRequest ( const std::string &action,
+                                          ParameterMap* aParameterMap,
+                                          QueryCallBack* aCallBack )
+  {
+    std::stringstream lUrlStream;
+    lUrlStream << ( theIsSecure ? "https://": "http://" ) << theHost;
+    if (thePort > 0) {
+      lUrlStream << ":" << thePort;
+    }
+    startQueryRequest(lUrlStream.str(), action, aParameterMap, aCallBack);
+  }
+
+  void
+  AWSQueryConnection::startQueryRequest ( const std::string& aURL,
+                                          const std::string &action,
+                                          ParameterMap* aParameterMap,
+                                          QueryCallBack* aCallBack )
   {
     setCommonParamaters(aParameterMap, action);
 
@@ -107,14 +143,12 @@ namespace aws {
     aCallBack->theSAXHandler.characters     = &QueryCallBack::SAX_CharactersSAXFunc;
     aCallBack->theSAXHandler.endElementNs   = &QueryCallBack::SAX_EndElementNs;
 
+    aCallBack->theParserCache = &theParserCache;
     aCallBack->createParser();
 
     std::stringstream lStringToSign;
     std::stringstream lUrl;
 
-    // begin with the url
-    lUrl << aURL;
-
     // build query url and the string to sign
     bool lFirst = true;
     for ( ParameterMapIter lIter = aParameterMap->begin();
@@ -149,48 +183,77 @@ namespace aws {
                                  lBase64EncodedStringLength ) );
     }
 
-    // necessary, in order to keep the string until the end of the function
+    // the resource of the url is kept if the request is routed to an endpoint
+    theQueryBaseUrl = aURL;
+    theQueryResource.clear();
+    std::string::size_type lAuthority = aURL.find ( "://" );
+    if ( lAuthority != std::string::npos ) {
+      std::string::size_type lPath = aURL.find ( '/', lAuthority + 3 );
+      if ( lPath != std::string::npos )
+        theQueryResource = aURL.substr ( lPath );
+    }
+    theQuery = lUrl.str();
+
+    routeRequest();
+    setQueryUrl ( aCallBack );
+  }
+
+  void
+  AWSQueryConnection::setQueryUrl ( QueryCallBack* aCallBack )
+  {
+    // necessary, in order to keep the string until the end of the request
     // can possibly be removed with a newer curl version
     // because it will always copy
-    std::string lUrlString = lUrl.str();
-    //std::cout << lUrlString << std::endl << std::flush;
-    LOG_INFO("Send request:" << lUrlString);
-    
-    
-    
-    //std::cout << lUrlString << std::endl;
-    // set the request url
-    curl_easy_setopt ( theCurl, CURLOPT_URL, lUrlString.c_str() );
+    if ( theEndpoints.isNull() ) {
+      theQueryUrl = theQueryBaseUrl + theQuery;
+    } else {
+      std::stringstream lEndpointUrl;
+      lEndpointUrl << ( theIsSecure ? "https://": "http://" ) << theHost;
+      if ( thePort > 0 ) {
+        lEndpointUrl << ":" << thePort;
+      }
+      lEndpointUrl << theQueryResource << theQuery;
+      theQueryUrl = lEndpointUrl.str();
+    }
+    LOG_INFO("Send request:" << theQueryUrl);
 
-    // set the request method (i.e. get, post) and the according callback functions
-    //setRequestMethod ( aActionType );
+    // set the request url
+    curl_easy_setopt ( theCurl, CURLOPT_URL, theQueryUrl.c_str() );
 
     // set the data object received in the callback function
     curl_easy_setopt ( theCurl, CURLOPT_WRITEDATA, ( void* ) ( aCallBack ) );
 
-    // set a callback for retrieving all http header information
-    // curl_easy_setopt ( theCurl, CURLOPT_HEADERFUNCTION, AWSQueryConnection::getHeaderData );
-
     //curl_easy_setopt ( theCurl, CURLOPT_VERBOSE, 1 );
 
-
     if ( ++theNumberOfRequests >= MAX_REQUESTS )
     {
-      curl_easy_setopt ( theCurl, CURLOPT_FRESH_CONNECT, "TRUE" );
+      curl_easy_setopt ( theCurl, CURLOPT_FRESH_CONNECT, 1L );
       theNumberOfRequests = 0;
+    } else {
+      curl_easy_setopt ( theCurl, CURLOPT_FRESH_CONNECT, 0L );
     }
+  }
 
-    // finally, execute the request
-    CURLcode lCurlCode = curl_easy_perform ( theCurl );
-    curl_easy_setopt ( theCurl, CURLOPT_FRESH_CONNECT, "FALSE" );
+  void
+  AWSQueryConnection::finishQueryRequest ( QueryCallBack* aCallBack, int aCurlCode )
+  {
+    reportEndpoint ( aCurlCode );
+    completeQueryRequest ( aCallBack, aCurlCode );
+  }
 
+  void
+  AWSQueryConnection::completeQueryRequest ( QueryCallBack* aCallBack, int aCurlCode )
+  {
     //If the error code is !=0 and the handler is marked as succefully there was nothing parsed
     //so we should set the error code from the http reques
-    if ( lCurlCode != 0 )
+    if ( aCurlCode != CURLE_OK )
     {
       std::stringstream lTmp;
       lTmp << theCurlErrorBuffer;
-      QueryErrorResponse lQER = QueryErrorResponse(lTmp.str(), lTmp.str(), "", lUrlString);
+      // e.g. a request cancelled by the reactor
+      if ( lTmp.str().empty() )
+        lTmp << curl_easy_strerror ( static_cast<CURLcode> ( aCurlCode ) );
+      QueryErrorResponse lQER = QueryErrorResponse(lTmp.str(), lTmp.str(), "", theQueryUrl);
       aCallBack->theIsSuccessful = false;
       aCallBack->theQueryErrorResponse = lQER;
     } else if(aCallBack->theIsSuccessful){ //only if we haven't catched an error before, we overwrite the error with an HTTP one
@@ -201,18 +264,20 @@ namespace aws {
     		// tested the normal case, the response was lResponseCode = 200
         std::stringstream lTmp;
         lTmp << "Errorneous HTTP status code " << lResponseCode;
-        QueryErrorResponse lQER = QueryErrorResponse(lTmp.str(), lTmp.str(), "", lUrlString);
+        // a 503 without an error document means that the service is overloaded
+        QueryErrorResponse lQER = QueryErrorResponse(lResponseCode == 503 ? "ServiceUnavailable" : lTmp.str(),
+                                                     lTmp.str(), "", theQueryUrl);
         aCallBack->theIsSuccessful = false;
         aCallBack->theQueryErrorResponse = lQER;
     	}
     }
 
     // signal the parse that this is the end
-    xmlParseChunk ( aCallBack->theParserCtxt, 0, 0, 1 );
+    aCallBack->parseChunk ( 0, 0, true );
     
     double lDownloadSize;
     curl_easy_getinfo( theCurl, CURLINFO_SIZE_DOWNLOAD, &lDownloadSize);
-    aCallBack->theInTransfer = lUrlString.size();
+    aCallBack->theInTransfer = theQueryUrl.size();
     aCallBack->theOutTransfer = lDownloadSize;
     aCallBack->destroyParser();
     
@@ -246,7 +311,7 @@ namespace aws {
     // this guarantees to read the input in chunks as they come in
     // by libxml; we always read as much as is in the buffer
     // because we stream internally.
-    xmlParseChunk ( lQueryCallBack->theParserCtxt, lChars, size * nmemb, 0 );
+    lQueryCallBack->parseChunk ( lChars, size * nmemb, false );
 
     return size * nmemb;
   }
@@ -256,5 +321,12 @@ namespace aws {
     aResponse->theInTransfer = aHandler.theInTransfer;
   }
 
+  void AWSQueryConnection::setError(QueryCallBack& aHandler, QueryResponse* aResponse){
+    setCommons(aHandler, aResponse);
+    aResponse->theIsSuccessful = false;
+    aResponse->theQueryErrorResponse = aHandler.getQueryErrorResponse();
+    aResponse->theRequestId = aResponse->theQueryErrorResponse.getRequestId();
+  }
+
 
 }//Namespace
@@ -40,6 +40,13 @@ namespace aws {
 
       curl_slist* theSList;
 
+      // the request in progress (see startQueryRequest); curl keeps a
+      // pointer to theQueryUrl
+      std::string theQueryBaseUrl;
+      std::string theQueryResource;
+      std::string theQuery;
+      std::string theQueryUrl;
+
       struct ltstr
       {
         bool operator()(std::string s1, std::string s2) const
@@ -76,6 +83,24 @@ namespace aws {
                                       ParameterMap* aParameterMap,
                                       QueryCallBack* aCallBackWrapper );
 
+      // asynchronous requests: startQueryRequest prepares the request on the
+      // curl handle (see getHandle) which is performed by a reactor afterwards;
+      // finishQueryRequest sets the result of aCallBackWrapper like
+      // makeQueryRequest (requests performed by a reactor don't fail over)
+      virtual void startQueryRequest ( const std::string& aAction,
+                                       ParameterMap* aParameterMap,
+                                       QueryCallBack* aCallBackWrapper );
+
+      virtual void startQueryRequest ( const std::string& aUrl,
+                                       const std::string& aAction,
+                                       ParameterMap* aParameterMap,
+                                       QueryCallBack* aCallBackWrapper );
+
+      virtual void finishQueryRequest ( QueryCallBack* aCallBackWrapper, int aCurlCode );
+
+      CURL*
+      getHandle() const { return theCurl; }
+
       virtual void makeQueryRequestOnResource ( const std::string& aResource,
                                       const std::string& aAction,
                                       ParameterMap* aParameterMap,
@@ -83,6 +108,12 @@ namespace aws {
 
       virtual void setCommonParamaters ( ParameterMap* aParameterMap, const std::string& );
 
+      // sets the url of the request in progress (again after a failover)
+      void setQueryUrl ( QueryCallBack* aCallBackWrapper );
+
+      // sets the errors, the transfer sizes, and finishes parsing
+      void completeQueryRequest ( QueryCallBack* aCallBackWrapper, int aCurlCode );
+
       // TODO make it const std::string
       std::string getQueryTimestamp();
 
@@ -91,6 +122,10 @@ namespace aws {
       
       virtual void setCommons(QueryCallBack& aHandler, QueryResponse* aResponse);
 
+      // marks aResponse as failed with the error of aHandler (used by the
+      // functions that report errors instead of throwing them)
+      virtual void setError(QueryCallBack& aHandler, QueryResponse* aResponse);
+
   };
 
 } /* namespace aws */
@@ -21,31 +21,6 @@ namespace aws
 {
   class AWSQueryConnection;
 
-  class QueryResponse
-  {
-    protected:
-      friend class AWSQueryConnection;
-      std::string theRequestId;
-      double theInTransfer;
-      double theOutTransfer;
-
-    public:
-      const std::string& getRequestId() const
-      {
-        return theRequestId;
-      }
-      
-      double getInTransfer() const
-      {
-        return theInTransfer;
-      }
-      
-      double getOutTransfer() const
-      {
-        return theOutTransfer;
-      }
-  };
-
   class QueryErrorResponse
   {
     protected:
@@ -75,5 +50,45 @@ namespace aws
         void setUrl(std::string& value){theUrl = value;};
   };
 
+  class QueryResponse
+  {
+    protected:
+      friend class AWSQueryConnection;
+      std::string theRequestId;
+      double theInTransfer;
+      double theOutTransfer;
+      // only set to false for the responses of the non-throwing functions
+      bool theIsSuccessful;
+      QueryErrorResponse theQueryErrorResponse;
+
+    public:
+      QueryResponse() : theInTransfer(0), theOutTransfer(0), theIsSuccessful(true) {}
+
+      const std::string& getRequestId() const
+      {
+        return theRequestId;
+      }
+      
+      double getInTransfer() const
+      {
+        return theInTransfer;
+      }
+      
+      double getOutTransfer() const
+      {
+        return theOutTransfer;
+      }
+
+      bool isSuccessful() const
+      {
+        return theIsSuccessful;
+      }
+
+      const QueryErrorResponse& getQueryErrorResponse() const
+      {
+        return theQueryErrorResponse;
+      }
+  };
+
 }//namespace aws
 #endif
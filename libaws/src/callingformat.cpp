@@ -34,6 +34,13 @@ CallingFormat::getRegularCallingFormat()
     return &lRegularCallingFormat;
 }
 
+VirtualHostCallingFormat*
+CallingFormat::getVirtualHostCallingFormat() 
+{
+    static VirtualHostCallingFormat lVirtualHostCallingFormat;
+    return &lVirtualHostCallingFormat;
+}
+
 CallingFormat::~CallingFormat()
 {
     
@@ -78,4 +85,65 @@ RegularCallingFormat::~RegularCallingFormat()
 {
 }
 
+bool
+VirtualHostCallingFormat::isDnsCompatible(bool aIsSecure, const std::string& aBucketName)
+{
+    // 3 to 63 lowercase letters, digits, dashes, and dots
+    // that neither start nor end with a dash or a dot
+    if (aBucketName.size() < 3 || aBucketName.size() > 63)
+      return false;
+    if (aBucketName.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789-.") != std::string::npos)
+      return false;
+    if (aBucketName.find("..") != std::string::npos || aBucketName.find(".-") != std::string::npos
+        || aBucketName.find("-.") != std::string::npos)
+      return false;
+    char lFirst = aBucketName[0];
+    char lLast = aBucketName[aBucketName.size() - 1];
+    if (lFirst == '-' || lFirst == '.' || lLast == '-' || lLast == '.')
+      return false;
+    // dots would not match the wildcard certificate of the server
+    if (aIsSecure && aBucketName.find('.') != std::string::npos)
+      return false;
+    return true;
+}
+
+std::string 
+VirtualHostCallingFormat::getEndpoint(std::string aServerName, int aPort, std::string aBucketName) 
+{
+    std::stringstream s;
+    if (aBucketName.size() != 0)
+      s << aBucketName << ".";
+    s << aServerName << ":" << aPort;
+    return s.str();
+}
+
+std::string
+VirtualHostCallingFormat::getPathBase(std::string /*aBucketName*/, std::string aKey)
+{
+    return "/" + aKey;
+}
+
+std::string
+VirtualHostCallingFormat::getUrl(bool aIsSecure, std::string aServer, int aPort, std::string aBucketName, 
+                                 std::string aKey, PathArgs_t* aPathArgs)
+{
+    if (aBucketName.size() == 0 || !isDnsCompatible(aIsSecure, aBucketName))
+      return getRegularCallingFormat()->getUrl(aIsSecure, aServer, aPort, aBucketName, aKey, aPathArgs);
+
+    std::stringstream s;
+    std::string::size_type lSchemeEnd = aServer.find("://");
+    if (lSchemeEnd == std::string::npos)
+      s << (aIsSecure ? "https://": "http://") << aBucketName << "." << aServer;
+    else
+      s << aServer.substr(0, lSchemeEnd + 3) << aBucketName << "." << aServer.substr(lSchemeEnd + 3);
+    if(aPort > 0)
+      s << ":" << aPort;
+    s << getPathBase(aBucketName, aKey) << Canonizer::convertPathArgs(aPathArgs);
+    return s.str();
+}
+
+VirtualHostCallingFormat::~VirtualHostCallingFormat()
+{
+}
+
 } /* namespace aws */
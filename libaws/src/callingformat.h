@@ -22,6 +22,7 @@
 namespace aws { 
 	
   class RegularCallingFormat;
+  class VirtualHostCallingFormat;
   typedef class std::map<std::string, std::string> PathArgs_t;
 
   class CallingFormat {
@@ -35,7 +36,8 @@ namespace aws {
                                  std::string aKey, PathArgs_t* aPathArgs) = 0;
 
     public:
-      static RegularCallingFormat*    getRegularCallingFormat();
+      static RegularCallingFormat*     getRegularCallingFormat();
+      static VirtualHostCallingFormat* getVirtualHostCallingFormat();
   };
 
   class RegularCallingFormat : public CallingFormat {
@@ -51,6 +53,21 @@ namespace aws {
       bool isBucketSpecified(std::string aBucketName);
   };
 
+  // addresses the bucket as part of the host name (i.e. bucket.s3.amazonaws.com/key)
+  // buckets whose name can't be used as a host name are addressed path-style
+  class VirtualHostCallingFormat : public CallingFormat {
+    public:
+      virtual ~VirtualHostCallingFormat();
+      virtual std::string getEndpoint(std::string aServer, int aPort, std::string aBucketName);
+      virtual std::string getPathBase(std::string aBucketName, std::string aKey);
+      virtual std::string getUrl(bool aIsSecure, std::string aServer, 
+                                 int aPort, std::string aBucketName, 
+                                 std::string aKey, PathArgs_t* aPathArgs);
+
+      // whether the bucket can be addressed as part of the host name
+      static bool isDnsCompatible(bool aIsSecure, const std::string& aBucketName);
+  };
+
 } /* namespace aws */
 
 
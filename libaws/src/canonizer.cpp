@@ -29,15 +29,17 @@ std::string
 Canonizer::canonicalize(s3::S3Connection::ActionType aType, 
                         std::string aBucketName, std::string aKey,
                         RequestHeaderMap* aHeaderMap, bool aAclParam, 
-                        bool aTorrentParam, bool aLoggingParam) {
+                        bool aTorrentParam, bool aLoggingParam,
+                        PathArgs_t* aSubResources) {
 
     std::stringstream lStringToSign;
     
     lStringToSign << s3::S3Connection::requestTypeForAction(aType) << "\n";
     aHeaderMap->getHeaderStringToSign(&lStringToSign);
     
-    // TODO repace with the help of the callingformat class
     // build the path using the bucket and key
+    // the resource is always signed path-style, regardless of the calling
+    // format used to address the bucket (path or virtual host)
     if (aBucketName.size() != 0) {
         lStringToSign << "/" << aBucketName;
     }
@@ -59,6 +61,12 @@ Canonizer::canonicalize(s3::S3Connection::ActionType aType,
         lStringToSign << "?logging";
         assert(!(aTorrentParam | aAclParam));
     } 
+
+    // e.g. ?partNumber=1&uploadId=... (the map keeps them sorted by name)
+    if (aSubResources) {
+        assert(!(aAclParam | aTorrentParam | aLoggingParam));
+        lStringToSign << convertPathArgs(aSubResources);
+    }
     
     return lStringToSign.str();
 }
@@ -32,7 +32,8 @@ public:
     static std::string canonicalize(s3::S3Connection::ActionType aRequestMethod, 
                                     std::string aBucketName, std::string aKey,
                                     RequestHeaderMap* aHeaderMap, bool aAclParam = false, 
-                                    bool aTorrentParam = false, bool aLoggingParam = false);
+                                    bool aTorrentParam = false, bool aLoggingParam = false,
+                                    PathArgs_t* aSubResources = 0);
                                     
     static std::string convertPathArgs(PathArgs_t* aPathArgs); 
 };
@@ -47,6 +47,7 @@ namespace aws {
     class HeadResponse;
     class DeleteResponse;
     class DeleteAllResponse;
+    class CopyResponse;
     class BucketLoggingStatusResponse;
     class SetBucketLoggingResponse;
     class DisableBucketLoggingResponse;
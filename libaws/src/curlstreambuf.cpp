@@ -21,21 +21,26 @@
 
 namespace aws { namespace s3 {
 
-CurlStreamBuffer::CurlStreamBuffer(CURL* aEasyHandle)
+CurlStreamBuffer::CurlStreamBuffer(CURL* aEasyHandle, bool aPerform)
   : std::streambuf(),
+    theMultiHandle(0),
     theEasyHandle(aEasyHandle)
 {
-  theMultiHandle = curl_multi_init();
   curl_easy_setopt(theEasyHandle, CURLOPT_WRITEDATA, this);
   curl_easy_setopt(theEasyHandle, CURLOPT_WRITEFUNCTION, CurlStreamBuffer::write_callback);
-  curl_multi_add_handle(theMultiHandle, theEasyHandle);
+  if (aPerform) {
+    theMultiHandle = curl_multi_init();
+    curl_multi_add_handle(theMultiHandle, theEasyHandle);
+  }
 }
 
 CurlStreamBuffer::~CurlStreamBuffer()
 {
   ::free(eback());
-  curl_multi_remove_handle(theMultiHandle, theEasyHandle);
-  curl_multi_cleanup(theMultiHandle);
+  if (theMultiHandle) {
+    curl_multi_remove_handle(theMultiHandle, theEasyHandle);
+    curl_multi_cleanup(theMultiHandle);
+  }
 }
 
 
@@ -52,6 +57,11 @@ CurlStreamBuffer::multi_perform()
     while (CURLM_CALL_MULTI_PERFORM == curl_multi_perform(theMultiHandle, &lStillRunning))
       ;
 
+    // wait for activity on the sockets or until curl's next timeout; unlike
+    // select on curl_multi_fdset this also waits while curl has no socket yet
+    if (lStillRunning)
+      curl_multi_wait(theMultiHandle, 0, 0, 1000, 0);
+
     while ((msg = curl_multi_info_read(theMultiHandle, &lMsgsInQueue))) {
       if (msg->msg == CURLMSG_DONE) {
         lError = msg->data.result;
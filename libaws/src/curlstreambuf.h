@@ -26,7 +26,9 @@ namespace aws { namespace s3 {
 class CurlStreamBuffer : public std::streambuf
 {
 public:
-  CurlStreamBuffer(CURL* aEasyHandle);
+  // if aPerform is false, the easy handle is performed by someone else
+  // (e.g. the multi handle of a reactor) and multi_perform must not be called
+  CurlStreamBuffer(CURL* aEasyHandle, bool aPerform = true);
   virtual ~CurlStreamBuffer();
 
   virtual int 
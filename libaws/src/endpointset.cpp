@@ -0,0 +1,156 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "endpointset.h"
+
+#include <algorithm>
+
+namespace aws {
+
+  const double EndpointSet::LATENCY_WEIGHT = 0.2;
+
+  EndpointSet::EndpointSet()
+    : theNumberOfFailovers(0)
+  {
+  }
+
+  void
+  EndpointSet::addEndpoint(const std::string& aHost, unsigned int aWeight)
+  {
+    Endpoint lEndpoint;
+    lEndpoint.theHost = aHost;
+    lEndpoint.theWeight = aWeight > 0 ? aWeight : 1;
+    lEndpoint.theLatency = 0;
+    lEndpoint.theFailures = 0;
+    lEndpoint.theRetryTime = 0;
+
+    theMutex.lock();
+    if (theEndpoints.size() < MAX_ENDPOINTS)
+      theEndpoints.push_back(lEndpoint);
+    theMutex.unlock();
+  }
+
+  size_t
+  EndpointSet::getNumberOfEndpoints() const
+  {
+    theMutex.lock();
+    size_t lSize = theEndpoints.size();
+    theMutex.unlock();
+    return lSize;
+  }
+
+  std::string
+  EndpointSet::getHost(size_t aEndpoint) const
+  {
+    theMutex.lock();
+    std::string lHost = theEndpoints[aEndpoint].theHost;
+    theMutex.unlock();
+    return lHost;
+  }
+
+  double
+  EndpointSet::getLatency(size_t aEndpoint) const
+  {
+    theMutex.lock();
+    double lLatency = theEndpoints[aEndpoint].theLatency;
+    theMutex.unlock();
+    return lLatency;
+  }
+
+  bool
+  EndpointSet::isHealthy(size_t aEndpoint) const
+  {
+    theMutex.lock();
+    bool lIsHealthy = theEndpoints[aEndpoint].theFailures == 0;
+    theMutex.unlock();
+    return lIsHealthy;
+  }
+
+  uint64_t
+  EndpointSet::getNumberOfFailovers() const
+  {
+    theMutex.lock();
+    uint64_t lFailovers = theNumberOfFailovers;
+    theMutex.unlock();
+    return lFailovers;
+  }
+
+  size_t
+  EndpointSet::select(Excluded aExcluded, std::string& aHost)
+  {
+    time_t lNow = time(0);
+    size_t lBest = MAX_ENDPOINTS;
+    double lBestScore = 0;
+    size_t lNextRetry = MAX_ENDPOINTS;
+
+    theMutex.lock();
+    for (size_t i = 0; i < theEndpoints.size(); ++i) {
+      if (aExcluded & ((Excluded) 1 << i))
+        continue;
+      const Endpoint& lEndpoint = theEndpoints[i];
+      if (lEndpoint.theFailures > 0 && lEndpoint.theRetryTime > lNow) {
+        if (lNextRetry == MAX_ENDPOINTS
+            || lEndpoint.theRetryTime < theEndpoints[lNextRetry].theRetryTime)
+          lNextRetry = i;
+        continue;
+      }
+      // endpoints due for a retry are probed like unmeasured ones
+      double lScore = lEndpoint.theFailures > 0 ? 0 : lEndpoint.theLatency / lEndpoint.theWeight;
+      if (lBest == MAX_ENDPOINTS || lScore < lBestScore) {
+        lBest = i;
+        lBestScore = lScore;
+      }
+    }
+    if (lBest == MAX_ENDPOINTS)
+      lBest = lNextRetry;
+    if (lBest != MAX_ENDPOINTS)
+      aHost = theEndpoints[lBest].theHost;
+    theMutex.unlock();
+    return lBest;
+  }
+
+  void
+  EndpointSet::reportSuccess(size_t aEndpoint, double aLatency)
+  {
+    theMutex.lock();
+    Endpoint& lEndpoint = theEndpoints[aEndpoint];
+    if (lEndpoint.theLatency == 0)
+      lEndpoint.theLatency = aLatency;
+    else
+      lEndpoint.theLatency += LATENCY_WEIGHT * (aLatency - lEndpoint.theLatency);
+    lEndpoint.theFailures = 0;
+    theMutex.unlock();
+  }
+
+  void
+  EndpointSet::reportFailure(size_t aEndpoint)
+  {
+    theMutex.lock();
+    Endpoint& lEndpoint = theEndpoints[aEndpoint];
+    time_t lInterval = (time_t) 1 << std::min(lEndpoint.theFailures, 6u);
+    lEndpoint.theRetryTime = time(0) + std::min(lInterval, MAX_RETRY_INTERVAL);
+    ++lEndpoint.theFailures;
+    theMutex.unlock();
+  }
+
+  void
+  EndpointSet::countFailover()
+  {
+    theMutex.lock();
+    ++theNumberOfFailovers;
+    theMutex.unlock();
+  }
+
+} /* namespace aws */
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_ENDPOINTSET_H
+#define AWS_ENDPOINTSET_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <time.h>
+#include <libaws/mutex.h>
+
+namespace aws {
+
+  // endpoints of a service that connections route their requests to
+  // (see aws::AWSEndpointSet); shared by connections of different threads
+  class EndpointSet : public SmartObject
+  {
+    public:
+      // a set of endpoints excluded from the selection (a bit per endpoint)
+      typedef uint64_t Excluded;
+
+      static const size_t MAX_ENDPOINTS = 64;
+
+      EndpointSet();
+
+      void
+      addEndpoint(const std::string& aHost, unsigned int aWeight);
+
+      size_t
+      getNumberOfEndpoints() const;
+
+      std::string
+      getHost(size_t aEndpoint) const;
+
+      double
+      getLatency(size_t aEndpoint) const;
+
+      bool
+      isHealthy(size_t aEndpoint) const;
+
+      uint64_t
+      getNumberOfFailovers() const;
+
+      // the best endpoint that isn't excluded or MAX_ENDPOINTS if all are:
+      // unmeasured endpoints first, then the healthy endpoint with the
+      // lowest latency per weight, and the endpoint that is retried next if
+      // none is healthy
+      size_t
+      select(Excluded aExcluded, std::string& aHost);
+
+      // aLatency is the time to the first byte of a response in seconds
+      void
+      reportSuccess(size_t aEndpoint, double aLatency);
+
+      // marks the endpoint as unhealthy; it is retried after a second,
+      // doubled for every further failure up to a minute
+      void
+      reportFailure(size_t aEndpoint);
+
+      void
+      countFailover();
+
+    protected:
+      struct Endpoint
+      {
+        std::string   theHost;
+        unsigned int  theWeight;
+        double        theLatency;   // moving average, 0 if not measured
+        unsigned int  theFailures;  // consecutive failures
+        time_t        theRetryTime; // unhealthy until then
+      };
+
+      // weight of a new latency in the moving average
+      static const double LATENCY_WEIGHT;
+      static const time_t MAX_RETRY_INTERVAL = 60;
+
+      mutable AWSMutex      theMutex;
+      std::vector<Endpoint> theEndpoints;
+      uint64_t              theNumberOfFailovers;
+  };
+
+} /* namespace aws */
+#endif
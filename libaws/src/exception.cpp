@@ -15,6 +15,8 @@
  */
 #include <libaws/exception.h>
 
+#include <cstring>
+
 namespace aws {
 
   AWSException::~AWSException() throw()
@@ -60,6 +62,17 @@ namespace aws {
     return theErrorString.c_str();
   }
 
+  AWSFileException::AWSFileException(const std::string& aFileName, int aErrno)
+    : theErrorString(aFileName + ": " + strerror(aErrno)) {}
+
+  AWSFileException::~AWSFileException() throw() {}
+
+  const char*
+  AWSFileException::what() const throw()
+  {
+    return theErrorString.c_str();
+  }
+
   AWSInitializationException::AWSInitializationException(const std::string& aErrorString) 
     : theErrorString(aErrorString) {}
 
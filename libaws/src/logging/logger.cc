@@ -5,18 +5,27 @@
 #include "logging/loggermanager.hh"
 #include "logging/loggerconfig.hh"
 
+#include <libaws/awslog.h>
+
 
 namespace logging {
+
+namespace {
+  // sinks of the log messages; called by the writer thread of aws::AWSLog
+  void writeLogMessage(int, const char* message, void* config) {
+    static_cast<LoggerConfig*>(config)->logMessage(message);
+  }
+
+  void writeXMLMessage(int, const char* message, void* config) {
+    static_cast<LoggerConfig*>(config)->logXMLMessage(message);
+  }
+}
   bool Logger::DO_XML_LOG=true;
 
   Logger::Logger(const std::string& loggerName) : theLoggerName(loggerName){
 	theLoggerPtr = LoggerManager::logmanager()->registerLogger(loggerName);
 }
 
-int Logger::getLevel() const{
-	return theLoggerPtr->getLogLevel();
-}
-
 void Logger::logMessage(int level, const std::string& message, uint32_t line) {
 	if(getLevel() <= level)
 	{
@@ -36,8 +45,7 @@ void Logger::logMessage(int level, const std::string& message, uint32_t line) {
       logMessage << theLoggerName << std::string(width, ' ') << '\t';
     }
 		logMessage << "LogLevel=" << level << '\t' << message << std::endl ;
-		std::string lMessage(logMessage.str().c_str());
-	  theLoggerPtr->logMessage(lMessage);
+	  aws::AWSLog::log(level, logMessage.str(), &writeLogMessage, theLoggerPtr);
 
     if(DO_XML_LOG){
       std::stringstream log4jMessage;
@@ -64,8 +72,7 @@ void Logger::logMessage(int level, const std::string& message, uint32_t line) {
 
 
        log4jMessage << "</log4j:event>\r\n\r\n" << std::endl;
-       std::string lXMLMessage(log4jMessage.str().c_str());
-       theLoggerPtr->logXMLMessage(lXMLMessage);
+       aws::AWSLog::log(level, log4jMessage.str(), &writeXMLMessage, theLoggerPtr);
 
     }
 	}
@@ -3,11 +3,10 @@
 
 #include <string>
 #include <libaws/common.h>
+#include "logging/loggerconfig.hh"
 
 namespace logging {
 
-class LoggerConfig;
-
 	class Logger {
 	 public:
 	 	  /**
@@ -20,7 +19,7 @@ class LoggerConfig;
 	       * returns the current log level for this logger
 	       * @return the log level
 	       */
-	      int getLevel() const;
+	      int getLevel() const { return theLoggerPtr->getLogLevel(); }
 
 	      /**
 	       * sets the new log level for this logger
@@ -62,10 +62,6 @@ namespace logging {
   }
 
 
-  int LoggerConfig::getLogLevel() const {
-      return theLogLevel;
-    }
-
   void LoggerConfig::setLogLevel (int newLevel) {
     theLogLevel = newLevel;
   }
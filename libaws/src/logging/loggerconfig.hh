@@ -32,7 +32,7 @@ class LoggerConfig {
 		 * returns the log level for this config
 		 * @return the log level
 		 */
-		int getLogLevel() const;
+		int getLogLevel() const { return theLogLevel; }
 		
 		/**
 		 * sets the new level for this config
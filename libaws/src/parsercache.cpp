@@ -0,0 +1,95 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "parsercache.h"
+
+#include <string.h>
+
+namespace aws {
+
+  ParserCache::~ParserCache()
+  {
+    if (theParser)
+      destroy(theParser);
+  }
+
+  ParserCache::Parser
+  ParserCache::acquire(xmlSAXHandler* aSAXHandler, void* aUserData)
+  {
+    if (theInUse)
+      return create(aSAXHandler, aUserData);
+
+    if (!theParser) {
+      theParser = create(aSAXHandler, aUserData);
+      if (!theParser)
+        return 0;
+    } else {
+#ifdef AWS_XML_TOKENIZER
+      theParser->reset(aSAXHandler, aUserData);
+#else
+      xmlCtxtResetPush(theParser, NULL, 0, NULL, NULL);
+      // the context owns a copy of the handler that was passed on creation
+      memcpy(theParser->sax, aSAXHandler, sizeof(xmlSAXHandler));
+      theParser->userData = aUserData;
+#endif
+    }
+    theInUse = true;
+    return theParser;
+  }
+
+  void
+  ParserCache::release(Parser aParser)
+  {
+    if (aParser == theParser)
+      theInUse = false;
+    else
+      destroy(aParser);
+  }
+
+  ParserCache::Parser
+  ParserCache::create(xmlSAXHandler* aSAXHandler, void* aUserData)
+  {
+#ifdef AWS_XML_TOKENIZER
+    XMLTokenizer* lTokenizer = new XMLTokenizer();
+    lTokenizer->reset(aSAXHandler, aUserData);
+    return lTokenizer;
+#else
+    return xmlCreatePushParserCtxt(aSAXHandler, aUserData, NULL, 0, 0);
+#endif
+  }
+
+  void
+  ParserCache::destroy(Parser aParser)
+  {
+#ifdef AWS_XML_TOKENIZER
+    delete aParser;
+#else
+    xmlFreeParserCtxt(aParser);
+#endif
+  }
+
+  void
+  ParserCache::parseChunk(Parser aParser, const char* aChunk, int aSize, bool aTerminate)
+  {
+    if (!aParser)
+      return;
+#ifdef AWS_XML_TOKENIZER
+    aParser->parseChunk(aChunk, aSize, aTerminate);
+#else
+    xmlParseChunk(aParser, aChunk, aSize, aTerminate ? 1 : 0);
+#endif
+  }
+
+} /* namespace aws */
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_PARSERCACHE_H
+#define AWS_PARSERCACHE_H
+
+#include <libaws/config.h>
+#include <libxml/parser.h>
+
+#ifdef AWS_XML_TOKENIZER
+#  include "xmltokenizer.h"
+#endif
+
+namespace aws {
+
+  // Keeps the push parser of a connection between requests.
+  // Creating a libxml2 context allocates the dictionary, the input stacks,
+  // and the SAX handler, which dominates the handling of small responses; a
+  // context that is reset keeps these allocations.
+  class ParserCache
+  {
+    public:
+#ifdef AWS_XML_TOKENIZER
+      typedef XMLTokenizer* Parser;
+#else
+      typedef xmlParserCtxtPtr Parser;
+#endif
+
+      ParserCache() : theParser(0), theInUse(false) {}
+      ~ParserCache();
+
+      // returns a parser that calls the functions of aSAXHandler with
+      // aUserData; it must be given back by release before the next acquire
+      // (a new parser is created if the cached one is still in use)
+      Parser
+      acquire(xmlSAXHandler* aSAXHandler, void* aUserData);
+
+      void
+      release(Parser aParser);
+
+      // a parser that isn't cached
+      static Parser
+      create(xmlSAXHandler* aSAXHandler, void* aUserData);
+
+      static void
+      destroy(Parser aParser);
+
+      static void
+      parseChunk(Parser aParser, const char* aChunk, int aSize, bool aTerminate);
+
+    protected:
+      Parser theParser;
+      bool   theInUse;
+  };
+
+} /* namespace aws */
+#endif
@@ -28,6 +28,7 @@ namespace aws {
     class GetHandler;
     class DeleteHandler;
     class HeadHandler;
+    class CopyHandler;
     class BucketLoggingStatusHandler;
     class SetBucketLoggingHandler;
     class DisableBucketLoggingHandler;
@@ -44,6 +45,7 @@ namespace aws {
     friend class aws::s3::GetHandler;
     friend class aws::s3::DeleteHandler;
     friend class aws::s3::HeadHandler;
+    friend class aws::s3::CopyHandler;
     friend class aws::s3::BucketLoggingStatusHandler;
     friend class aws::s3::SetBucketLoggingHandler;
     friend class aws::s3::DisableBucketLoggingHandler;
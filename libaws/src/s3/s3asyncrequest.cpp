@@ -0,0 +1,59 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "s3/s3asyncrequest.h"
+#include "s3/s3response.h"
+
+#include <curl/curl.h>
+
+namespace aws { namespace s3 {
+
+S3AsyncRequest::S3AsyncRequest(int aActionType, S3Response* aResponse, S3Handler* aHandler,
+                               void (*aThrowError)(S3Response*))
+  : theActionType(aActionType),
+    theResponse(aResponse),
+    theHandler(aHandler),
+    theSList(0),
+    theThrowError(aThrowError)
+{
+}
+
+S3AsyncRequest::~S3AsyncRequest()
+{
+  theWrapper.destroyParser();
+  if (theSList)
+    curl_slist_free_all(theSList);
+  delete theResponse;
+  delete theHandler;
+}
+
+S3Response*
+S3AsyncRequest::releaseResponse()
+{
+  S3Response* lResponse = theResponse;
+  theResponse = 0;
+  return lResponse;
+}
+
+S3Response*
+S3AsyncRequest::finish(bool aThrow)
+{
+  if (aThrow && !theResponse->isSuccessful())
+    theThrowError(theResponse);
+  return releaseResponse();
+}
+
+} /* namespace s3 */
+} /* namespace aws */
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3_S3ASYNCREQUEST_H
+#define AWS_S3_S3ASYNCREQUEST_H
+
+#include "common.h"
+
+#include "s3/s3object.h"
+#include "s3/s3handler.h"
+#include "s3/s3callbackwrapper.h"
+
+struct curl_slist;
+
+namespace aws { namespace s3 {
+
+// state of a request that is started by S3Connection::startXXX, performed
+// by a reactor, and completed by S3Connection::finishAsync
+class S3AsyncRequest
+{
+public:
+  S3AsyncRequest(int aActionType, S3Response* aResponse, S3Handler* aHandler,
+                 void (*aThrowError)(S3Response*));
+  ~S3AsyncRequest();
+
+  // transfers the ownership of the response to the caller
+  S3Response*
+  releaseResponse();
+
+  // like releaseResponse, but throws the exception of the request type if
+  // aThrow is true and the request wasn't successful (like S3Request::finish)
+  S3Response*
+  finish(bool aThrow = true);
+
+  int                theActionType; // S3Connection::ActionType
+  S3Response*        theResponse;
+  S3Handler*         theHandler;
+  S3CallBackWrapper  theWrapper;
+  S3Object           theObject;     // data of a put
+  struct curl_slist* theSList;      // headers of the request
+
+  // throws the exception of the request type (see s3requesttraits.h)
+  void             (*theThrowError)(S3Response*);
+};
+
+} /* namespace s3 */
+} /* namespace aws */
+#endif
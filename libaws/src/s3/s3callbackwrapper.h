@@ -19,20 +19,32 @@
 #include <string.h>
 
 #include <libxml/parser.h>
+#include <curl/curl.h>
 
 #include "s3/s3response.h"
+#include "parsercache.h"
 
 namespace aws
 {
   namespace s3
   {
     class S3Handler;
+    class S3Target;
+    class GetResponse;
 
     class S3CallBackWrapper
     {
     public:
       S3CallBackWrapper()
-        : theParserCreated(false)
+        : theParserCreated(false),
+          theParserCache(0),
+          theParserCtxt(0),
+          theTarget(0),
+          theMethod(0),
+          theHeaderParser(0),
+          theGetResponse(0),
+          theContentLength(0),
+          theIsDecoded(false)
       {
         memset ( &theSAXHandler, 0, sizeof ( theSAXHandler ) );
         theSAXHandler.initialized    = XML_SAX2_MAGIC;
@@ -40,27 +52,58 @@ namespace aws
       
       ~S3CallBackWrapper()
       {
+        // gives the parser back to the cache if a request failed early
+        destroyParser();
       }
 
+      // the parser itself is only created once the first chunk of the body
+      // arrives, i.e. never for responses without a body
       void
       createParser()
       {
-        theParserCtxt = xmlCreatePushParserCtxt ( &theSAXHandler, this, NULL, 0, 0 );
         theParserCreated = true;
       }
 
+      void
+      parseChunk(const char* aChunk, int aSize, bool aTerminate)
+      {
+        if (!theParserCtxt) {
+          if (aSize == 0)
+            return;
+          theParserCtxt = theParserCache
+              ? theParserCache->acquire(&theSAXHandler, this)
+              : ParserCache::create(&theSAXHandler, this);
+        }
+        ParserCache::parseChunk(theParserCtxt, aChunk, aSize, aTerminate);
+      }
+
       void
       destroyParser()
       {
-        if (theParserCreated)
-          xmlFreeParserCtxt ( theParserCtxt );        
+        if (theParserCtxt) {
+          if (theParserCache)
+            theParserCache->release(theParserCtxt);
+          else
+            ParserCache::destroy(theParserCtxt);
+        }
+        theParserCtxt = 0;
+        theParserCreated = false;
       }
 
       bool                    theParserCreated;
+      aws::ParserCache*       theParserCache; // set by the connection
       aws::s3::S3Response*    theResponse;
       aws::s3::S3Handler*     theHandler;
       xmlSAXHandler           theSAXHandler;
-      xmlParserCtxtPtr        theParserCtxt;
+      ParserCache::Parser     theParserCtxt;
+      aws::s3::S3Target*      theTarget; // only set for gets that don't use a stream buffer
+
+      // bound by the request traits of the request type (see s3requesttraits.h)
+      void                  (*theMethod)(CURL*);
+      void                  (*theHeaderParser)(S3Response*, const std::string&);
+      aws::s3::GetResponse*   theGetResponse;   // only set for gets
+      long long*              theContentLength; // only set for gets and heads
+      bool                    theIsDecoded;     // the object was compressed by put
     };
 
 } }
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "s3/s3codec.h"
+#include "s3/s3response.h"
+
+#include <cstring>
+
+namespace aws { namespace s3 {
+
+const char* CODEC_METADATA  = "libaws-codec";
+const char* LENGTH_METADATA = "libaws-length";
+const char* GZIP_CODEC      = "gzip";
+
+// windowBits for deflateInit2/inflateInit2 that selects the gzip format
+#define GZIP_WINDOW_BITS (15 + 16)
+
+GzipCodec::GzipCodec(bool aCompress, Sink aSink, void* aUserData)
+  : theCompress(aCompress),
+    theIsFinished(false),
+    theSink(aSink),
+    theUserData(aUserData)
+{
+  memset(&theStream, 0, sizeof(theStream));
+  int lRes;
+  if (theCompress) {
+    lRes = deflateInit2(&theStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                        GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY);
+  } else {
+    lRes = inflateInit2(&theStream, GZIP_WINDOW_BITS);
+  }
+  theIsInitialized = (lRes == Z_OK);
+}
+
+GzipCodec::~GzipCodec()
+{
+  if (theIsInitialized) {
+    if (theCompress)
+      deflateEnd(&theStream);
+    else
+      inflateEnd(&theStream);
+  }
+}
+
+bool
+GzipCodec::process(const char* aData, size_t aSize)
+{
+  theStream.next_in = (Bytef*) aData;
+  theStream.avail_in = aSize;
+  return run(Z_NO_FLUSH);
+}
+
+bool
+GzipCodec::finish()
+{
+  theStream.next_in = 0;
+  theStream.avail_in = 0;
+  return run(Z_FINISH);
+}
+
+bool
+GzipCodec::run(int aFlush)
+{
+  if (!theIsInitialized)
+    return false;
+
+  int lRes;
+  do {
+    theStream.next_out = (Bytef*) theBuffer;
+    theStream.avail_out = BUFFER_SIZE;
+    lRes = theCompress ? deflate(&theStream, aFlush) : inflate(&theStream, Z_NO_FLUSH);
+    if (lRes != Z_OK && lRes != Z_STREAM_END && lRes != Z_BUF_ERROR)
+      return false;
+    if (lRes == Z_STREAM_END)
+      theIsFinished = true;
+    size_t lProduced = BUFFER_SIZE - theStream.avail_out;
+    if (lProduced > 0 && !theSink(theBuffer, lProduced, theUserData))
+      return false;
+    // the output buffer was filled completely, so there might be more
+  } while (theStream.avail_out == 0 && lRes != Z_STREAM_END);
+
+  return true;
+}
+
+bool
+GzipCodec::isCompressible(const std::string& aContentType)
+{
+  // same kind of data as CACHE_TEXT_FILES_ONLY in s3fs: text, xml, and scripts
+  return aContentType.compare(0, 5, "text/") == 0
+      || aContentType.find("xml") != std::string::npos
+      || aContentType.find("json") != std::string::npos
+      || aContentType.find("javascript") != std::string::npos;
+}
+
+
+GzipStreamBuffer::GzipStreamBuffer(std::streambuf* aSource)
+  : std::streambuf(),
+    theSource(aSource),
+    theIsFinished(false)
+{
+  memset(&theStream, 0, sizeof(theStream));
+  theIsInitialized = (inflateInit2(&theStream, GZIP_WINDOW_BITS) == Z_OK);
+  setg(theOutput, theOutput, theOutput);
+}
+
+GzipStreamBuffer::~GzipStreamBuffer()
+{
+  if (theIsInitialized)
+    inflateEnd(&theStream);
+}
+
+void
+GzipStreamBuffer::fail(const char* aMessage)
+{
+  // std::istream turns this into badbit on the stream reading from us
+  S3ResponseError lError;
+  lError.theErrorCode = S3Exception::InternalError;
+  lError.theErrorMessage = aMessage;
+  throw GetException(lError);
+}
+
+int
+GzipStreamBuffer::underflow()
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+
+  if (!theIsInitialized || theIsFinished)
+    return traits_type::eof();
+
+  theStream.next_out = (Bytef*) theOutput;
+  theStream.avail_out = sizeof(theOutput);
+
+  // inflate until at least one byte was produced
+  while (theStream.avail_out == sizeof(theOutput)) {
+    if (theStream.avail_in == 0) {
+      std::streamsize lRead = theSource->sgetn(theInput, sizeof(theInput));
+      if (lRead <= 0) {
+        theIsFinished = true;
+        fail("compressed object is truncated");
+      }
+      theStream.next_in = (Bytef*) theInput;
+      theStream.avail_in = lRead;
+    }
+    int lRes = inflate(&theStream, Z_NO_FLUSH);
+    if (lRes == Z_STREAM_END) {
+      theIsFinished = true;
+      break;
+    } else if (lRes != Z_OK && lRes != Z_BUF_ERROR) {
+      theIsFinished = true;
+      fail("compressed object is corrupt");
+    }
+  }
+
+  size_t lProduced = sizeof(theOutput) - theStream.avail_out;
+  setg(theOutput, theOutput, theOutput + lProduced);
+  if (lProduced == 0)
+    return traits_type::eof();
+  return traits_type::to_int_type(*gptr());
+}
+
+} /* namespace s3 */
+} /* namespace aws */
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3_S3CODEC_H
+#define AWS_S3_S3CODEC_H
+
+#include <streambuf>
+#include <string>
+#include <zlib.h>
+
+namespace aws { namespace s3 {
+
+// metadata entries (x-amz-meta-*) of objects that were compressed by put
+extern const char* CODEC_METADATA;  // name of the codec (i.e. "gzip")
+extern const char* LENGTH_METADATA; // size of the uncompressed object
+extern const char* GZIP_CODEC;
+
+// gzip compression or decompression of a stream of data with a fixed size
+// output buffer; the output is passed to a sink whenever the buffer is full
+class GzipCodec
+{
+public:
+  // returns false if the data couldn't be consumed (aborts the codec)
+  typedef bool (*Sink)(const char* aData, size_t aSize, void* aUserData);
+
+  GzipCodec(bool aCompress, Sink aSink, void* aUserData);
+  ~GzipCodec();
+
+  // returns false if the data is corrupt or the sink failed
+  bool
+  process(const char* aData, size_t aSize);
+
+  // flushes the remaining output (compression only)
+  bool
+  finish();
+
+  // true once the end of the compressed data has been decoded
+  bool
+  isFinished() const { return theIsFinished; }
+
+  static bool
+  isCompressible(const std::string& aContentType);
+
+  static const size_t BUFFER_SIZE = 16384;
+
+protected:
+  bool
+  run(int aFlush);
+
+  z_stream theStream;
+  bool     theCompress;
+  bool     theIsInitialized;
+  bool     theIsFinished;
+  Sink     theSink;
+  void*    theUserData;
+  char     theBuffer[BUFFER_SIZE];
+};
+
+// read-only stream buffer that decompresses the data of another stream buffer
+class GzipStreamBuffer : public std::streambuf
+{
+public:
+  GzipStreamBuffer(std::streambuf* aSource);
+  virtual ~GzipStreamBuffer();
+
+  virtual int
+  underflow();
+
+protected:
+  void
+  fail(const char* aMessage);
+
+  std::streambuf* theSource;
+  z_stream        theStream;
+  bool            theIsInitialized;
+  bool            theIsFinished;
+  char            theInput[GzipCodec::BUFFER_SIZE];
+  char            theOutput[GzipCodec::BUFFER_SIZE];
+};
+
+} /* namespace s3 */
+} /* namespace aws */
+#endif
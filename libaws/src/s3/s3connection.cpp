@@ -16,6 +16,12 @@
 #include "common.h"
 
 #include <memory>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sys/time.h>
 #include <curl/curl.h>
 #include <openssl/hmac.h>
 #include <cassert>
@@ -26,6 +32,7 @@
 #include "callingformat.h"
 #include "util.h"
 #include "curlstreambuf.h"
+#include "s3/s3codec.h"
 
 
 #include "s3/s3connection.h"
@@ -33,6 +40,8 @@
 #include "s3/s3handler.h"
 #include "s3/s3response.h"
 #include "s3/s3callbackwrapper.h"
+#include "s3/s3requesttraits.h"
+#include "s3/s3asyncrequest.h"
 
 /* min(a,b) macro defined in WinDef.h */
 #ifdef min
@@ -43,35 +52,42 @@ using namespace aws;
 
 namespace aws { namespace s3 {
 
-#define REQUEST_PROLOG(REQUESTNAME)                                                   \
-  REQUESTNAME ## Handler  lHandler;                                                    \
-  S3CallBackWrapper       lWrapper;                                                   \
-                                                                                      \
-  lWrapper.theResponse  = lRes.get();                                                 \
-  lWrapper.theHandler   = &lHandler;                                                  \
-                                                                                      \
-  lWrapper.theSAXHandler.startElementNs = &REQUESTNAME ## Handler::startElementNs;    \
-  lWrapper.theSAXHandler.characters     = &REQUESTNAME ## Handler::charactersSAXFunc; \
-  lWrapper.theSAXHandler.endElementNs   = &REQUESTNAME ## Handler::endElementNs;      \
-                                                                                      \
-  lWrapper.createParser();                                                            \
-                                                                                      \
-  try {
+namespace {
 
-#define REQUEST_EPILOG(REQUESTNAME)                                \
-  } catch (AWSConnectionException& ce) {                           \
-    lWrapper.destroyParser();                                      \
-    throw ce;                                                      \
-  } catch (AWSException& e) {                                      \
-    lWrapper.destroyParser();                                      \
-    throw e;                                                       \
-  }                                                                \
-  lWrapper.destroyParser();                                        \
-                                                                   \
-  if ( ! lRes->isSuccessful() )                                    \
-    throw REQUESTNAME ## Exception( lRes->theS3ResponseError );
+  // escapes a key or a query argument for the use in an url
+  std::string
+  escape(const std::string& aString)
+  {
+    char* lEscapedChar = curl_escape(aString.c_str(), aString.size());
+    std::string lEscaped(lEscapedChar);
+    curl_free(lEscapedChar);
+    return lEscaped;
+  }
 
+  // microseconds since the epoch
+  long long
+  now()
+  {
+    struct timeval lTime;
+    gettimeofday(&lTime, 0);
+    return lTime.tv_sec * 1000000LL + lTime.tv_usec;
+  }
 
+} /* anonymous namespace */
+
+template <int ActionType>
+S3AsyncRequest*
+S3Connection::createAsyncRequest(S3Response* aResponse)
+{
+  typedef S3RequestTraits<ActionType> Traits;
+
+  typename Traits::Response* lResponse = static_cast<typename Traits::Response*>(aResponse);
+  typename Traits::Handler* lHandler = new typename Traits::Handler();
+  S3AsyncRequest* lRequest = new S3AsyncRequest(ActionType, lResponse, lHandler,
+                                                &S3Connection::throwError<ActionType>);
+  bindRequest<ActionType>(lRequest->theWrapper, lResponse, lHandler);
+  return lRequest;
+}
 
 std::string S3Connection::DEFAULT_HOST = "s3.amazonaws.com";
 
@@ -79,7 +95,19 @@ S3Connection::S3Connection(const std::string& aAccessKeyId, const std::string& a
                            const std::string& aCustomHost)
   : AWSConnection(aAccessKeyId, aSecretAccessKey, aCustomHost.size()==0?DEFAULT_HOST:aCustomHost, -1, true),
     theEncryptedResultSize(0),
-    theBase64EncodedString(0)
+    theBase64EncodedString(0),
+    theCallingFormat(CallingFormat::getRegularCallingFormat()),
+    theCompress(false),
+    theHttpVersion(HTTP_1_0),
+    theMulti(0),
+    theHedgePercentile(0),
+    theHedgeBudget(0),
+    theHedgeTokens(0),
+    theHedgeConnection(0),
+    theHedgeMulti(0),
+    theNextLatency(0),
+    theNumberOfHedgedRequests(0),
+    theNumberOfHedgeWins(0)
 {
   // set callbacks for retrieving all http header information
   curl_easy_setopt(theCurl, CURLOPT_HEADERFUNCTION, S3Connection::getHeaderData);
@@ -87,134 +115,113 @@ S3Connection::S3Connection(const std::string& aAccessKeyId, const std::string& a
   curl_easy_setopt(theCurl, CURLOPT_ERRORBUFFER, theCurlErrorBuffer);
 
   // we enforce http 1.0 here in order to not use transfer-encoding: chunked
-  // amazon doesn't understand that
+  // amazon doesn't understand that (see setHttpVersion)
   curl_easy_setopt(theCurl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
 
 }
 
-S3Connection::~S3Connection() {  }
+S3Connection::~S3Connection()
+{
+  delete theHedgeConnection;
+  if (theHedgeMulti)
+    curl_multi_cleanup(theHedgeMulti);
+  if (theMulti)
+    curl_multi_cleanup(theMulti);
+}
+
+void
+S3Connection::setHttpVersion(HttpVersion aVersion)
+{
+  // put always sends the content length and suppresses transfer-encoding,
+  // so newer versions of http are safe to use
+  long lVersion = aVersion == HTTP_1_0 ? CURL_HTTP_VERSION_1_0 : CURL_HTTP_VERSION_1_1;
+#ifdef CURLPIPE_MULTIPLEX
+  if (aVersion == HTTP_2)
+    lVersion = CURL_HTTP_VERSION_2TLS;
+  // wait for a connection that can be multiplexed instead of opening a new one
+  curl_easy_setopt(theCurl, CURLOPT_PIPEWAIT, aVersion == HTTP_2 ? 1L : 0L);
+#endif
+  curl_easy_setopt(theCurl, CURLOPT_HTTP_VERSION, lVersion);
+  theHttpVersion = aVersion;
+}
+
+void
+S3Connection::setHedging(unsigned int aPercentile, unsigned int aBudget)
+{
+  theHedgePercentile = std::min(aPercentile, 100u);
+  theHedgeBudget = aBudget;
+  theHedgeTokens = 0;
+}
+
+void
+S3Connection::setCallingFormat(CallingFormat* aCallingFormat)
+{
+  theCallingFormat = aCallingFormat;
+}
+
+void
+S3Connection::setCallingFormat(const std::string& aBucketName, CallingFormat* aCallingFormat)
+{
+  if (aCallingFormat)
+    theBucketCallingFormats[aBucketName] = aCallingFormat;
+  else
+    theBucketCallingFormats.erase(aBucketName);
+}
+
+CallingFormat*
+S3Connection::getCallingFormat(const std::string& aBucketName) const
+{
+  std::map<std::string, CallingFormat*>::const_iterator lIter =
+      theBucketCallingFormats.find(aBucketName);
+  return lIter == theBucketCallingFormats.end() ? theCallingFormat : (*lIter).second;
+}
 
 // Bucket handling functions
 CreateBucketResponse*
 S3Connection::createBucket(const std::string& aBucketName)
 {
-  std::auto_ptr<CreateBucketResponse> lRes(new CreateBucketResponse(aBucketName));
+  S3Request<CREATE_BUCKET> lRequest(new CreateBucketResponse(aBucketName));
 
-  REQUEST_PROLOG(CreateBucket);
+  makeRequest(aBucketName, CREATE_BUCKET, lRequest.getWrapper(), 0, 0);
 
-  makeRequest(aBucketName, CREATE_BUCKET, &lWrapper, 0, 0);
-
-  REQUEST_EPILOG(CreateBucket);
-
-  return lRes.release();
+  return lRequest.finish();
 }
 
 ListAllBucketsResponse*
 S3Connection::listAllBuckets()
 {
-  std::auto_ptr<ListAllBucketsResponse> lRes(new ListAllBucketsResponse());
+  S3Request<LIST_ALL_BUCKETS> lRequest(new ListAllBucketsResponse());
 
-  REQUEST_PROLOG(ListAllBuckets);
+  makeRequest("", LIST_ALL_BUCKETS, lRequest.getWrapper(), 0, 0);
 
-  makeRequest("", LIST_ALL_BUCKETS, &lWrapper, 0, 0);
-
-  REQUEST_EPILOG(ListAllBuckets);
-
-  return lRes.release();
+  return lRequest.finish();
 }
 
 ListBucketResponse*
 S3Connection::listBucket(const std::string& aBucketName, const std::string& aPrefix,
                          const std::string& aMarker, int aMaxKeys)
 {
-  std::auto_ptr<ListBucketResponse> lRes(new ListBucketResponse(aBucketName, aPrefix,
-                                                                aMarker, aMaxKeys));
-
-  ListBucketHandler     lHandler;
-
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
-
-  lWrapper.theSAXHandler.startElementNs = &ListBucketHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &ListBucketHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &ListBucketHandler::endElementNs;
-
-  PathArgs_t lPathArgsMap;
-
-  char* lEscapedPrefixChar = curl_escape(aPrefix.c_str(), aPrefix.size());
-  char* lEscapedMarkerChar = curl_escape(aMarker.c_str(), aMarker.size());
-
-  std::string lEscapedPrefix(lEscapedPrefixChar);
-  std::string lEscapedMarker(lEscapedMarkerChar);
-
-  if (lEscapedPrefix.size() != 0)
-      lPathArgsMap.insert(stringpair_t("prefix", lEscapedPrefix));
-
-  if (lEscapedMarker.size() != 0)
-      lPathArgsMap.insert(stringpair_t("marker", lEscapedMarker));
-
-  if (aMaxKeys != -1) {
-      std::stringstream s;
-      s << aMaxKeys;
-      lPathArgsMap.insert(stringpair_t("max-keys", s.str()));
-  }
-
-  lWrapper.createParser();
-
-  try {
-    makeRequest(aBucketName, LIST_BUCKET, &lWrapper, &lPathArgsMap, 0);
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    curl_free(lEscapedPrefixChar);
-    curl_free(lEscapedMarkerChar);
-    throw e;
-  }
-  lWrapper.destroyParser();
-  curl_free(lEscapedPrefixChar);
-  curl_free(lEscapedMarkerChar);
-
-  if ( ! lRes->isSuccessful() )
-    throw ListBucketException( lRes->theS3ResponseError );
-
-  return lRes.release();
+  return listBucket(aBucketName, aPrefix, aMarker, "", aMaxKeys);
 }
 
 ListBucketResponse*
 S3Connection::listBucket(const std::string& aBucketName, const std::string& aPrefix,
-                         const std::string& aMarker, const std::string& aDelimiter, int aMaxKeys)
+                         const std::string& aMarker, const std::string& aDelimiter, int aMaxKeys,
+                         bool aThrow)
 {
-  std::auto_ptr<ListBucketResponse> lRes(new ListBucketResponse(aBucketName, aPrefix,
-                                                                aMarker, aMaxKeys));
-
-  ListBucketHandler     lHandler;
-
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
-
-  lWrapper.theSAXHandler.startElementNs = &ListBucketHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &ListBucketHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &ListBucketHandler::endElementNs;
+  S3Request<LIST_BUCKET> lRequest(new ListBucketResponse(aBucketName, aPrefix,
+                                                         aMarker, aMaxKeys));
 
   PathArgs_t lPathArgsMap;
 
-  char* lEscapedPrefixChar = curl_escape(aPrefix.c_str(), aPrefix.size());
-  char* lEscapedMarkerChar = curl_escape(aMarker.c_str(), aMarker.size());
-  char* lEscapedDelimiterChar = curl_escape(aDelimiter.c_str(), aDelimiter.size());
+  if (aPrefix.size() != 0)
+      lPathArgsMap.insert(stringpair_t("prefix", escape(aPrefix)));
 
-  std::string lEscapedPrefix(lEscapedPrefixChar);
-  std::string lEscapedMarker(lEscapedMarkerChar);
-  std::string lEscapedDelimiter(lEscapedDelimiterChar);
+  if (aMarker.size() != 0)
+      lPathArgsMap.insert(stringpair_t("marker", escape(aMarker)));
 
-  if (lEscapedPrefix.size() != 0)
-      lPathArgsMap.insert(stringpair_t("prefix", lEscapedPrefix));
-
-  if (lEscapedMarker.size() != 0)
-      lPathArgsMap.insert(stringpair_t("marker", lEscapedMarker));
-
-  if (lEscapedDelimiter.size() != 0)
-      lPathArgsMap.insert(stringpair_t("delimiter", lEscapedDelimiterChar));
+  if (aDelimiter.size() != 0)
+      lPathArgsMap.insert(stringpair_t("delimiter", escape(aDelimiter)));
 
   if (aMaxKeys != -1) {
       std::stringstream s;
@@ -222,43 +229,19 @@ S3Connection::listBucket(const std::string& aBucketName, const std::string& aPre
       lPathArgsMap.insert(stringpair_t("max-keys", s.str()));
   }
 
-  lWrapper.createParser();
-
-  try {
-    makeRequest(aBucketName, LIST_BUCKET, &lWrapper, &lPathArgsMap, 0);
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    curl_free(lEscapedPrefixChar);
-    curl_free(lEscapedMarkerChar);
-    curl_free(lEscapedDelimiterChar);
-    throw e;
-  }
-  lWrapper.destroyParser();
-  curl_free(lEscapedPrefixChar);
-  curl_free(lEscapedMarkerChar);
-  curl_free(lEscapedDelimiterChar);
-
-  if ( ! lRes->isSuccessful() )
-    throw ListBucketException( lRes->theS3ResponseError );
+  makeRequest(aBucketName, LIST_BUCKET, lRequest.getWrapper(), &lPathArgsMap, 0);
 
-  return lRes.release();
+  return lRequest.finish(aThrow);
 }
 
 DeleteBucketResponse*
 S3Connection::deleteBucket(const std::string& aBucketName, RequestHeaderMap* aHeaderMap)
 {
-  std::auto_ptr<DeleteBucketResponse> lRes(new DeleteBucketResponse(aBucketName));
-
-  REQUEST_PROLOG(DeleteBucket);
-
-  makeRequest(aBucketName, DELETE_BUCKET, &lWrapper, 0, aHeaderMap);
-
-  REQUEST_EPILOG(DeleteBucket);
+  S3Request<DELETE_BUCKET> lRequest(new DeleteBucketResponse(aBucketName));
 
-  if ( ! lRes->isSuccessful() )
-    throw DeleteBucketException( lRes->theS3ResponseError );
+  makeRequest(aBucketName, DELETE_BUCKET, lRequest.getWrapper(), 0, aHeaderMap);
 
-  return lRes.release();
+  return lRequest.finish();
 }
 
 PutResponse*
@@ -270,142 +253,204 @@ S3Connection::put(const std::string& aBucketName,
                   long aSize,
                   bool aReducedRedunancy)
 {
-  std::auto_ptr<PutResponse> lRes(new PutResponse(aBucketName));
-
-  PutHandler             lHandler;
-
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
+  S3Object lObject;
+  lObject.theIstream = &aObject;
+  lObject.theContentType = aContentType;
+
+  if (aSize == -1) {
+    // determine object size
+    aObject.seekg(0, std::ios_base::beg);
+    std::istream::pos_type begin_pos = aObject.tellg();
+    aObject.seekg(0, std::ios_base::end);
+    lObject.theContentLength = aObject.tellg() - begin_pos;
+    lObject.theIstream->seekg(0, std::ios_base::beg);
+  } else {
+    lObject.theContentLength = aSize;
+  }
 
-  lWrapper.theSAXHandler.startElementNs = &PutHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &PutHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &PutHandler::endElementNs;
+  return putObject(aBucketName, aKey, &lObject, aMetaDataMap, aReducedRedunancy);
+}
 
-  char* lEscapedKeyChar = curl_escape(aKey.c_str(), aKey.size());
-  std::string lEscapedKey(lEscapedKeyChar);
-  curl_free(lEscapedKeyChar);
+PutResponse*
+S3Connection::put(const std::string& aBucketName,
+                  const std::string& aKey,
+                  const char* aObject,
+                  const std::string& aContentType,
+                  const std::map<std::string, std::string>* aMetaDataMap,
+                  long aSize,
+                  bool aReducedRedunancy)
+{
+  S3Object lObject;
+  lObject.theDataPointer = aObject;
+  lObject.theContentType = aContentType;
+  lObject.theContentLength = aSize;
 
-  lWrapper.createParser();
+  return putObject(aBucketName, aKey, &lObject, aMetaDataMap, aReducedRedunancy);
+}
 
-  try {
-    S3Object lObject;
-    lObject.theIstream = &aObject;
-    lObject.theContentType = aContentType;
-
-    if (aSize == -1) {
-      // determine object size
-      aObject.seekg(0, std::ios_base::beg);
-      std::istream::pos_type begin_pos = aObject.tellg();
-      aObject.seekg(0, std::ios_base::end);
-      lObject.theContentLength = aObject.tellg() - begin_pos;
-      lObject.theIstream->seekg(0, std::ios_base::beg);
-    } else {
-      lObject.theContentLength = aSize;
-    }
+namespace {
 
-    if (aMetaDataMap || aReducedRedunancy) {
-      RequestHeaderMap lRequestHeaderMap;
-      if (aReducedRedunancy) {
-        lRequestHeaderMap.addHeader("x-amz-storage-class", "REDUCED_REDUNDANCY");
-      }
+  // unmaps a memory mapped region of a file when leaving the scope
+  struct MappedRegion
+  {
+    void*  theAddress;
+    size_t theLength;
 
-      if (aMetaDataMap) {
-        for (std::map<std::string, std::string>::const_iterator lIter = aMetaDataMap->begin();
-            lIter != aMetaDataMap->end(); ++lIter) {
-          // special header case since we are not supposed to have prefix in the MetaDataMap
-          if (((*lIter).first).find("x-amz") != std::string::npos) {
-            // add the header as it is
-            lRequestHeaderMap.addHeader((*lIter).first, (*lIter).second);
-          } else {
-            lRequestHeaderMap.addHeader("x-amz-meta-" + (*lIter).first, (*lIter).second);
-          }
-        }
-      }
+    MappedRegion() : theAddress(MAP_FAILED), theLength(0) {}
 
-      makeRequest(aBucketName, PUT, &lWrapper, 0, &lRequestHeaderMap, lEscapedKey, &lObject);
-    } else {
-      makeRequest(aBucketName, PUT, &lWrapper, 0, 0, lEscapedKey, &lObject);
+    ~MappedRegion()
+    {
+      if (theAddress != MAP_FAILED)
+        munmap(theAddress, theLength);
     }
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    throw e;
-  }
-
-  lWrapper.destroyParser();
-
-  if ( ! lRes->isSuccessful() )
-    throw PutException( lRes->theS3ResponseError );
+  };
 
-  return lRes.release();
-}
+} /* anonymous namespace */
 
 PutResponse*
 S3Connection::put(const std::string& aBucketName,
                   const std::string& aKey,
-                  const char* aObject,
+                  int aFileDescriptor,
+                  off_t aOffset,
                   const std::string& aContentType,
                   const std::map<std::string, std::string>* aMetaDataMap,
                   long aSize,
                   bool aReducedRedunancy)
 {
-  std::auto_ptr<PutResponse> lRes(new PutResponse(aBucketName));
+  S3Object lObject;
+  lObject.theContentType = aContentType;
+
+  // a region beyond the end of the file would fault in the read callback
+  struct stat lStat;
+  if (fstat(aFileDescriptor, &lStat) != 0 || aOffset < 0 || lStat.st_size < aOffset
+      || (aSize != -1 && (aSize < 0 || aOffset + (off_t)aSize > lStat.st_size))) {
+    S3ResponseError lError;
+    lError.theErrorCode = S3Exception::InvalidArgument;
+    lError.theErrorMessage = "the region to put exceeds the size of the file";
+    throw PutException(lError);
+  }
+  lObject.theContentLength = aSize == -1 ? lStat.st_size - aOffset : aSize;
+
+  // map the region into memory such that curl's read callback copies
+  // straight from the page cache; files that can't be mapped (e.g. pipes)
+  // are read with pread in the read callback
+  MappedRegion lRegion;
+  if (lObject.theContentLength > 0) {
+    static const long lPageSize = sysconf(_SC_PAGESIZE);
+    off_t lMapOffset = aOffset - (aOffset % lPageSize);
+    lRegion.theLength = lObject.theContentLength + (aOffset - lMapOffset);
+    lRegion.theAddress = mmap(0, lRegion.theLength, PROT_READ, MAP_SHARED,
+                              aFileDescriptor, lMapOffset);
+  }
 
-  PutHandler             lHandler;
+  if (lRegion.theAddress != MAP_FAILED) {
+#ifdef HAVE_POSIX_MADVISE_F
+    posix_madvise(lRegion.theAddress, lRegion.theLength, POSIX_MADV_SEQUENTIAL);
+#endif
+    lObject.theDataPointer = static_cast<const char*>(lRegion.theAddress)
+                             + (lRegion.theLength - lObject.theContentLength);
+  } else {
+    lObject.theFileDescriptor = aFileDescriptor;
+    lObject.theFileOffset = aOffset;
+  }
 
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
+  return putObject(aBucketName, aKey, &lObject, aMetaDataMap, aReducedRedunancy);
+}
 
-  lWrapper.theSAXHandler.startElementNs = &PutHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &PutHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &PutHandler::endElementNs;
+PutResponse*
+S3Connection::putObject(const std::string& aBucketName,
+                        const std::string& aKey,
+                        S3Object* aObject,
+                        const std::map<std::string, std::string>* aMetaDataMap,
+                        bool aReducedRedunancy)
+{
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<PUT>(new PutResponse(aBucketName)));
+
+  RequestHeaderMap lRequestHeaderMap;
+  if (aReducedRedunancy) {
+    lRequestHeaderMap.addHeader("x-amz-storage-class", "REDUCED_REDUNDANCY");
+  }
 
-  char* lEscapedKeyChar = curl_escape(aKey.c_str(), aKey.size());
-  std::string lEscapedKey(lEscapedKeyChar);
-  curl_free(lEscapedKeyChar);
+  if (aMetaDataMap) {
+    for (std::map<std::string, std::string>::const_iterator lIter = aMetaDataMap->begin();
+        lIter != aMetaDataMap->end(); ++lIter) {
+      // special header case since we are not supposed to have prefix in the MetaDataMap
+      if (((*lIter).first).find("x-amz") != std::string::npos) {
+        // add the header as it is
+        lRequestHeaderMap.addHeader((*lIter).first, (*lIter).second);
+      } else {
+        lRequestHeaderMap.addHeader("x-amz-meta-" + (*lIter).first, (*lIter).second);
+      }
+    }
+  }
 
-  lWrapper.createParser();
+  // the size of the compressed object must be known before the upload starts,
+  // hence, the object is compressed into a temporary file first
+  S3Object lCompressed;
+  FILE* lTmpFile = 0;
+  if (theCompress && aObject->theContentLength >= MIN_COMPRESSION_SIZE
+      && GzipCodec::isCompressible(aObject->theContentType)) {
+    lTmpFile = compressObject(aObject, &lCompressed);
+    if (lTmpFile) {
+      std::ostringstream lLength;
+      lLength << aObject->theContentLength;
+      lRequestHeaderMap.addHeader(std::string("x-amz-meta-") + CODEC_METADATA, GZIP_CODEC);
+      lRequestHeaderMap.addHeader(std::string("x-amz-meta-") + LENGTH_METADATA, lLength.str());
+      aObject = &lCompressed;
+    }
+  }
 
   try {
-    S3Object lObject;
-    lObject.theDataPointer = aObject;
-    lObject.theContentType = aContentType;
-    lObject.theContentLength = aSize;
+    performAsync(lRequest.get(), aBucketName, aKey, &lRequestHeaderMap, aObject);
+  } catch (AWSException&) {
+    if (lTmpFile)
+      fclose(lTmpFile);
+    throw;
+  }
 
-    if (aMetaDataMap || aReducedRedunancy) {
-      RequestHeaderMap lRequestHeaderMap;
+  if (lTmpFile)
+    fclose(lTmpFile);
 
-      if (aReducedRedunancy) {
-        lRequestHeaderMap.addHeader("x-amz-storage-class", "REDUCED_REDUNDANCY");
-      }
-      if (aMetaDataMap) {
-        for (std::map<std::string, std::string>::const_iterator lIter = aMetaDataMap->begin();
-            lIter != aMetaDataMap->end(); ++lIter) {
-          if (((*lIter).first).find("x-amz") != std::string::npos) {
-            // add the header as it is
-            lRequestHeaderMap.addHeader((*lIter).first, (*lIter).second);
-          } else {
-            lRequestHeaderMap.addHeader("x-amz-meta-" + (*lIter).first, (*lIter).second);
-          }
-        }
-      }
+  return static_cast<PutResponse*>(lRequest->finish());
+}
 
-      makeRequest(aBucketName, PUT, &lWrapper, 0, &lRequestHeaderMap, lEscapedKey, &lObject);
-    } else {
-      makeRequest(aBucketName, PUT, &lWrapper, 0, 0, lEscapedKey, &lObject);
+FILE*
+S3Connection::compressObject(S3Object* aObject, S3Object* aCompressed)
+{
+  FILE* lTmpFile = tmpfile();
+  if (!lTmpFile)
+    return 0; // send the object uncompressed
+
+  GzipCodec lCodec(true, S3Connection::writeFile, lTmpFile);
+  char lBuffer[GzipCodec::BUFFER_SIZE];
+  uint64_t lRemaining = aObject->theContentLength;
+  bool lSuccess = true;
+
+  // read the object in the same way curl would do it
+  while (lSuccess && lRemaining > 0) {
+    size_t lRead = setPutData(lBuffer, 1, std::min((uint64_t) sizeof(lBuffer), lRemaining), aObject);
+    if (lRead == 0 || lRead == CURL_READFUNC_ABORT) {
+      lSuccess = false;
+      break;
     }
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    throw e;
+    lSuccess = lCodec.process(lBuffer, lRead);
+    lRemaining -= lRead;
   }
 
-  lWrapper.destroyParser();
-
-  if ( ! lRes->isSuccessful() )
-    throw PutException( lRes->theS3ResponseError );
+  if (!lSuccess || !lCodec.finish() || fflush(lTmpFile) != 0) {
+    fclose(lTmpFile);
+    S3ResponseError lError;
+    lError.theErrorCode = S3Exception::InternalError;
+    lError.theErrorMessage = "couldn't compress the object";
+    throw PutException(lError);
+  }
 
-  return lRes.release();
+  aCompressed->theContentType = aObject->theContentType;
+  aCompressed->theFileDescriptor = fileno(lTmpFile);
+  aCompressed->theFileOffset = 0;
+  aCompressed->theContentLength = ftello(lTmpFile);
+  return lTmpFile;
 }
 
 std::string
@@ -433,61 +478,109 @@ S3Connection::queryString(ActionType aActionType,
                lBase64EncodedStringLength);
   lSignature = urlEncode(lSignature);
 
-  stream.str("");
-  stream << "http://" << aBucketName << "." << DEFAULT_HOST << "/" <<
-            aKey << "?AWSAccessKeyId=" << theAccessKeyId << "&Expires=" <<
-            lExpireString << "&Signature=" << lSignature;
-  return stream.str();
+  PathArgs_t lPathArgs;
+  lPathArgs.insert(std::pair<std::string, std::string>("AWSAccessKeyId", theAccessKeyId));
+  lPathArgs.insert(std::pair<std::string, std::string>("Expires", lExpireString));
+  lPathArgs.insert(std::pair<std::string, std::string>("Signature", lSignature));
+
+  return getCallingFormat(aBucketName)->getUrl(theIsSecure, theHost, thePort,
+                                               aBucketName, aKey, &lPathArgs);
 }
 
 GetResponse*
 S3Connection::get(const std::string& aBucketName, const std::string& aKey, 
-                  const std::map<std::string, std::string>* aMetaDataMap)
+                  const std::map<std::string, std::string>* aMetaDataMap,
+                  bool aThrow)
 {
-  std::auto_ptr<GetResponse> lRes(new GetResponse(aBucketName, aKey));
-
-  GetHandler             lHandler;
-
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
-
-  lWrapper.theSAXHandler.startElementNs = &GetHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &GetHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &GetHandler::endElementNs;
+  return getObject(aBucketName, aKey, 0, aMetaDataMap, aThrow);
+}
 
-  char* lEscapedKeyChar = curl_escape(aKey.c_str(), aKey.size());
-  std::string lEscapedKey(lEscapedKeyChar);
+GetResponse*
+S3Connection::get(const std::string& aBucketName, const std::string& aKey,
+                  char* aBuffer, size_t aBufferSize,
+                  const std::map<std::string, std::string>* aMetaDataMap)
+{
+  struct iovec lIovec;
+  lIovec.iov_base = aBuffer;
+  lIovec.iov_len = aBufferSize;
+  return get(aBucketName, aKey, &lIovec, 1, aMetaDataMap);
+}
 
-  lWrapper.createParser();
+GetResponse*
+S3Connection::get(const std::string& aBucketName, const std::string& aKey,
+                  const struct iovec* aIovec, int aIovecCount,
+                  const std::map<std::string, std::string>* aMetaDataMap)
+{
+  S3Target lTarget;
+  lTarget.theIovec = aIovec;
+  lTarget.theIovecCount = aIovecCount;
+  return getObject(aBucketName, aKey, &lTarget, aMetaDataMap);
+}
 
-  try {
+GetResponse*
+S3Connection::get(const std::string& aBucketName, const std::string& aKey,
+                  int aFileDescriptor, off_t aOffset,
+                  const std::map<std::string, std::string>* aMetaDataMap)
+{
+  S3Target lTarget;
+  lTarget.theFileDescriptor = aFileDescriptor;
+  lTarget.theFileOffset = aOffset;
+  return getObject(aBucketName, aKey, &lTarget, aMetaDataMap);
+}
 
-    if (aMetaDataMap) {
-      RequestHeaderMap lRequestHeaderMap;
-      for (std::map<std::string, std::string>::const_iterator lIter = aMetaDataMap->begin();
-           lIter != aMetaDataMap->end(); ++lIter) {
-        lRequestHeaderMap.addHeader("x-amz-meta-" + (*lIter).first, (*lIter).second);
-      }
+GetResponse*
+S3Connection::getObject(const std::string& aBucketName, const std::string& aKey,
+                        S3Target* aTarget,
+                        const std::map<std::string, std::string>* aMetaDataMap,
+                        bool aThrow)
+{
+  RequestHeaderMap lRequestHeaderMap;
+  if (aMetaDataMap) {
+    for (std::map<std::string, std::string>::const_iterator lIter = aMetaDataMap->begin();
+         lIter != aMetaDataMap->end(); ++lIter) {
+      lRequestHeaderMap.addHeader("x-amz-meta-" + (*lIter).first, (*lIter).second);
+    }
+  }
 
-      makeRequest(aBucketName, GET, &lWrapper, 0, &lRequestHeaderMap, lEscapedKey, 0);
-    } else {
-      makeRequest(aBucketName, GET, &lWrapper, 0, 0, lEscapedKey, 0);
+  if (!aTarget) {
+    // the object is streamed from the connection while it's read
+    S3Request<GET> lRequest(new GetResponse(aBucketName, aKey));
+    if (theHedgePercentile) {
+      S3Request<GET> lHedge(new GetResponse(aBucketName, aKey));
+      if (!makeHedgedRequest(aBucketName, GET, lRequest.getWrapper(), lHedge.getWrapper(),
+                             &lRequestHeaderMap, escape(aKey)))
+        return lHedge.finish(aThrow);
+      return lRequest.finish(aThrow);
     }
 
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    curl_free(lEscapedKeyChar);
-    throw e;
+    makeRequest(aBucketName, GET, lRequest.getWrapper(), 0, &lRequestHeaderMap, escape(aKey), 0);
+    return lRequest.finish(aThrow);
   }
 
-  lWrapper.destroyParser();
-  curl_free(lEscapedKeyChar);
-
-  if ( ! lRes->isSuccessful() )
-    throw GetException( lRes->theS3ResponseError );
+  // two requests can't write into the same target, hence, no hedging
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<GET>(new GetResponse(aBucketName, aKey)));
+  lRequest->theWrapper.theTarget = aTarget;
+
+  performAsync(lRequest.get(), aBucketName, aKey, &lRequestHeaderMap, 0);
+
+  GetResponse* lRes = static_cast<GetResponse*>(lRequest->theResponse);
+  if (aTarget->theOverflow) {
+    lRes->theIsSuccessful = false;
+    lRes->theS3ResponseError.theErrorCode = S3Exception::EntityTooLarge;
+    lRes->theS3ResponseError.theErrorMessage = "the object doesn't fit into the provided buffers";
+  } else if (aTarget->theErrno) {
+    lRes->theIsSuccessful = false;
+    lRes->theS3ResponseError.theErrorCode = S3Exception::InternalError;
+    lRes->theS3ResponseError.theErrorMessage = strerror(aTarget->theErrno);
+  } else if (aTarget->theDecoder && !aTarget->theDecoder->isFinished()) {
+    // the transfer ended before the end of the compressed data
+    lRes->theIsSuccessful = false;
+    lRes->theS3ResponseError.theErrorCode = S3Exception::InternalError;
+    lRes->theS3ResponseError.theErrorMessage = "incomplete compressed body";
+  }
 
-  return lRes.release();
+  return static_cast<GetResponse*>(lRequest->finish(aThrow));
 }
 
 
@@ -495,80 +588,209 @@ GetResponse*
 S3Connection::get(const std::string& aBucketName, const std::string& aKey,
                   const std::string& aOldEtag)
 {
-  std::auto_ptr<GetResponse> lRes(new GetResponse(aBucketName, aKey));
+  S3Request<GET> lRequest(new GetResponse(aBucketName, aKey));
+
+  RequestHeaderMap lRequestHeaderMap;
+  lRequestHeaderMap.addHeader("If-None-Match",aOldEtag);
 
-  GetHandler             lHandler;
+  if (theHedgePercentile) {
+    S3Request<GET> lHedge(new GetResponse(aBucketName, aKey));
+    if (!makeHedgedRequest(aBucketName, GET, lRequest.getWrapper(), lHedge.getWrapper(),
+                           &lRequestHeaderMap, escape(aKey)))
+      return lHedge.finish();
+    return lRequest.finish();
+  }
 
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
+  makeRequest(aBucketName, GET, lRequest.getWrapper(), 0, &lRequestHeaderMap, escape(aKey), 0);
 
-  lWrapper.theSAXHandler.startElementNs = &GetHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &GetHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &GetHandler::endElementNs;
+  return lRequest.finish();
+}
 
-  char* lEscapedKeyChar = curl_escape(aKey.c_str(), aKey.size());
-  std::string lEscapedKey(lEscapedKeyChar);
+DeleteResponse*
+S3Connection::del(const std::string& aBucketName, const std::string& aKey, bool aThrow)
+{
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<DELETE>(new DeleteResponse(aBucketName, aKey)));
 
-  RequestHeaderMap lRequestHeaderMap;
-  lRequestHeaderMap.addHeader("If-None-Match",aOldEtag);
+  performAsync(lRequest.get(), aBucketName, aKey, 0, 0);
 
-  lWrapper.createParser();
+  return static_cast<DeleteResponse*>(lRequest->finish(aThrow));
+}
 
-  try {
-    makeRequest(aBucketName, GET, &lWrapper, 0, &lRequestHeaderMap, lEscapedKey, 0);
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    curl_free(lEscapedKeyChar);
-    throw e;
+CopyResponse*
+S3Connection::copy(const std::string& aSrcBucketName, const std::string& aSrcKey,
+                   const std::string& aDstBucketName, const std::string& aDstKey,
+                   const std::map<std::string, std::string>* aMetaDataMap,
+                   const std::string& aContentType)
+{
+  S3Request<COPY> lRequest(new CopyResponse(aDstBucketName, aDstKey));
+
+  RequestHeaderMap lRequestHeaderMap;
+  lRequestHeaderMap.addHeader("x-amz-copy-source", "/" + aSrcBucketName + "/" + escape(aSrcKey));
+
+  // the metadata of the source object is kept unless new metadata is given
+  if (aMetaDataMap) {
+    lRequestHeaderMap.addHeader("x-amz-metadata-directive", "REPLACE");
+
+    // an object compressed by put must keep its codec entries, otherwise
+    // the copy would be served as compressed data
+    std::auto_ptr<S3AsyncRequest> lHead(
+        createAsyncRequest<HEAD>(new HeadResponse(aSrcBucketName)));
+    performAsync(lHead.get(), aSrcBucketName, aSrcKey, 0, 0);
+    if (lHead->theWrapper.theIsDecoded && aMetaDataMap->find(CODEC_METADATA) == aMetaDataMap->end()) {
+      std::ostringstream lLength;
+      lLength << static_cast<HeadResponse*>(lHead->theResponse)->getContentLength();
+      lRequestHeaderMap.addHeader(std::string("x-amz-meta-") + CODEC_METADATA, GZIP_CODEC);
+      lRequestHeaderMap.addHeader(std::string("x-amz-meta-") + LENGTH_METADATA, lLength.str());
+    }
+
+    for (std::map<std::string, std::string>::const_iterator lIter = aMetaDataMap->begin();
+        lIter != aMetaDataMap->end(); ++lIter) {
+      if (((*lIter).first).find("x-amz") != std::string::npos) {
+        // add the header as it is
+        lRequestHeaderMap.addHeader((*lIter).first, (*lIter).second);
+      } else {
+        lRequestHeaderMap.addHeader("x-amz-meta-" + (*lIter).first, (*lIter).second);
+      }
+    }
+    if (aContentType.size() != 0) {
+      lRequestHeaderMap.addHeader("Content-Type", aContentType);
+    }
+  } else {
+    lRequestHeaderMap.addHeader("x-amz-metadata-directive", "COPY");
   }
 
-  lWrapper.destroyParser();
+  // there is no body to send
+  lRequestHeaderMap.addHeader("Expect", "");
 
-  curl_free(lEscapedKeyChar);
+  makeRequest(aDstBucketName, COPY, lRequest.getWrapper(), 0, &lRequestHeaderMap,
+              escape(aDstKey), 0);
 
-  if ( ! lRes->isSuccessful() )
-    throw GetException( lRes->theS3ResponseError );
+  return lRequest.finish();
+}
 
-  return lRes.release();
+CopyResponse*
+S3Connection::initiateMultipartCopy(const std::string& aSrcBucketName, const std::string& aSrcKey,
+                                    const std::string& aDstBucketName, const std::string& aDstKey,
+                                    long long& aSize)
+{
+  // the parts are copied byte by byte, i.e. the size is the one of the
+  // stored (maybe compressed) object and not the decoded one
+  long long lDecodedLength = -1;
+  std::auto_ptr<S3AsyncRequest> lHead(
+      createAsyncRequest<HEAD>(new HeadResponse(aSrcBucketName)));
+  lHead->theWrapper.theContentLength = &lDecodedLength;
+  performAsync(lHead.get(), aSrcBucketName, aSrcKey, 0, 0);
+
+  HeadResponse* lHeadResponse = static_cast<HeadResponse*>(lHead->theResponse);
+  if (!lHeadResponse->isSuccessful())
+    throwError<COPY>(lHeadResponse);
+  aSize = lHeadResponse->getContentLength();
+
+  // the upload doesn't take anything from the source, i.e. its metadata
+  // (including the codec entries of a compressed object) is copied here
+  RequestHeaderMap lRequestHeaderMap;
+  const std::map<std::string, std::string>& lMetaData = lHeadResponse->getMetaData();
+  for (std::map<std::string, std::string>::const_iterator lIter = lMetaData.begin();
+       lIter != lMetaData.end(); ++lIter) {
+    lRequestHeaderMap.addHeader("x-amz-meta-" + (*lIter).first, (*lIter).second);
+  }
+  if (lHead->theWrapper.theIsDecoded) {
+    lRequestHeaderMap.addHeader(std::string("x-amz-meta-") + CODEC_METADATA, GZIP_CODEC);
+    if (lDecodedLength >= 0) {
+      std::ostringstream lLength;
+      lLength << lDecodedLength;
+      lRequestHeaderMap.addHeader(std::string("x-amz-meta-") + LENGTH_METADATA, lLength.str());
+    }
+  }
+  if (lHeadResponse->getContentType().size() != 0)
+    lRequestHeaderMap.addHeader("Content-Type", lHeadResponse->getContentType());
+  lRequestHeaderMap.addHeader("Expect", "");
+
+  S3Request<INITIATE_MULTIPART_UPLOAD> lRequest(new CopyResponse(aDstBucketName, aDstKey));
+  PathArgs_t lPathArgsMap;
+  lPathArgsMap.insert(PathArgs_t::value_type("uploads", ""));
+
+  makeRequest(aDstBucketName, INITIATE_MULTIPART_UPLOAD, lRequest.getWrapper(), &lPathArgsMap,
+              &lRequestHeaderMap, escape(aDstKey), 0);
+
+  return lRequest.finish();
 }
 
-DeleteResponse*
-S3Connection::del(const std::string& aBucketName, const std::string& aKey)
+CopyResponse*
+S3Connection::copyPart(const std::string& aSrcBucketName, const std::string& aSrcKey,
+                       const std::string& aDstBucketName, const std::string& aDstKey,
+                       const std::string& aUploadId, int aPartNumber,
+                       long long aFirstByte, long long aLastByte)
 {
-  std::auto_ptr<DeleteResponse> lRes(new DeleteResponse(aBucketName, aKey));
+  S3Request<UPLOAD_PART_COPY> lRequest(new CopyResponse(aDstBucketName, aDstKey));
+
+  std::ostringstream lPartNumber;
+  lPartNumber << aPartNumber;
+  PathArgs_t lPathArgsMap;
+  lPathArgsMap.insert(PathArgs_t::value_type("partNumber", lPartNumber.str()));
+  lPathArgsMap.insert(PathArgs_t::value_type("uploadId", escape(aUploadId)));
 
-  DeleteHandler           lHandler;
+  std::ostringstream lRange;
+  lRange << "bytes=" << aFirstByte << "-" << aLastByte;
+  RequestHeaderMap lRequestHeaderMap;
+  lRequestHeaderMap.addHeader("x-amz-copy-source", "/" + aSrcBucketName + "/" + escape(aSrcKey));
+  lRequestHeaderMap.addHeader("x-amz-copy-source-range", lRange.str());
 
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
+  // there is no body to send
+  lRequestHeaderMap.addHeader("Expect", "");
 
-  lWrapper.theSAXHandler.startElementNs = &DeleteHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &DeleteHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &DeleteHandler::endElementNs;
+  makeRequest(aDstBucketName, UPLOAD_PART_COPY, lRequest.getWrapper(), &lPathArgsMap,
+              &lRequestHeaderMap, escape(aDstKey), 0);
 
-  char* lEscapedKeyChar = curl_escape(aKey.c_str(), aKey.size());
-  std::string lEscapedKey(lEscapedKeyChar);
+  return lRequest.finish();
+}
 
-  lWrapper.createParser();
+CopyResponse*
+S3Connection::completeMultipartCopy(const std::string& aDstBucketName, const std::string& aDstKey,
+                                    const std::string& aUploadId,
+                                    const std::vector<std::string>& aETags)
+{
+  S3Request<COMPLETE_MULTIPART_UPLOAD> lRequest(new CopyResponse(aDstBucketName, aDstKey));
 
-  try {
-    makeRequest(aBucketName, DELETE, &lWrapper, 0, 0, lEscapedKey, 0);
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    curl_free(lEscapedKeyChar);
-    throw e;
+  PathArgs_t lPathArgsMap;
+  lPathArgsMap.insert(PathArgs_t::value_type("uploadId", escape(aUploadId)));
+
+  std::ostringstream lBody;
+  lBody << "<CompleteMultipartUpload>";
+  for (size_t i = 0; i < aETags.size(); ++i) {
+    lBody << "<Part><PartNumber>" << (i + 1) << "</PartNumber>"
+          << "<ETag>\"" << aETags[i] << "\"</ETag></Part>";
   }
+  lBody << "</CompleteMultipartUpload>";
+  std::string lBodyString = lBody.str();
 
-  lWrapper.destroyParser();
+  S3Object lObject;
+  lObject.theDataPointer = lBodyString.c_str();
+  lObject.theContentType = "application/xml";
+  lObject.theContentLength = lBodyString.size();
 
-  curl_free(lEscapedKeyChar);
+  makeRequest(aDstBucketName, COMPLETE_MULTIPART_UPLOAD, lRequest.getWrapper(), &lPathArgsMap,
+              0, escape(aDstKey), &lObject);
 
-  if ( ! lRes->isSuccessful() )
-    throw DeleteException( lRes->theS3ResponseError );
+  return lRequest.finish();
+}
 
-  return lRes.release();
+void
+S3Connection::abortMultipartCopy(const std::string& aDstBucketName, const std::string& aDstKey,
+                                 const std::string& aUploadId)
+{
+  S3Request<ABORT_MULTIPART_UPLOAD> lRequest(new CopyResponse(aDstBucketName, aDstKey));
+
+  PathArgs_t lPathArgsMap;
+  lPathArgsMap.insert(PathArgs_t::value_type("uploadId", escape(aUploadId)));
+
+  try {
+    makeRequest(aDstBucketName, ABORT_MULTIPART_UPLOAD, lRequest.getWrapper(), &lPathArgsMap,
+                0, escape(aDstKey), 0);
+  } catch (AWSException&) {
+    // the parts are removed by a lifecycle rule of the bucket (if any)
+  }
 }
 
 DeleteAllResponse*
@@ -599,59 +821,185 @@ S3Connection::deleteAll(const std::string& aBucketName, const std::string& aPref
   return lRes.release();
 }
 
+DeleteAllResponse*
+S3Connection::deleteAll(const std::string& aBucketName, const std::string& aPrefix,
+                        const std::vector<std::string>& aKeys)
+{
+  std::auto_ptr<DeleteAllResponse> lRes(new DeleteAllResponse(aBucketName, aPrefix));
+
+  std::auto_ptr<DeleteResponse> lDelete;
+  try {
+    for (std::vector<std::string>::const_iterator lIter = aKeys.begin();
+         lIter != aKeys.end(); ++lIter) {
+      lDelete.reset(del(aBucketName, *lIter));
+    }
+  } catch (DeleteException &lDelExc) {
+    throw DeleteAllException( lDelExc.getErrorCode(), lDelExc.getErrorMessage(), lDelExc.getRequestId(), lDelExc.getHostId() );
+  }
+
+  return lRes.release();
+}
+
 HeadResponse*
-S3Connection::head(const std::string& aBucketName, const std::string& aKey)
+S3Connection::head(const std::string& aBucketName, const std::string& aKey, bool aThrow)
 {
-  std::auto_ptr<HeadResponse> lRes(new HeadResponse(aBucketName));
+  if (theHedgePercentile) {
+    S3Request<HEAD> lRequest(new HeadResponse(aBucketName));
+    S3Request<HEAD> lHedge(new HeadResponse(aBucketName));
+    if (!makeHedgedRequest(aBucketName, HEAD, lRequest.getWrapper(), lHedge.getWrapper(),
+                           0, escape(aKey)))
+      return lHedge.finish(aThrow);
+    return lRequest.finish(aThrow);
+  }
 
-  HeadHandler             lHandler;
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<HEAD>(new HeadResponse(aBucketName)));
 
-  S3CallBackWrapper       lWrapper;
-  lWrapper.theResponse  = lRes.get();
-  lWrapper.theHandler   = &lHandler;
+  performAsync(lRequest.get(), aBucketName, aKey, 0, 0);
 
-  lWrapper.theSAXHandler.startElementNs = &HeadHandler::startElementNs;
-  lWrapper.theSAXHandler.characters     = &HeadHandler::charactersSAXFunc;
-  lWrapper.theSAXHandler.endElementNs   = &HeadHandler::endElementNs;
+  return static_cast<HeadResponse*>(lRequest->finish(aThrow));
+}
 
-  char* lEscapedKeyChar = curl_escape(aKey.c_str(), aKey.size());
-  std::string lEscapedKey(lEscapedKeyChar);
+void
+S3Connection::startAsync(S3AsyncRequest* aRequest, const std::string& aBucketName,
+                         const std::string& aKey, S3Object* aObject)
+{
+  aRequest->theWrapper.createParser();
+  routeRequest();
+  aRequest->theSList = prepareRequest(aBucketName, (ActionType) aRequest->theActionType,
+                                      &aRequest->theWrapper, 0, 0, escape(aKey),
+                                      aObject, true);
+}
 
-  lWrapper.createParser();
+S3AsyncRequest*
+S3Connection::startHead(const std::string& aBucketName, const std::string& aKey)
+{
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<HEAD>(new HeadResponse(aBucketName)));
 
-  try {
-    makeRequest(aBucketName, HEAD, &lWrapper, 0, 0, lEscapedKey, 0);
-  } catch (AWSException& e) {
-    lWrapper.destroyParser();
-    curl_free(lEscapedKeyChar);
-    throw e;
+  startAsync(lRequest.get(), aBucketName, aKey, 0);
+  return lRequest.release();
+}
+
+S3AsyncRequest*
+S3Connection::startGet(const std::string& aBucketName, const std::string& aKey)
+{
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<GET>(new GetResponse(aBucketName, aKey)));
+
+  startAsync(lRequest.get(), aBucketName, aKey, 0);
+  return lRequest.release();
+}
+
+S3AsyncRequest*
+S3Connection::startPut(const std::string& aBucketName, const std::string& aKey,
+                       const char* aData, const std::string& aContentType, long aSize)
+{
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<PUT>(new PutResponse(aBucketName)));
+
+  lRequest->theObject.theDataPointer = aData;
+  lRequest->theObject.theContentType = aContentType;
+  lRequest->theObject.theContentLength = aSize;
+
+  startAsync(lRequest.get(), aBucketName, aKey, &lRequest->theObject);
+  return lRequest.release();
+}
+
+S3AsyncRequest*
+S3Connection::startDelete(const std::string& aBucketName, const std::string& aKey)
+{
+  std::auto_ptr<S3AsyncRequest> lRequest(
+      createAsyncRequest<DELETE>(new DeleteResponse(aBucketName, aKey)));
+
+  startAsync(lRequest.get(), aBucketName, aKey, 0);
+  return lRequest.release();
+}
+
+void
+S3Connection::performAsync(S3AsyncRequest* aRequest, const std::string& aBucketName,
+                           const std::string& aKey, RequestHeaderMap* aHeaderMap,
+                           S3Object* aObject)
+{
+  if (!theMulti)
+    theMulti = curl_multi_init();
+
+  aRequest->theWrapper.createParser();
+  routeRequest();
+
+  int lResCode;
+  while (true) {
+    aRequest->theSList = prepareRequest(aBucketName, (ActionType) aRequest->theActionType,
+                                        &aRequest->theWrapper, 0, aHeaderMap, escape(aKey),
+                                        aObject, true);
+
+    curl_multi_add_handle(theMulti, theCurl);
+    int lStillRunning = 1;
+    while (lStillRunning) {
+      while (CURLM_CALL_MULTI_PERFORM == curl_multi_perform(theMulti, &lStillRunning))
+        ;
+      if (lStillRunning)
+        curl_multi_wait(theMulti, 0, 0, 1000, 0);
+    }
+
+    lResCode = CURLE_OK;
+    CURLMsg* lMsg;
+    int lMsgsInQueue;
+    while ((lMsg = curl_multi_info_read(theMulti, &lMsgsInQueue))) {
+      if (lMsg->msg == CURLMSG_DONE)
+        lResCode = lMsg->data.result;
+    }
+    curl_multi_remove_handle(theMulti, theCurl);
+
+    if (!failover(lResCode))
+      break;
+
+    // nothing has been sent or received, repeat the request on the next endpoint
+    curl_slist_free_all(aRequest->theSList);
+    aRequest->theSList = 0;
   }
 
-  lWrapper.destroyParser();
+  completeAsync(aRequest, lResCode);
+}
 
-  curl_free(lEscapedKeyChar);
+void
+S3Connection::finishAsync(S3AsyncRequest* aRequest, int aCurlCode)
+{
+  reportEndpoint(aCurlCode);
 
-  if ( ! lRes->isSuccessful() )
-    throw HeadException( lRes->theS3ResponseError );
+  completeAsync(aRequest, aCurlCode);
 
-  return lRes.release();
+  if ( ! aRequest->theResponse->isSuccessful() )
+    aRequest->theThrowError(aRequest->theResponse);
+}
+
+void
+S3Connection::completeAsync(S3AsyncRequest* aRequest, int aCurlCode)
+{
+  struct curl_slist* lSList = aRequest->theSList;
+  aRequest->theSList = 0;
+
+  try {
+    finishRequest(&aRequest->theWrapper, aCurlCode, lSList);
+  } catch (AWSException&) {
+    aRequest->theWrapper.destroyParser();
+    throw;
+  }
+
+  aRequest->theWrapper.destroyParser();
 }
 
 BucketLoggingStatusResponse*
 S3Connection::bucketLoggingStatus(const std::string& aBucketName)
 {
-  std::auto_ptr<BucketLoggingStatusResponse> lRes(new BucketLoggingStatusResponse(aBucketName));
-
-  REQUEST_PROLOG(BucketLoggingStatus);
+  S3Request<BUCKET_LOGGING> lRequest(new BucketLoggingStatusResponse(aBucketName));
 
   PathArgs_t lPathArgsMap;
   lPathArgsMap.insert(stringpair_t("logging", ""));
 
-  makeRequest(aBucketName, BUCKET_LOGGING, &lWrapper, &lPathArgsMap, 0);
+  makeRequest(aBucketName, BUCKET_LOGGING, lRequest.getWrapper(), &lPathArgsMap, 0);
 
-  REQUEST_EPILOG(BucketLoggingStatus);
-
-  return lRes.release();
+  return lRequest.finish();
 
 }
 
@@ -672,73 +1020,14 @@ S3Connection::disableBucketLogging(const std::string& aBucketName)
 }
 
 void
-S3Connection::setRequestMethod(ActionType aActionType)
+S3Connection::setRequestMethod(S3CallBackWrapper* aCallBackWrapper)
 {
-  curl_easy_setopt(theCurl, CURLOPT_READFUNCTION, setCreateBucketData);
+  // the body of a put is served by setPutData (see prepareRequest)
+  curl_easy_setopt(theCurl, CURLOPT_READFUNCTION, S3Connection::setCreateBucketData);
   // this is overriden in the curlstreambuf
   curl_easy_setopt(theCurl, CURLOPT_WRITEFUNCTION,  S3Connection::getS3Data);
   curl_easy_setopt(theCurl, CURLOPT_FRESH_CONNECT, "FALSE");
-  switch (aActionType) {
-      case CREATE_BUCKET: {
-          curl_easy_setopt(theCurl, CURLOPT_READFUNCTION, S3Connection::setCreateBucketData);
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, 0);
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 1);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 0);
-          break;
-      }
-      case LIST_ALL_BUCKETS: {
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 1);
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 0);
-          break;
-      }
-      case LIST_BUCKET: {
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 1);
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 0);
-          break;
-      }
-      case DELETE_BUCKET: {
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, "DELETE");
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 0);
-          break;
-      }
-      case PUT: {
-          curl_easy_setopt(theCurl, CURLOPT_READFUNCTION, S3Connection::setPutData);
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 0);
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 1);
-          break;
-      }
-      case GET: {
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 1);
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 0);
-          break;
-      }
-      case HEAD: {
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, "HEAD");
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 0);
-          break;
-      }
-      case DELETE: {
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, "DELETE");
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 0);
-          break;
-      }
-      case BUCKET_LOGGING: {
-          curl_easy_setopt(theCurl, CURLOPT_CUSTOMREQUEST, "GET");
-          curl_easy_setopt(theCurl, CURLOPT_UPLOAD, 0);
-          curl_easy_setopt(theCurl, CURLOPT_HTTPGET, 1);
-          break;
-      }
-      default: {
-          assert(false);
-      }
-  }
+  aCallBackWrapper->theMethod(theCurl);
 }
 
 void
@@ -755,24 +1044,219 @@ S3Connection::makeRequest(const std::string& aBucketName,
     PathArgs_t* aPathArgsMap, RequestHeaderMap* aHeaderMap,
     const std::string& aKey, S3Object* aObject)
 {
-  S3Response* lResponse;
+  routeRequest();
+
+  struct curl_slist* lSList;
+  CURLcode lResCode;
+  GetResponse* lGetResponse = aCallBackWrapper->theGetResponse;
+  while (true) {
+    lSList = prepareRequest(aBucketName, aActionType, aCallBackWrapper,
+                            aPathArgsMap, aHeaderMap, aKey, aObject, false);
+
+    if (lGetResponse && lGetResponse->theStreamBuffer) {
+      lResCode = (CURLcode) lGetResponse->theStreamBuffer->multi_perform();
+    } else {
+      lResCode = curl_easy_perform(theCurl);
+    }
+
+    if (!failover(lResCode))
+      break;
+
+    // nothing has been sent or received, repeat the request on the next endpoint
+    curl_slist_free_all(lSList);
+    if (lGetResponse && lGetResponse->theStreamBuffer) {
+      delete lGetResponse->theInputStream;
+      lGetResponse->theInputStream = 0;
+      delete lGetResponse->theStreamBuffer;
+      lGetResponse->theStreamBuffer = 0;
+    }
+  }
+
+  finishRequest(aCallBackWrapper, lResCode, lSList);
+}
+
+bool
+S3Connection::makeHedgedRequest(const std::string& aBucketName, ActionType aActionType,
+                                S3CallBackWrapper* aCallBackWrapper,
+                                S3CallBackWrapper* aHedgeWrapper,
+                                RequestHeaderMap* aHeaderMap, const std::string& aKey)
+{
+  // the hedge is signed separately (prepareRequest adds date and signature)
+  RequestHeaderMap lHedgeHeaderMap;
+  if (aHeaderMap)
+    lHedgeHeaderMap = *aHeaderMap;
+
+  theHedgeTokens = std::min(theHedgeTokens + theHedgeBudget, MAX_HEDGE_TOKENS);
+  long long lDelay = getHedgeDelay();
+
+  if (!theHedgeMulti)
+    theHedgeMulti = curl_multi_init();
+
+  // index 0 is the request of this connection, 1 the hedge
+  S3Connection*      lConnections[2] = { this, 0 };
+  S3CallBackWrapper* lWrappers[2]    = { aCallBackWrapper, aHedgeWrapper };
+  struct curl_slist* lSLists[2]      = { 0, 0 };
+  long long          lStart[2]       = { 0, 0 };
+  bool               lRunning[2]     = { false, false };
+  int                lResult[2]      = { 0, 0 };
+  int                lWinner         = -1;
+
+  // the stream buffer of a get must not perform the request itself
+  routeRequest();
+  lSLists[0] = prepareRequest(aBucketName, aActionType, aCallBackWrapper, 0, aHeaderMap,
+                              aKey, 0, true);
+  curl_multi_add_handle(theHedgeMulti, theCurl);
+  lStart[0] = now();
+  lRunning[0] = true;
+
+  while (lWinner < 0 || lRunning[lWinner]) {
+    int lStillRunning = 0;
+    while (CURLM_CALL_MULTI_PERFORM == curl_multi_perform(theHedgeMulti, &lStillRunning))
+      ;
+
+    CURLMsg* lMsg;
+    int lMsgsInQueue;
+    while ((lMsg = curl_multi_info_read(theHedgeMulti, &lMsgsInQueue))) {
+      if (lMsg->msg == CURLMSG_DONE) {
+        int i = lMsg->easy_handle == theCurl ? 0 : 1;
+        lRunning[i] = false;
+        lResult[i] = lMsg->data.result;
+        curl_multi_remove_handle(theHedgeMulti, lMsg->easy_handle);
+      }
+    }
+
+    // the first request that receives a response wins; a request that
+    // failed without a response only wins if the other one failed, too
+    for (int i = 0; i < 2 && lWinner < 0; ++i) {
+      if (!lConnections[i])
+        continue;
+      long lCode = 0;
+      curl_easy_getinfo(lConnections[i]->theCurl, CURLINFO_RESPONSE_CODE, &lCode);
+      if (lCode != 0) {
+        lWinner = i;
+        addLatency(now() - lStart[i]);
+      } else if (!lRunning[i] && !lRunning[1 - i]) {
+        lWinner = i;
+      }
+      if (lWinner == 1)
+        ++theNumberOfHedgeWins;
+    }
+
+    if (lWinner >= 0) {
+      int lLoser = 1 - lWinner;
+      if (lRunning[lLoser]) {
+        curl_multi_remove_handle(theHedgeMulti, lConnections[lLoser]->theCurl);
+        lRunning[lLoser] = false;
+      }
+      if (!lRunning[lWinner])
+        break;
+    }
+
+    // send the hedge if the response is overdue and the budget allows it
+    long long lWait = 1000000;
+    if (lWinner < 0 && !lConnections[1] && lDelay >= 0 && theHedgeTokens >= 100) {
+      lWait = lStart[0] + lDelay - now();
+      if (lWait <= 0) {
+        theHedgeTokens -= 100;
+        ++theNumberOfHedgedRequests;
+        lConnections[1] = getHedgeConnection();
+        lConnections[1]->routeRequest(theEndpoint);
+        lSLists[1] = lConnections[1]->prepareRequest(aBucketName, aActionType, aHedgeWrapper,
+                                                     0, &lHedgeHeaderMap, aKey, 0, true);
+        curl_multi_add_handle(theHedgeMulti, lConnections[1]->theCurl);
+        lStart[1] = now();
+        lRunning[1] = true;
+        continue;
+      }
+    }
+
+    // wait for activity on the sockets or the hedging delay; curl_multi_wait
+    // returns earlier if curl's own timeout expires first
+    int lTimeout = 1000;
+    if (lWait / 1000 < lTimeout)
+      lTimeout = lWait / 1000;
+    curl_multi_wait(theHedgeMulti, 0, 0, lTimeout, 0);
+  }
+
+  int lLoser = 1 - lWinner;
+  if (lSLists[lLoser])
+    curl_slist_free_all(lSLists[lLoser]);
+
+  lConnections[lWinner]->reportEndpoint(lResult[lWinner]);
+  lConnections[lWinner]->finishRequest(lWrappers[lWinner], lResult[lWinner], lSLists[lWinner]);
+  return lWinner == 0;
+}
+
+long long
+S3Connection::getHedgeDelay() const
+{
+  if (theLatencies.size() < MIN_LATENCIES)
+    return -1;
+  std::vector<long long> lLatencies(theLatencies);
+  size_t lIndex = std::min(lLatencies.size() * theHedgePercentile / 100, lLatencies.size() - 1);
+  std::nth_element(lLatencies.begin(), lLatencies.begin() + lIndex, lLatencies.end());
+  return lLatencies[lIndex];
+}
+
+void
+S3Connection::addLatency(long long aLatency)
+{
+  if (theLatencies.size() < MAX_LATENCIES) {
+    theLatencies.push_back(aLatency);
+  } else {
+    theLatencies[theNextLatency] = aLatency;
+    theNextLatency = (theNextLatency + 1) % MAX_LATENCIES;
+  }
+}
+
+S3Connection*
+S3Connection::getHedgeConnection()
+{
+  if (!theHedgeConnection) {
+    // like the connections of the factory, the hedge shares the dns cache
+    // and the tls sessions through theShareHandle (see AWSConnection)
+    theHedgeConnection = new S3Connection(theAccessKeyId, theSecretAccessKey, theHost);
+    theHedgeConnection->thePort = thePort;
+    theHedgeConnection->theIsSecure = theIsSecure;
+    theHedgeConnection->theEndpoints = theEndpoints;
+  }
+  // the settings of this connection may have changed since the last hedge
+  theHedgeConnection->theCallingFormat = theCallingFormat;
+  theHedgeConnection->theBucketCallingFormats = theBucketCallingFormats;
+  theHedgeConnection->theCompress = theCompress;
+  // a stream of the same http/2 connection would hit the same server
+  HttpVersion lVersion = theHttpVersion == HTTP_2 ? HTTP_1_1 : (HttpVersion) theHttpVersion;
+  if (theHedgeConnection->theHttpVersion != lVersion)
+    theHedgeConnection->setHttpVersion(lVersion);
+  return theHedgeConnection;
+}
+
+struct curl_slist*
+S3Connection::prepareRequest(const std::string& aBucketName,
+    ActionType aActionType, S3CallBackWrapper* aCallBackWrapper,
+    PathArgs_t* aPathArgsMap, RequestHeaderMap* aHeaderMap,
+    const std::string& aKey, S3Object* aObject, bool aIsAsync)
+{
   aws::CallingFormat* lCallingFormat;
   RequestHeaderMap lHeaderMap;
   std::string lStringToSign;
   std::stringstream lAuthData;
-  CURLcode lResCode;
   struct curl_slist* lSList;
 
-  lResponse = aCallBackWrapper->theResponse;
-  lCallingFormat = aws::CallingFormat::getRegularCallingFormat();
+  lCallingFormat = getCallingFormat(aBucketName);
   std::string lUrl = lCallingFormat->getUrl(theIsSecure, theHost, thePort,
                                             aBucketName, aKey, aPathArgsMap);
 
+  // curl only writes the error buffer if an error occurs
+  theCurlErrorBuffer[0] = 0;
+
+  aCallBackWrapper->theParserCache = &theParserCache;
+
   // set the request url
   curl_easy_setopt(theCurl, CURLOPT_URL, lUrl.c_str());
 
   // set the request method (i.e. get, put) and the according callback functions
-  setRequestMethod(aActionType);
+  setRequestMethod(aCallBackWrapper);
 
   // set the data object received in the callback function
   curl_easy_setopt(theCurl, CURLOPT_WRITEDATA, (void*)(aCallBackWrapper));
@@ -786,6 +1270,7 @@ S3Connection::makeRequest(const std::string& aBucketName,
   aHeaderMap->addDateHeader();
 
   if (aObject) {
+    curl_easy_setopt(theCurl, CURLOPT_READFUNCTION, S3Connection::setPutData);
     curl_easy_setopt(theCurl, CURLOPT_READDATA, (void*) aObject);
     aHeaderMap->addMetadataHeaders(aObject);
     aHeaderMap->addHeader("Content-Type", aObject->theContentType);
@@ -798,8 +1283,15 @@ S3Connection::makeRequest(const std::string& aBucketName,
   }
 
   // authorization
+  // the upload id and part number of a multipart copy are signed, the
+  // path args of the other requests (e.g. prefix and marker) are not
+  bool lIsMultipart = aActionType == INITIATE_MULTIPART_UPLOAD
+                      || aActionType == UPLOAD_PART_COPY
+                      || aActionType == COMPLETE_MULTIPART_UPLOAD
+                      || aActionType == ABORT_MULTIPART_UPLOAD;
   lStringToSign = Canonizer::canonicalize(aActionType, aBucketName, aKey, aHeaderMap,
-                                          false, false, aActionType==BUCKET_LOGGING);
+                                          false, false, aActionType==BUCKET_LOGGING,
+                                          lIsMultipart ? aPathArgsMap : 0);
   {
     // compute signature
     HMAC(EVP_sha1(), theSecretAccessKey.c_str(),  theSecretAccessKey.size(),
@@ -831,41 +1323,67 @@ S3Connection::makeRequest(const std::string& aBucketName,
     theNumberOfRequests = 0;
   }
 
-  GetResponse* lGetResponse = dynamic_cast<GetResponse*>(lResponse);
+  // gets into caller provided buffers or files don't use the stream buffer
+  GetResponse* lGetResponse = aCallBackWrapper->theGetResponse;
+  if (lGetResponse && aCallBackWrapper->theTarget) {
+    curl_easy_setopt(theCurl, CURLOPT_WRITEFUNCTION, S3Connection::getObjectData);
+    lGetResponse = 0;
+  }
+
   if (lGetResponse) {
-    lGetResponse->theStreamBuffer = new CurlStreamBuffer(theCurl);
+    // asynchronous requests are performed by the multi handle of a reactor
+    lGetResponse->theStreamBuffer = new CurlStreamBuffer(theCurl, !aIsAsync);
     lGetResponse->theInputStream =
         new std::istream(lGetResponse->theStreamBuffer);
-    lResCode = (CURLcode) lGetResponse->theStreamBuffer->multi_perform();
+  }
+
+  return lSList;
+}
 
+void
+S3Connection::finishRequest(S3CallBackWrapper* aCallBackWrapper, int aResCode,
+                            struct curl_slist* aSList)
+{
+  S3Response* lResponse = aCallBackWrapper->theResponse;
+  GetResponse* lGetResponse = aCallBackWrapper->theGetResponse;
+  if (lGetResponse && !lGetResponse->theStreamBuffer)
+    lGetResponse = 0;
+
+  if (lGetResponse) {
     // parse the error in case we had one
     if ( ! lResponse->isSuccessful() ) {
       char lBuf[1024];
       size_t lRead;
       while ( true ) {
-        lGetResponse->theInputStream->read(lBuf, 1024);
+        lGetResponse->theInputStream->read(lBuf, 1023);
         lRead = lGetResponse->theInputStream->gcount();
         if (lRead == 0) {
           break;
         }
         lBuf[lRead] = 0;
-        xmlParseChunk(aCallBackWrapper->theParserCtxt, lBuf, lRead, 0);
+        aCallBackWrapper->parseChunk(lBuf, lRead, false);
       }
-      xmlParseChunk(aCallBackWrapper->theParserCtxt, 0, 0, 1);
+      aCallBackWrapper->parseChunk(0, 0, true);
     }
   } else {
-    lResCode = curl_easy_perform(theCurl);
     if (! (lResponse->isSuccessful()) ) {
       // tell the parser that parsing is finished
-      xmlParseChunk(aCallBackWrapper->theParserCtxt, 0, 0, 1);
+      aCallBackWrapper->parseChunk(0, 0, true);
     }
   }
-  curl_slist_free_all(lSList);
+  curl_slist_free_all(aSList);
 
-  if (lResCode != 0 && 
-  !(lResCode==18 && !lGetResponse) // head only (reporting partial file, that can be ignored)
+  // objects compressed by put are decompressed transparently
+  if (lResponse->isSuccessful())
+    decodeResponse(aCallBackWrapper);
+
+  if (aResCode != 0 && 
+  !(aResCode==18 && !lGetResponse) && // head only (reporting partial file, that can be ignored)
+  !(aResCode==CURLE_WRITE_ERROR && aCallBackWrapper->theTarget) // reported by the get function
     ) {
-     std::cerr << "[S3Connection::makeRequest] Response CURLCode is: " << (int) lResCode << std::endl;
+     std::cerr << "[S3Connection::makeRequest] Response CURLCode is: " << aResCode << std::endl;
+    if (theCurlErrorBuffer[0] == 0) // e.g. a request canceled by a reactor
+      throw AWSConnectionException(curl_easy_strerror((CURLcode) aResCode));
     throw AWSConnectionException(theCurlErrorBuffer);
   }
 
@@ -883,7 +1401,7 @@ S3Connection::getS3Data(void *ptr, size_t size, size_t nmemb, void *data)
   // this guarantees to read the input in chunks as they come in
   // by libxml; we always read as much as is in the buffer
   // because we stream internally.
-  xmlParseChunk(lWrapper->theParserCtxt, lChars, size * nmemb, 0);
+  lWrapper->parseChunk(lChars, size * nmemb, false);
 
   return size * nmemb;
 }
@@ -893,68 +1411,158 @@ S3Connection::getHeaderData(void *ptr, size_t size, size_t nmemb, void *stream)
 {
   S3CallBackWrapper* lWrapper = static_cast<S3CallBackWrapper*>(stream);
   S3Response* lRes = lWrapper->theResponse;
-  GetResponse* lGetResponse = 0;
-  HeadResponse* lHeadResponse = 0;
-  CreateBucketResponse* lCreateResponse = 0;
 
   std::string lTmp(static_cast<char*>(ptr), size*nmemb);
   trim(lTmp);
 
-  if ((lHeadResponse = dynamic_cast<HeadResponse*>(lRes))) {
-    if (lTmp.find("404 Not") != std::string::npos) {
+  std::string lValue;
+  std::string lName;
+  int lStatusCode = getStatusCode(lTmp);
+  if (lStatusCode != -1) {
+    // each status line (e.g. of 100 Continue) replaces the previous one
+    lRes->theIsSuccessful = lStatusCode >= 200 && lStatusCode < 300;
+
+    // throttling is reported by the status line only for requests without body
+    if (lStatusCode == 503) {
+      lRes->theS3ResponseError.theErrorCode = S3Exception::SlowDown;
+      lRes->theS3ResponseError.theErrorMessage = "SERVICE UNAVAILABLE";
+    }
+    if (lWrapper->theHeaderParser)
+      lWrapper->theHeaderParser(lRes, lTmp);
+  } else if (parseHeader(lTmp, "ETag", lValue)) {
+    lRes->theETag = unquote(lValue);
+  } else if (parseHeader(lTmp, "Date", lValue)) {
+    lRes->theDate = lValue;
+  } else if (parseHeader(lTmp, "x-amz-id-2", lValue)) {
+    lRes->theAmazonId = lValue;
+  } else if (parseHeader(lTmp, "x-amz-request-id", lValue)) {
+    lRes->theRequestId = lValue;
+  } else if (parseHeader(lTmp, "x-amz-meta-", &lName, &lValue)) {
+    lRes->theMetaData.insert(std::pair<std::string, std::string>(lName, lValue));
+  } else if (lWrapper->theHeaderParser) {
+    // headers of specific responses (see s3requesttraits.h)
+    lWrapper->theHeaderParser(lRes, lTmp);
+  }
+
+  return size * nmemb;
+}
+
+
+size_t
+S3Connection::getObjectData(void *ptr, size_t size, size_t nmemb, void *data)
+{
+  S3CallBackWrapper* lWrapper = static_cast<S3CallBackWrapper*>(data);
+  S3Target* lTarget = lWrapper->theTarget;
+  size_t lSize = size * nmemb;
+  char* lChars = static_cast<char*>(ptr);
 
-      lHeadResponse->theIsSuccessful = false;
-      lHeadResponse->theS3ResponseError.theErrorCode=S3Exception::NoSuchKey;
-      lHeadResponse->theS3ResponseError.theErrorMessage="NOT FOUND";
-    }else if ( lTmp.find("Content-Length:") != std::string::npos) {
-      lHeadResponse->theContentLength = atoll(lTmp.c_str() + 16);
-    } else if ( lTmp.find("Content-Type:") != std::string::npos) {
-      lHeadResponse->theContentType = lTmp.substr(14, lTmp.length() -14);
+  // the body of an error response is parsed as usual
+  if ( ! lWrapper->theResponse->isSuccessful() ) {
+    lWrapper->parseChunk(lChars, lSize, false);
+    return lSize;
+  }
+
+  // all headers have been received with the first chunk of the body
+  if (!lTarget->theIsCodecChecked) {
+    lTarget->theIsCodecChecked = true;
+    const std::map<std::string, std::string>& lMetaData = lWrapper->theResponse->theMetaData;
+    std::map<std::string, std::string>::const_iterator lCodec = lMetaData.find(CODEC_METADATA);
+    if (lCodec != lMetaData.end() && (*lCodec).second == GZIP_CODEC)
+      lTarget->theDecoder = new GzipCodec(false, S3Connection::writeTarget, lTarget);
+  }
+
+  if (lTarget->theDecoder) {
+    if (!lTarget->theDecoder->process(lChars, lSize)) {
+      if (!lTarget->theOverflow && !lTarget->theErrno)
+        lTarget->theErrno = EIO; // corrupt data
+      return 0; // abort the transfer
     }
+    return lSize;
   }
 
-  if (lTmp.find("200 OK") != std::string::npos ||
-      lTmp.find("204 No Content") != std::string::npos) {
-    // if we got a 20x header, the request was successful
-    lRes->theIsSuccessful = true;
-  } else if (lTmp.find("ETag:") != std::string::npos) {
-    lRes->theETag = lTmp.substr(7, lTmp.find_last_of('"') - 7);
-  } else if (lTmp.find("Date:") != std::string::npos) {
-    lRes->theDate = lTmp.substr(6, lTmp.size());
-  } else if (lTmp.find("x-amz-id-2:") != std::string::npos) {
-    lRes->theAmazonId = lTmp.substr(12, lTmp.size());
-  } else if (lTmp.find("x-amz-request-id:") != std::string::npos) {
-    lRes->theRequestId = lTmp.substr(18, lTmp.size());
-  } else if (lTmp.find("x-amz-meta-") != std::string::npos) {
-    size_t lEndOfName = lTmp.find_first_of(":")+1;
-    assert (lEndOfName != std::string::npos);
-    std::string lName = lTmp.substr(11, lEndOfName - 12);
-    std::string lValue = lTmp.substr(lEndOfName+1, lTmp.length());
-    lRes->theMetaData.insert(std::pair<std::string, std::string>(lName, lValue));
-  } else if ((lGetResponse = dynamic_cast<GetResponse*>(lRes))) {
-    if (lTmp.find("Last-Modified:") != std::string::npos) {
-      // parse a time string of the following format: Fri, 09 Nov 2007 13:05:49 GMT
-      Time t(lTmp.c_str()+15);
-      lGetResponse->theLastModified = t;
-
-    } else if ( lTmp.find("Content-Length:") != std::string::npos) {
-      lGetResponse->theContentLength = atoll(lTmp.c_str() + 16);
-    } else if ( lTmp.find("Content-Type:") != std::string::npos) {
-      lGetResponse->theContentType = lTmp.substr(14, lTmp.length() -14);
-    } else if ( lTmp.find("304 N") != std::string::npos ) {
-      // not modified (returned when using If-Modified-Since or If-Non-Match)
-      lGetResponse->theIsSuccessful = true;
-      lGetResponse->theIsModified = false;
+  return writeTarget(lChars, lSize, lTarget) ? lSize : 0;
+}
+
+bool
+S3Connection::writeTarget(const char* aData, size_t aSize, void* aTarget)
+{
+  S3Target* lTarget = static_cast<S3Target*>(aTarget);
+  size_t lSize = aSize;
+  const char* lChars = aData;
+
+  if (lTarget->theFileDescriptor >= 0) { // write directly to the file
+    size_t lWritten = 0;
+    while (lWritten < lSize) {
+      ssize_t lRes = pwrite(lTarget->theFileDescriptor, lChars + lWritten, lSize - lWritten,
+                            lTarget->theFileOffset + lTarget->theDataWritten + lWritten);
+      if (lRes < 0) {
+        if (errno == EINTR)
+          continue;
+        lTarget->theErrno = errno;
+        return false; // abort the transfer
+      }
+      lWritten += lRes;
     }
-  } else if ((lCreateResponse = dynamic_cast<CreateBucketResponse*>(lRes))) {
-    if (lTmp.find("Location:") != std::string::npos) {
-      lCreateResponse->theLocation = lTmp.substr(10, lTmp.find_last_of('"') - 10);
+    lTarget->theDataWritten += lWritten;
+    return true;
+  }
+
+  // scatter into the buffers
+  size_t lCopied = 0;
+  while (lCopied < lSize) {
+    if (lTarget->theCurrentIovec >= lTarget->theIovecCount) {
+      lTarget->theOverflow = true;
+      return false; // abort the transfer
+    }
+    const struct iovec& lIovec = lTarget->theIovec[lTarget->theCurrentIovec];
+    size_t lAvailable = lIovec.iov_len - lTarget->theCurrentIovecOffset;
+    size_t lCopy = std::min(lAvailable, lSize - lCopied);
+    memcpy(static_cast<char*>(lIovec.iov_base) + lTarget->theCurrentIovecOffset,
+           lChars + lCopied, lCopy);
+    lCopied += lCopy;
+    lTarget->theCurrentIovecOffset += lCopy;
+    if (lTarget->theCurrentIovecOffset == lIovec.iov_len) {
+      ++lTarget->theCurrentIovec;
+      lTarget->theCurrentIovecOffset = 0;
     }
   }
+  lTarget->theDataWritten += lCopied;
+  return true;
+}
 
-  return size * nmemb;
+bool
+S3Connection::writeFile(const char* aData, size_t aSize, void* aFile)
+{
+  return fwrite(aData, 1, aSize, static_cast<FILE*>(aFile)) == aSize;
 }
 
+void
+S3Connection::decodeResponse(S3CallBackWrapper* aCallBackWrapper)
+{
+  std::map<std::string, std::string>& lMetaData = aCallBackWrapper->theResponse->theMetaData;
+  std::map<std::string, std::string>::iterator lCodec = lMetaData.find(CODEC_METADATA);
+  if (lCodec == lMetaData.end() || (*lCodec).second != GZIP_CODEC)
+    return;
+
+  long long lContentLength = -1;
+  std::map<std::string, std::string>::iterator lLength = lMetaData.find(LENGTH_METADATA);
+  if (lLength != lMetaData.end()) {
+    lContentLength = atoll((*lLength).second.c_str());
+    lMetaData.erase(lLength);
+  }
+  lMetaData.erase(lCodec);
+  aCallBackWrapper->theIsDecoded = true;
+
+  if (lContentLength >= 0 && aCallBackWrapper->theContentLength)
+    *aCallBackWrapper->theContentLength = lContentLength;
+
+  GetResponse* lGetResponse = aCallBackWrapper->theGetResponse;
+  if (lGetResponse && lGetResponse->theStreamBuffer) {
+    lGetResponse->theDecodeBuffer = new GzipStreamBuffer(lGetResponse->theStreamBuffer);
+    delete lGetResponse->theInputStream;
+    lGetResponse->theInputStream = new std::istream(lGetResponse->theDecodeBuffer);
+  }
+}
 
 size_t
 S3Connection::setCreateBucketData(void *aBuffer, size_t aSize, size_t nmemb, void *stream)
@@ -982,8 +1590,21 @@ S3Connection::setPutData(void *aBuffer, size_t aSize, size_t nmemb, void* data)
     lObject->theDataRead += remaining;
     return remaining;
   }
+  else if (lObject->theFileDescriptor >= 0) { // serve data directly from a file
+    remaining = lObject->theContentLength - lObject->theDataRead;
+    remaining = std::min(remaining, maxsize);
+    ssize_t lRead;
+    do {
+      lRead = pread(lObject->theFileDescriptor, charptr, remaining,
+                    lObject->theFileOffset + lObject->theDataRead);
+    } while (lRead < 0 && errno == EINTR);
+    if (lRead < 0)
+      return CURL_READFUNC_ABORT;
+    lObject->theDataRead += lRead;
+    return lRead;
+  }
   else {
-    assert(false);  // either of the two (theIstream or theDataPointer) must be set
+    assert(false);  // either theIstream, theDataPointer, or theFileDescriptor must be set
   }
   return 0; // avoid warning
 }
@@ -1016,6 +1637,21 @@ S3Connection::requestTypeForAction(ActionType aType)
       case HEAD: {
           return "HEAD";
       }
+      case COPY: {
+          return "PUT";
+      }
+      case INITIATE_MULTIPART_UPLOAD: {
+          return "POST";
+      }
+      case UPLOAD_PART_COPY: {
+          return "PUT";
+      }
+      case COMPLETE_MULTIPART_UPLOAD: {
+          return "POST";
+      }
+      case ABORT_MULTIPART_UPLOAD: {
+          return "DELETE";
+      }
       case BUCKET_LOGGING: {
           return "GET";
       }
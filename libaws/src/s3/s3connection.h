@@ -19,7 +19,11 @@
 #include "common.h"
 
 #include <map>
+#include <vector>
 #include <iostream>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/uio.h>
 
 #include "awsconnection.h"
 
@@ -35,18 +39,24 @@ namespace aws {
   class    Canonizer;
   class    RequestHeaderMap;
   class    S3ConnectionImpl;
+  class    S3PresignerImpl;
   typedef  std::map < std::string, std::string > PathArgs_t;
 
   namespace s3 {
 
     class  S3Object;
+    class  S3Target;
+    class  S3AsyncRequest;
     struct S3CallBackWrapper;
+    template <int ActionType> class S3Request;
 
 
     class S3Connection : public aws::AWSConnection {
 
       friend class    ::aws::S3ConnectionImpl;
+      friend class    ::aws::S3PresignerImpl;
       friend class    ::aws::Canonizer;
+      template <int ActionType> friend class S3Request;
 
     private:
       //! Instance of this class are only created by the aws::AWSConnectionFactory
@@ -56,6 +66,46 @@ namespace aws {
     protected:
       static std::string DEFAULT_HOST; // the amazon s3 default hostname
 
+      unsigned int    theEncryptedResultSize;
+      char*           theBase64EncodedString;
+      unsigned char   theEncryptedResult[1024];
+
+      // calling format used for all buckets that have no calling format
+      // set in theBucketCallingFormats (path-style by default)
+      CallingFormat*  theCallingFormat;
+      std::map<std::string, CallingFormat*> theBucketCallingFormats;
+
+      // compress text objects with gzip before sending them
+      bool            theCompress;
+
+      int             theHttpVersion; // HttpVersion
+
+      // smaller objects are never compressed
+      static const uint64_t MIN_COMPRESSION_SIZE = 1024;
+
+      // performs the requests of the synchronous functions that are built
+      // on the asynchronous requests (see performAsync)
+      CURLM*          theMulti;
+
+      // hedging of head and get requests (see makeHedgedRequest)
+      unsigned int    theHedgePercentile;  // 0 if hedging is disabled
+      unsigned int    theHedgeBudget;      // percent of the requests
+      unsigned int    theHedgeTokens;      // a hedge costs 100 tokens
+      S3Connection*   theHedgeConnection;  // sends the duplicates
+      CURLM*          theHedgeMulti;       // races both requests
+      std::vector<long long> theLatencies; // time to the first byte in us
+      size_t          theNextLatency;
+      uint64_t        theNumberOfHedgedRequests;
+      uint64_t        theNumberOfHedgeWins;
+
+      // hedging starts once enough latencies have been measured
+      static const size_t MIN_LATENCIES = 16;
+      static const size_t MAX_LATENCIES = 128;
+      // unused budget is saved for bursts of at most 10 hedges
+      static const unsigned int MAX_HEDGE_TOKENS = 1000;
+
+    public:
+      // the request traits of each type are defined in s3requesttraits.h
       enum ActionType {
         CREATE_BUCKET = 0,
         LIST_ALL_BUCKETS,
@@ -67,18 +117,49 @@ namespace aws {
         HEAD,
         BUCKET_LOGGING,
         SET_BUCKET_LOGGING,
-        DISABLE_BUCKET_LOGGING
+        DISABLE_BUCKET_LOGGING,
+        COPY,
+        // the requests of a multipart copy (see multipartCopy)
+        INITIATE_MULTIPART_UPLOAD,
+        UPLOAD_PART_COPY,
+        COMPLETE_MULTIPART_UPLOAD,
+        ABORT_MULTIPART_UPLOAD
       };
 
-      unsigned int    theEncryptedResultSize;
-      char*           theBase64EncodedString;
-      unsigned char   theEncryptedResult[1024];
-
-    public:
       virtual ~S3Connection();
 
       std::string getProtocolVersion() { return "2006-03-01"; }
 
+      void
+      setCallingFormat(CallingFormat* aCallingFormat);
+
+      void
+      setCallingFormat(const std::string& aBucketName, CallingFormat* aCallingFormat);
+
+      CallingFormat*
+      getCallingFormat(const std::string& aBucketName) const;
+
+      void
+      setCompression(bool aCompress) { theCompress = aCompress; }
+
+      enum HttpVersion {
+        HTTP_1_0 = 0,
+        HTTP_1_1,
+        HTTP_2     // falls back to HTTP/1.1
+      };
+
+      void
+      setHttpVersion(HttpVersion aVersion);
+
+      void
+      setHedging(unsigned int aPercentile, unsigned int aBudget);
+
+      uint64_t
+      getNumberOfHedgedRequests() const { return theNumberOfHedgedRequests; }
+
+      uint64_t
+      getNumberOfHedgeWins() const { return theNumberOfHedgeWins; }
+
       CreateBucketResponse*
       createBucket(const std::string& aBucketName);
 
@@ -94,7 +175,8 @@ namespace aws {
 
       ListBucketResponse*
       listBucket(const std::string& aBucketName, const std::string& aPrefix, 
-                 const std::string& aMarker, const std::string& aDelimiter, int aMaxKeys);
+                 const std::string& aMarker, const std::string& aDelimiter, int aMaxKeys,
+                 bool aThrow = true);
 
       PutResponse*
       put(const std::string& aBucketName,
@@ -114,6 +196,16 @@ namespace aws {
           long aSize,
           bool aReducedRedunancy);
 
+      PutResponse*
+      put(const std::string& aBucketName,
+          const std::string& aKey,
+          int aFileDescriptor,
+          off_t aOffset,
+          const std::string& aContentType,
+          const std::map<std::string, std::string>* aMetaDataMap,
+          long aSize,
+          bool aReducedRedunancy);
+
       std::string
       queryString(ActionType aActionType, const std::string& aBucketName,
                   const std::string& aKey, time_t aExpiration);
@@ -124,16 +216,73 @@ namespace aws {
 
       GetResponse*
       get(const std::string& aBucketName, const std::string& aKey, 
+          const std::map<std::string, std::string>* aMetaDataMap,
+          bool aThrow = true);
+
+      GetResponse*
+      get(const std::string& aBucketName, const std::string& aKey,
+          char* aBuffer, size_t aBufferSize,
           const std::map<std::string, std::string>* aMetaDataMap);
 
+      GetResponse*
+      get(const std::string& aBucketName, const std::string& aKey,
+          const struct iovec* aIovec, int aIovecCount,
+          const std::map<std::string, std::string>* aMetaDataMap);
+
+      GetResponse*
+      get(const std::string& aBucketName, const std::string& aKey,
+          int aFileDescriptor, off_t aOffset,
+          const std::map<std::string, std::string>* aMetaDataMap);
+
+      CopyResponse*
+      copy(const std::string& aSrcBucketName, const std::string& aSrcKey,
+           const std::string& aDstBucketName, const std::string& aDstKey,
+           const std::map<std::string, std::string>* aMetaDataMap,
+           const std::string& aContentType);
+
+      // the steps of a copy of objects larger than 5 GB; the parts are
+      // copied by UploadPartCopy requests which may be sent by other
+      // connections in parallel (see aws::S3Connection::multipartCopy)
+      //
+      // initiateMultipartCopy starts the upload of the copy with the metadata
+      // and content type of the source and sets aSize to its size
+      CopyResponse*
+      initiateMultipartCopy(const std::string& aSrcBucketName, const std::string& aSrcKey,
+                            const std::string& aDstBucketName, const std::string& aDstKey,
+                            long long& aSize);
+
+      // copies the bytes aFirstByte to aLastByte (inclusive) of the source
+      CopyResponse*
+      copyPart(const std::string& aSrcBucketName, const std::string& aSrcKey,
+               const std::string& aDstBucketName, const std::string& aDstKey,
+               const std::string& aUploadId, int aPartNumber,
+               long long aFirstByte, long long aLastByte);
+
+      // aETags are the etags of the parts 1 to n
+      CopyResponse*
+      completeMultipartCopy(const std::string& aDstBucketName, const std::string& aDstKey,
+                            const std::string& aUploadId,
+                            const std::vector<std::string>& aETags);
+
+      // discards the parts copied so far; doesn't throw because it's only
+      // called after the copy failed
+      void
+      abortMultipartCopy(const std::string& aDstBucketName, const std::string& aDstKey,
+                         const std::string& aUploadId);
+
       DeleteResponse*
-      del(const std::string& aBucketName, const std::string& aKey);
+      del(const std::string& aBucketName, const std::string& aKey, bool aThrow = true);
 
       DeleteAllResponse*
       deleteAll(const std::string& aBucketName, const std::string& aPrefix);
 
+      // deletes the given keys (e.g. from an index) instead of listing the prefix
+      DeleteAllResponse*
+      deleteAll(const std::string& aBucketName, const std::string& aPrefix,
+                const std::vector<std::string>& aKeys);
+
       HeadResponse*
-      head(const std::string& aBucketName, const std::string& aKey);
+      head(const std::string& aBucketName, const std::string& aKey, bool aThrow = true);
 
       BucketLoggingStatusResponse*
       bucketLoggingStatus(const std::string& aBucketName);
@@ -146,6 +295,28 @@ namespace aws {
       DisableBucketLoggingResponse*
       disableBucketLogging(const std::string& aBucketName);
 
+      // asynchronous requests: the easy handle of this connection is
+      // performed by a reactor afterwards (one request at a time)
+      S3AsyncRequest*
+      startHead(const std::string& aBucketName, const std::string& aKey);
+
+      S3AsyncRequest*
+      startGet(const std::string& aBucketName, const std::string& aKey);
+
+      S3AsyncRequest*
+      startPut(const std::string& aBucketName, const std::string& aKey,
+               const char* aData, const std::string& aContentType, long aSize);
+
+      S3AsyncRequest*
+      startDelete(const std::string& aBucketName, const std::string& aKey);
+
+      // throws the same exceptions as the synchronous functions
+      void
+      finishAsync(S3AsyncRequest* aRequest, int aCurlCode);
+
+      CURL*
+      getHandle() const { return theCurl; }
+
     private:
       void
       makeRequest(const std::string& aBucketName, ActionType aActionType, S3CallBackWrapper* aResponse,
@@ -156,12 +327,100 @@ namespace aws {
                   PathArgs_t * aPathArgsMap, RequestHeaderMap * aHeaderMap,
                   const std::string& aKey, S3Object* aObject);
 
-      void            setRequestMethod(ActionType aActionType);
+      // makeRequest is split into preparing the curl handle, performing it,
+      // and finishing the request (i.e. parsing errors, throwing exceptions)
+      struct curl_slist*
+      prepareRequest(const std::string& aBucketName, ActionType aActionType,
+                     S3CallBackWrapper* aResponse, PathArgs_t * aPathArgsMap,
+                     RequestHeaderMap * aHeaderMap, const std::string& aKey,
+                     S3Object* aObject, bool aIsAsync);
+
+      void
+      finishRequest(S3CallBackWrapper* aResponse, int aCurlCode, struct curl_slist* aSList);
+
+      // performs a head or get request like makeRequest, but if no response
+      // arrived within the hedging delay, the request is sent again by the
+      // hedge connection (into aHedgeWrapper). The first request to respond
+      // wins and the other one is canceled. Returns false if the hedge won.
+      bool
+      makeHedgedRequest(const std::string& aBucketName, ActionType aActionType,
+                        S3CallBackWrapper* aCallBackWrapper, S3CallBackWrapper* aHedgeWrapper,
+                        RequestHeaderMap* aHeaderMap, const std::string& aKey);
+
+      // the percentile of the measured latencies or -1 if there are too few
+      long long
+      getHedgeDelay() const;
+
+      void
+      addLatency(long long aLatency);
+
+      // creates the hedge connection on first use
+      S3Connection*
+      getHedgeConnection();
+
+      void
+      startAsync(S3AsyncRequest* aRequest, const std::string& aBucketName,
+                 const std::string& aKey, S3Object* aObject);
+
+      // performs aRequest on theMulti like a reactor would do it and waits
+      // until it is done (repeating it on another endpoint if it couldn't
+      // be sent); throws connection errors but leaves the response unchecked
+      void
+      performAsync(S3AsyncRequest* aRequest, const std::string& aBucketName,
+                   const std::string& aKey, RequestHeaderMap* aHeaderMap,
+                   S3Object* aObject);
+
+      // finishes a request performed by a reactor or by performAsync
+      void
+      completeAsync(S3AsyncRequest* aRequest, int aCurlCode);
+
+      void            setRequestMethod(S3CallBackWrapper* aCallBackWrapper);
+
+      // throws the exception of a request type (see s3requesttraits.h)
+      template <int ActionType> static void
+      throwError(S3Response* aResponse);
+
+      template <int ActionType> static S3AsyncRequest*
+      createAsyncRequest(S3Response* aResponse);
+
+      // receives an object into aTarget or a stream buffer if aTarget is 0
+      // (shared by all get functions that don't use an etag)
+      GetResponse*
+      getObject(const std::string& aBucketName, const std::string& aKey,
+                S3Target* aTarget,
+                const std::map<std::string, std::string>* aMetaDataMap,
+                bool aThrow = true);
+
+      // sends the object described by aObject (shared by all put functions)
+      PutResponse*
+      putObject(const std::string& aBucketName, const std::string& aKey,
+                S3Object* aObject,
+                const std::map<std::string, std::string>* aMetaDataMap,
+                bool aReducedRedunancy);
+
+      // compresses aObject into a temporary file which is described by
+      // aCompressed; returns 0 if no temporary file could be created
+      FILE*
+      compressObject(S3Object* aObject, S3Object* aCompressed);
+
+      // removes the codec metadata of a get or head response and sets the
+      // size and the input stream to the uncompressed object
+      static void
+      decodeResponse(S3CallBackWrapper* aCallBackWrapper);
 
       //all the callback handlers
       static          size_t
       getS3Data(void *aBuffer, size_t aSize, size_t nmemb, void *userp);
 
+      static          size_t
+      getObjectData(void *aBuffer, size_t aSize, size_t nmemb, void *userp);
+
+      static          bool
+      writeTarget(const char* aData, size_t aSize, void* aTarget);
+
+      static          bool
+      writeFile(const char* aData, size_t aSize, void* aFile);
+
       static          size_t
       setCreateBucketData(void *aBuffer, size_t aSize, size_t nmemb, void *stream);
 
@@ -81,6 +81,11 @@ namespace aws {
 
   HeadException::~HeadException() throw() {}
 
+  CopyException::CopyException(const s3::S3ResponseError& aError)
+  : S3Exception(aError) {}
+
+  CopyException::~CopyException() throw() {}
+
   DeleteException::DeleteException(const s3::S3ResponseError& aError)
   : S3Exception(aError) {}
 
@@ -738,6 +738,124 @@ HeadHandler::endElementNs(void * ctx,
 }
 
 
+CopyHandler::CopyHandler()
+        : S3Handler()
+{}
+
+
+void
+CopyHandler::startElementNs( void * ctx, 
+                             const xmlChar * localname, 
+                             const xmlChar * prefix, 
+                             const xmlChar * URI, 
+                             int nb_namespaces, 
+                             const xmlChar ** namespaces, 
+                             int nb_attributes, 
+                             int nb_defaulted, 
+                             const xmlChar ** attributes )
+{
+  S3CallBackWrapper*    lWrapper = static_cast<S3CallBackWrapper*>( ctx );
+  CopyResponse* lRes     = static_cast<CopyResponse*>( lWrapper->theResponse );
+  CopyHandler*  lHandler = static_cast<CopyHandler*>(lWrapper->theHandler);
+
+  // a copy might fail after the 200 OK has been sent
+  // in this case, the body contains an error instead of the result
+  if (xmlStrEqual(localname, BAD_CAST "Error")) {
+      lRes->theIsSuccessful = false;
+  } 
+  else if (xmlStrEqual(localname, BAD_CAST "Code")) {
+      lHandler->setState(Code);
+  } 
+  else if (xmlStrEqual(localname, BAD_CAST "Message")) {
+      lHandler->setState(Message);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "RequestId")) {
+      lHandler->setState(RequestId);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "HostId")) {
+      lHandler->setState(HostId);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "LastModified")) {
+      lHandler->setState(LastModified);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "ETag")) {
+      lRes->theETag.clear();
+      lHandler->setState(ETag);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "UploadId")) {
+      lHandler->setState(UploadId);
+  }
+}
+    
+void
+CopyHandler::charactersSAXFunc(void * ctx, 
+    					       const xmlChar * value, 
+    					       int len)
+{
+  S3CallBackWrapper*    lWrapper = static_cast<S3CallBackWrapper*>( ctx );
+  CopyResponse* lRes     = static_cast<CopyResponse*>( lWrapper->theResponse );
+  CopyHandler*  lHandler = static_cast<CopyHandler*>(lWrapper->theHandler);
+            
+  if (lHandler->isSet(Code)) {
+      lRes->theS3ResponseError.theErrorCode = S3ResponseError::parseError(std::string((const char*)value, len));
+  } 
+  else if (lHandler->isSet(Message)) {
+      lRes->theS3ResponseError.theErrorMessage = std::string((const char*)value, len);
+  }
+  else if (lHandler->isSet(RequestId)) {
+      lRes->theS3ResponseError.theRequestId = std::string((const char*)value, len);
+  }
+  else if (lHandler->isSet(HostId)) {
+      lRes->theS3ResponseError.theHostId = std::string((const char*)value, len);         
+  }
+  else if (lHandler->isSet(LastModified)) {
+      lRes->theLastModified = std::string((const char*)value, len);
+  }
+  else if (lHandler->isSet(ETag)) {
+      // the quotes are delivered separately (&quot;)
+      // strip them to match the etag returned in the header of other requests
+      for (int i = 0; i < len; ++i) {
+        if (value[i] != '"')
+          lRes->theETag += (char) value[i];
+      }
+  }
+  else if (lHandler->isSet(UploadId)) {
+      lRes->theUploadId += std::string((const char*)value, len);
+  }
+}
+
+void
+CopyHandler::endElementNs(void * ctx, 
+    					      const xmlChar * localname, 
+    					      const xmlChar * prefix, 
+    					      const xmlChar * URI)
+{
+  S3CallBackWrapper*    lWrapper = static_cast<S3CallBackWrapper*>( ctx );
+  CopyHandler*  lHandler = static_cast<CopyHandler*>(lWrapper->theHandler);
+
+  if (xmlStrEqual(localname, BAD_CAST "Code")) {
+      lHandler->unsetState(Code);
+  } 
+  else if (xmlStrEqual(localname, BAD_CAST "Message")) {
+      lHandler->unsetState(Message);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "RequestId")) {
+      lHandler->unsetState(RequestId);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "HostId")) {
+      lHandler->unsetState(HostId);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "LastModified")) {
+      lHandler->unsetState(LastModified);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "ETag")) {
+      lHandler->unsetState(ETag);
+  }
+  else if (xmlStrEqual(localname, BAD_CAST "UploadId")) {
+      lHandler->unsetState(UploadId);
+  }
+}
+
 DeleteHandler::DeleteHandler()
     : S3Handler()
 {
@@ -28,6 +28,7 @@ class S3Handler
 {
 public:
     S3Handler();
+    virtual ~S3Handler() {}
     
     void setState(uint64_t s)   { theCurrentState |= s; }
     bool isSet(uint64_t s)      { return (theCurrentState & s) == s; }
@@ -313,6 +314,44 @@ protected:
     };
 
     
+public:
+    static void startElementNs( void * ctx, 
+                                const xmlChar * localname, 
+                                const xmlChar * prefix, 
+                                const xmlChar * URI, 
+                                int nb_namespaces, 
+                                const xmlChar ** namespaces, 
+                                int nb_attributes, 
+                                int nb_defaulted, 
+                                const xmlChar ** attributes );
+    
+    static void	charactersSAXFunc(void * ctx, 
+    					          const xmlChar * value, 
+                                  int len);
+    
+    static void	endElementNs(void * ctx, 
+    					     const xmlChar * localname, 
+    					     const xmlChar * prefix, 
+                             const xmlChar * URI);
+};
+
+class CopyHandler  : public S3Handler
+{
+public:
+    CopyHandler();
+
+protected:
+    enum States {
+        Code         = 1,
+        Message      = 2,
+        RequestId    = 4,
+        HostId       = 8,
+        LastModified = 16,
+        ETag         = 32,
+        UploadId     = 64
+    };
+
+    
 public:
     static void startElementNs( void * ctx, 
                                 const xmlChar * localname, 
@@ -15,6 +15,7 @@
  */
 #include "common.h"
 #include "s3/s3object.h"
+#include "s3/s3codec.h"
 #include <istream>
 
 namespace aws { namespace s3 
@@ -25,7 +26,28 @@ S3Object::S3Object()
       theContentLength(0),
       theDataPointer(0),
       theIstream(0),
+      theFileDescriptor(-1),
+      theFileOffset(0),
       theDataRead(0)
 { }    
+
+S3Target::S3Target()
+    : theIovec(0),
+      theIovecCount(0),
+      theFileDescriptor(-1),
+      theFileOffset(0),
+      theDataWritten(0),
+      theCurrentIovec(0),
+      theCurrentIovecOffset(0),
+      theOverflow(false),
+      theErrno(0),
+      theIsCodecChecked(false),
+      theDecoder(0)
+{ }
+
+S3Target::~S3Target()
+{
+    delete theDecoder;
+}
     
 } } // end namespaces
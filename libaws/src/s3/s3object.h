@@ -21,9 +21,13 @@
 #include <map>
 #include <list>
 #include <istream>
+#include <sys/types.h>
+#include <sys/uio.h>
 
 namespace aws { namespace s3 
 {
+
+class GzipCodec;
     
 class S3Object 
 {
@@ -40,10 +44,36 @@ public:
     // use either of the following memebers
     const char*      theDataPointer;
     std::istream*    theIstream;
+    int              theFileDescriptor; // read with pread starting at theFileOffset
+    off_t            theFileOffset;
 
     // data needed in the setPutData function
     size_t           theDataRead;
 }; 
+
+// destination of a get request that receives the object directly
+// into caller provided buffers or a file instead of a CurlStreamBuffer
+class S3Target
+{
+public:
+    S3Target();
+    ~S3Target();
+
+    // use either of the following members
+    const struct iovec* theIovec;
+    int              theIovecCount;
+    int              theFileDescriptor; // written with pwrite starting at theFileOffset
+    off_t            theFileOffset;
+
+    // data needed in the getObjectData function
+    uint64_t         theDataWritten;
+    int              theCurrentIovec;
+    size_t           theCurrentIovecOffset;
+    bool             theOverflow; // set if the object doesn't fit into the buffers
+    int              theErrno;    // set if writing to the file failed
+    bool             theIsCodecChecked;
+    GzipCodec*       theDecoder;  // set if the object was compressed by put
+};
     
 } } // end namespaces
 
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "s3/s3requesttraits.h"
+#include "util.h"
+
+#include <stdlib.h>
+
+namespace aws { namespace s3 {
+
+// the following functions are called by S3Connection::getHeaderData for all
+// header lines that are not common to all responses
+
+void
+S3RequestTraits<S3Connection::CREATE_BUCKET>::parseHeader(S3Response* aResponse,
+                                                          const std::string& aLine)
+{
+  CreateBucketResponse* lRes = static_cast<CreateBucketResponse*>(aResponse);
+  std::string lValue;
+  if (aws::parseHeader(aLine, "Location", lValue)) {
+    lRes->theLocation = unquote(lValue);
+  }
+}
+
+void
+S3RequestTraits<S3Connection::GET>::parseHeader(S3Response* aResponse,
+                                                const std::string& aLine)
+{
+  GetResponse* lRes = static_cast<GetResponse*>(aResponse);
+  std::string lValue;
+  if (aws::parseHeader(aLine, "Last-Modified", lValue)) {
+    // parse a time string of the following format: Fri, 09 Nov 2007 13:05:49 GMT
+    Time t(lValue.c_str());
+    lRes->theLastModified = t;
+  } else if (aws::parseHeader(aLine, "Content-Length", lValue)) {
+    lRes->theContentLength = atoll(lValue.c_str());
+  } else if (aws::parseHeader(aLine, "Content-Type", lValue)) {
+    lRes->theContentType = lValue;
+  } else if (getStatusCode(aLine) == 304) {
+    // not modified (returned when using If-Modified-Since or If-Non-Match)
+    lRes->theIsSuccessful = true;
+    lRes->theIsModified = false;
+  }
+}
+
+void
+S3RequestTraits<S3Connection::HEAD>::parseHeader(S3Response* aResponse,
+                                                 const std::string& aLine)
+{
+  HeadResponse* lRes = static_cast<HeadResponse*>(aResponse);
+  std::string lValue;
+  if (getStatusCode(aLine) == 404) {
+    lRes->theIsSuccessful = false;
+    lRes->theS3ResponseError.theErrorCode = S3Exception::NoSuchKey;
+    lRes->theS3ResponseError.theErrorMessage = "NOT FOUND";
+  } else if (aws::parseHeader(aLine, "Content-Length", lValue)) {
+    lRes->theContentLength = atoll(lValue.c_str());
+  } else if (aws::parseHeader(aLine, "Content-Type", lValue)) {
+    lRes->theContentType = lValue;
+  }
+}
+
+} /* namespace s3 */
+} /* namespace aws */
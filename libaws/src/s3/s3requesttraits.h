@@ -0,0 +1,317 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_S3_S3REQUESTTRAITS_H
+#define AWS_S3_S3REQUESTTRAITS_H
+
+#include "common.h"
+
+#include <string>
+#include <memory>
+#include <curl/curl.h>
+
+#include <libaws/s3exception.h>
+
+#include "s3/s3connection.h"
+#include "s3/s3response.h"
+#include "s3/s3handler.h"
+#include "s3/s3callbackwrapper.h"
+
+namespace aws { namespace s3 {
+
+  // http methods used by the requests
+  struct HttpGet
+  {
+    static void
+    set(CURL* aCurl)
+    {
+      curl_easy_setopt(aCurl, CURLOPT_CUSTOMREQUEST, 0);
+      curl_easy_setopt(aCurl, CURLOPT_HTTPGET, 1);
+      curl_easy_setopt(aCurl, CURLOPT_UPLOAD, 0);
+    }
+  };
+
+  // the body (if any) is served by the read callback of the connection
+  struct HttpPut
+  {
+    static void
+    set(CURL* aCurl)
+    {
+      curl_easy_setopt(aCurl, CURLOPT_CUSTOMREQUEST, 0);
+      curl_easy_setopt(aCurl, CURLOPT_HTTPGET, 0);
+      curl_easy_setopt(aCurl, CURLOPT_UPLOAD, 1);
+    }
+  };
+
+  // the body (if any) is served by the read callback of the connection
+  struct HttpPost
+  {
+    static void
+    set(CURL* aCurl)
+    {
+      curl_easy_setopt(aCurl, CURLOPT_CUSTOMREQUEST, "POST");
+      curl_easy_setopt(aCurl, CURLOPT_HTTPGET, 0);
+      curl_easy_setopt(aCurl, CURLOPT_UPLOAD, 1);
+    }
+  };
+
+  struct HttpDelete
+  {
+    static void
+    set(CURL* aCurl)
+    {
+      curl_easy_setopt(aCurl, CURLOPT_CUSTOMREQUEST, "DELETE");
+      curl_easy_setopt(aCurl, CURLOPT_UPLOAD, 0);
+      curl_easy_setopt(aCurl, CURLOPT_HTTPGET, 0);
+    }
+  };
+
+  struct HttpHead
+  {
+    static void
+    set(CURL* aCurl)
+    {
+      curl_easy_setopt(aCurl, CURLOPT_CUSTOMREQUEST, "HEAD");
+      curl_easy_setopt(aCurl, CURLOPT_UPLOAD, 0);
+      curl_easy_setopt(aCurl, CURLOPT_HTTPGET, 0);
+    }
+  };
+
+  // defaults for requests that only parse the common headers
+  struct S3RequestTraitsBase
+  {
+    static void
+    parseHeader(S3Response*, const std::string&) {}
+
+    // the response whose body is received by a stream buffer or a target
+    static GetResponse*
+    getResponse(S3Response*) { return 0; }
+
+    // set to the uncompressed size if the object was compressed by put
+    static long long*
+    getContentLength(S3Response*) { return 0; }
+  };
+
+  // Binds the response, handler, exception, http method, and header policy
+  // of a request to its S3Connection::ActionType at compile time. A new
+  // operation only needs a specialization of this template.
+  template <int ActionType> struct S3RequestTraits;
+
+  template <> struct S3RequestTraits<S3Connection::CREATE_BUCKET> : S3RequestTraitsBase
+  {
+    typedef CreateBucketResponse  Response;
+    typedef CreateBucketHandler   Handler;
+    typedef CreateBucketException Exception;
+    typedef HttpPut               Method;
+
+    static void
+    parseHeader(S3Response* aResponse, const std::string& aLine);
+  };
+
+  template <> struct S3RequestTraits<S3Connection::LIST_ALL_BUCKETS> : S3RequestTraitsBase
+  {
+    typedef ListAllBucketsResponse  Response;
+    typedef ListAllBucketsHandler   Handler;
+    typedef ListAllBucketsException Exception;
+    typedef HttpGet                 Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::LIST_BUCKET> : S3RequestTraitsBase
+  {
+    typedef ListBucketResponse  Response;
+    typedef ListBucketHandler   Handler;
+    typedef ListBucketException Exception;
+    typedef HttpGet             Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::DELETE_BUCKET> : S3RequestTraitsBase
+  {
+    typedef DeleteBucketResponse  Response;
+    typedef DeleteBucketHandler   Handler;
+    typedef DeleteBucketException Exception;
+    typedef HttpDelete            Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::PUT> : S3RequestTraitsBase
+  {
+    typedef PutResponse  Response;
+    typedef PutHandler   Handler;
+    typedef PutException Exception;
+    typedef HttpPut      Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::GET> : S3RequestTraitsBase
+  {
+    typedef GetResponse  Response;
+    typedef GetHandler   Handler;
+    typedef GetException Exception;
+    typedef HttpGet      Method;
+
+    static void
+    parseHeader(S3Response* aResponse, const std::string& aLine);
+
+    static GetResponse*
+    getResponse(S3Response* aResponse) { return static_cast<GetResponse*>(aResponse); }
+
+    static long long*
+    getContentLength(S3Response* aResponse)
+    {
+      return &static_cast<GetResponse*>(aResponse)->theContentLength;
+    }
+  };
+
+  template <> struct S3RequestTraits<S3Connection::DELETE> : S3RequestTraitsBase
+  {
+    typedef DeleteResponse  Response;
+    typedef DeleteHandler   Handler;
+    typedef DeleteException Exception;
+    typedef HttpDelete      Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::HEAD> : S3RequestTraitsBase
+  {
+    typedef HeadResponse  Response;
+    typedef HeadHandler   Handler;
+    typedef HeadException Exception;
+    typedef HttpHead      Method;
+
+    static void
+    parseHeader(S3Response* aResponse, const std::string& aLine);
+
+    static long long*
+    getContentLength(S3Response* aResponse)
+    {
+      return &static_cast<HeadResponse*>(aResponse)->theContentLength;
+    }
+  };
+
+  template <> struct S3RequestTraits<S3Connection::BUCKET_LOGGING> : S3RequestTraitsBase
+  {
+    typedef BucketLoggingStatusResponse  Response;
+    typedef BucketLoggingStatusHandler   Handler;
+    typedef BucketLoggingStatusException Exception;
+    typedef HttpGet                      Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::COPY> : S3RequestTraitsBase
+  {
+    typedef CopyResponse  Response;
+    typedef CopyHandler   Handler;
+    typedef CopyException Exception;
+    typedef HttpPut       Method; // the data is taken from x-amz-copy-source
+  };
+
+  // the requests of a multipart copy report their errors as a failed copy
+  template <> struct S3RequestTraits<S3Connection::INITIATE_MULTIPART_UPLOAD> : S3RequestTraitsBase
+  {
+    typedef CopyResponse  Response;
+    typedef CopyHandler   Handler;
+    typedef CopyException Exception;
+    typedef HttpPost      Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::UPLOAD_PART_COPY> : S3RequestTraitsBase
+  {
+    typedef CopyResponse  Response;
+    typedef CopyHandler   Handler;
+    typedef CopyException Exception;
+    typedef HttpPut       Method; // the data is taken from x-amz-copy-source-range
+  };
+
+  template <> struct S3RequestTraits<S3Connection::COMPLETE_MULTIPART_UPLOAD> : S3RequestTraitsBase
+  {
+    typedef CopyResponse  Response;
+    typedef CopyHandler   Handler;
+    typedef CopyException Exception;
+    typedef HttpPost      Method;
+  };
+
+  template <> struct S3RequestTraits<S3Connection::ABORT_MULTIPART_UPLOAD> : S3RequestTraitsBase
+  {
+    typedef CopyResponse  Response;
+    typedef CopyHandler   Handler;
+    typedef CopyException Exception;
+    typedef HttpDelete    Method;
+  };
+
+  // sets up a callback wrapper for a request of the given type
+  template <int ActionType>
+  void
+  bindRequest(S3CallBackWrapper& aWrapper,
+              typename S3RequestTraits<ActionType>::Response* aResponse,
+              typename S3RequestTraits<ActionType>::Handler* aHandler)
+  {
+    typedef S3RequestTraits<ActionType> Traits;
+
+    aWrapper.theResponse      = aResponse;
+    aWrapper.theHandler       = aHandler;
+    aWrapper.theMethod        = &Traits::Method::set;
+    aWrapper.theHeaderParser  = &Traits::parseHeader;
+    aWrapper.theGetResponse   = Traits::getResponse(aResponse);
+    aWrapper.theContentLength = Traits::getContentLength(aResponse);
+
+    aWrapper.theSAXHandler.startElementNs = &Traits::Handler::startElementNs;
+    aWrapper.theSAXHandler.characters     = &Traits::Handler::charactersSAXFunc;
+    aWrapper.theSAXHandler.endElementNs   = &Traits::Handler::endElementNs;
+  }
+
+  // only the connection may create the exceptions of the requests
+  template <int ActionType>
+  void
+  S3Connection::throwError(S3Response* aResponse)
+  {
+    throw typename S3RequestTraits<ActionType>::Exception(aResponse->getS3ResponseError());
+  }
+
+  // a synchronous request; owns the response until it is finished
+  template <int ActionType>
+  class S3Request
+  {
+  public:
+    typedef S3RequestTraits<ActionType>   Traits;
+    typedef typename Traits::Response     Response;
+
+    explicit S3Request(Response* aResponse)
+      : theResponse(aResponse)
+    {
+      bindRequest<ActionType>(theWrapper, aResponse, &theHandler);
+      theWrapper.createParser();
+    }
+
+    S3CallBackWrapper*
+    getWrapper() { return &theWrapper; }
+
+    Response*
+    getResponse() { return theResponse.get(); }
+
+    // transfers the ownership of the response to the caller
+    Response*
+    finish(bool aThrow = true)
+    {
+      theWrapper.destroyParser();
+      if (aThrow && !theResponse->isSuccessful())
+        S3Connection::throwError<ActionType>(theResponse.get());
+      return theResponse.release();
+    }
+
+  private:
+    std::auto_ptr<Response>       theResponse;
+    typename Traits::Handler      theHandler;
+    S3CallBackWrapper             theWrapper;
+  };
+
+} /* namespace s3 */
+} /* namespace aws */
+#endif
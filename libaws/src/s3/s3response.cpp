@@ -17,6 +17,7 @@
 #include <iostream>
 
 #include "curlstreambuf.h"
+#include "s3/s3codec.h"
 #include "s3/s3response.h"
 
 namespace aws { namespace s3 {
@@ -37,6 +38,7 @@ namespace aws { namespace s3 {
     }
 
     S3ResponseError::S3ResponseError()
+      : theErrorCode(S3Exception::NoError)
     { }
 
     S3ResponseError::S3ResponseError(const S3ResponseError& e)
@@ -46,28 +48,44 @@ namespace aws { namespace s3 {
         theHostId(e.theHostId)
     {}
 
+    // the names of the error codes in the order of S3Exception::ErrorCode
+    static const char* ERROR_CODES[] = {
+      "AccessDenied", "AccountProblem", "AllAccessDisabled",
+      "AmbiguousGrantByEmailAddress", "BadDigest", "BucketAlreadyExists",
+      "BucketNotEmpty", "CredentialsNotSupported", "EntityTooLarge",
+      "InlineDataTooLarge", "IncompleteBody", "InternalError",
+      "InvalidAccessKeyId", "InvalidAddressingHeader", "InvalidArgument",
+      "InvalidBucketName", "InvalidDigest", "InvalidRange", "InvalidSecurity",
+      "InvalidSOAPRequest", "InvalidStorageClass",
+      "InvalidTargetBucketForLogging", "KeyTooLong", "InvalidURI",
+      "MalformedACLError", "MalformedXMLError", "MaxMessageLengthExceeded",
+      "MetadataTooLarge", "MethodNotAllowed", "MissingAttachment",
+      "MissingContentLength", "MissingSecurityElement",
+      "MissingSecurityHeader", "NoLoggingStatusForKey", "NoSuchBucket",
+      "NoSuchKey", "NotImplemented", "NotSignedUp", "OperationAborted",
+      "PreconditionFailed", "RequestTimeout", "RequestTimeTooSkewed",
+      "RequestTorrentOfBucketError", "SignatureDoesNotMatch",
+      "TooManyBuckets", "UnexpectedContent", "UnresolvableGrantByEmailAddress",
+      "NoError", "SlowDown", "ServiceUnavailable"
+    };
+
+    static const int NUMBER_OF_ERROR_CODES = sizeof(ERROR_CODES) / sizeof(ERROR_CODES[0]);
+
     S3Exception::ErrorCode
     S3ResponseError::parseError ( const std::string& aString )
     {
-      if ( aString.compare ( "InvalidAccessKeyId" ) == 0 ) {
-        return S3Exception::InvalidAccessKeyId;
-      }if ( aString.compare ( "BucketAlreadyExists" ) == 0 ) {
-        return S3Exception::BucketAlreadyExists;
-      }else {
-        return S3Exception::NoError;
+      for (int i = 0; i < NUMBER_OF_ERROR_CODES; ++i) {
+        if ( aString.compare ( ERROR_CODES[i] ) == 0 )
+          return static_cast<S3Exception::ErrorCode>(i);
       }
+      return S3Exception::NoError;
     }
     
     std::string 
     S3ResponseError::getErrorCode(S3Exception::ErrorCode aCode){
-      switch(aCode){
-        case S3Exception::InvalidAccessKeyId:
-          return "InvalidAccessKeyId";
-        case S3Exception::BucketAlreadyExists:
-          return "BucketAlreadyExists";
-        default:
-          return "Not implemented the Conversion";
-      }
+      if (aCode >= 0 && aCode < NUMBER_OF_ERROR_CODES)
+        return ERROR_CODES[aCode];
+      return "NoError";
     }
 
 
@@ -194,6 +212,7 @@ namespace aws { namespace s3 {
           theKey ( aKey ),
           theContentLength ( 0 ),
           theStreamBuffer( 0 ),
+          theDecodeBuffer( 0 ),
           theInputStream( 0 ),
           theIsModified(true)
     {
@@ -202,6 +221,7 @@ namespace aws { namespace s3 {
     GetResponse::~GetResponse()
     {
       delete theInputStream;
+      delete theDecodeBuffer;
       delete theStreamBuffer;
     }
 
@@ -217,6 +237,18 @@ namespace aws { namespace s3 {
     }
 
 
+    CopyResponse::CopyResponse ( const std::string& aBucketName,
+                                 const std::string& aKey )
+        : theBucketName ( aBucketName ),
+          theKey ( aKey )
+    {
+    }
+
+    CopyResponse::~CopyResponse()
+    {
+    }
+
+
     DeleteResponse::DeleteResponse ( const std::string& aBucketName,
                                      const std::string& aKey )
         : theBucketName ( aBucketName ),
@@ -30,6 +30,8 @@
 namespace aws { namespace s3  {
 
   class CurlStreamBuffer;
+  class GzipStreamBuffer;
+  template <int ActionType> struct S3RequestTraits;
 
   class S3ResponseError
   {
@@ -41,11 +43,14 @@ namespace aws { namespace s3  {
     friend class PutHandler;
     friend class HeadHandler;
     friend class DeleteHandler;
+    friend class CopyHandler;
     friend class BucketLoggingStatusHandler;
     friend class SetBucketLoggingHandler;
     friend class DisableBucketLoggingHandler;
     friend class S3Connection;
     friend class S3Response;
+    friend class GzipStreamBuffer;
+    template <int ActionType> friend struct S3RequestTraits;
 
   private:
     static S3Exception::ErrorCode
@@ -118,6 +123,7 @@ class CreateBucketResponse : public S3Response
 {
 	friend class CreateBucketHandler;
   friend class S3Connection;
+  template <int ActionType> friend struct S3RequestTraits;
 	
 private: // only a S3Connection can create me
   CreateBucketResponse(const std::string& aBucketName);
@@ -277,6 +283,7 @@ class GetResponse : public S3Response
 {
   friend class GetHandler;
   friend class S3Connection;
+  template <int ActionType> friend struct S3RequestTraits;
 
 public:
     GetResponse(const std::string& aBucketName, const std::string& aKey);
@@ -309,6 +316,7 @@ protected:
     std::string       theKey;
     long long         theContentLength;
     CurlStreamBuffer* theStreamBuffer;
+    GzipStreamBuffer* theDecodeBuffer; // set if the object was compressed by put
     std::istream*     theInputStream;
     std::string       theContentType;
     Time              theLastModified;
@@ -319,6 +327,7 @@ class HeadResponse : public S3Response
 {
     friend class HeadHandler;
     friend class S3Connection;
+    template <int ActionType> friend struct S3RequestTraits;
 public:
     HeadResponse(const std::string& aBucketName);
     virtual ~HeadResponse();
@@ -342,6 +351,34 @@ protected:
     Time              theLastModified;
 };
 
+class CopyResponse : public S3Response
+{
+    friend class CopyHandler;
+    friend class S3Connection;
+public:
+    CopyResponse(const std::string& aBucketName, const std::string& aKey);
+    virtual ~CopyResponse();
+
+    const std::string&
+    getBucketName() const { return theBucketName; }
+
+    const std::string&
+    getKey() const { return theKey; }
+
+    const std::string&
+    getLastModified() const { return theLastModified; }
+
+    // only set by the initiation of a multipart copy
+    const std::string&
+    getUploadId() const { return theUploadId; }
+
+protected:
+    std::string     theBucketName;
+    std::string     theKey;
+    std::string     theLastModified;
+    std::string     theUploadId;
+};
+
 class DeleteResponse : public S3Response
 {
     friend class DeleteHandler;
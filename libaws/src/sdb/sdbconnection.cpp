@@ -122,7 +122,7 @@ namespace aws {
 
     PutAttributesResponse*
     SDBConnection::putAttributes ( const std::string& aDomainName, const std::string& aItemName,
-			const std::vector<Attribute>& attributes ) {
+			const std::vector<Attribute>& attributes, bool aThrow ) {
 
       ParameterMap lMap;
       lMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
@@ -131,18 +131,12 @@ namespace aws {
 
       PutAttributesHandler lHandler;
       makeQueryRequest ( "PutAttributes", &lMap, &lHandler );
-      if ( lHandler.isSuccessful() ) {
-      	PutAttributesResponse* lPtr = lHandler.theResponse;
-        setCommons(lHandler, lPtr);
-        return lPtr;
-      }
-			else {
-				throw PutAttributesException(lHandler.getQueryErrorResponse());
-      }
+      return putAttributesResult(lHandler, aThrow);
     }
 
     BatchPutAttributesResponse*
-    SDBConnection::batchPutAttributes ( const std::string& aDomainName, const SDBBatch& aBatch ) {
+    SDBConnection::batchPutAttributes ( const std::string& aDomainName, const SDBBatch& aBatch,
+                                        bool aThrow ) {
 
       ParameterMap lMap;
       lMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
@@ -154,6 +148,12 @@ namespace aws {
       	BatchPutAttributesResponse* lPtr = lHandler.theResponse;
         setCommons(lHandler, lPtr);
         return lPtr;
+      }
+      else if ( !aThrow ) {
+        delete lHandler.theResponse;
+        BatchPutAttributesResponse* lPtr = new BatchPutAttributesResponse();
+        setError(lHandler, lPtr);
+        return lPtr;
       }
 			else {
 				throw BatchPutAttributesException(lHandler.getQueryErrorResponse());
@@ -162,7 +162,7 @@ namespace aws {
 
     DeleteAttributesResponse*
     SDBConnection::deleteAttributes ( const std::string& aDomainName, const std::string& aItemName,
-			const std::vector<Attribute>& attributes ) {
+			const std::vector<Attribute>& attributes, bool aThrow ) {
 
       ParameterMap lMap;
       lMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
@@ -175,6 +175,12 @@ namespace aws {
       	DeleteAttributesResponse* lPtr = lHandler.theResponse;
         setCommons(lHandler, lPtr);
         return lPtr;
+      }
+      else if ( !aThrow ) {
+        delete lHandler.theResponse;
+        DeleteAttributesResponse* lPtr = new DeleteAttributesResponse();
+        setError(lHandler, lPtr);
+        return lPtr;
       }
 			else {
 				throw DeleteAttributesException(lHandler.getQueryErrorResponse());
@@ -183,55 +189,29 @@ namespace aws {
 
     GetAttributesResponse*
     SDBConnection::getAttributes ( const std::string& aDomainName, const std::string& aItemName,
-			const std::string& attributeName ) {
+			const std::string& attributeName, bool aThrow ) {
 
       ParameterMap lMap;
-      lMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
-      lMap.insert ( ParameterPair ( "ItemName", aItemName ) );
-      if (attributeName != std::string("")) {
-        lMap.insert ( ParameterPair ( "AttributeName", attributeName ) );
-      }
+      insertGetParameter(lMap, aDomainName, aItemName, attributeName);
 
       GetAttributesHandler lHandler;
       makeQueryRequest ( "GetAttributes", &lMap, &lHandler );
-      if ( lHandler.isSuccessful() ) {
-      	GetAttributesResponse* lPtr = lHandler.theResponse;
-        setCommons(lHandler, lPtr);
-        return lPtr;
-      }
-			else {
-				throw GetAttributesException(lHandler.getQueryErrorResponse());
-      }
+      return getAttributesResult(lHandler, aThrow);
     }
 
     SDBQueryResponse*
     SDBConnection::query (const std::string& aDomainName,
                           const std::string& aQueryExpression,
     		                  int aMaxNumberOfItems,
-                          const std::string& aNextToken )
+                          const std::string& aNextToken,
+                          bool aThrow )
     {
       ParameterMap lMap;
-      lMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
-      lMap.insert ( ParameterPair ( "QueryExpression", aQueryExpression ) );
-      if (aMaxNumberOfItems > 0 ) {
-        std::stringstream s;
-        s << aMaxNumberOfItems;
-        lMap.insert ( ParameterPair ( "MaxNumberOfItems", s.str() ) );
-      }
-      if (aNextToken != std::string("") ) {
-        lMap.insert ( ParameterPair ( "NextToken", aNextToken ) );
-      }
+      insertQueryParameter(lMap, aDomainName, aQueryExpression, aMaxNumberOfItems, aNextToken);
 
       QueryHandler lHandler;
       makeQueryRequest ( "Query", &lMap, &lHandler );
-      if ( lHandler.isSuccessful() ) {
-      	SDBQueryResponse* lPtr = lHandler.theResponse;
-        setCommons(lHandler, lPtr);
-        return lPtr;
-      }
-			else {
-				throw QueryException(lHandler.getQueryErrorResponse());
-      }
+      return queryResult(lHandler, aThrow);
     }
 
     SDBQueryWithAttributesResponse*
@@ -273,6 +253,143 @@ namespace aws {
       }
     }
 
+    PutAttributesHandler*
+    SDBConnection::startPutAttributes ( const std::string& aDomainName, const std::string& aItemName,
+			const std::vector<Attribute>& attributes ) {
+
+      ParameterMap lMap;
+      lMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
+      lMap.insert ( ParameterPair ( "ItemName", aItemName ) );
+      insertAttParameter(lMap, attributes, true);
+
+      std::auto_ptr<PutAttributesHandler> lHandler(new PutAttributesHandler());
+      startQueryRequest ( "PutAttributes", &lMap, lHandler.get() );
+      return lHandler.release();
+    }
+
+    PutAttributesResponse*
+    SDBConnection::finishPutAttributes ( PutAttributesHandler* aHandler, int aCurlCode ) {
+      finishQueryRequest(aHandler, aCurlCode);
+      return putAttributesResult(*aHandler, true);
+    }
+
+    GetAttributesHandler*
+    SDBConnection::startGetAttributes ( const std::string& aDomainName, const std::string& aItemName,
+			const std::string& attributeName ) {
+
+      ParameterMap lMap;
+      insertGetParameter(lMap, aDomainName, aItemName, attributeName);
+
+      std::auto_ptr<GetAttributesHandler> lHandler(new GetAttributesHandler());
+      startQueryRequest ( "GetAttributes", &lMap, lHandler.get() );
+      return lHandler.release();
+    }
+
+    GetAttributesResponse*
+    SDBConnection::finishGetAttributes ( GetAttributesHandler* aHandler, int aCurlCode ) {
+      finishQueryRequest(aHandler, aCurlCode);
+      return getAttributesResult(*aHandler, true);
+    }
+
+    QueryHandler*
+    SDBConnection::startQuery (const std::string& aDomainName,
+                               const std::string& aQueryExpression,
+                               int aMaxNumberOfItems,
+                               const std::string& aNextToken )
+    {
+      ParameterMap lMap;
+      insertQueryParameter(lMap, aDomainName, aQueryExpression, aMaxNumberOfItems, aNextToken);
+
+      std::auto_ptr<QueryHandler> lHandler(new QueryHandler());
+      startQueryRequest ( "Query", &lMap, lHandler.get() );
+      return lHandler.release();
+    }
+
+    SDBQueryResponse*
+    SDBConnection::finishQuery ( QueryHandler* aHandler, int aCurlCode ) {
+      finishQueryRequest(aHandler, aCurlCode);
+      return queryResult(*aHandler, true);
+    }
+
+    PutAttributesResponse*
+    SDBConnection::putAttributesResult ( PutAttributesHandler& aHandler, bool aThrow ) {
+      if ( aHandler.isSuccessful() ) {
+      	PutAttributesResponse* lPtr = aHandler.theResponse;
+        setCommons(aHandler, lPtr);
+        return lPtr;
+      }
+      else if ( !aThrow ) {
+        delete aHandler.theResponse;
+        PutAttributesResponse* lPtr = new PutAttributesResponse();
+        setError(aHandler, lPtr);
+        return lPtr;
+      }
+			else {
+				throw PutAttributesException(aHandler.getQueryErrorResponse());
+      }
+    }
+
+    GetAttributesResponse*
+    SDBConnection::getAttributesResult ( GetAttributesHandler& aHandler, bool aThrow ) {
+      if ( aHandler.isSuccessful() ) {
+      	GetAttributesResponse* lPtr = aHandler.theResponse;
+        setCommons(aHandler, lPtr);
+        return lPtr;
+      }
+      else if ( !aThrow ) {
+        delete aHandler.theResponse;
+        GetAttributesResponse* lPtr = new GetAttributesResponse();
+        setError(aHandler, lPtr);
+        return lPtr;
+      }
+			else {
+				throw GetAttributesException(aHandler.getQueryErrorResponse());
+      }
+    }
+
+    SDBQueryResponse*
+    SDBConnection::queryResult ( QueryHandler& aHandler, bool aThrow ) {
+      if ( aHandler.isSuccessful() ) {
+      	SDBQueryResponse* lPtr = aHandler.theResponse;
+        setCommons(aHandler, lPtr);
+        return lPtr;
+      }
+      else if ( !aThrow ) {
+        delete aHandler.theResponse;
+        SDBQueryResponse* lPtr = new SDBQueryResponse();
+        setError(aHandler, lPtr);
+        return lPtr;
+      }
+			else {
+				throw QueryException(aHandler.getQueryErrorResponse());
+      }
+    }
+
+    void
+    SDBConnection::insertGetParameter(ParameterMap& aMap, const std::string& aDomainName,
+        const std::string& aItemName, const std::string& attributeName) {
+      aMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
+      aMap.insert ( ParameterPair ( "ItemName", aItemName ) );
+      if (attributeName != std::string("")) {
+        aMap.insert ( ParameterPair ( "AttributeName", attributeName ) );
+      }
+    }
+
+    void
+    SDBConnection::insertQueryParameter(ParameterMap& aMap, const std::string& aDomainName,
+        const std::string& aQueryExpression, int aMaxNumberOfItems, const std::string& aNextToken) {
+      aMap.insert ( ParameterPair ( "DomainName", aDomainName ) );
+      aMap.insert ( ParameterPair ( "QueryExpression", aQueryExpression ) );
+      if (aMaxNumberOfItems > 0 ) {
+        std::stringstream s;
+        s << aMaxNumberOfItems;
+        aMap.insert ( ParameterPair ( "MaxNumberOfItems", s.str() ) );
+      }
+      if (aNextToken != std::string("") ) {
+        aMap.insert ( ParameterPair ( "NextToken", aNextToken ) );
+      }
+    }
+
     void
     SDBConnection::insertAttParameter(ParameterMap& aMap, const std::vector<Attribute>& attributes, bool insertReplaces) {
       int lAttNr = 0;
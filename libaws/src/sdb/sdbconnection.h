@@ -38,6 +38,9 @@ namespace aws {
 		class GetAttributesResponse;
 		class SDBQueryResponse;
 		class SDBQueryWithAttributesResponse;
+		class PutAttributesHandler;
+		class GetAttributesHandler;
+		class QueryHandler;
 
 		class SDBConnection: public AWSQueryConnection {
 
@@ -61,28 +64,34 @@ namespace aws {
 			ListDomainsResponse*
 			listDomains(int aMaxNumberOfDomains = 0, const std::string& aNextToken = "");
 
+			// if aThrow is false, errors reported by SimpleDB are returned in the response
 			PutAttributesResponse*
 			putAttributes(const std::string& aDomainName,
 					const std::string& aItemName,
-					const std::vector<aws::Attribute>& attributes);
+					const std::vector<aws::Attribute>& attributes,
+					bool aThrow = true);
 
       BatchPutAttributesResponse*
       batchPutAttributes(const std::string& aDomainName,
-                         const aws::SDBBatch& aBatch);
+                         const aws::SDBBatch& aBatch,
+                         bool aThrow = true);
 
 			DeleteAttributesResponse*
 			deleteAttributes(const std::string& aDomainName,
 					const std::string& aItemName,
-					const std::vector<aws::Attribute>& attributes);
+					const std::vector<aws::Attribute>& attributes,
+					bool aThrow = true);
 
 			GetAttributesResponse*
 			getAttributes(const std::string& aDomainName,
-					const std::string& aItemName, const std::string& attributeName = "");
+					const std::string& aItemName, const std::string& attributeName = "",
+					bool aThrow = true);
 
 			SDBQueryResponse*
 			query(const std::string& aDomainName,
 					const std::string& aQueryExpression, int aMaxNumberOfItems = 0,
-					const std::string& aNextToken = "");
+					const std::string& aNextToken = "",
+					bool aThrow = true);
 
       SDBQueryWithAttributesResponse*
       queryWithAttributes(const std::string& aDomainName,
@@ -91,7 +100,55 @@ namespace aws {
                           int aMaxNumberOfItems,
                           const std::string& aNextToken);
 
+			// asynchronous requests (see AWSQueryConnection::startQueryRequest);
+			// the caller owns the handler returned by startXXX and passes it to
+			// finishXXX, which returns the response or throws like the
+			// synchronous function
+			PutAttributesHandler*
+			startPutAttributes(const std::string& aDomainName,
+					const std::string& aItemName,
+					const std::vector<aws::Attribute>& attributes);
+
+			PutAttributesResponse*
+			finishPutAttributes(PutAttributesHandler* aHandler, int aCurlCode);
+
+			GetAttributesHandler*
+			startGetAttributes(const std::string& aDomainName,
+					const std::string& aItemName, const std::string& attributeName = "");
+
+			GetAttributesResponse*
+			finishGetAttributes(GetAttributesHandler* aHandler, int aCurlCode);
+
+			QueryHandler*
+			startQuery(const std::string& aDomainName,
+					const std::string& aQueryExpression, int aMaxNumberOfItems = 0,
+					const std::string& aNextToken = "");
+
+			SDBQueryResponse*
+			finishQuery(QueryHandler* aHandler, int aCurlCode);
+
 		private:
+			// the response of a finished request; throws if aThrow is true and it failed
+			PutAttributesResponse*
+			putAttributesResult(PutAttributesHandler& aHandler, bool aThrow);
+
+			GetAttributesResponse*
+			getAttributesResult(GetAttributesHandler& aHandler, bool aThrow);
+
+			SDBQueryResponse*
+			queryResult(QueryHandler& aHandler, bool aThrow);
+
+			void insertGetParameter(ParameterMap& aMap,
+					const std::string& aDomainName,
+					const std::string& aItemName,
+					const std::string& attributeName);
+
+			void insertQueryParameter(ParameterMap& aMap,
+					const std::string& aDomainName,
+					const std::string& aQueryExpression,
+					int aMaxNumberOfItems,
+					const std::string& aNextToken);
+
 			void insertAttParameter(ParameterMap& aMap,
 					const std::vector<aws::Attribute>& attributes,
 					bool insertReplaces);
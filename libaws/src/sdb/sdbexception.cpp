@@ -39,7 +39,27 @@ namespace aws {
 	}
 
 	SDBException::ErrorCode SDBException::parseError(const std::string& aString) {
-		return SDBException::Unknown;
+		if (aString.compare("InvalidAccessKeyId") == 0) {
+			return SDBException::InvalidAccessKeyId;
+		} else if (aString.compare("AccessDenied") == 0) {
+			return SDBException::AccessDenied;
+		} else if (aString.compare("AuthFailure") == 0) {
+			return SDBException::AuthFailure;
+		} else if (aString.compare("NoSuchDomain") == 0) {
+			return SDBException::AWS_SimpleDomainService_NonExistentDomain;
+		} else if (aString.compare("InvalidParameterValue") == 0) {
+			return SDBException::InvalidParameterValue;
+		} else if (aString.compare("MissingParameter") == 0) {
+			return SDBException::MissingParameter;
+		} else if (aString.compare("RequestThrottled") == 0 || aString.compare("Throttling") == 0) {
+			return SDBException::RequestThrottled;
+		} else if (aString.compare("ServiceUnavailable") == 0 || aString.compare("ServiceOverload") == 0) {
+			return SDBException::ServiceUnavailable;
+		} else if (aString.compare("InternalError") == 0) {
+			return SDBException::InternalError;
+		} else {
+			return SDBException::Unknown;
+		}
 	}
 
 	CreateDomainException::CreateDomainException(const QueryErrorResponse& aError) :
@@ -31,6 +31,8 @@ namespace aws {
 
 		class SDBResponse: public QueryResponse {
 		public:
+			SDBResponse() : theBoxUsage(0) {}
+
 			float getBoxUsage() {
 	      return theBoxUsage;
 	    }
@@ -108,84 +108,190 @@ namespace aws { namespace sqs {
   }
 
   SendMessageResponse*
-  SQSConnection::sendMessage(const std::string &aQueueUrl, const std::string &aMessageBody, bool aEncode)
+  SQSConnection::sendMessage(const std::string &aQueueUrl, const std::string &aMessageBody, bool aEncode,
+                             bool aThrow)
   {
     ParameterMap lMap;
-    long lBody64Len;
-    std::string enc;
-    if (aEncode)
-      enc = AWSConnection::base64Encode(aMessageBody.c_str(), aMessageBody.size(), lBody64Len);
-    else
-      enc = aMessageBody;
-    if (enc.size() > 32768) {
-      std::stringstream lTmp;
-      lTmp << "Message larger than 32kB : " << enc.size() / 1024 << " kb";
-      throw SendMessageException( QueryErrorResponse("1", lTmp.str(), "", "") );
-    }
-    lMap.insert ( ParameterPair ( "MessageBody", enc ) );
-    return sendMessage(aQueueUrl, lMap);
+    insertMessageBody(lMap, aMessageBody, aEncode);
+    return sendMessage(aQueueUrl, lMap, aThrow);
   }
     
   SendMessageResponse*
   SQSConnection::sendMessage (const std::string &aQueueUrl,
-                              ParameterMap& lMap) {
+                              ParameterMap& lMap,
+                              bool aThrow) {
     SendMessageHandler lHandler;
     makeQueryRequest (aQueueUrl, "SendMessage", &lMap, &lHandler);
-    if (lHandler.isSuccessful()) {
-      setCommons(lHandler, lHandler.theSendMessageResponse);
-        return lHandler.theSendMessageResponse;
-      } else {
-        throw SendMessageException (lHandler.getQueryErrorResponse());
-      }
+    return sendMessageResult(lHandler, aThrow);
   }
 
   ReceiveMessageResponse*
   SQSConnection::receiveMessage (const std::string &aQueueUrl,
                                  int aNumberOfMessages,
                                  int aVisibilityTimeout,
-                                 bool aDecode) {
+                                 bool aDecode,
+                                 bool aThrow) {
     ParameterMap lMap;
-    if (aNumberOfMessages != 0) {
-        std::stringstream s;
-        s << aNumberOfMessages;
-        lMap.insert (ParameterPair ("MaxNumberOfMessages", s.str()));
-      }
-    if (aVisibilityTimeout > -1) {
-        std::stringstream s;
-        s << aVisibilityTimeout;
-        lMap.insert (ParameterPair ("VisibilityTimeout", s.str()));
-      }
-  
-    return receiveMessage (aQueueUrl, lMap, aDecode);
+    insertReceiveParameters(lMap, aNumberOfMessages, aVisibilityTimeout);
+    return receiveMessage (aQueueUrl, lMap, aDecode, aThrow);
   } 
   
   ReceiveMessageResponse*
   SQSConnection::receiveMessage (const std::string &aQueueUrl,
                                  ParameterMap& lMap,
-                                 bool aDecode) {
+                                 bool aDecode,
+                                 bool aThrow) {
     ReceiveMessageHandler lHandler(aDecode);
     makeQueryRequest (aQueueUrl, "ReceiveMessage", &lMap, &lHandler);
-    if (lHandler.isSuccessful()) {
-      setCommons(lHandler, lHandler.theReceiveMessageResponse);
-        return lHandler.theReceiveMessageResponse;
-      } else {
-        throw ReceiveMessageException (lHandler.getQueryErrorResponse());
-      }
+    return receiveMessageResult(lHandler, aThrow);
   }
 
   DeleteMessageResponse*
-  SQSConnection::deleteMessage(const std::string &aQueueUrl, const std::string &aReceiptHandle)
+  SQSConnection::deleteMessage(const std::string &aQueueUrl, const std::string &aReceiptHandle,
+                               bool aThrow)
   {
     ParameterMap lMap;
     lMap.insert ( ParameterPair ( "ReceiptHandle", aReceiptHandle ) );
 
     DeleteMessageHandler lHandler;
     makeQueryRequest ( aQueueUrl, "DeleteMessage", &lMap, &lHandler );
-    if (lHandler.isSuccessful()) {
-      setCommons(lHandler, lHandler.theDeleteMessageResponse);
-      return lHandler.theDeleteMessageResponse;
+    return deleteMessageResult(lHandler, aThrow);
+  }
+
+  SendMessageHandler*
+  SQSConnection::startSendMessage(const std::string &aQueueUrl, const std::string &aMessageBody, bool aEncode)
+  {
+    ParameterMap lMap;
+    insertMessageBody(lMap, aMessageBody, aEncode);
+
+    std::auto_ptr<SendMessageHandler> lHandler(new SendMessageHandler());
+    startQueryRequest (aQueueUrl, "SendMessage", &lMap, lHandler.get());
+    return lHandler.release();
+  }
+
+  SendMessageResponse*
+  SQSConnection::finishSendMessage(SendMessageHandler* aHandler, int aCurlCode)
+  {
+    finishQueryRequest(aHandler, aCurlCode);
+    return sendMessageResult(*aHandler, true);
+  }
+
+  ReceiveMessageHandler*
+  SQSConnection::startReceiveMessage(const std::string &aQueueUrl,
+                                     int aNumberOfMessages,
+                                     int aVisibilityTimeout,
+                                     bool aDecode)
+  {
+    ParameterMap lMap;
+    insertReceiveParameters(lMap, aNumberOfMessages, aVisibilityTimeout);
+
+    std::auto_ptr<ReceiveMessageHandler> lHandler(new ReceiveMessageHandler(aDecode));
+    startQueryRequest (aQueueUrl, "ReceiveMessage", &lMap, lHandler.get());
+    return lHandler.release();
+  }
+
+  ReceiveMessageResponse*
+  SQSConnection::finishReceiveMessage(ReceiveMessageHandler* aHandler, int aCurlCode)
+  {
+    finishQueryRequest(aHandler, aCurlCode);
+    return receiveMessageResult(*aHandler, true);
+  }
+
+  DeleteMessageHandler*
+  SQSConnection::startDeleteMessage(const std::string &aQueueUrl, const std::string &aReceiptHandle)
+  {
+    ParameterMap lMap;
+    lMap.insert ( ParameterPair ( "ReceiptHandle", aReceiptHandle ) );
+
+    std::auto_ptr<DeleteMessageHandler> lHandler(new DeleteMessageHandler());
+    startQueryRequest (aQueueUrl, "DeleteMessage", &lMap, lHandler.get());
+    return lHandler.release();
+  }
+
+  DeleteMessageResponse*
+  SQSConnection::finishDeleteMessage(DeleteMessageHandler* aHandler, int aCurlCode)
+  {
+    finishQueryRequest(aHandler, aCurlCode);
+    return deleteMessageResult(*aHandler, true);
+  }
+
+  void
+  SQSConnection::insertMessageBody(ParameterMap& aMap, const std::string &aMessageBody, bool aEncode)
+  {
+    long lBody64Len;
+    std::string enc;
+    if (aEncode)
+      enc = AWSConnection::base64Encode(aMessageBody.c_str(), aMessageBody.size(), lBody64Len);
+    else
+      enc = aMessageBody;
+    if (enc.size() > 32768) {
+      std::stringstream lTmp;
+      lTmp << "Message larger than 32kB : " << enc.size() / 1024 << " kb";
+      throw SendMessageException( QueryErrorResponse("1", lTmp.str(), "", "") );
+    }
+    aMap.insert ( ParameterPair ( "MessageBody", enc ) );
+  }
+
+  void
+  SQSConnection::insertReceiveParameters(ParameterMap& aMap, int aNumberOfMessages, int aVisibilityTimeout)
+  {
+    if (aNumberOfMessages != 0) {
+        std::stringstream s;
+        s << aNumberOfMessages;
+        aMap.insert (ParameterPair ("MaxNumberOfMessages", s.str()));
+      }
+    if (aVisibilityTimeout > -1) {
+        std::stringstream s;
+        s << aVisibilityTimeout;
+        aMap.insert (ParameterPair ("VisibilityTimeout", s.str()));
+      }
+  }
+
+  SendMessageResponse*
+  SQSConnection::sendMessageResult(SendMessageHandler& aHandler, bool aThrow)
+  {
+    if (aHandler.isSuccessful()) {
+      setCommons(aHandler, aHandler.theSendMessageResponse);
+      return aHandler.theSendMessageResponse;
+    } else if (!aThrow) {
+      delete aHandler.theSendMessageResponse;
+      SendMessageResponse* lResponse = new SendMessageResponse();
+      setError(aHandler, lResponse);
+      return lResponse;
+    } else {
+      throw SendMessageException (aHandler.getQueryErrorResponse());
+    }
+  }
+
+  ReceiveMessageResponse*
+  SQSConnection::receiveMessageResult(ReceiveMessageHandler& aHandler, bool aThrow)
+  {
+    if (aHandler.isSuccessful()) {
+      setCommons(aHandler, aHandler.theReceiveMessageResponse);
+      return aHandler.theReceiveMessageResponse;
+    } else if (!aThrow) {
+      delete aHandler.theReceiveMessageResponse;
+      ReceiveMessageResponse* lResponse = new ReceiveMessageResponse();
+      setError(aHandler, lResponse);
+      return lResponse;
+    } else {
+      throw ReceiveMessageException (aHandler.getQueryErrorResponse());
+    }
+  }
+
+  DeleteMessageResponse*
+  SQSConnection::deleteMessageResult(DeleteMessageHandler& aHandler, bool aThrow)
+  {
+    if (aHandler.isSuccessful()) {
+      setCommons(aHandler, aHandler.theDeleteMessageResponse);
+      return aHandler.theDeleteMessageResponse;
+    } else if (!aThrow) {
+      delete aHandler.theDeleteMessageResponse;
+      DeleteMessageResponse* lResponse = new DeleteMessageResponse();
+      setError(aHandler, lResponse);
+      return lResponse;
     } else {
-    	throw DeleteMessageException( lHandler.getQueryErrorResponse() );
+      throw DeleteMessageException( aHandler.getQueryErrorResponse() );
     }
   }
 
@@ -34,6 +34,9 @@ namespace aws {
     class ReceiveMessageResponse;
     class DeleteMessageResponse;
     class GetQueueAttributesResponse;
+    class SendMessageHandler;
+    class ReceiveMessageHandler;
+    class DeleteMessageHandler;
 
     class SQSConnection : public AWSQueryConnection
     {
@@ -61,27 +64,76 @@ namespace aws {
         virtual ListQueuesResponse*
         listQueues ( const std::string &aQueueNamePrefix = "" );
 
+        // if aThrow is false, errors reported by SQS are returned in the response
         virtual SendMessageResponse*
-        sendMessage ( const std::string &aQueueUrl, const std::string &aMessageBody, bool aEncode=true);
+        sendMessage ( const std::string &aQueueUrl, const std::string &aMessageBody, bool aEncode=true,
+                      bool aThrow = true);
         
-        virtual SendMessageResponse* sendMessage (const std::string &aQueueUrl, ParameterMap& lMap);
+        virtual SendMessageResponse* sendMessage (const std::string &aQueueUrl, ParameterMap& lMap,
+                                                  bool aThrow = true);
 
         virtual ReceiveMessageResponse*
         receiveMessage( const std::string &aQueueUrl,
                         int aNumberOfMessages = 0,
                         int aVisibilityTimeout = -1,
-                        bool aDecode = true);
+                        bool aDecode = true,
+                        bool aThrow = true);
         
         virtual ReceiveMessageResponse*
         receiveMessage (const std::string &aQueueUrl,
                         ParameterMap& lMap,
-                        bool aDecode = true);
+                        bool aDecode = true,
+                        bool aThrow = true);
 
         virtual DeleteMessageResponse*
-        deleteMessage( const std::string &aQueueUrl, const std::string &aReceiptHandle);
+        deleteMessage( const std::string &aQueueUrl, const std::string &aReceiptHandle,
+                       bool aThrow = true);
 
         virtual GetQueueAttributesResponse*
         getQueueAttributes( const std::string &aQueueUrl, const std::string &aReceiptHandle);
+
+        // asynchronous requests (see AWSQueryConnection::startQueryRequest);
+        // the caller owns the handler returned by startXXX and passes it to
+        // finishXXX, which returns the response or throws like the
+        // synchronous function
+        virtual SendMessageHandler*
+        startSendMessage ( const std::string &aQueueUrl, const std::string &aMessageBody, bool aEncode = true );
+
+        virtual SendMessageResponse*
+        finishSendMessage ( SendMessageHandler* aHandler, int aCurlCode );
+
+        virtual ReceiveMessageHandler*
+        startReceiveMessage ( const std::string &aQueueUrl,
+                              int aNumberOfMessages = 0,
+                              int aVisibilityTimeout = -1,
+                              bool aDecode = true );
+
+        virtual ReceiveMessageResponse*
+        finishReceiveMessage ( ReceiveMessageHandler* aHandler, int aCurlCode );
+
+        virtual DeleteMessageHandler*
+        startDeleteMessage ( const std::string &aQueueUrl, const std::string &aReceiptHandle );
+
+        virtual DeleteMessageResponse*
+        finishDeleteMessage ( DeleteMessageHandler* aHandler, int aCurlCode );
+
+      protected:
+        // the parameters of the requests (shared by the synchronous and asynchronous functions)
+        void
+        insertMessageBody ( ParameterMap& aMap, const std::string &aMessageBody, bool aEncode );
+
+        void
+        insertReceiveParameters ( ParameterMap& aMap, int aNumberOfMessages, int aVisibilityTimeout );
+
+        // the response of a finished request; throws if aThrow is true and it failed
+        SendMessageResponse*
+        sendMessageResult ( SendMessageHandler& aHandler, bool aThrow );
+
+        ReceiveMessageResponse*
+        receiveMessageResult ( ReceiveMessageHandler& aHandler, bool aThrow );
+
+        DeleteMessageResponse*
+        deleteMessageResult ( DeleteMessageHandler& aHandler, bool aThrow );
     };
 
   } /* namespace sqs  */
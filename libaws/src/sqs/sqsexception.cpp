@@ -44,6 +44,16 @@ namespace aws {
         return SQSException::AWS_SimpleQueueService_QueueDeletedRecently;
       } else if (aString.compare ("AWS.SimpleQueueService.QueueNameExists") == 0 || aString.compare ("QueueAlreadyExists") == 0) {
         return SQSException::AWS_SimpleQueueService_QueueNameExists;
+      } else if (aString.compare ("AWS.SimpleQueueService.NonExistentQueue") == 0) {
+        return SQSException::AWS_SimpleQueueService_NonExistentQueue;
+      } else if (aString.compare ("RequestThrottled") == 0 || aString.compare ("Throttling") == 0) {
+        return SQSException::RequestThrottled;
+      } else if (aString.compare ("ServiceUnavailable") == 0) {
+        return SQSException::ServiceUnavailable;
+      } else if (aString.compare ("InternalError") == 0) {
+        return SQSException::InternalError;
+      } else if (aString.compare ("AccessDenied") == 0) {
+        return SQSException::AccessDenied;
       } else {
         return SQSException::Unknown;
       }
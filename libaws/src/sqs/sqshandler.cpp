@@ -162,7 +162,8 @@ namespace aws {
       }
     }
 
-    ReceiveMessageHandler::ReceiveMessageHandler(bool aDecode) : theDecode(aDecode)
+    ReceiveMessageHandler::ReceiveMessageHandler(bool aDecode)
+      : theDecode(aDecode), theReceiveMessageResponse(0)
     {
     }
 
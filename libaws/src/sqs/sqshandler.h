@@ -105,6 +105,8 @@ namespace aws {
         SendMessageResponse* theSendMessageResponse;
 
       public:
+        SendMessageHandler() : theSendMessageResponse(0) {}
+
         virtual void responseStartElement ( const xmlChar *  localname, int nb_attributes, const xmlChar ** attributes );
         virtual void responseCharacters ( const xmlChar *  value, int len );
         virtual void responseEndElement ( const xmlChar *  localname );
@@ -136,6 +138,8 @@ namespace aws {
         DeleteMessageResponse* theDeleteMessageResponse;
 
       public:
+        DeleteMessageHandler() : theDeleteMessageResponse(0) {}
+
         virtual void responseStartElement ( const xmlChar *  localname, int nb_attributes, const xmlChar ** attributes );
         virtual void responseCharacters ( const xmlChar *  value, int len );
         virtual void responseEndElement ( const xmlChar *  localname );
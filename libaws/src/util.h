@@ -17,21 +17,73 @@
 #define AWS_UTIL_H
 
 #include <string.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <string>
 
 namespace aws {
 
-  void
+  inline void
   trim(std::string& str)
   {
-    std::string::size_type pos = str.find_last_not_of(" \n\t");
+    std::string::size_type pos = str.find_last_not_of(" \r\n\t");
     if(pos != std::string::npos) {
       str.erase(pos + 1);
-      pos = str.find_first_not_of(" \n\t");
+      pos = str.find_first_not_of(" \r\n\t");
       if(pos != std::string::npos) str.erase(0, pos);
     }
     else str.erase(str.begin(), str.end());
   }
 
+  // returns the code of a status line ("HTTP/1.1 200 OK", "HTTP/2 200")
+  // or -1 if the line isn't a status line
+  inline int
+  getStatusCode(const std::string& aLine)
+  {
+    if (aLine.compare(0, 5, "HTTP/") != 0)
+      return -1;
+    std::string::size_type lPos = aLine.find(' ');
+    if (lPos == std::string::npos)
+      return -1;
+    return atoi(aLine.c_str() + lPos + 1);
+  }
+
+  // checks if the header line starts with aName (case-insensitive, HTTP/2
+  // sends lowercase names) and returns the rest of the name and the value
+  inline bool
+  parseHeader(const std::string& aLine, const char* aName,
+              std::string* aRestOfName, std::string* aValue)
+  {
+    size_t lLength = strlen(aName);
+    std::string::size_type lColon = aLine.find(':');
+    if (lColon == std::string::npos || lColon < lLength
+        || strncasecmp(aLine.c_str(), aName, lLength) != 0)
+      return false;
+    if (aRestOfName)
+      *aRestOfName = aLine.substr(lLength, lColon - lLength);
+    else if (lColon != lLength)
+      return false;
+    *aValue = aLine.substr(lColon + 1);
+    trim(*aValue);
+    return true;
+  }
+
+  // returns the value of the header aName in aValue
+  inline bool
+  parseHeader(const std::string& aLine, const char* aName, std::string& aValue)
+  {
+    return parseHeader(aLine, aName, 0, &aValue);
+  }
+
+  // removes the quotes around a value (e.g. of ETag)
+  inline std::string
+  unquote(const std::string& aValue)
+  {
+    if (aValue.length() >= 2 && aValue[0] == '"' && aValue[aValue.length()-1] == '"')
+      return aValue.substr(1, aValue.length() - 2);
+    return aValue;
+  }
+
 } /* namespace aws */
 
 #endif
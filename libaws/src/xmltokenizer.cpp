@@ -0,0 +1,366 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "xmltokenizer.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace aws {
+
+  static const size_t INITIAL_BUFFER_SIZE = 4096;
+  static const size_t INITIAL_NAMES_SIZE = 256;
+
+  static bool
+  isSpace(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  // the end of a name is a space, '/', or '>' (written out such that debug
+  // builds don't call a function for every character)
+#define AWS_IS_NAME_END(c) ((unsigned char) (c) <= ' ' || (c) == '/' || (c) == '>')
+
+  // finds aEnd in [aBegin, aLast) and returns 0 if it isn't found
+  static char*
+  find(char* aBegin, char* aLast, const char* aEnd)
+  {
+    size_t lLength = strlen(aEnd);
+    for (char* p = aBegin; p + lLength <= aLast; ++p) {
+      p = static_cast<char*>(memchr(p, aEnd[0], aLast - p));
+      if (!p || p + lLength > aLast)
+        return 0;
+      if (memcmp(p, aEnd, lLength) == 0)
+        return p;
+    }
+    return 0;
+  }
+
+  // finds the '>' that closes a tag (ignoring '>' in attribute values)
+  static char*
+  findTagEnd(char* aBegin, char* aLast)
+  {
+    char lQuote = 0;
+    for (char* p = aBegin; p < aLast; ++p) {
+      if (lQuote) {
+        if (*p == lQuote)
+          lQuote = 0;
+      } else if (*p == '"' || *p == '\'') {
+        lQuote = *p;
+      } else if (*p == '>') {
+        return p;
+      }
+    }
+    return 0;
+  }
+
+  // true if [aBegin, aLast) could be the beginning of aPrefix
+  static bool
+  isPrefixOf(const char* aBegin, const char* aLast, const char* aPrefix)
+  {
+    size_t lLength = aLast - aBegin;
+    return lLength < strlen(aPrefix) && memcmp(aBegin, aPrefix, lLength) == 0;
+  }
+
+  XMLTokenizer::XMLTokenizer()
+    : theSAXHandler(0),
+      theUserData(0),
+      theBuffer(0),
+      theSize(0),
+      theCapacity(0),
+      theNames(0),
+      theNamesSize(0),
+      theNamesCapacity(0),
+      theDepth(0),
+      theError(false)
+  {
+  }
+
+  XMLTokenizer::~XMLTokenizer()
+  {
+    ::free(theBuffer);
+    ::free(theNames);
+  }
+
+  void
+  XMLTokenizer::reset(xmlSAXHandler* aSAXHandler, void* aUserData)
+  {
+    theSAXHandler = aSAXHandler;
+    theUserData = aUserData;
+    theSize = 0;
+    theNamesSize = 0;
+    theDepth = 0;
+    theError = false;
+  }
+
+  bool
+  XMLTokenizer::parseChunk(const char* aChunk, size_t aSize, bool aTerminate)
+  {
+    if (theError)
+      return false;
+
+    if (theSize + aSize > theCapacity) {
+      size_t lCapacity = theCapacity ? theCapacity : INITIAL_BUFFER_SIZE;
+      while (lCapacity < theSize + aSize)
+        lCapacity *= 2;
+      char* lBuffer = static_cast<char*>(::realloc(theBuffer, lCapacity));
+      if (!lBuffer) {
+        theError = true;
+        return false;
+      }
+      theBuffer = lBuffer;
+      theCapacity = lCapacity;
+    }
+    if (aSize)
+      memcpy(theBuffer + theSize, aChunk, aSize);
+    theSize += aSize;
+
+    size_t lConsumed = tokenize(aTerminate);
+    if (aTerminate && !theError && (lConsumed != theSize || theDepth != 0))
+      theError = true; // truncated document
+
+    theSize -= lConsumed;
+    if (theSize && lConsumed)
+      memmove(theBuffer, theBuffer + lConsumed, theSize);
+
+    return !theError;
+  }
+
+  size_t
+  XMLTokenizer::tokenize(bool aTerminate)
+  {
+    char* lLast = theBuffer + theSize;
+    char* p = theBuffer;
+
+    while (p < lLast && !theError) {
+      if (*p != '<') {
+        // text up to the next tag; only complete text nodes are passed
+        char* lEnd = static_cast<char*>(memchr(p, '<', lLast - p));
+        if (!lEnd) {
+          if (!aTerminate)
+            break;
+          lEnd = lLast;
+        }
+        if (theDepth > 0)
+          characters(p, lEnd - p);
+        p = lEnd;
+        continue;
+      }
+
+      if (lLast - p < 2)
+        break;
+
+      if (p[1] == '?') {
+        char* lEnd = find(p + 2, lLast, "?>");
+        if (!lEnd)
+          break;
+        p = lEnd + 2;
+      } else if (p[1] == '!') {
+        if (isPrefixOf(p, lLast, "<!--") || isPrefixOf(p, lLast, "<![CDATA["))
+          break;
+        if (lLast - p >= 4 && memcmp(p, "<!--", 4) == 0) {
+          char* lEnd = find(p + 4, lLast, "-->");
+          if (!lEnd)
+            break;
+          p = lEnd + 3;
+        } else if (lLast - p >= 9 && memcmp(p, "<![CDATA[", 9) == 0) {
+          char* lEnd = find(p + 9, lLast, "]]>");
+          if (!lEnd)
+            break;
+          if (theDepth > 0 && lEnd > p + 9 && theSAXHandler->characters)
+            theSAXHandler->characters(theUserData, (const xmlChar*) p + 9, lEnd - p - 9);
+          p = lEnd + 3;
+        } else {
+          char* lEnd = findTagEnd(p + 2, lLast);
+          if (!lEnd)
+            break;
+          p = lEnd + 1;
+        }
+      } else if (p[1] == '/') {
+        char* lName = p + 2;
+        char* lNameEnd = lName;
+        while (lNameEnd < lLast && !AWS_IS_NAME_END(*lNameEnd))
+          ++lNameEnd;
+        char* lEnd = lNameEnd;
+        while (lEnd < lLast && isSpace(*lEnd))
+          ++lEnd;
+        if (lEnd == lLast)
+          break;
+        // the end tag must close the innermost open element
+        if (*lEnd != '>' || !popName(lName, lNameEnd - lName)) {
+          theError = true;
+          break;
+        }
+        *lNameEnd = 0;
+        char* lColon = static_cast<char*>(memchr(lName, ':', lNameEnd - lName));
+        if (lColon)
+          lName = lColon + 1;
+        if (theSAXHandler->endElementNs)
+          theSAXHandler->endElementNs(theUserData, (const xmlChar*) lName, 0, 0);
+        p = lEnd + 1;
+      } else {
+        char* lName = p + 1;
+        char* lNameEnd = lName;
+        while (lNameEnd < lLast && !AWS_IS_NAME_END(*lNameEnd))
+          ++lNameEnd;
+        // most tags have no attributes, i.e. the name is followed by '>'
+        char* lEnd = lNameEnd < lLast && *lNameEnd == '>'
+                     ? lNameEnd : findTagEnd(lNameEnd, lLast);
+        if (!lEnd)
+          break;
+        if (lName == lNameEnd) {
+          theError = true;
+          break;
+        }
+        bool lIsEmpty = lEnd[-1] == '/';
+        if (!lIsEmpty && !pushName(lName, lNameEnd - lName)) {
+          theError = true;
+          break;
+        }
+        *lNameEnd = 0;
+        char* lColon = static_cast<char*>(memchr(lName, ':', lNameEnd - lName));
+        if (lColon)
+          lName = lColon + 1;
+        if (theSAXHandler->startElementNs)
+          theSAXHandler->startElementNs(theUserData, (const xmlChar*) lName, 0, 0,
+                                        0, 0, 0, 0, 0);
+        if (lIsEmpty && theSAXHandler->endElementNs)
+          theSAXHandler->endElementNs(theUserData, (const xmlChar*) lName, 0, 0);
+        p = lEnd + 1;
+      }
+    }
+    return p - theBuffer;
+  }
+
+  bool
+  XMLTokenizer::pushName(const char* aName, size_t aLength)
+  {
+    size_t lSize = theNamesSize + aLength + sizeof(size_t);
+    if (lSize > theNamesCapacity) {
+      size_t lCapacity = theNamesCapacity ? theNamesCapacity : INITIAL_NAMES_SIZE;
+      while (lCapacity < lSize)
+        lCapacity *= 2;
+      char* lNames = static_cast<char*>(::realloc(theNames, lCapacity));
+      if (!lNames)
+        return false;
+      theNames = lNames;
+      theNamesCapacity = lCapacity;
+    }
+    memcpy(theNames + theNamesSize, aName, aLength);
+    memcpy(theNames + theNamesSize + aLength, &aLength, sizeof(size_t));
+    theNamesSize = lSize;
+    ++theDepth;
+    return true;
+  }
+
+  bool
+  XMLTokenizer::popName(const char* aName, size_t aLength)
+  {
+    if (theDepth == 0)
+      return false;
+    size_t lLength;
+    memcpy(&lLength, theNames + theNamesSize - sizeof(size_t), sizeof(size_t));
+    const char* lName = theNames + theNamesSize - sizeof(size_t) - lLength;
+    if (lLength != aLength || memcmp(lName, aName, aLength) != 0)
+      return false;
+    theNamesSize -= aLength + sizeof(size_t);
+    --theDepth;
+    return true;
+  }
+
+  void
+  XMLTokenizer::characters(char* aText, size_t aSize)
+  {
+    size_t lSize = decode(aText, aSize);
+    if (lSize && theSAXHandler->characters)
+      theSAXHandler->characters(theUserData, (const xmlChar*) aText, lSize);
+  }
+
+  static size_t
+  encodeUtf8(unsigned long aCode, char* aOut)
+  {
+    if (aCode < 0x80) {
+      aOut[0] = (char) aCode;
+      return 1;
+    } else if (aCode < 0x800) {
+      aOut[0] = (char) (0xC0 | (aCode >> 6));
+      aOut[1] = (char) (0x80 | (aCode & 0x3F));
+      return 2;
+    } else if (aCode < 0x10000) {
+      aOut[0] = (char) (0xE0 | (aCode >> 12));
+      aOut[1] = (char) (0x80 | ((aCode >> 6) & 0x3F));
+      aOut[2] = (char) (0x80 | (aCode & 0x3F));
+      return 3;
+    }
+    aOut[0] = (char) (0xF0 | (aCode >> 18));
+    aOut[1] = (char) (0x80 | ((aCode >> 12) & 0x3F));
+    aOut[2] = (char) (0x80 | ((aCode >> 6) & 0x3F));
+    aOut[3] = (char) (0x80 | (aCode & 0x3F));
+    return 4;
+  }
+
+  size_t
+  XMLTokenizer::decode(char* aText, size_t aSize)
+  {
+    char* lLast = aText + aSize;
+    char* lIn = static_cast<char*>(memchr(aText, '&', aSize));
+    if (!lIn)
+      return aSize;
+
+    // a reference is never shorter than its replacement, i.e. the text
+    // can be written over itself
+    char* lOut = lIn;
+    while (lIn < lLast) {
+      if (*lIn != '&') {
+        *lOut++ = *lIn++;
+        continue;
+      }
+      char* lEnd = static_cast<char*>(memchr(lIn, ';', lLast - lIn));
+      size_t lLength = lEnd ? lEnd - lIn - 1 : 0;
+      const char* lName = lIn + 1;
+      char lReplacement = 0;
+      if (lLength == 2 && memcmp(lName, "lt", 2) == 0)
+        lReplacement = '<';
+      else if (lLength == 2 && memcmp(lName, "gt", 2) == 0)
+        lReplacement = '>';
+      else if (lLength == 3 && memcmp(lName, "amp", 3) == 0)
+        lReplacement = '&';
+      else if (lLength == 4 && memcmp(lName, "quot", 4) == 0)
+        lReplacement = '"';
+      else if (lLength == 4 && memcmp(lName, "apos", 4) == 0)
+        lReplacement = '\'';
+      else if (lLength >= 2 && lName[0] == '#') {
+        char* lNumberEnd;
+        unsigned long lCode = lName[1] == 'x'
+            ? strtoul(lName + 2, &lNumberEnd, 16)
+            : strtoul(lName + 1, &lNumberEnd, 10);
+        if (lNumberEnd == lEnd && lCode > 0 && lCode <= 0x10FFFF) {
+          lOut += encodeUtf8(lCode, lOut);
+          lIn = lEnd + 1;
+          continue;
+        }
+      }
+      if (lReplacement) {
+        *lOut++ = lReplacement;
+        lIn = lEnd + 1;
+      } else {
+        // unknown references are passed unchanged
+        *lOut++ = *lIn++;
+      }
+    }
+    return lOut - aText;
+  }
+
+} /* namespace aws */
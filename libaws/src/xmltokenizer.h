@@ -0,0 +1,88 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AWS_XMLTOKENIZER_H
+#define AWS_XMLTOKENIZER_H
+
+#include <cstddef>
+#include <libxml/parser.h>
+
+namespace aws {
+
+  // A streaming tokenizer for the response documents of AWS, which is used
+  // instead of libxml2 if libaws is built with AWS_XML_TOKENIZER.
+  //
+  // It calls the startElementNs, characters, and endElementNs functions of
+  // a SAX2 handler such that the existing handlers can be used unchanged.
+  // Names are passed without namespace prefix (prefix and URI are always 0)
+  // and attributes are skipped, because none of the handlers use them.
+  // The text of an element is decoded in place and passed in one call
+  // (libxml2 may split it, e.g. at entity references). Comments,
+  // processing instructions, and declarations are skipped; CDATA sections
+  // are passed as text.
+  //
+  // Chunks are appended to a buffer that is kept between documents, i.e.
+  // after the first few documents no memory is allocated.
+  class XMLTokenizer
+  {
+    public:
+      XMLTokenizer();
+      ~XMLTokenizer();
+
+      // starts a new document whose events are passed to aSAXHandler
+      void
+      reset(xmlSAXHandler* aSAXHandler, void* aUserData);
+
+      // returns false if the document is malformed; no more events are
+      // passed to the handler in this case
+      bool
+      parseChunk(const char* aChunk, size_t aSize, bool aTerminate);
+
+    protected:
+      // processes all complete tokens in the buffer and returns the
+      // number of bytes consumed
+      size_t
+      tokenize(bool aTerminate);
+
+      // decodes the entity and character references of a text in place
+      // and returns the size of the decoded text
+      static size_t
+      decode(char* aText, size_t aSize);
+
+      // the names of the open elements, each followed by its length;
+      // an end tag must match the innermost one
+      bool
+      pushName(const char* aName, size_t aLength);
+
+      bool
+      popName(const char* aName, size_t aLength);
+
+      void
+      characters(char* aText, size_t aSize);
+
+      xmlSAXHandler* theSAXHandler;
+      void*          theUserData;
+      char*          theBuffer;
+      size_t         theSize;
+      size_t         theCapacity;
+      char*          theNames;
+      size_t         theNamesSize;
+      size_t         theNamesCapacity;
+      int            theDepth;
+      bool           theError;
+  };
+
+} /* namespace aws */
+#endif
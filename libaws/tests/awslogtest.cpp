@@ -0,0 +1,136 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <libaws/aws.h>
+
+using namespace aws;
+
+// counts the messages a sink received (only called by the writer thread)
+struct Received
+{
+  Received() : theMessages(0), theOutOfOrder(0), theRepeated(0) {}
+
+  std::vector<int> theNext; // next expected number of every producer
+  int theMessages;
+  int theOutOfOrder;
+  int theRepeated;
+  std::string theLongest;
+};
+
+static void
+countingSink(int aPriority, const char* aMessage, void* aUserData)
+{
+  Received* lReceived = static_cast<Received*>(aUserData);
+  std::string lMessage(aMessage);
+  if (lMessage.find("last message repeated") == 0) {
+    ++lReceived->theRepeated;
+    return;
+  }
+  ++lReceived->theMessages;
+  if (lMessage.size() > lReceived->theLongest.size())
+    lReceived->theLongest = lMessage;
+
+  // "<producer> <number>": the messages of a producer arrive in order
+  std::istringstream lStream(lMessage);
+  size_t lProducer;
+  int lNumber;
+  if (lStream >> lProducer >> lNumber && lProducer < lReceived->theNext.size()) {
+    if (lNumber != lReceived->theNext[lProducer])
+      ++lReceived->theOutOfOrder;
+    lReceived->theNext[lProducer] = lNumber + 1;
+  }
+}
+
+static const int NUMBER_OF_PRODUCERS = 4;
+static const int MESSAGES_PER_PRODUCER = 1000;
+
+static Received theReceived;
+
+static void*
+produce(void* aProducer)
+{
+  long lProducer = (long) aProducer;
+  for (int i = 0; i < MESSAGES_PER_PRODUCER; ++i) {
+    std::ostringstream lMessage;
+    lMessage << lProducer << " " << i;
+    AWSLog::log(1, lMessage.str(), &countingSink, &theReceived);
+    if (i % 64 == 63)
+      AWSLog::flush(); // the ring buffer of a thread holds 128 messages, none is dropped
+  }
+  return 0;
+}
+
+int
+awslogtest(int argc, char* argv[])
+{
+  AWSLog::setSuppressionInterval(0);
+  theReceived.theNext.resize(NUMBER_OF_PRODUCERS, 0);
+
+  std::vector<pthread_t> lThreads(NUMBER_OF_PRODUCERS);
+  for (long i = 0; i < NUMBER_OF_PRODUCERS; ++i)
+    pthread_create(&lThreads[i], 0, &produce, (void*) i);
+  for (int i = 0; i < NUMBER_OF_PRODUCERS; ++i)
+    pthread_join(lThreads[i], 0);
+  AWSLog::flush();
+
+  int lExpected = NUMBER_OF_PRODUCERS * MESSAGES_PER_PRODUCER;
+  if (theReceived.theMessages != lExpected || AWSLog::getNumberOfDroppedMessages() != 0) {
+    std::cerr << "received " << theReceived.theMessages << " of " << lExpected
+              << " messages, " << AWSLog::getNumberOfDroppedMessages() << " dropped" << std::endl;
+    return 1;
+  }
+  // every message of a producer follows the one before it
+  for (int i = 0; i < NUMBER_OF_PRODUCERS; ++i) {
+    if (theReceived.theNext[i] != MESSAGES_PER_PRODUCER) {
+      std::cerr << "messages of producer " << i << " incomplete" << std::endl;
+      return 1;
+    }
+  }
+  if (theReceived.theOutOfOrder != 0) {
+    std::cerr << theReceived.theOutOfOrder << " messages out of order" << std::endl;
+    return 1;
+  }
+
+  // messages that don't fit into a ring buffer record
+  std::string lLong(5000, 'x');
+  AWSLog::log(1, lLong, &countingSink, &theReceived);
+  AWSLog::flush();
+  if (theReceived.theLongest != lLong) {
+    std::cerr << "long message truncated" << std::endl;
+    return 1;
+  }
+
+  // duplicates are only counted
+  AWSLog::setSuppressionInterval(10);
+  theReceived.theMessages = 0;
+  for (int i = 0; i < 10; ++i)
+    AWSLog::log(1, "again and again", &countingSink, &theReceived);
+  AWSLog::log(1, "something else", &countingSink, &theReceived);
+  AWSLog::flush();
+  if (theReceived.theMessages != 2 || theReceived.theRepeated != 1) {
+    std::cerr << "duplicates not suppressed: " << theReceived.theMessages
+              << " messages, " << theReceived.theRepeated << " repeat notices" << std::endl;
+    return 1;
+  }
+
+  std::cout << lExpected << " messages of " << NUMBER_OF_PRODUCERS << " threads, "
+            << AWSLog::getNumberOfDroppedMessages() << " dropped" << std::endl;
+  return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <unistd.h>
+#include <../fuse/cachebackend.h> //HACK
+#include <../fuse/lrubackend.h>
+#include <../fuse/shmbackend.h>
+
+using namespace aws;
+
+static bool
+has(CacheBackend& aBackend, const std::string& aKey, const std::string& aValue)
+{
+  std::string lValue;
+  return aBackend.get(aKey, lValue) && lValue == aValue;
+}
+
+static std::string
+key(int aNumber)
+{
+  std::ostringstream lKey;
+  lKey << "bucket:ex::dir/file" << aNumber;
+  return lKey.str();
+}
+
+// collects the values of get_multi
+class Collector : public CacheBackend::Receiver
+{
+public:
+  Collector(size_t aSize) : theValues(aSize) {}
+
+  virtual void receive(size_t aIndex, const char* aValue, size_t aLength)
+  {
+    theValues[aIndex].assign(aValue, aLength);
+  }
+
+  std::vector<std::string> theValues;
+};
+
+static int
+lrutest()
+{
+  // room for four keys of 2 and values of 10 bytes
+  LRUBackend lLRU(48, 10, 0);
+  if (!lLRU.set("k1", "value1", 6) || !has(lLRU, "k1", "value1")) {
+    std::cerr << "lru: value not stored" << std::endl;
+    return 1;
+  }
+  lLRU.set("k1", "newvalue1", 9);
+  if (!has(lLRU, "k1", "newvalue1")) {
+    std::cerr << "lru: value not replaced" << std::endl;
+    return 1;
+  }
+  lLRU.set("k1", "v111111111", 10);
+  lLRU.set("k2", "v222222222", 10);
+  lLRU.set("k3", "v333333333", 10);
+  lLRU.set("k4", "v444444444", 10);
+
+  // k1 is used again, so k2 is the least recently used entry
+  std::string lValue;
+  lLRU.get("k1", lValue);
+  lLRU.set("k5", "v555555555", 10);
+  if (lLRU.get("k2", lValue) || !has(lLRU, "k1", "v111111111") || !has(lLRU, "k5", "v555555555")) {
+    std::cerr << "lru: not the least recently used entry evicted" << std::endl;
+    return 1;
+  }
+
+  // larger than an item
+  if (lLRU.set("k6", "v6666666666", 11) || lLRU.get("k6", lValue)) {
+    std::cerr << "lru: too large value stored" << std::endl;
+    return 1;
+  }
+
+  lLRU.remove("k1");
+  if (lLRU.get("k1", lValue)) {
+    std::cerr << "lru: value not removed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int
+shmtest(const std::string& aPath)
+{
+  // as many slots as a key probes, so every key competes for all of them
+  ShmBackend lShm(aPath, 8, 128, 0);
+  if (!lShm.is_open()) {
+    std::cerr << "shm: couldn't create " << aPath << std::endl;
+    return 1;
+  }
+
+  std::vector<int> lKeys;
+  for (int i = 0; i < 8; ++i) {
+    lShm.set(key(i), "value", 5);
+    lKeys.push_back(i);
+  }
+  for (int i = 0; i < 8; ++i) {
+    if (!has(lShm, key(i), "value")) {
+      std::cerr << "shm: value not stored" << std::endl;
+      return 1;
+    }
+  }
+
+  // a full table replaces the least recently used of the probed slots
+  for (int lRound = 0; lRound < 8; ++lRound) {
+    int lVictim = lKeys[lRound];
+    std::string lValue;
+    for (int i = 0; i < 8; ++i) {
+      if (i != lRound)
+        lShm.get(key(lKeys[i]), lValue);
+    }
+    lKeys[lRound] = 8 + lRound;
+    lShm.set(key(lKeys[lRound]), "value", 5);
+    if (lShm.get(key(lVictim), lValue)) {
+      std::cerr << "shm: not the least recently used entry evicted" << std::endl;
+      return 1;
+    }
+    for (int i = 0; i < 8; ++i) {
+      if (!has(lShm, key(lKeys[i]), "value")) {
+        std::cerr << "shm: recently used entry evicted" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  // values that don't fit into a slot aren't stored and don't keep an old value
+  std::string lLarge(200, 'x');
+  std::string lValue;
+  if (lShm.set(key(lKeys[0]), lLarge.c_str(), lLarge.size()) || lShm.get(key(lKeys[0]), lValue)) {
+    std::cerr << "shm: too large value stored" << std::endl;
+    return 1;
+  }
+
+  // another process opening the same file sees the values
+  ShmBackend lOther(aPath, 1, 1, 0);
+  if (!lOther.is_open() || !has(lOther, key(lKeys[1]), "value")) {
+    std::cerr << "shm: value not shared" << std::endl;
+    return 1;
+  }
+  lOther.remove(key(lKeys[1]));
+  if (lShm.get(key(lKeys[1]), lValue)) {
+    std::cerr << "shm: value not removed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int
+tieredtest()
+{
+  // the upper tier takes only small values
+  LRUBackend* lUpper = new LRUBackend(1024, 4, 0);
+  LRUBackend* lLower = new LRUBackend(1024, 100, 0);
+  TieredBackend lTiers;
+  lTiers.add(lUpper);
+  lTiers.add(lLower);
+  if (lTiers.name() != "lru+lru") {
+    std::cerr << "tiered: wrong name " << lTiers.name() << std::endl;
+    return 1;
+  }
+
+  if (!lTiers.set("large", "large value", 11) || !has(*lLower, "large", "large value")) {
+    std::cerr << "tiered: value not stored in the tier that has room for it" << std::endl;
+    return 1;
+  }
+
+  // values of a lower tier are copied into the tiers above
+  lLower->set("small", "abc", 3);
+  if (!has(lTiers, "small", "abc") || !has(*lUpper, "small", "abc")) {
+    std::cerr << "tiered: value not copied into the upper tier" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> lKeys;
+  lKeys.push_back("large");
+  lKeys.push_back("missing");
+  lKeys.push_back("small");
+  Collector lCollector(lKeys.size());
+  lTiers.get_multi(lKeys, lCollector);
+  if (lCollector.theValues[0] != "large value" || !lCollector.theValues[1].empty()
+      || lCollector.theValues[2] != "abc") {
+    std::cerr << "tiered: get_multi returned wrong values" << std::endl;
+    return 1;
+  }
+
+  lTiers.remove("small");
+  std::string lValue;
+  if (lUpper->get("small", lValue) || lLower->get("small", lValue)) {
+    std::cerr << "tiered: value not removed from all tiers" << std::endl;
+    return 1;
+  }
+
+  std::ostringstream lStats;
+  lTiers.print_stats(lStats);
+  if (lStats.str() != "cache.tier.lru.hits 1\ncache.tier.lru.hits 2\n") {
+    std::cerr << "tiered: wrong statistics " << lStats.str() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int
+cachebackendtest(int argc, char* argv[])
+{
+  int lReturnCode = lrutest();
+  if (lReturnCode != 0)
+    return lReturnCode;
+
+  std::ostringstream lPath;
+  lPath << "/tmp/libaws_cachebackendtest_" << getpid();
+  unlink(lPath.str().c_str());
+  lReturnCode = shmtest(lPath.str());
+  unlink(lPath.str().c_str());
+  if (lReturnCode != 0)
+    return lReturnCode;
+
+  lReturnCode = tieredtest();
+  if (lReturnCode != 0)
+    return lReturnCode;
+
+  std::cout << "lru, shm, and tiered cache backends OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <sys/time.h>
+#include <../src/parsercache.h> //HACK
+
+using namespace aws;
+
+// an error response, the kind of small document most requests receive
+static const char theDoc[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<Error><Code>NoSuchKey</Code><Message>The specified key does not exist.</Message>"
+  "<Key>dir/file.txt</Key><RequestId>4442587FB7D0A2F9</RequestId>"
+  "<HostId>eftixk72aD6Ap51TnqcoF8eFidJG9Z/2mkiDFu8yU9AS1ed4OpIszj7UDNEHGran</HostId></Error>";
+
+static void
+recordStart(void* ctx, const xmlChar* localname, const xmlChar* prefix,
+            const xmlChar* URI, int nb_namespaces, const xmlChar** namespaces,
+            int nb_attributes, int nb_defaulted, const xmlChar** attributes)
+{
+  *static_cast<std::string*>(ctx) += std::string("<") + (const char*) localname + ">";
+}
+
+static void
+recordCharacters(void* ctx, const xmlChar* value, int len)
+{
+  static_cast<std::string*>(ctx)->append((const char*) value, len);
+}
+
+static double
+now()
+{
+  struct timeval lTime;
+  gettimeofday(&lTime, 0);
+  return lTime.tv_sec + lTime.tv_usec / 1000000.0;
+}
+
+int
+parsercachetest(int argc, char* argv[])
+{
+  xmlSAXHandler lHandler;
+  memset(&lHandler, 0, sizeof(lHandler));
+  lHandler.initialized    = XML_SAX2_MAGIC;
+  lHandler.startElementNs = recordStart;
+  lHandler.characters     = recordCharacters;
+
+  std::string lExpected;
+  ParserCache::Parser lFresh = ParserCache::create(&lHandler, &lExpected);
+  ParserCache::parseChunk(lFresh, theDoc, sizeof(theDoc) - 1, true);
+  ParserCache::destroy(lFresh);
+
+  // a released parser is handed out again and reports to the new user data
+  ParserCache lCache;
+  std::string lFirst, lSecond;
+  ParserCache::Parser lParser = lCache.acquire(&lHandler, &lFirst);
+  ParserCache::parseChunk(lParser, theDoc, sizeof(theDoc) - 1, true);
+  lCache.release(lParser);
+  ParserCache::Parser lReused = lCache.acquire(&lHandler, &lSecond);
+  ParserCache::parseChunk(lReused, theDoc, sizeof(theDoc) - 1, true);
+  if (lReused != lParser) {
+    std::cerr << "released parser not reused" << std::endl;
+    return 1;
+  }
+  if (lFirst != lExpected || lSecond != lExpected) {
+    std::cerr << "reused parser reported different events" << std::endl;
+    return 1;
+  }
+
+  // the cached parser is in use, so a parser of its own is created
+  std::string lThird;
+  ParserCache::Parser lOther = lCache.acquire(&lHandler, &lThird);
+  ParserCache::parseChunk(lOther, theDoc, sizeof(theDoc) - 1, true);
+  if (lOther == lReused || lThird != lExpected) {
+    std::cerr << "parser in use handed out again" << std::endl;
+    return 1;
+  }
+  lCache.release(lOther);
+  lCache.release(lReused);
+  if (lCache.acquire(&lHandler, &lThird) != lParser) {
+    std::cerr << "cached parser replaced" << std::endl;
+    return 1;
+  }
+  lCache.release(lParser);
+
+  // time per response with a new parser for each and with the cached one
+  const int lIterations = 20000;
+  std::string lSink;
+  double lStart = now();
+  for (int i = 0; i < lIterations; ++i) {
+    lSink.clear();
+    ParserCache::Parser lNew = ParserCache::create(&lHandler, &lSink);
+    ParserCache::parseChunk(lNew, theDoc, sizeof(theDoc) - 1, true);
+    ParserCache::destroy(lNew);
+  }
+  double lCreated = now() - lStart;
+
+  lStart = now();
+  for (int i = 0; i < lIterations; ++i) {
+    lSink.clear();
+    ParserCache::Parser lCached = lCache.acquire(&lHandler, &lSink);
+    ParserCache::parseChunk(lCached, theDoc, sizeof(theDoc) - 1, true);
+    lCache.release(lCached);
+  }
+  double lCached = now() - lStart;
+
+  std::cout << "error response (" << sizeof(theDoc) - 1 << " bytes): new parser "
+            << lCreated * 1000000 / lIterations << " us, cached parser "
+            << lCached * 1000000 / lIterations << " us" << std::endl;
+  return 0;
+}
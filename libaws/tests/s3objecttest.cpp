@@ -15,7 +15,12 @@
  */
 #include <iostream>
 #include <sstream>
+#include <iterator>
+#include <vector>
+#include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/uio.h>
 #include <libaws/aws.h>
 
 using namespace aws;
@@ -85,6 +90,34 @@ put(S3Connection* lS3Rest)
       return 1;
     }
   }
+
+  {
+    FILE* lFile = tmpfile();
+    fputs("This is a file descriptor test!", lFile);
+    fflush(lFile);
+    try {
+      // skip "This is a "
+      PutResponsePtr lPut = lS3Rest->put(bucketName, "a/b/c/e",
+                                         fileno(lFile), 10, "text/plain");
+      std::cout << "Object sent successfully" << std::endl;
+    } catch (PutException& e) {
+  		std::cerr << "Couldn't put object" << std::endl;
+  		std::cerr << e.what() << std::endl;
+      fclose(lFile);
+      return 1;
+    }
+
+    // the region must not reach beyond the end of the file
+    try {
+      lS3Rest->put(bucketName, "a/b/c/e", fileno(lFile), 10, "text/plain", 4096);
+      std::cerr << "Region beyond the end of the file not rejected" << std::endl;
+      fclose(lFile);
+      return 1;
+    } catch (PutException& e) {
+      std::cout << "Region beyond the end of the file rejected" << std::endl;
+    }
+    fclose(lFile);
+  }
   return 0;
 }
 
@@ -158,9 +191,467 @@ getobject(S3Connection* lS3Rest)
       std::cerr << e.what() << std::endl;
     }
   }
+
+  // "a/b/c/d" is "Hello"
+  {
+    try {
+      char lBuf[16];
+      GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/d", lBuf, sizeof(lBuf));
+      if (lGet->getContentLength() != 5 || std::string(lBuf, 5) != "Hello") {
+        std::cerr << "Wrong object received into buffer" << std::endl;
+        return 1;
+      }
+
+      char lFirst[2], lSecond[3];
+      struct iovec lIovec[2];
+      lIovec[0].iov_base = lFirst;  lIovec[0].iov_len = sizeof(lFirst);
+      lIovec[1].iov_base = lSecond; lIovec[1].iov_len = sizeof(lSecond);
+      lGet = lS3Rest->get(bucketName, "a/b/c/d", lIovec, 2);
+      if (std::string(lFirst, 2) != "He" || std::string(lSecond, 3) != "llo") {
+        std::cerr << "Wrong object received into buffers" << std::endl;
+        return 1;
+      }
+
+      FILE* lFile = tmpfile();
+      fputs("12345", lFile);
+      fflush(lFile);
+      lGet = lS3Rest->get(bucketName, "a/b/c/d", fileno(lFile), 3);
+      char lContent[9];
+      size_t lRead = pread(fileno(lFile), lContent, sizeof(lContent), 0);
+      fclose(lFile);
+      if (lRead != 8 || std::string(lContent, 8) != "123Hello") {
+        std::cerr << "Wrong object received into file" << std::endl;
+        return 1;
+      }
+      std::cout << "Object retrieved into buffers and file successfully" << std::endl;
+    } catch (GetException& e) {
+      std::cerr << "Couldn't get object into buffer" << std::endl;
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  {
+    try {
+      char lBuf[4];
+      lS3Rest->get(bucketName, "a/b/c/d", lBuf, sizeof(lBuf));
+      std::cerr << "Object larger than the buffer not reported" << std::endl;
+      return 1;
+    } catch (GetException& e) {
+      if (e.getErrorCode() != S3Exception::EntityTooLarge) {
+        std::cerr << "Wrong error for object larger than the buffer: " << e.what() << std::endl;
+        return 1;
+      }
+    }
+  }
   return  0;
 }
 
+int
+cacheobject(S3Connection* lS3Rest)
+{
+  try {
+    // the bucket policy (no time to live) makes the second get revalidate
+    S3ObjectCache lCache(1024 * 1024, 60);
+    lCache.setBucketPolicy(bucketName, 0, 1024);
+
+    S3CachedObjectPtr lFirst = lCache.get(lS3Rest, bucketName, "a/b/c");
+    S3CachedObjectPtr lSecond = lCache.get(lS3Rest, bucketName, "a/b/c");
+    if (lFirst->getData() != lSecond->getData()
+        || lCache.getNumberOfMisses() != 1 || lCache.getNumberOfRevalidations() != 1) {
+      std::cerr << "Cached object doesn't match" << std::endl;
+      return 1;
+    }
+    std::cout << "Cached object: " << lSecond->getData() << std::endl;
+  } catch (GetException& e) {
+    std::cerr << "Couldn't get object" << std::endl;
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int
+compressobject(S3Connection* lS3Rest)
+{
+  std::string lText;
+  for (int i = 0; i < 1000; ++i)
+    lText += "This is a compression test!\n";
+
+  lS3Rest->setCompression(S3Connection::GZIP_COMPRESSION);
+  try {
+    PutResponsePtr lPut = lS3Rest->put(bucketName, "a/b/c/g", lText.c_str(),
+                                       "text/plain", lText.size());
+    std::cout << "Object sent compressed successfully" << std::endl;
+  } catch (PutException& e) {
+    lS3Rest->setCompression(S3Connection::NO_COMPRESSION);
+  	std::cerr << "Couldn't put object" << std::endl;
+  	std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  lS3Rest->setCompression(S3Connection::NO_COMPRESSION);
+
+  try {
+    {
+      GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/g");
+      std::istream& lInStream = lGet->getInputStream();
+      std::string lRead((std::istreambuf_iterator<char>(lInStream)),
+                        std::istreambuf_iterator<char>());
+      if (lRead != lText || lGet->getContentLength() != (long long) lText.size()) {
+        std::cerr << "Compressed object doesn't match" << std::endl;
+        return 1;
+      }
+    }
+
+    std::vector<char> lBuffer(lText.size());
+    GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/g", &lBuffer[0], lBuffer.size());
+    if (std::string(&lBuffer[0], lBuffer.size()) != lText) {
+      std::cerr << "Compressed object doesn't match" << std::endl;
+      return 1;
+    }
+    std::cout << "Compressed object retrieved successfully" << std::endl;
+  } catch (GetException& e) {
+    std::cerr << "Couldn't get object" << std::endl;
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // a copy with new metadata must still be decompressed
+  try {
+    std::map<std::string, std::string> lMetaData;
+    lMetaData["name"] = "value";
+    CopyResponsePtr lCopy = lS3Rest->copy(bucketName, "a/b/c/g", bucketName, "a/b/c/h",
+                                          &lMetaData, "text/plain");
+    GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/h");
+    std::istream& lInStream = lGet->getInputStream();
+    std::string lRead((std::istreambuf_iterator<char>(lInStream)),
+                      std::istreambuf_iterator<char>());
+    std::map<std::string, std::string> lMap = lGet->getMetaData();
+    if (lRead != lText || lMap["name"] != "value") {
+      std::cerr << "Copy of the compressed object doesn't match" << std::endl;
+      return 1;
+    }
+    std::cout << "Compressed object copied successfully" << std::endl;
+  } catch (S3Exception& e) {
+    std::cerr << "Couldn't copy or get object" << std::endl;
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // a compressed object that ends early must not be returned as complete
+  try {
+    std::map<std::string, std::string> lMetaData;
+    lMetaData["libaws-codec"] = "gzip";
+    // only the header of a gzip stream
+    std::istringstream lStream(std::string("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10));
+    PutResponsePtr lPut = lS3Rest->put(bucketName, "a/b/c/h", lStream, "text/plain", &lMetaData);
+
+    char lBuffer[64];
+    GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/h", lBuffer, sizeof(lBuffer));
+    std::cerr << "Truncated compressed object wasn't reported" << std::endl;
+    return 1;
+  } catch (GetException& e) {
+    std::cout << "Truncated compressed object reported: " << e.what() << std::endl;
+  } catch (S3Exception& e) {
+    std::cerr << "Couldn't put object" << std::endl;
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // an object that claims to be compressed but isn't must not read as empty
+  try {
+    std::map<std::string, std::string> lMetaData;
+    lMetaData["libaws-codec"] = "gzip";
+    std::istringstream lStream("This is not compressed!");
+    PutResponsePtr lPut = lS3Rest->put(bucketName, "a/b/c/g", lStream, "text/plain", &lMetaData);
+
+    GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/g");
+    std::istream& lInStream = lGet->getInputStream();
+    char lBuffer[64];
+    lInStream.read(lBuffer, sizeof(lBuffer));
+    if (!lInStream.bad()) {
+      std::cerr << "Corrupt compressed object wasn't reported" << std::endl;
+      return 1;
+    }
+    std::cout << "Corrupt compressed object reported" << std::endl;
+  } catch (S3Exception& e) {
+    std::cerr << "Couldn't put or get object" << std::endl;
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int
+copyobject(S3Connection* lS3Rest)
+{
+  {
+    try {
+      CopyResponsePtr lCopy = lS3Rest->copy(bucketName, "a/b/c", bucketName, "a/b/c/f");
+      std::cout << "Object copied successfully (ETag " << lCopy->getETag()
+                << " | Last Modified: " << lCopy->getLastModified() << ")" << std::endl;
+
+      // the copy has the content and the metadata of the source
+      GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/f");
+      std::string lContent((std::istreambuf_iterator<char>(lGet->getInputStream())),
+                           std::istreambuf_iterator<char>());
+      std::map<std::string, std::string> lMap = lGet->getMetaData();
+      if (lContent != "This is a meta-data test!" || lMap["name"] != "value") {
+        std::cerr << "Copy differs from the source object" << std::endl;
+        return 1;
+      }
+    } catch (CopyException& e) {
+  		std::cerr << "Couldn't copy object" << std::endl;
+  		std::cerr << e.what() << std::endl;
+      return 1;
+    } catch (GetException& e) {
+      std::cerr << "Couldn't get copied object" << std::endl;
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  {
+    try {
+      lS3Rest->copy(bucketName, "x", bucketName, "y");
+      return 1;
+    } catch (CopyException& e) {
+      std::cerr << "Couldn't copy object" << std::endl;
+      std::cerr << e.what() << std::endl;
+    }
+  }
+  return 0;
+}
+
+int
+multipartcopyobject(AWSConnectionFactory* aFactory, const char* aAccessKeyId,
+                    const char* aSecretAccessKey, const std::string& aHost)
+{
+  S3ConnectionPtr lS3Rest = aFactory->createS3Connection(aAccessKeyId, aSecretAccessKey,
+                                                         aHost);
+  ConnectionPool<S3ConnectionPtr> lPool(2, aAccessKeyId, aSecretAccessKey, aHost);
+
+  // three parts (5 MB, 5 MB and 2 MB) copied by several threads
+  std::string lData(12 * 1024 * 1024, 0);
+  for (size_t i = 0; i < lData.size(); ++i)
+    lData[i] = (char) ((i * 7919) % 251);
+  std::map<std::string, std::string> lMetaData;
+  lMetaData["name"] = "value";
+
+  {
+    try {
+      lS3Rest->put(bucketName, "a/b/c/large", lData.c_str(), "text/plain", lData.size(),
+                   &lMetaData);
+      CopyResponsePtr lCopy = lS3Rest->multipartCopy(bucketName, "a/b/c/large",
+                                                     bucketName, "a/b/c/large2",
+                                                     &lPool, 5 * 1024 * 1024);
+      std::cout << "Object copied in parts successfully (ETag " << lCopy->getETag()
+                << ")" << std::endl;
+
+      GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/large2");
+      std::string lContent((std::istreambuf_iterator<char>(lGet->getInputStream())),
+                           std::istreambuf_iterator<char>());
+      std::map<std::string, std::string> lMap = lGet->getMetaData();
+      if (lContent != lData || lMap["name"] != "value"
+          || lGet->getContentType() != "text/plain") {
+        std::cerr << "Copy in parts differs from the source object" << std::endl;
+        return 1;
+      }
+    } catch (S3Exception& e) {
+      std::cerr << "Couldn't copy object in parts" << std::endl;
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  // parts smaller than 5 MB are rejected on completion, i.e. the upload
+  // is aborted and no copy is created
+  {
+    try {
+      lS3Rest->multipartCopy(bucketName, "a/b/c/large", bucketName, "a/b/c/large3",
+                             &lPool, 1024 * 1024);
+      std::cerr << "Copy in too small parts succeeded" << std::endl;
+      return 1;
+    } catch (CopyException& e) {
+      std::cerr << "Couldn't copy object in parts" << std::endl;
+      std::cerr << e.what() << std::endl;
+    }
+    if (lS3Rest->tryHead(bucketName, "a/b/c/large3")->isSuccessful()) {
+      std::cerr << "Aborted copy in parts left an object" << std::endl;
+      return 1;
+    }
+  }
+
+  {
+    try {
+      lS3Rest->multipartCopy(bucketName, "x", bucketName, "y", &lPool);
+      return 1;
+    } catch (CopyException& e) {
+      std::cerr << "Couldn't copy object in parts" << std::endl;
+      std::cerr << e.what() << std::endl;
+    }
+  }
+
+  lS3Rest->del(bucketName, "a/b/c/large");
+  lS3Rest->del(bucketName, "a/b/c/large2");
+  return 0;
+}
+
+int
+tryobject(S3Connection* lS3Rest)
+{
+  HeadResponsePtr lHead = lS3Rest->tryHead(bucketName, "a/b/c");
+  if (!lHead->isSuccessful()) {
+    std::cerr << "Couldn't head existing object: " << lHead->getErrorCode() << std::endl;
+    return 1;
+  }
+
+  lHead = lS3Rest->tryHead(bucketName, "a/b/x");
+  if (lHead->isSuccessful() || lHead->getErrorCode() != S3Exception::NoSuchKey) {
+    std::cerr << "Missing object not reported by tryHead" << std::endl;
+    return 1;
+  }
+
+  GetResponsePtr lGet = lS3Rest->tryGet(bucketName, "a/b/x");
+  if (lGet->isSuccessful() || lGet->getErrorCode() != S3Exception::NoSuchKey) {
+    std::cerr << "Missing object not reported by tryGet" << std::endl;
+    return 1;
+  }
+  std::cout << "Missing object reported without exception" << std::endl;
+  return 0;
+}
+
+int
+hedgeobject(S3Connection* lS3Rest)
+{
+  // responses must be the same whether a request was hedged or not
+  lS3Rest->setHedging(50, 100);
+  for (int i = 0; i < 40; ++i) {
+    HeadResponsePtr lHead = lS3Rest->head(bucketName, "a/b/c");
+    GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c");
+    if (lGet->getContentLength() != lHead->getContentLength()) {
+      std::cerr << "Hedged get and head differ" << std::endl;
+      return 1;
+    }
+  }
+  HeadResponsePtr lHead = lS3Rest->tryHead(bucketName, "a/b/x");
+  if (lHead->isSuccessful()) {
+    std::cerr << "Missing object not reported by hedged head" << std::endl;
+    return 1;
+  }
+  std::cout << "Hedged " << lS3Rest->getNumberOfHedgedRequests() << " requests, "
+            << lS3Rest->getNumberOfHedgeWins() << " hedges won" << std::endl;
+  lS3Rest->setHedging(0);
+  return 0;
+}
+
+int
+endpointobject(AWSConnectionFactory* aFactory, const char* aAccessKeyId,
+               const char* aSecretAccessKey, const std::string& aHost)
+{
+  // the first endpoint can't be connected, requests must fail over
+  AWSEndpointSetPtr lEndpoints = aFactory->createEndpointSet();
+  lEndpoints->addEndpoint("http://127.0.0.1:1");
+  lEndpoints->addEndpoint(aHost);
+  S3ConnectionPtr lS3Rest = aFactory->createS3Connection(aAccessKeyId, aSecretAccessKey,
+                                                         lEndpoints);
+  for (int i = 0; i < 5; ++i) {
+    HeadResponsePtr lHead = lS3Rest->head(bucketName, "a/b/c");
+    if (lHead->getContentLength() == 0) {
+      std::cerr << "Routed head returned no object" << std::endl;
+      return 1;
+    }
+  }
+  if (lEndpoints->isHealthy(0) || !lEndpoints->isHealthy(1)
+      || lEndpoints->getNumberOfFailovers() == 0) {
+    std::cerr << "Unreachable endpoint not detected" << std::endl;
+    return 1;
+  }
+  std::cout << "Routed to " << lEndpoints->getHost(1) << " after "
+            << lEndpoints->getNumberOfFailovers() << " failovers" << std::endl;
+  return 0;
+}
+
+int
+http2object(S3Connection* lS3Rest)
+{
+  // HTTP/2 sends status lines without reason phrase and lowercase header names
+  lS3Rest->setHttpVersion(S3Connection::HTTP_2);
+  try {
+    std::map<std::string, std::string> lMetaData;
+    lMetaData["name"] = "value";
+    std::istringstream lStream("This is a HTTP/2 test!");
+    PutResponsePtr lPut = lS3Rest->put(bucketName, "a/b/c/g", lStream, "text/plain", &lMetaData);
+    if (lPut->getETag().empty()) {
+      std::cerr << "No ETag in the HTTP/2 put response" << std::endl;
+      return 1;
+    }
+
+    HeadResponsePtr lHead = lS3Rest->head(bucketName, "a/b/c/g");
+    {
+      // the connection can't be used while the get response exists
+      GetResponsePtr lGet = lS3Rest->get(bucketName, "a/b/c/g");
+      std::string lContent((std::istreambuf_iterator<char>(lGet->getInputStream())),
+                           std::istreambuf_iterator<char>());
+      std::map<std::string, std::string> lMap = lGet->getMetaData();
+      if (lHead->getContentLength() != 22 || lGet->getContentLength() != 22
+          || lContent != "This is a HTTP/2 test!" || lMap["name"] != "value"
+          || lGet->getETag() != lPut->getETag()) {
+        std::cerr << "Wrong HTTP/2 head or get response" << std::endl;
+        return 1;
+      }
+    }
+
+    lHead = lS3Rest->tryHead(bucketName, "a/b/x");
+    if (lHead->isSuccessful() || lHead->getErrorCode() != S3Exception::NoSuchKey) {
+      std::cerr << "Missing object not reported over HTTP/2" << std::endl;
+      return 1;
+    }
+  } catch (S3Exception& e) {
+    std::cerr << "Couldn't use HTTP/2" << std::endl;
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  lS3Rest->setHttpVersion(S3Connection::HTTP_1_1);
+  std::cout << "HTTP/2 put, head, and get successful" << std::endl;
+  return 0;
+}
+
+int
+indexobject(S3Connection* lS3Rest)
+{
+  const char lFileName[] = "s3objecttest.index";
+  remove(lFileName);
+  {
+    S3BucketIndex lIndex(lFileName, bucketName, "", 2);
+    lIndex.refresh(lS3Rest);
+    S3BucketIndex::Object lObject;
+    if (lIndex.lookup("a/b/c", lObject) != S3BucketIndex::FOUND
+        || lIndex.lookup("a/b/c/none", lObject) != S3BucketIndex::MISSING) {
+      std::cerr << "Index lookup failed" << std::endl;
+      return 1;
+    }
+    lIndex.invalidate("a/b/c/none");
+    if (lIndex.lookup("a/b/c/none", lObject) != S3BucketIndex::UNKNOWN) {
+      std::cerr << "Invalidated key still answered by the index" << std::endl;
+      return 1;
+    }
+    lIndex.refresh(lS3Rest, 3600);
+  }
+  // the reopened index is complete without listing the bucket again
+  S3BucketIndex lIndex(lFileName, bucketName, "", 2);
+  std::vector<S3BucketIndex::Object> lObjects;
+  if (!lIndex.list("a/b/", "/", lObjects) || lObjects.size() != 1
+      || lIndex.refresh(lS3Rest, 3600) != 0) {
+    std::cerr << "Index not persisted" << std::endl;
+    return 1;
+  }
+  std::cout << "Indexed " << lIndex.getNumberOfObjects() << " objects in "
+            << lIndex.getNumberOfRanges() << " ranges" << std::endl;
+  remove(lFileName);
+  return 0;
+}
+
 int
 deleteobject(S3Connection* lS3Rest)
 {
@@ -168,6 +659,10 @@ deleteobject(S3Connection* lS3Rest)
     try {
       lS3Rest->del(bucketName, "a/b/c");
       lS3Rest->del(bucketName, "a/b/c/d");
+      lS3Rest->del(bucketName, "a/b/c/e");
+      lS3Rest->del(bucketName, "a/b/c/f");
+      lS3Rest->del(bucketName, "a/b/c/g");
+      lS3Rest->del(bucketName, "a/b/c/h");
       std::cout << "Object deleted successfully" << std::endl;
     } catch (DeleteException& e) {
   		std::cerr << "Couldn't delete object" << std::endl;
@@ -231,6 +726,43 @@ s3objecttest(int argc, char* argv[])
     if (lReturnCode != 0)
       return lReturnCode;
 
+    lReturnCode = cacheobject(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = compressobject(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = copyobject(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = multipartcopyobject(lFactory, lAccessKeyId, lSecretAccessKey,
+                                      "s3.amazonaws.com");
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = tryobject(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = hedgeobject(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = endpointobject(lFactory, lAccessKeyId, lSecretAccessKey, "s3.amazonaws.com");
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = http2object(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
+    lReturnCode = indexobject(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
     lReturnCode = deleteobject(lS3Rest.get());
     if (lReturnCode != 0)
       return lReturnCode;
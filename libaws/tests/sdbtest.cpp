@@ -182,6 +182,19 @@ int queryWithAttributes(SDBConnection* lCon) {
 	return 0;
 }
 
+int tryGetAttributes(SDBConnection* lCon) {
+	// errors are reported by the responses of the try functions
+	GetAttributesResponsePtr lPtr = lCon->tryGetAttributes("missingDomain",
+			"testItem");
+	if (lPtr->isSuccessful()
+			|| lPtr->getErrorCode() != SDBException::AWS_SimpleDomainService_NonExistentDomain) {
+		std::cerr << "Got attributes of a domain that doesn't exist" << std::endl;
+		return 1;
+	}
+	std::cout << "Get attributes failed as expected: " << lPtr->getErrorMessage() << std::endl;
+	return 0;
+}
+
 int sdbtest(int argc, char* argv[]) {
 	AWSConnectionFactory* lFactory = AWSConnectionFactory::getInstance();
 
@@ -225,6 +238,9 @@ int sdbtest(int argc, char* argv[]) {
 		if (queryWithAttributes(lCon) != 0) {
 			return 1;
 		}
+		if (tryGetAttributes(lCon) != 0) {
+			return 1;
+		}
 		if (deleteDomain(lCon) != 0) {
 			return 1;
 		}
@@ -106,7 +106,7 @@ testMessages(SQSConnection* lSQSCon)
       SendMessageResponsePtr lSendResponse = lSQSCon->sendMessage(lAQueueURL, "my cool body");
       std::string lMessageId = lSendResponse->getMessageId();
       if (lMessageId == "") {
-      	std::cout << "Emtpy message ID" << std::cout;
+      	std::cout << "Emtpy message ID" << std::endl;
       	return 1;
       }
       std::cout << "Message sent. ID: " << lMessageId << std::endl;
@@ -148,6 +148,47 @@ testMessages(SQSConnection* lSQSCon)
   return 0;
 }
 
+int
+testTryMessages(SQSConnection* lSQSCon)
+{
+  CreateQueueResponsePtr lCreateQueue = lSQSCon->createQueue("aQueue");
+  std::string lAQueueURL = lCreateQueue->getQueueUrl();
+
+  // errors are reported by the responses of the try functions
+  SendMessageResponsePtr lSendResponse = lSQSCon->trySendMessage(lAQueueURL, "my cool body");
+  if (!lSendResponse->isSuccessful() || lSendResponse->getErrorCode() != SQSException::NoError) {
+    std::cout << "Couldn't send message: " << lSendResponse->getErrorMessage() << std::endl;
+    return 1;
+  }
+
+  ReceiveMessageResponsePtr lReceiveResponse = lSQSCon->tryReceiveMessage(lAQueueURL + "Missing", 1);
+  if (lReceiveResponse->isSuccessful() || lReceiveResponse->getErrorCode() == SQSException::NoError) {
+    std::cout << "Received a message from a queue that doesn't exist" << std::endl;
+    return 1;
+  }
+  std::cout << "Receive failed as expected: " << lReceiveResponse->getErrorMessage() << std::endl;
+
+  lReceiveResponse = lSQSCon->tryReceiveMessage(lAQueueURL, 1);
+  if (!lReceiveResponse->isSuccessful() || lReceiveResponse->getNumberOfRetrievedMessages() != 1) {
+    std::cout << "Couldn't receive the message" << std::endl;
+    return 1;
+  }
+  ReceiveMessageResponse::Message lMessage;
+  lReceiveResponse->open();
+  lReceiveResponse->next(lMessage);
+  lReceiveResponse->close();
+
+  DeleteMessageResponsePtr lDeleteResponse = lSQSCon->tryDeleteMessage(lAQueueURL,
+      lMessage.receipt_handle);
+  if (!lDeleteResponse->isSuccessful()) {
+    std::cout << "Couldn't delete message: " << lDeleteResponse->getErrorMessage() << std::endl;
+    return 1;
+  }
+
+  lSQSCon->deleteQueue(lAQueueURL);
+  return 0;
+}
+
 int
 sqstest(int argc, char* argv[])
 {
@@ -186,6 +227,10 @@ sqstest(int argc, char* argv[])
     if (lReturnCode != 0)
       return lReturnCode;
 
+    lReturnCode = testTryMessages(lS3Rest.get());
+    if (lReturnCode != 0)
+      return lReturnCode;
+
 
   } catch (AWSConnectionException& e) {
     std::cerr << e.what() << std::endl;
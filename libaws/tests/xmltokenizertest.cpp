@@ -0,0 +1,209 @@
+/*
+ * Copyright 2008 28msec, Inc.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <sys/time.h>
+#include <libxml/parser.h>
+#include <../src/xmltokenizer.h> //HACK
+
+using namespace aws;
+
+// a ListBucketResult with some keys that need escaping
+static std::string
+listBucketResult()
+{
+  std::stringstream lDoc;
+  lDoc << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+       << "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+       << "<Name>testbucket</Name><Prefix></Prefix><Marker></Marker>"
+       << "<MaxKeys>1000</MaxKeys><IsTruncated>false</IsTruncated>";
+  for (int i = 0; i < 100; ++i) {
+    lDoc << "<Contents><Key>dir/file &amp; &lt;" << i << "&gt; &#x263A;</Key>"
+         << "<LastModified>2009-10-12T17:50:30.000Z</LastModified>"
+         << "<ETag>&quot;fba9dede5f27731c9771645a39863328&quot;</ETag>"
+         << "<Size>434234</Size>"
+         << "<Owner><ID>75aa57f09aa0c8caeab4f8c24e99d10f8e7faeebf76c078efc7c6caea54ba06a</ID>"
+         << "<DisplayName>mtd@amazon.com</DisplayName></Owner>"
+         << "<StorageClass>STANDARD</StorageClass></Contents>\n";
+  }
+  lDoc << "<CommonPrefixes><Prefix>photos/</Prefix></CommonPrefixes></ListBucketResult>";
+  return lDoc.str();
+}
+
+static std::string
+receiveMessageResponse()
+{
+  std::stringstream lDoc;
+  lDoc << "<ReceiveMessageResponse xmlns=\"http://queue.amazonaws.com/doc/2009-02-01/\">"
+       << "<ReceiveMessageResult>";
+  for (int i = 0; i < 10; ++i) {
+    lDoc << "<Message><MessageId>5fea7756-0ea4-451a-a703-a558b933e274</MessageId>"
+         << "<ReceiptHandle>MbZj6wDWli+JvwwJaBV+3dcjk2YW2vA3+STFFljTM8tJJg6HRG6PYSasuWXPJB+Cw"
+         << "Lj1FjgXUv1uSj1gUPAWV66FU/WeR4mq2OKpEGYWbnLmpRCJVAyeMjeU5ZBdtcQ+QE</ReceiptHandle>"
+         << "<MD5OfBody>fafb00f5732ab283681e124bf8747ed1</MD5OfBody>"
+         << "<Body><![CDATA[<order id=\"" << i << "\"/>]]> message &amp; body " << i << "</Body>"
+         << "<Attribute><Name>SenderId</Name><Value>195004372649</Value></Attribute>"
+         << "<!-- comment --></Message>";
+  }
+  lDoc << "</ReceiveMessageResult><ResponseMetadata>"
+       << "<RequestId>b6633655-283d-45b4-aee4-4e84e0ae6afa</RequestId>"
+       << "</ResponseMetadata></ReceiveMessageResponse>";
+  return lDoc.str();
+}
+
+// records the events of a document, joining adjacent text
+static void
+recordStart(void* ctx, const xmlChar* localname, const xmlChar* prefix,
+            const xmlChar* URI, int nb_namespaces, const xmlChar** namespaces,
+            int nb_attributes, int nb_defaulted, const xmlChar** attributes)
+{
+  *static_cast<std::string*>(ctx) += std::string("\n<") + (const char*) localname + ">";
+}
+
+static void
+recordCharacters(void* ctx, const xmlChar* value, int len)
+{
+  static_cast<std::string*>(ctx)->append((const char*) value, len);
+}
+
+static void
+recordEnd(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI)
+{
+  *static_cast<std::string*>(ctx) += std::string("</") + (const char*) localname + ">";
+}
+
+// counts the events, such that the throughput is that of the parser
+static void
+countStart(void* ctx, const xmlChar* localname, const xmlChar* prefix,
+           const xmlChar* URI, int nb_namespaces, const xmlChar** namespaces,
+           int nb_attributes, int nb_defaulted, const xmlChar** attributes)
+{
+  ++*static_cast<size_t*>(ctx);
+}
+
+static void
+countCharacters(void* ctx, const xmlChar* value, int len)
+{
+  *static_cast<size_t*>(ctx) += len;
+}
+
+static double
+now()
+{
+  struct timeval lTime;
+  gettimeofday(&lTime, 0);
+  return lTime.tv_sec + lTime.tv_usec / 1000000.0;
+}
+
+static int
+testDocument(const std::string& aName, const std::string& aDoc)
+{
+  xmlSAXHandler lHandler;
+  memset(&lHandler, 0, sizeof(lHandler));
+  lHandler.initialized    = XML_SAX2_MAGIC;
+  lHandler.startElementNs = recordStart;
+  lHandler.characters     = recordCharacters;
+  lHandler.endElementNs   = recordEnd;
+
+  std::string lExpected;
+  xmlParserCtxtPtr lCtxt = xmlCreatePushParserCtxt(&lHandler, &lExpected, NULL, 0, 0);
+  xmlParseChunk(lCtxt, aDoc.c_str(), aDoc.size(), 1);
+  xmlFreeParserCtxt(lCtxt);
+
+  // the same events for any chunking of the document
+  XMLTokenizer lTokenizer;
+  size_t lChunkSizes[] = { 1, 2, 3, 7, 64, 1000, aDoc.size() };
+  for (size_t i = 0; i < sizeof(lChunkSizes) / sizeof(size_t); ++i) {
+    std::string lResult;
+    lTokenizer.reset(&lHandler, &lResult);
+    bool lOk = true;
+    for (size_t lPos = 0; lPos < aDoc.size() && lOk; lPos += lChunkSizes[i]) {
+      size_t lSize = std::min(lChunkSizes[i], aDoc.size() - lPos);
+      lOk = lTokenizer.parseChunk(aDoc.c_str() + lPos, lSize, false);
+    }
+    lOk = lOk && lTokenizer.parseChunk(0, 0, true);
+    if (!lOk || lResult != lExpected) {
+      std::cerr << aName << ": tokenizer differs from libxml2 for chunks of "
+                << lChunkSizes[i] << " bytes" << std::endl;
+      return 1;
+    }
+  }
+
+  // throughput of both parsers (reusing the parser as ParserCache does)
+  xmlSAXHandler lCounter;
+  memset(&lCounter, 0, sizeof(lCounter));
+  lCounter.initialized    = XML_SAX2_MAGIC;
+  lCounter.startElementNs = countStart;
+  lCounter.characters     = countCharacters;
+
+  const int lIterations = 2000;
+  size_t lCount = 0;
+  double lStart = now();
+  lCtxt = xmlCreatePushParserCtxt(&lCounter, &lCount, NULL, 0, 0);
+  for (int i = 0; i < lIterations; ++i) {
+    xmlCtxtResetPush(lCtxt, NULL, 0, NULL, NULL);
+    lCtxt->userData = &lCount;
+    xmlParseChunk(lCtxt, aDoc.c_str(), aDoc.size(), 1);
+  }
+  xmlFreeParserCtxt(lCtxt);
+  double lLibxml = now() - lStart;
+
+  lStart = now();
+  for (int i = 0; i < lIterations; ++i) {
+    lTokenizer.reset(&lCounter, &lCount);
+    lTokenizer.parseChunk(aDoc.c_str(), aDoc.size(), true);
+  }
+  double lTokenizerTime = now() - lStart;
+
+  double lMegaBytes = (double) aDoc.size() * lIterations / (1024 * 1024);
+  std::cout << aName << " (" << aDoc.size() << " bytes): libxml2 "
+            << lMegaBytes / lLibxml << " MB/s, tokenizer "
+            << lMegaBytes / lTokenizerTime << " MB/s" << std::endl;
+  return 0;
+}
+
+static int
+testMalformed()
+{
+  xmlSAXHandler lHandler;
+  memset(&lHandler, 0, sizeof(lHandler));
+  lHandler.initialized = XML_SAX2_MAGIC;
+
+  const char* lDocs[] = { "<a><b>", "<a></a></a>", "<>", "<a><!-- x</a>", "<a></b>",
+                          "<a><b></a></b>", "<x:a></y:a>", "<a></a b>", "<a><!x" };
+  XMLTokenizer lTokenizer;
+  for (size_t i = 0; i < sizeof(lDocs) / sizeof(char*); ++i) {
+    lTokenizer.reset(&lHandler, 0);
+    if (lTokenizer.parseChunk(lDocs[i], strlen(lDocs[i]), true)) {
+      std::cerr << "malformed document accepted: " << lDocs[i] << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int
+xmltokenizertest(int argc, char* argv[])
+{
+  if (testDocument("ListBucketResult", listBucketResult()) != 0)
+    return 1;
+  if (testDocument("ReceiveMessageResponse", receiveMessageResponse()) != 0)
+    return 1;
+  return testMalformed();
+}